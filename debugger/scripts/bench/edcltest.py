@@ -0,0 +1,169 @@
+"""
+ @copyright  Copyright 2019 Sergey Khabarov. All right reserved.
+ @author     Sergey Khabarov - sergeykhbr@gmail.com
+ @brief      EDCL windowed transfer test with the lossy UDP link.
+
+  Starts the functional RISC-V platform headless. The debugger TAP talks
+  to the simulated GRETH responder over a pair of UdpService links. The
+  'LossPeriod' attribute of these links drops every N-th datagram:
+  requests on 'udpedcl' and responses on 'udpboard'. Random data is
+  written with 'loadbin' and read back with 'memdump' through the EDCL
+  TAP until the 14-bit sequence counter wraps several times. The test
+  fails on any data mismatch, or when no retransmission was reported.
+
+  Must be started from the directory with appdbg64g.exe (see _run_bench.sh):
+      python3 edcltest.py                      - default loss periods
+      python3 edcltest.py -q 5 -r 3            - request/response loss
+"""
+
+import os
+import sys
+import time
+import socket
+import tempfile
+import subprocess
+import argparse
+import simbench
+
+EDCL_SEGMENT_BYTES = 32     # EDCL_PAYLOAD_MAX_BYTES in edcl.h
+EDCL_SEQ_TOTAL = 1 << 14
+TEST_ADDR = 0x10040000      # upper half of sram0, target is halted
+TEST_BYTES = 128 * 1024
+# Printed by EdclService on timeout and on NAK with the expected counter
+RESEND_MESSAGES = [b'Re-sending from', b'Re-sending transaction']
+
+class EdclRpcClient(simbench.RpcClient):
+    """Counts the retransmission messages of the EDCL TAP"""
+    def __init__(self, port):
+        simbench.RpcClient.__init__(self, port)
+        self.resend = 0
+
+    def receive(self):
+        rx = self.skt.recv(simbench.BUFFER_SIZE)
+        if len(rx) == 0:
+            raise IOError('Connection closed by simulator')
+        self.buffer += rx
+        msglist = self.buffer.split(b'\0')
+        self.buffer = msglist[-1]
+        resplist = []
+        for msg in msglist[:-1]:
+            if msg[2:9] == b'Console':
+                for pattern in RESEND_MESSAGES:
+                    self.resend += msg.count(pattern)
+                continue
+            resplist.append(msg)
+        return resplist
+
+def run_test(exe, port, args):
+    wl = {'Name':'edcltest',
+          'Attr':{'edcltap':[['LogLevel', 3],
+                             ['WindowSize', args.window]],
+                  'udpedcl':[['LossPeriod', args.req_loss],
+                             ['Timeout', args.timeout]],
+                  'udpboard':[['LossPeriod', args.resp_loss]]}}
+    with open(simbench.TARGETS_DIR + 'functional_sim_gui.json') as f:
+        cfg, init = simbench.make_headless(
+                simbench.config_to_object(f.read()), wl, port)
+    fd, cfgfile = tempfile.mkstemp(prefix='edcltest_', suffix='.json')
+    with os.fdopen(fd, 'w') as f:
+        f.write(repr(cfg))
+    fd, wrfile = tempfile.mkstemp(prefix='edcltest_', suffix='.bin')
+    os.close(fd)
+    fd, rdfile = tempfile.mkstemp(prefix='edcltest_', suffix='.bin')
+    os.close(fd)
+
+    env = dict(os.environ)
+    env['LD_LIBRARY_PATH'] = os.getcwd()
+    devnull = open(os.devnull, 'w')
+    proc = subprocess.Popen([exe, '-c', cfgfile, '-nogui'], env=env,
+                            stdin=subprocess.PIPE, stdout=devnull,
+                            stderr=devnull)
+    rpc = EdclRpcClient(port)
+    errors = 0
+    try:
+        if not rpc.connect(proc):
+            raise IOError('Simulator not started')
+        t_end = time.time() + simbench.CONNECT_TIMEOUT_SEC
+        while rpc.cmd('status') is None:
+            if time.time() > t_end:
+                raise IOError('Target not responding')
+            time.sleep(0.1)
+        rpc.cmd('halt')
+
+        segments = 0
+        rnd = 0
+        t_start = time.time()
+        while segments < args.wraps * EDCL_SEQ_TOTAL:
+            data = os.urandom(TEST_BYTES)
+            with open(wrfile, 'wb') as f:
+                f.write(data)
+            rpc.cmd('loadbin %s 0x%x' % (wrfile, TEST_ADDR))
+            rpc.cmd('memdump 0x%x %d %s' % (TEST_ADDR, TEST_BYTES, rdfile))
+            with open(rdfile, 'rb') as f:
+                rdata = f.read()
+            if rdata != data:
+                errors += 1
+                bad = next((i for i in range(min(len(rdata), len(data)))
+                            if rdata[i] != data[i]), min(len(rdata), len(data)))
+                sys.stderr.write('round %d: mismatch at 0x%x\n'
+                                 % (rnd, TEST_ADDR + bad))
+            segments += 2 * TEST_BYTES // EDCL_SEGMENT_BYTES
+            rnd += 1
+        wall = time.time() - t_start
+        # Console output may be delivered after the last response
+        rpc.skt.settimeout(0.5)
+        try:
+            while True:
+                rpc.receive()
+        except socket.timeout:
+            pass
+        rpc.skt.settimeout(None)
+
+        print('rounds %d, segments %d (sequence wraps %d), '
+              'retransmissions %d, %.1f s'
+              % (rnd, segments, segments // EDCL_SEQ_TOTAL, rpc.resend, wall))
+        if rpc.resend == 0 and (args.req_loss or args.resp_loss):
+            sys.stderr.write('No retransmission reported\n')
+            errors += 1
+        rpc.cmd('exit')
+    except (IOError, socket.error) as e:
+        sys.stderr.write('%s\n' % e)
+        errors += 1
+    finally:
+        rpc.close()
+        for i in range(50):
+            if proc.poll() is not None:
+                break
+            time.sleep(0.1)
+        if proc.poll() is None:
+            proc.kill()
+            proc.wait()
+        devnull.close()
+        for fname in [cfgfile, wrfile, rdfile]:
+            os.remove(fname)
+    return errors
+
+def main():
+    parser = argparse.ArgumentParser(description='EDCL lossy link test')
+    parser.add_argument('-q', '--req-loss', type=int, default=7,
+                        help='drop every N-th request, 0 = no loss')
+    parser.add_argument('-r', '--resp-loss', type=int, default=11,
+                        help='drop every N-th response, 0 = no loss')
+    parser.add_argument('-w', '--window', type=int, default=8,
+                        help='EDCL requests in flight')
+    parser.add_argument('-t', '--timeout', type=int, default=50,
+                        help='EDCL link timeout in msec')
+    parser.add_argument('-n', '--wraps', type=int, default=2,
+                        help='sequence counter wraps to test')
+    parser.add_argument('-p', '--port', type=int, default=simbench.TCP_PORT,
+                        help='rpc server port')
+    parser.add_argument('-e', '--exe', default='./appdbg64g.exe',
+                        help='simulator executable')
+    args = parser.parse_args()
+
+    errors = run_test(args.exe, args.port, args)
+    print('EDCL test %s' % ('FAILED' if errors else 'PASSED'))
+    return 1 if errors else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
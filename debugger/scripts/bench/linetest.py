@@ -0,0 +1,98 @@
+"""
+ @copyright  Copyright 2019 Sergey Khabarov. All right reserved.
+ @author     Sergey Khabarov - sergeykhbr@gmail.com
+ @brief      DWARF line table lookup test of the 'line' command.
+
+  Starts the functional RISC-V platform headless and loads the Zephyr
+  example ELF-file built with '--gc-sections'. Its '.debug_line' contains
+  sequences of the discarded functions relocated to address 0. Addresses
+  without line info must return nil, addresses of the code must return
+  the same file and line as 'readelf --debug-dump=decodedline'.
+
+  Must be started from the directory with appdbg64g.exe (see _run_bench.sh):
+      python3 linetest.py
+"""
+
+import os
+import sys
+import time
+import socket
+import tempfile
+import subprocess
+import argparse
+import simbench
+
+ELF_FILE = simbench.EXAMPLES_DIR + 'zephyr/gcc711/zephyr.elf'
+
+# [request, expected file suffix or None, expected line]
+CHECKS = [
+    ['0x0', None, 0],                   # discarded sequences start here
+    ['0x1000', None, 0],
+    ['0x0ffffffe', None, 0],            # below the first sequence
+    ['0x10000000', 'swap.S', 56],
+    ['main', 'main.c', 45],
+    ['0x20000000', None, 0],            # above the last sequence
+]
+
+def run_test(exe, port):
+    wl = {'Name':'linetest', 'InitCommands':[]}
+    with open(simbench.TARGETS_DIR + 'functional_sim_gui.json') as f:
+        cfg, init = simbench.make_headless(
+                simbench.config_to_object(f.read()), wl, port)
+    fd, cfgfile = tempfile.mkstemp(prefix='linetest_', suffix='.json')
+    with os.fdopen(fd, 'w') as f:
+        f.write(repr(cfg))
+
+    env = dict(os.environ)
+    env['LD_LIBRARY_PATH'] = os.getcwd()
+    devnull = open(os.devnull, 'w')
+    proc = subprocess.Popen([exe, '-c', cfgfile, '-nogui'], env=env,
+                            stdin=subprocess.PIPE, stdout=devnull,
+                            stderr=devnull)
+    rpc = simbench.RpcClient(port)
+    errors = 0
+    try:
+        if not rpc.connect(proc):
+            raise IOError('Simulator not started')
+        rpc.cmd('loadelf %s nocode' % ELF_FILE)
+        for req, fname, line in CHECKS:
+            resp = rpc.cmd('line %s' % req)
+            if fname is None:
+                ok = resp is None
+            else:
+                ok = (isinstance(resp, list) and len(resp) == 2
+                      and resp[0].endswith(fname) and resp[1] == line)
+            print('line %-12s %-40s %s' % (req, resp, 'OK' if ok else 'FAIL'))
+            if not ok:
+                errors += 1
+        rpc.cmd('exit')
+    except (IOError, socket.error) as e:
+        sys.stderr.write('%s\n' % e)
+        errors += 1
+    finally:
+        rpc.close()
+        for i in range(50):
+            if proc.poll() is not None:
+                break
+            time.sleep(0.1)
+        if proc.poll() is None:
+            proc.kill()
+            proc.wait()
+        devnull.close()
+        os.remove(cfgfile)
+    return errors
+
+def main():
+    parser = argparse.ArgumentParser(description='DWARF line table test')
+    parser.add_argument('-p', '--port', type=int, default=simbench.TCP_PORT,
+                        help='rpc server port')
+    parser.add_argument('-e', '--exe', default='./appdbg64g.exe',
+                        help='simulator executable')
+    args = parser.parse_args()
+
+    errors = run_test(args.exe, args.port)
+    print('Line table test %s' % ('FAILED' if errors else 'PASSED'))
+    return 1 if errors else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,453 @@
+"""
+  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @brief     Simulator throughput benchmark.
+
+  Starts appdbg64g headless for every workload (GUI service is removed from
+  the platform configuration), runs a fixed number of instructions through
+  the JSON-RPC 'Command' interface and reports host MIPS, wall time and
+  RSS of the simulator process as JSON. MIPS is computed from the CPU
+  'steps' counter, a workload halted before the end is reported as an
+  error. RPC workloads instead repeat the
+  list of requests with the halted target and report requests per second
+  and response size (JSON parser/serializer cost on both sides).
+
+  Must be started from the directory with appdbg64g.exe (see _run_bench.sh):
+      python3 simbench.py                      - run all workloads
+      python3 simbench.py -w riscv_dhrystone   - run selected workloads
+      python3 simbench.py -l                   - list workloads
+      python3 simbench.py -o result.json       - store report into file
+"""
+
+import os
+import sys
+import time
+import json
+import socket
+import tempfile
+import subprocess
+import argparse
+
+TCP_IP = '127.0.0.1'
+TCP_PORT = 8697
+BUFFER_SIZE = 65536
+POLLING_SEC = 1.0
+RUN_TIMEOUT_SEC = 3600.0
+CONNECT_TIMEOUT_SEC = 10.0
+# Printed by functional CPU models when 'c N' is finished
+HALT_MESSAGE = b'Stepping breakpoint'
+
+TARGETS_DIR = '../../targets/'
+EXAMPLES_DIR = '../../../examples/'
+
+DHRY_RISCV = EXAMPLES_DIR + 'dhrystone21/makefiles/bin/dhrystone21'
+DHRY_ARM = EXAMPLES_DIR + 'dhrystone21/makefiles/binarm/dhrystone21'
+
+"""
+  Workload description:
+    Config       - platform configuration from the 'targets' directory
+    Model        - CPU model kind, reported as is
+    Steps        - number of instructions to execute
+    Attr         - attributes overriding: {'InstanceName':[[name,value],..]}
+    InitCommands - replace 'InitCommands' of the platform configuration,
+                   executed over RPC once the debug port answers
+    Requests     - RPC workload: list of [RequestType, Action] to repeat
+    Count        - RPC workload: number of repetitions
+"""
+WORKLOADS = [
+    {'Name':'riscv_zephyr',
+     'Descr':'Zephyr kernel boot and shell: timer interrupts, UART output',
+     'Model':'functional RISC-V',
+     'Config':'functional_sim_gui.json',
+     'Steps':20000000},
+    {'Name':'riscv_dhrystone',
+     'Descr':'Dhrystone 2.1: integer, branches, strcpy/memcpy loops',
+     'Model':'functional RISC-V',
+     'Config':'functional_sim_gui.json',
+     'Steps':20000000,
+     'Attr':{'fwimage0':[['InitFile', DHRY_RISCV + '.hex']],
+             'sram0':[['InitFile', DHRY_RISCV + '.hex']]},
+     'InitCommands':['loadelf ' + DHRY_RISCV + '.elf nocode']},
+    {'Name':'arm_dhrystone',
+     'Descr':'Dhrystone 2.1 compiled for ARM/Thumb',
+     'Model':'functional ARM',
+     'Config':'functional_arm_gui.json',
+     'Steps':20000000},
+    {'Name':'thumb_stm32l4',
+     'Descr':'STM32L476 demo: Thumb-2, SysTick/NVIC interrupts, peripherals',
+     'Model':'functional ARM',
+     'Config':'stm32l4xx_gui.json',
+     'Steps':20000000},
+    {'Name':'sysc_zephyr',
+     'Descr':'Zephyr kernel boot on the RIVER SystemC RTL model',
+     'Model':'SystemC RIVER',
+     'Config':'sysc_river_gui.json',
+     'Steps':1000000},
+    {'Name':'rpc_config',
+     'Descr':'JSON-RPC: full platform configuration response',
+     'Model':'functional ARM',
+     'Config':'stm32l4xx_gui.json',
+     'Requests':[['Configuration', '']],
+     'Count':100},
+    {'Name':'rpc_memdump',
+     'Descr':'JSON-RPC: 64 KB memory dump response',
+     'Model':'functional RISC-V',
+     'Config':'functional_sim_gui.json',
+     'Requests':[['Command', 'memdump 0x10000000 65536 ' + os.devnull]],
+     'Count':50},
+    {'Name':'rpc_small',
+     'Descr':'JSON-RPC: short commands (registers, status, 4 B read)',
+     'Model':'functional RISC-V',
+     'Config':'functional_sim_gui.json',
+     'Requests':[['Command', 'regs'], ['Command', 'status'],
+                 ['Command', 'read 0x10000000 4']],
+     'Count':100},
+]
+
+class ConfigParser(object):
+    """Platform configurations use relaxed python-like syntax: multi-line
+       strings, optional commas. Mirror of string_to_attribute() parser."""
+    def __init__(self, text):
+        self.text = text
+        self.off = 0
+
+    def skip(self):
+        while self.off < len(self.text) and self.text[self.off] in ' \r\n\t':
+            self.off += 1
+
+    def peek(self):
+        self.skip()
+        if self.off < len(self.text):
+            return self.text[self.off]
+        return ''
+
+    def parse(self):
+        c = self.peek()
+        if c in '\'"':
+            end = self.text.index(c, self.off + 1)
+            val = self.text[self.off + 1:end]
+            self.off = end + 1
+            return val
+        if c in '[{':
+            is_list = c == '['
+            val = [] if is_list else {}
+            self.off += 1
+            while self.peek() not in ']}':
+                item = self.parse()
+                if is_list:
+                    val.append(item)
+                else:
+                    if self.peek() != ':':
+                        raise ValueError('Wrong dictionary delimiter')
+                    self.off += 1
+                    val[item] = self.parse()
+                if self.peek() == ',':
+                    self.off += 1
+            self.off += 1
+            return val
+        for word, val in (('None', None), ('false', False), ('False', False),
+                          ('true', True), ('True', True)):
+            if self.text.startswith(word, self.off):
+                self.off += len(word)
+                return val
+        start = self.off
+        while self.off < len(self.text) \
+            and self.text[self.off] not in ' \r\n\t,:]})':
+            self.off += 1
+        word = self.text[start:self.off]
+        if start == self.off:
+            raise ValueError('Can\'t detect format at %d' % start)
+        if '.' in word:
+            return float(word)
+        return int(word, 0)
+
+def config_to_object(text):
+    return ConfigParser(text).parse()
+
+def set_attribute(attrlist, name, value):
+    for item in attrlist:
+        if len(item) >= 2 and item[0] == name:
+            item[1] = value
+            return
+    attrlist.append([name, value])
+
+def make_headless(cfg, wl, port):
+    cfg['GlobalSettings']['GUI'] = False
+    # Init commands are sent over RPC when the target is ready, otherwise
+    # the run may start before the loader has finished.
+    init = wl.get('InitCommands', cfg['GlobalSettings'].get('InitCommands'))
+    cfg['GlobalSettings']['InitCommands'] = []
+    services = []
+    for serv in cfg['Services']:
+        if serv['Class'] == 'GuiPluginClass':
+            continue
+        services.append(serv)
+        for inst in serv['Instances']:
+            name = inst['Name']
+            if name == 'rpcserver':
+                set_attribute(inst['Attr'], 'HostPort', port)
+            elif name in ('gdbserver', 'binserver'):
+                set_attribute(inst['Attr'], 'Enable', False)
+            if name in wl.get('Attr', {}):
+                for item in wl['Attr'][name]:
+                    set_attribute(inst['Attr'], item[0], item[1])
+    cfg['Services'] = services
+    return cfg, init or []
+
+class RpcClient(object):
+    """Minimal blocking client: one request in flight. Console output
+       redirected by the simulator is only checked on the halt message of
+       the functional CPU models so that the end of run is detected without
+       frequent 'isrunning' polling (each request slows down simulation)."""
+    def __init__(self, port):
+        self.skt = None
+        self.port = port
+        self.messageid = 0
+        self.buffer = b''
+        self.halted = False
+
+    def connect(self, proc):
+        t_end = time.time() + CONNECT_TIMEOUT_SEC
+        while time.time() < t_end:
+            if proc.poll() is not None:
+                return False
+            try:
+                self.skt = socket.create_connection((TCP_IP, self.port))
+                return True
+            except socket.error:
+                time.sleep(0.1)
+        return False
+
+    def receive(self):
+        """Returns list of raw responses, console messages are filtered out."""
+        rx = self.skt.recv(BUFFER_SIZE)
+        if len(rx) == 0:
+            raise IOError('Connection closed by simulator')
+        self.buffer += rx
+        msglist = self.buffer.split(b'\0')
+        self.buffer = msglist[-1]
+        resplist = []
+        for msg in msglist[:-1]:
+            if msg[2:9] == b'Console':
+                if HALT_MESSAGE in msg:
+                    self.halted = True
+                continue
+            resplist.append(msg)
+        return resplist
+
+    def request(self, reqtype, action, raw=False):
+        """Returns response or its string when raw is True"""
+        req = str([self.messageid, reqtype, action])
+        self.skt.sendall(req.encode() + b'\0')
+        while True:
+            for msg in self.receive():
+                resp = msg if raw else config_to_object(msg.decode('latin-1'))
+                if raw:
+                    self.messageid += 1
+                    return resp
+                if resp[0] == self.messageid:
+                    self.messageid += 1
+                    if len(resp) > 1:
+                        return resp[1]
+                    return None
+
+    def cmd(self, cmd):
+        return self.request('Command', cmd)
+
+    def wait_halt(self, timeout):
+        """Wait for the halt message, 'isrunning' is polled as a fallback
+           for models that don't print it."""
+        t_end = time.time() + timeout
+        while not self.halted:
+            if time.time() > t_end:
+                raise IOError('Timeout')
+            self.skt.settimeout(POLLING_SEC)
+            try:
+                self.receive()
+                continue
+            except socket.timeout:
+                pass
+            finally:
+                self.skt.settimeout(None)
+            if not self.cmd('isrunning'):
+                return
+
+    def close(self):
+        if self.skt is not None:
+            self.skt.close()
+
+def read_rss_kb(pid):
+    """Linux only: current and peak resident set size."""
+    res = {'RssKb':None, 'RssPeakKb':None}
+    try:
+        with open('/proc/%d/status' % pid) as f:
+            for line in f:
+                if line.startswith('VmRSS:'):
+                    res['RssKb'] = int(line.split()[1])
+                elif line.startswith('VmHWM:'):
+                    res['RssPeakKb'] = int(line.split()[1])
+    except IOError:
+        pass
+    return res
+
+def read_steps(rpc):
+    """Executed instructions counter of the CPU"""
+    steps = rpc.cmd('reg steps')
+    if not isinstance(steps, int):
+        raise IOError('Steps counter not available')
+    return steps
+
+def run_steps(rpc, wl, res, collect_stat):
+    """MIPS is computed from the executed instructions. The run fails when
+       the target stopped earlier: breakpoint, error or a hung model."""
+    if collect_stat:
+        rpc.cmd('stats enable')
+    rpc.halted = False
+    steps_start = read_steps(rpc)
+    t_start = time.time()
+    rpc.cmd('c %d' % wl['Steps'])
+    rpc.wait_halt(RUN_TIMEOUT_SEC)
+    wall = time.time() - t_start
+    executed = read_steps(rpc) - steps_start
+    res['WallSec'] = round(wall, 3)
+    res['Executed'] = executed
+    res['MIPS'] = round(executed / wall / 1000000.0, 3)
+    if collect_stat:
+        res['Statistic'] = rpc.cmd('stats')
+    if executed < wl['Steps']:
+        res['Error'] = 'Target halted after %d of %d instructions' % (
+                executed, wl['Steps'])
+
+def run_requests(rpc, wl, res):
+    """Responses aren't parsed by the client to measure the simulator only"""
+    rxbytes = 0
+    t_start = time.time()
+    for i in range(wl['Count']):
+        for req in wl['Requests']:
+            rxbytes += len(rpc.request(req[0], req[1], raw=True))
+    wall = time.time() - t_start
+    total = wl['Count'] * len(wl['Requests'])
+    res['WallSec'] = round(wall, 3)
+    res['Requests'] = total
+    res['RequestsPerSec'] = round(total / wall, 1)
+    res['ResponseBytes'] = rxbytes // total
+
+def run_workload(exe, wl, port, collect_stat):
+    res = {'Name':wl['Name'], 'Model':wl['Model'], 'Descr':wl['Descr']}
+    if 'Steps' in wl:
+        res['Steps'] = wl['Steps']
+    with open(TARGETS_DIR + wl['Config']) as f:
+        cfg, init = make_headless(config_to_object(f.read()), wl, port)
+    fd, cfgfile = tempfile.mkstemp(prefix='simbench_', suffix='.json')
+    with os.fdopen(fd, 'w') as f:
+        f.write(repr(cfg))
+
+    env = dict(os.environ)
+    env['LD_LIBRARY_PATH'] = os.getcwd()
+    devnull = open(os.devnull, 'w')
+    proc = subprocess.Popen([exe, '-c', cfgfile, '-nogui'], env=env,
+                            stdin=subprocess.PIPE, stdout=devnull,
+                            stderr=devnull)
+    rpc = RpcClient(port)
+    try:
+        if not rpc.connect(proc):
+            res['Error'] = 'Simulator not started (missing plugin?)'
+            return res
+        # Debug port answers only after the platform config is done
+        t_end = time.time() + CONNECT_TIMEOUT_SEC
+        while rpc.cmd('status') is None:
+            if time.time() > t_end:
+                raise IOError('Target not responding')
+            time.sleep(0.1)
+        for cmd in init:
+            rpc.cmd(cmd)
+        res.update(read_rss_kb(proc.pid))
+        res['RssStartKb'] = res.pop('RssKb')
+        if 'Requests' in wl:
+            run_requests(rpc, wl, res)
+        else:
+            run_steps(rpc, wl, res, collect_stat)
+        res.update(read_rss_kb(proc.pid))
+        rpc.cmd('exit')
+    except (IOError, socket.error) as e:
+        res['Error'] = str(e)
+    finally:
+        rpc.close()
+        for i in range(50):
+            if proc.poll() is not None:
+                break
+            time.sleep(0.1)
+        if proc.poll() is None:
+            proc.kill()
+            proc.wait()
+        devnull.close()
+        os.remove(cfgfile)
+    return res
+
+def main():
+    parser = argparse.ArgumentParser(description='Simulator benchmark')
+    parser.add_argument('-w', '--workload', action='append',
+                        help='workload name (default: all)')
+    parser.add_argument('-l', '--list', action='store_true',
+                        help='print workloads list')
+    parser.add_argument('-n', '--steps', type=int,
+                        help='override number of instructions')
+    parser.add_argument('-s', '--stats', action='store_true',
+                        help='collect instructions mix statistic')
+    parser.add_argument('-o', '--output', help='output JSON file')
+    parser.add_argument('-p', '--port', type=int, default=TCP_PORT,
+                        help='rpc server port')
+    parser.add_argument('-e', '--exe', default='./appdbg64g.exe',
+                        help='simulator executable')
+    args = parser.parse_args()
+
+    if args.list:
+        for wl in WORKLOADS:
+            print('%-20s %-20s %s' % (wl['Name'], wl['Model'], wl['Descr']))
+        return 0
+
+    wllist = WORKLOADS
+    if args.workload:
+        wllist = [wl for wl in WORKLOADS if wl['Name'] in args.workload]
+
+    report = {'Host':socket.gethostname(),
+              'Date':time.strftime('%Y-%m-%d %H:%M:%S'),
+              'Workloads':[]}
+    failed = 0
+    for wl in wllist:
+        wl = dict(wl)
+        if args.steps and 'Steps' in wl:
+            wl['Steps'] = args.steps
+        res = run_workload(args.exe, wl, args.port, args.stats)
+        if 'Error' in res:
+            failed += 1
+            sys.stderr.write('%s: %s\n' % (res['Name'], res['Error']))
+        elif 'MIPS' in res:
+            sys.stderr.write('%s: %.3f MIPS\n' % (res['Name'], res['MIPS']))
+        else:
+            sys.stderr.write('%s: %.1f requests/s\n' % (res['Name'],
+                                                         res['RequestsPerSec']))
+        report['Workloads'].append(res)
+
+    text = json.dumps(report, indent=2, sort_keys=True)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text + '\n')
+    else:
+        print(text)
+    return 1 if failed == len(wllist) else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
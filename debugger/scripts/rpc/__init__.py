@@ -29,6 +29,29 @@ class Simulator(object):
         req = ["Command",str(cmd)]
         return self.client.send(req)
 
+    def cmd_async(self, cmd, callback=None):
+        """
+        Send console command without waiting for the response. Use
+        wait() of the returned object to get the result.
+        """
+        req = ["Command",str(cmd)]
+        return self.client.send_async(req, callback)
+
+    def cmd_batch(self, cmdlist):
+        """
+        Execute list of console commands in one request, for an example
+        ['read 0x10000000 4', 'regs']. Returns list of results.
+        """
+        req = [["Command",str(c)] for c in cmdlist]
+        return self.client.send_batch(req)
+
+    def batch(self, reqlist):
+        """
+        Execute list of generic requests [[RequestType, Action], ...] in
+        one request. Returns list of results.
+        """
+        return self.client.send_batch(reqlist)
+
     def disconnect(self):
         self.client.stop()
         self.client.join()
@@ -0,0 +1,110 @@
+"""
+ @copyright  Copyright 2019 Sergey Khabarov. All right reserved.
+ @author     Sergey Khabarov - sergeykhbr@gmail.com
+ @brief      Binary protocol client for bulk memory and registers transfer.
+"""
+
+import socket
+import struct
+
+TCP_IP = '127.0.0.1'
+TCP_PORT = 8690     # binserver, next to the JSON-RPC port 8687
+
+# See src/libdbg64g/services/remote/bincmd.h
+BIN_FRAME_MAGIC = 0x4E494252
+HEADER = struct.Struct('<IIBBHIQII')
+CHUNK_MAX = 1 << 20
+
+BinCmd_MemRead = 0x01
+BinCmd_MemWrite = 0x02
+BinCmd_RegRead = 0x03
+BinCmd_RegWrite = 0x04
+BinCmd_BrAdd = 0x05
+BinCmd_BrRemove = 0x06
+BinCmd_Go = 0x07
+BinCmd_Halt = 0x08
+BinEvent_Halt = 0x80
+BinEvent_Resume = 0x81
+BinEvent_Console = 0x82
+
+class BinClient(object):
+    """
+    Synchronous client of the 'bin' TcpServer. Notifications received
+    while waiting for a response are passed into 'event_listener'
+    callback as (cmd, addr, payload).
+    """
+    def __init__(self, ip=TCP_IP, port=TCP_PORT, event_listener=None):
+        self.skt = socket.create_connection((ip, port))
+        self.skt.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.seqnum = 0
+        self.event_listener = event_listener
+
+    def close(self):
+        self.skt.close()
+
+    def recv_exact(self, size):
+        buf = bytearray()
+        while len(buf) < size:
+            rx = self.skt.recv(size - len(buf))
+            if not rx:
+                raise IOError('Connection closed')
+            buf += rx
+        return bytes(buf)
+
+    def request(self, cmd, addr=0, param=0, payload=b''):
+        self.seqnum = (self.seqnum + 1) & 0xFFFFFFFF
+        self.skt.sendall(HEADER.pack(BIN_FRAME_MAGIC, self.seqnum, cmd, 0, 0,
+                                     param, addr, len(payload), 0) + payload)
+        while True:
+            hdr = HEADER.unpack(self.recv_exact(HEADER.size))
+            data = self.recv_exact(hdr[7])
+            if hdr[2] & 0x80:
+                if self.event_listener:
+                    self.event_listener(hdr[2], hdr[6], data)
+                continue
+            if hdr[1] != self.seqnum:
+                raise ValueError('Unexpected response seqnum %d' % hdr[1])
+            if hdr[3] != 0:
+                raise IOError('Request %d failed with status %d'
+                              % (cmd, hdr[3]))
+            return data
+
+    def read(self, addr, size):
+        out = bytearray()
+        while len(out) < size:
+            sz = min(CHUNK_MAX, size - len(out))
+            out += self.request(BinCmd_MemRead, addr + len(out), sz)
+        return bytes(out)
+
+    def write(self, addr, data):
+        for off in range(0, len(data), CHUNK_MAX):
+            self.request(BinCmd_MemWrite, addr + off, 0,
+                         data[off:off + CHUNK_MAX])
+
+    def read_regs(self, addr, count):
+        data = self.request(BinCmd_RegRead, addr, count)
+        return list(struct.unpack('<%dQ' % count, data))
+
+    def write_regs(self, addr, values):
+        self.request(BinCmd_RegWrite, addr, 0,
+                     struct.pack('<%dQ' % len(values), *values))
+
+    def br_add(self, addr):
+        self.request(BinCmd_BrAdd, addr)
+
+    def br_rm(self, addr):
+        self.request(BinCmd_BrRemove, addr)
+
+    def go(self, steps=0):
+        self.request(BinCmd_Go, 0, steps)
+
+    def halt(self):
+        self.request(BinCmd_Halt)
+
+    def load_image(self, addr, filename):
+        with open(filename, 'rb') as f:
+            self.write(addr, f.read())
+
+    def dump(self, addr, size, filename):
+        with open(filename, 'wb') as f:
+            f.write(self.read(addr, size))
@@ -15,6 +15,30 @@ BUFFER_SIZE = 1024
 
 TCP_DEBUG = 0
 
+class RpcRequest(object):
+    """
+    Request sent without waiting for the response. Simulator executes
+    requests in order, the response is matched by the message id.
+    """
+    def __init__(self, callback=None):
+        self.event = threading.Event()
+        self.response = None
+        self.callback = callback
+
+    def complete(self, response):
+        self.response = response
+        self.event.set()
+        if self.callback:
+            self.callback(response)
+
+    def done(self):
+        return self.event.is_set()
+
+    def wait(self, sec=None):
+        if self.event.wait(sec) != True:
+            raise ValueError('RPC response timeout')
+        return self.response
+
 class TcpClient(threading.Thread):
     def __init__(self, name, eventDone):
         threading.Thread.__init__(self)
@@ -23,9 +47,11 @@ class TcpClient(threading.Thread):
         self.eventDone = eventDone
         self.messageid = 0
         self.enabled = True
-        self.eventTx = threading.Event()
-        self.response = ""
+        self.lock = threading.Lock()
+        self.txlock = threading.Lock()
+        self.pending = {}
         self.console_listeners = []
+        self.event_listeners = []
 
     def run(self):
         safe_print("Connecting to {0}:{1}\n".format(TCP_IP, TCP_PORT))
@@ -56,15 +82,19 @@ class TcpClient(threading.Thread):
                      json = eval(json)
                      if TCP_DEBUG == 1:
                          safe_print("i<= {0}".format(json))
-                     if json[0] == self.messageid:
-                          self.messageid += 1
-                          self.response = None
+                     with self.lock:
+                         req = self.pending.pop(json[0], None)
+                     if req is not None:
+                          response = None
                           if len(json) > 1:
-                              self.response = json[1]
-                          self.eventTx.set()
+                              response = json[1]
+                          req.complete(response)
                      elif json[0] == "Console":
                           for l in self.console_listeners:
                               l.callback(json[1])
+                     elif json[0] == "Event":
+                          for l in self.event_listeners:
+                              l.callback(json[1], json[2])
                      else:
                           raise ValueError(
                             'Unexpected simulation response: {0}'.format(json))
@@ -78,18 +108,35 @@ class TcpClient(threading.Thread):
         self.enabled = False
         self.skt.shutdown(socket.SHUT_WR)
 
-    def send(self, data):
-        data.insert(0, self.messageid)
-        tx = bytearray(str(data))
+    def send_async(self, data, callback=None):
+        """
+        Send request [RequestType, Action] and return RpcRequest object
+        without waiting for the response. Optional callback is called
+        from the receiver thread with the response value.
+        """
+        req = RpcRequest(callback)
+        with self.lock:
+            msgid = self.messageid
+            self.messageid += 1
+            self.pending[msgid] = req
+        tx = bytearray(str([msgid] + data))
         tx.append(0)
         if TCP_DEBUG == 1:
             safe_print("o=> {0}".format(tx))
+        # Receiver doesn't wait on this lock while sending is blocked
+        with self.txlock:
+            self.skt.sendall(tx)
+        return req
 
-        self.eventTx.clear()
-        self.response = ""
-        self.skt.send(tx)
-        self.eventTx.wait()
-        return self.response
+    def send(self, data):
+        return self.send_async(data).wait()
+
+    def send_batch(self, reqlist):
+        """
+        Execute list of requests [[RequestType, Action], ...] in one
+        round trip. Returns list of responses in the same order.
+        """
+        return self.send(["Batch", reqlist])
 
     def registerConsoleListener(self, listener):
         self.console_listeners.append(listener)
@@ -97,4 +144,20 @@ class TcpClient(threading.Thread):
     def unregisterConsoleListener(self, listener):
         if listener in self.console_listeners:
             self.console_listeners.remove(listener)
+
+    def registerEventListener(self, listener):
+        """
+        Listener callback(name, param) receives target events: 'Halt',
+        'Resume', 'Breakpoint', 'RegChanged' and 'MemDirty'.
+        Client should be connected.
+        """
+        if len(self.event_listeners) == 0:
+            self.send(["Events", True])
+        self.event_listeners.append(listener)
+
+    def unregisterEventListener(self, listener):
+        if listener in self.event_listeners:
+            self.event_listeners.remove(listener)
+            if len(self.event_listeners) == 0:
+                self.send(["Events", False])
         
\ No newline at end of file
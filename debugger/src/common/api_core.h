@@ -116,6 +116,14 @@ void RISCV_unregister_hap(IFace *ihap);
  */
 void RISCV_trigger_hap(int type, uint64_t param, const char *descr);
 
+/**
+ * @brief Post system event (hap) into the core event bus.
+ * @details Listeners are called asynchronously from the bus thread, so this
+ *          method can be used from the simulation threads. Pending haps
+ *          of the same kind are coalesced.
+ */
+void RISCV_post_hap(int type, uint64_t param, const char *descr);
+
 /**
  * @brief Get registred class interface by its name.
  * @details This method generally used to create instances of a specific
@@ -297,6 +305,13 @@ void* RISCV_memshare_map(sharemem_def h, int sz);
 void RISCV_memshare_unmap(void *buf, int sz);
 void RISCV_memshare_delete(sharemem_def h);
 
+/**
+ * Map the whole file into memory for reading. Returns 0 if the file cannot
+ * be opened or is empty; 'sz' receives the file size.
+ */
+const uint8_t *RISCV_file_map(const char *filename, int64_t *sz);
+void RISCV_file_unmap(const uint8_t *buf, int64_t sz);
+
 /** Memory allocator/de-allocator */
 void *RISCV_malloc(uint64_t sz);
 void RISCV_free(void *p);
@@ -20,14 +20,59 @@
 #include <cstdlib>
 #include <string>
 #include <algorithm>
+#include <utility>
 
 namespace debugger {
 
-static const int64_t MIN_ALLOC_BYTES = 1 << 12;
+/** Lists and dictionaries grow by power of 2, capacity isn't stored */
+static const unsigned LIST_CAPACITY_MIN = 4;
 static AttributeType NilAttribute;
 
+static unsigned list_capacity(unsigned size) {
+    unsigned ret = LIST_CAPACITY_MIN;
+    while (ret < size) {
+        ret <<= 1;
+    }
+    return ret;
+}
+
 void attribute_to_string(const AttributeType *attr, AutoBuffer *buf);
-int string_to_attribute(const char *cfg, int &off, AttributeType *out);
+
+/**
+ * @brief Configuration string parser without recursion.
+ * @details Parsed values are accumulated in the values stack and moved into
+ *          their list or dictionary when the closing bracket is found, so
+ *          every container is allocated once with the exact size.
+ */
+class ConfigParserType {
+ public:
+    explicit ConfigParserType(const char *cfg);
+    ~ConfigParserType();
+
+    int parse(AttributeType *out);
+
+ private:
+    struct FrameType {
+        char endmarker;     // ']' or '}'
+        unsigned base;      // first item index in the values stack
+    };
+
+    void skip();
+    int error(const char *msg, AttributeType *out);
+    int parse_value(AttributeType *out);
+    void push_value(AttributeType *v);
+    void push_frame(char endmarker);
+    void close_frame(AttributeType *out);
+
+    const char *cfg_;
+    int off_;
+    AttributeType *values_;
+    unsigned values_cnt_;
+    unsigned values_total_;
+    FrameType *frames_;
+    unsigned frames_cnt_;
+    unsigned frames_total_;
+};
 
 void AttributeType::allocAttrName(const char *name) {
     size_t len = strlen(name) + 1;
@@ -55,7 +100,7 @@ void AttributeType::freeAttrDescription() {
 
 void AttributeType::attr_free() {
     if (size()) {
-        if (is_string()) {
+        if (is_string() && size() >= sizeof(u_)) {
             RISCV_free(u_.string);
         } else if (is_data() && size() > 8) {
             RISCV_free(u_.data);
@@ -118,6 +163,25 @@ AttributeType &AttributeType::operator=(const AttributeType& other) {
     return *this;
 }
 
+AttributeType &AttributeType::operator=(AttributeType &&other) {
+    if (&other == this) {
+        return *this;
+    }
+    // 'other' may be an item of this list: detach it before freeing
+    KindType kind = other.kind_;
+    unsigned size = other.size_;
+    int64_t value = other.u_.integer;
+    other.kind_ = Attr_Invalid;
+    other.size_ = 0;
+    other.u_.integer = 0;
+
+    attr_free();
+    kind_ = kind;
+    size_ = size;
+    u_.integer = value;
+    return *this;
+}
+
 
 const AttributeType &AttributeType::operator[](unsigned idx) const {
     if (is_list()) {
@@ -178,12 +242,20 @@ const uint8_t &AttributeType::operator()(unsigned idx) const {
 }
 
 void AttributeType::make_string(const char *value) {
+    make_string(value, value ? (unsigned)strlen(value) : 0);
+}
+
+void AttributeType::make_string(const char *value, unsigned len) {
     attr_free();
     if (value) {
         kind_ = Attr_String;
-        size_ = (unsigned)strlen(value);
-        u_.string = static_cast<char *>(RISCV_malloc(size_ + 1));
-        memcpy(u_.string, value, size_ + 1);
+        size_ = len;
+        char *p = u_.string_bytes;
+        if (size_ >= sizeof(u_)) {
+            p = u_.string = static_cast<char *>(RISCV_malloc(size_ + 1));
+        }
+        memcpy(p, value, size_);
+        p[size_] = '\0';
     } else {
         kind_ = Attr_Nil;
     }
@@ -252,16 +324,14 @@ void AttributeType::make_list(unsigned size) {
 }
 
 void AttributeType::realloc_list(unsigned size) {
-    size_t req_sz = (size * sizeof(AttributeType) + MIN_ALLOC_BYTES - 1)
-                   / MIN_ALLOC_BYTES;
-    size_t cur_sz = (size_ * sizeof(AttributeType) + MIN_ALLOC_BYTES - 1)
-                  / MIN_ALLOC_BYTES;
-    if (req_sz > cur_sz) {
+    unsigned cur_cap = size_ ? list_capacity(size_) : 0;
+    if (size > cur_cap) {
+        unsigned cap = list_capacity(size);
         AttributeType * t1 = static_cast<AttributeType *>(
-                RISCV_malloc(MIN_ALLOC_BYTES * req_sz));
+                RISCV_malloc(cap * sizeof(AttributeType)));
         memcpy(static_cast<void*>(t1), u_.list, size_ * sizeof(AttributeType));
         memset(static_cast<void*>(&t1[size_]), 0,
-                (MIN_ALLOC_BYTES * req_sz) - size_ * sizeof(AttributeType));
+                (cap - size_) * sizeof(AttributeType));
         if (size_) {
             RISCV_free(u_.list);
         }
@@ -270,29 +340,30 @@ void AttributeType::realloc_list(unsigned size) {
     size_ = size;
 }
 
+void AttributeType::add_to_list(const AttributeType *item) {
+    if (size_ && item >= u_.list && item < &u_.list[size_]) {
+        // Item of this list: storage may be re-allocated
+        AttributeType t1(*item);
+        realloc_list(size_ + 1);
+        u_.list[size_ - 1] = std::move(t1);
+        return;
+    }
+    realloc_list(size_ + 1);
+    u_.list[size_ - 1] = *item;
+}
+
 void AttributeType::insert_to_list(unsigned idx, const AttributeType *item) {
     if (idx > size_) {
         RISCV_printf(NULL, LOG_ERROR, "%s", "Insert index out of bound");
         return;
     }
-    size_t new_sz = ((size_ + 1) * sizeof(AttributeType) + MIN_ALLOC_BYTES - 1)
-                  / MIN_ALLOC_BYTES;
-    AttributeType * t1 = static_cast<AttributeType *>(
-                RISCV_malloc(MIN_ALLOC_BYTES * new_sz));
-    memset(static_cast<void*>(t1 + idx), 0,
+    AttributeType t1(*item);
+    realloc_list(size_ + 1);
+    memmove(static_cast<void*>(&u_.list[idx + 1]), &u_.list[idx],
+            (size_ - 1 - idx) * sizeof(AttributeType));
+    memset(static_cast<void*>(&u_.list[idx]), 0,
            sizeof(AttributeType));  // Fix bug request #4
-
-    memcpy(static_cast<void*>(t1), u_.list, idx * sizeof(AttributeType));
-    t1[idx].clone(item);
-    memcpy(static_cast<void*>(&t1[idx + 1]), &u_.list[idx],
-           (size_ - idx) * sizeof(AttributeType));
-    memset(static_cast<void*>(&t1[size_ + 1]), 0,
-           (MIN_ALLOC_BYTES * new_sz) - (size_ + 1) * sizeof(AttributeType));
-    if (size_) {
-        RISCV_free(u_.list);
-    }
-    u_.list = t1;
-    size_++;
+    u_.list[idx] = std::move(t1);
 }
 
 void AttributeType::remove_from_list(unsigned idx) {
@@ -307,6 +378,11 @@ void AttributeType::remove_from_list(unsigned idx) {
         swap_list_item(idx, size() - 1);
         size_ -= 1;
     }
+    if (size_ == 0) {
+        // Capacity is derived from size, empty list has no storage
+        RISCV_free(u_.list);
+        u_.list = NULL;
+    }
 }
 
 void AttributeType::trim_list(unsigned start, unsigned end) {
@@ -456,17 +532,15 @@ void AttributeType::make_dict() {
 }
 
 void AttributeType::realloc_dict(unsigned size) {
-    size_t req_sz = (size * sizeof(AttributePairType) + MIN_ALLOC_BYTES - 1)
-                  / MIN_ALLOC_BYTES;
-    size_t cur_sz = (size_ * sizeof(AttributePairType) + MIN_ALLOC_BYTES - 1)
-                  / MIN_ALLOC_BYTES;
-    if (req_sz > cur_sz) {
+    unsigned cur_cap = size_ ? list_capacity(size_) : 0;
+    if (size > cur_cap) {
+        unsigned cap = list_capacity(size);
         AttributePairType * t1 = static_cast<AttributePairType *>(
-                RISCV_malloc(MIN_ALLOC_BYTES * req_sz));
+                RISCV_malloc(cap * sizeof(AttributePairType)));
         memcpy(static_cast<void*>(t1), u_.dict,
                size_ * sizeof(AttributePairType));
         memset(static_cast<void*>(&t1[size_]), 0,
-                (MIN_ALLOC_BYTES * req_sz) - size_ * sizeof(AttributePairType));
+                (cap - size_) * sizeof(AttributePairType));
         if (size_) {
             RISCV_free(u_.dict);
         }
@@ -478,68 +552,69 @@ void AttributeType::realloc_dict(unsigned size) {
 const AttributeType& AttributeType::to_config() {
     AutoBuffer strBuffer;
     attribute_to_string(this, &strBuffer);
-    make_string(strBuffer.getBuffer());
+    make_string(strBuffer.getBuffer(), strBuffer.size());
     return (*this);
 }
 
+void AttributeType::to_config(AutoBuffer *buf) const {
+    attribute_to_string(this, buf);
+}
+
 void AttributeType::from_config(const char *str) {
-    int off = 0;
-    string_to_attribute(str, off, this);
+    ConfigParserType parser(str);
+    parser.parse(this);
 }
 
 void attribute_to_string(const AttributeType *attr, AutoBuffer *buf) {
     IService *iserv;
     if (attr->is_nil()) {
-        buf->write_string("None");
+        buf->write_bin("None", 4);
     } else if (attr->is_int64() || attr->is_uint64()) {
         buf->write_uint64(attr->to_uint64());
     } else if (attr->is_string()) {
         buf->write_string('\"');
-        buf->write_string(attr->to_string());
+        buf->write_bin(attr->to_string(), attr->size());
         buf->write_string('\"');
     } else if (attr->is_bool()) {
         if (attr->to_bool()) {
-            buf->write_string("True");
+            buf->write_bin("True", 4);
         } else {
-            buf->write_string("False");
+            buf->write_bin("False", 5);
         }
     } else if (attr->is_list()) {
-        AttributeType list_item;
         unsigned list_sz = attr->size();
         buf->write_string('[');
         for (unsigned i = 0; i < list_sz; i++) {
-            list_item = (*attr)[i];
-            attribute_to_string(&list_item, buf);
+            attribute_to_string(attr->list(i), buf);
             if (i < (list_sz - 1)) {
                 buf->write_string(',');
             }
         }
         buf->write_string(']');
     } else if (attr->is_dict()) {
-        AttributeType dict_item;
         unsigned dict_sz = attr->size();;
         buf->write_string('{');
 
         for (unsigned i = 0; i < dict_sz; i++) {
+            const AttributeType &key = attr->u_.dict[i].key_;
             buf->write_string('\"');
-            buf->write_string(attr->u_.dict[i].key_.to_string());
-            buf->write_string('\"');
-            buf->write_string(':');
-            const AttributeType &dict_value = (*attr)[i];
-            attribute_to_string(&dict_value, buf);
+            buf->write_bin(key.to_string(), key.size());
+            buf->write_bin("\":", 2);
+            attribute_to_string(&attr->u_.dict[i].value_, buf);
             if (i < (dict_sz - 1)) {
                 buf->write_string(',');
             }
         }
         buf->write_string('}');
     } else if (attr->is_data()) {
+        const uint8_t *data = attr->data();
         buf->write_string('(');
         if (attr->size() > 0) {
             for (unsigned n = 0; n < attr->size()-1;  n++) {
-                buf->write_byte((*attr)(n));
+                buf->write_byte(data[n]);
                 buf->write_string(',');
             }
-            buf->write_byte((*attr)(attr->size()-1));
+            buf->write_byte(data[attr->size()-1]);
         }
         buf->write_string(')');
     } else if (attr->is_iface()) {
@@ -558,128 +633,238 @@ void attribute_to_string(const AttributeType *attr, AutoBuffer *buf) {
         }
     } else if (attr->is_floating()) {
         char fstr[64];
-        RISCV_sprintf(fstr, sizeof(fstr), "%.4f", attr->to_float());
-        buf->write_string(fstr);
+        int fsz = RISCV_sprintf(fstr, sizeof(fstr), "%.4f", attr->to_float());
+        buf->write_bin(fstr, fsz);
     }
 }
 
-int skip_special_symbols(const char *cfg, int off) {
-    const char *pcur = &cfg[off];
+ConfigParserType::ConfigParserType(const char *cfg) : cfg_(cfg), off_(0) {
+    values_ = 0;
+    values_cnt_ = 0;
+    values_total_ = 0;
+    frames_ = 0;
+    frames_cnt_ = 0;
+    frames_total_ = 0;
+}
+
+ConfigParserType::~ConfigParserType() {
+    for (unsigned i = 0; i < values_cnt_; i++) {
+        values_[i].attr_free();
+    }
+    RISCV_free(values_);
+    RISCV_free(frames_);
+}
+
+void ConfigParserType::skip() {
+    const char *pcur = &cfg_[off_];
     while (*pcur == ' ' || *pcur == '\r' || *pcur == '\n' || *pcur == '\t') {
         pcur++;
-        off++;
     }
-    return off;
+    off_ = static_cast<int>(pcur - cfg_);
 }
 
-int string_to_attribute(const char *cfg, int &off,
-                         AttributeType *out) {
-    off = skip_special_symbols(cfg, off);
-    int checkstart = off;
-    if (cfg[off] == '\'' || cfg[off] == '"') {
-        AutoBuffer buf;
-        uint8_t t1 = cfg[off];
-        int str_sz = 0;
-        const char *pcur = &cfg[++off];
-        while (*pcur != t1 && *pcur != '\0') {
-            pcur++;
-            str_sz++;
-        }
-        buf.write_bin(&cfg[off], str_sz);
-        out->make_string(buf.getBuffer());
-        off += str_sz;
-        if (cfg[off] != t1) {
-            RISCV_printf(NULL, LOG_ERROR,
-                        "JSON parser error: Wrong string format");
-            out->attr_free();
-            return -1;
+int ConfigParserType::error(const char *msg, AttributeType *out) {
+    RISCV_printf(NULL, LOG_ERROR, "JSON parser error: %s", msg);
+    out->attr_free();
+    return -1;
+}
+
+void ConfigParserType::push_value(AttributeType *v) {
+    if (values_cnt_ == values_total_) {
+        values_total_ = values_total_ ? 2 * values_total_ : 64;
+        AttributeType *t1 = static_cast<AttributeType *>(
+            RISCV_malloc(values_total_ * sizeof(AttributeType)));
+        memcpy(static_cast<void *>(t1), values_,
+               values_cnt_ * sizeof(AttributeType));
+        RISCV_free(values_);
+        values_ = t1;
+    }
+    // Storage isn't constructed: only the payload is moved
+    AttributeType &e = values_[values_cnt_++];
+    e.kind_ = v->kind_;
+    e.size_ = v->size_;
+    e.u_ = v->u_;
+    v->kind_ = Attr_Invalid;
+    v->size_ = 0;
+    v->u_.integer = 0;
+}
+
+void ConfigParserType::push_frame(char endmarker) {
+    if (frames_cnt_ == frames_total_) {
+        frames_total_ = frames_total_ ? 2 * frames_total_ : 16;
+        FrameType *t1 = static_cast<FrameType *>(
+            RISCV_malloc(frames_total_ * sizeof(FrameType)));
+        memcpy(t1, frames_, frames_cnt_ * sizeof(FrameType));
+        RISCV_free(frames_);
+        frames_ = t1;
+    }
+    frames_[frames_cnt_].endmarker = endmarker;
+    frames_[frames_cnt_].base = values_cnt_;
+    frames_cnt_++;
+}
+
+/**
+ * Items of the closed list/dictionary are on the top of the values stack:
+ * container is allocated once with the exact size and payloads are moved.
+ */
+void ConfigParserType::close_frame(AttributeType *out) {
+    FrameType &f = frames_[--frames_cnt_];
+    unsigned cnt = values_cnt_ - f.base;
+    AttributeType *items = &values_[f.base];
+    if (f.endmarker == ']') {
+        out->make_list(cnt);
+        for (unsigned i = 0; i < cnt; i++) {
+            AttributeType &e = out->u_.list[i];
+            e.kind_ = items[i].kind_;
+            e.size_ = items[i].size_;
+            e.u_ = items[i].u_;
         }
-        off = skip_special_symbols(cfg, off + 1);
-    } else if (cfg[off] == '[') {
-        off = skip_special_symbols(cfg, off + 1);
-        AttributeType new_item;
-        out->make_list(0);
-        while (cfg[off] != ']' && cfg[off] != '\0') {
-            if (string_to_attribute(cfg, off, &new_item)) {
-                /* error handling */
-                out->attr_free();
-                return -1;
-            }
-            out->realloc_list(out->size() + 1);
-            (*out)[out->size() - 1] = new_item;
+        values_cnt_ = f.base;
+        return;
+    }
 
-            off = skip_special_symbols(cfg, off);
-            if (cfg[off] == ',') {
-                off = skip_special_symbols(cfg, off + 1);
+    out->make_dict();
+    out->realloc_dict(cnt / 2);
+    unsigned total = 0;
+    for (unsigned i = 0; i < cnt; i += 2) {
+        // Duplicated key overwrites previous value
+        AttributePairType *pair = 0;
+        for (unsigned n = 0; n < total; n++) {
+            if (strcmp(out->u_.dict[n].key_.to_string(),
+                       items[i].to_string()) == 0) {
+                pair = &out->u_.dict[n];
+                pair->value_.attr_free();
+                items[i].attr_free();
+                break;
             }
         }
-        if (cfg[off] != ']') {
-            RISCV_printf(NULL, LOG_ERROR,
-                        "JSON parser error: Wrong list format");
+        if (!pair) {
+            pair = &out->u_.dict[total++];
+            pair->key_.kind_ = items[i].kind_;
+            pair->key_.size_ = items[i].size_;
+            pair->key_.u_ = items[i].u_;
+        }
+        pair->value_.kind_ = items[i + 1].kind_;
+        pair->value_.size_ = items[i + 1].size_;
+        pair->value_.u_ = items[i + 1].u_;
+    }
+    out->size_ = total;
+    values_cnt_ = f.base;
+
+    if (out->has_key("Type")) {
+        if (strcmp((*out)["Type"].to_string(), IFACE_SERVICE) == 0) {
+            IService *iserv;
+            iserv = static_cast<IService *>(
+                    RISCV_get_service((*out)["ModuleName"].to_string()));
             out->attr_free();
-            return -1;
+            *out = AttributeType(iserv);
+        } else {
+            RISCV_printf(NULL, LOG_ERROR,
+                    "Not implemented string to dict. attribute");
         }
-        off = skip_special_symbols(cfg, off + 1);
-    } else if (cfg[off] == '{') {
-        AttributeType new_key;
-        AttributeType new_value;
-        out->make_dict();
-        off = skip_special_symbols(cfg, off + 1);
-        while (cfg[off] != '}' && cfg[off] != '\0') {
-            if (string_to_attribute(cfg, off, &new_key)) {
-                RISCV_printf(NULL, LOG_ERROR,
-                            "JSON parser error: Wrong dictionary key");
-                out->attr_free();
-                return -1;
+    }
+}
+
+int ConfigParserType::parse(AttributeType *out) {
+    AttributeType item;
+    while (true) {
+        skip();
+        char c = cfg_[off_];
+        FrameType *top = frames_cnt_ ? &frames_[frames_cnt_ - 1] : 0;
+        bool is_key = top && top->endmarker == '}'
+                    && ((values_cnt_ - top->base) & 0x1) == 0;
+        if (c == '[' || c == '{') {
+            if (is_key) {
+                return error("Wrong dictionary key", out);
             }
-            off = skip_special_symbols(cfg, off);
-            if (cfg[off] != ':') {
-                out->attr_free();
-                RISCV_printf(NULL, LOG_ERROR,
-                            "JSON parser error: Wrong dictionary delimiter");
-                return -1;
+            push_frame(c == '[' ? ']' : '}');
+            off_++;
+            continue;
+        }
+        if (top && c == top->endmarker && (is_key || c == ']')) {
+            off_++;
+            close_frame(&item);
+        } else if (top && c == '\0') {
+            if (top->endmarker == ']') {
+                return error("Wrong list format", out);
             }
-            off = skip_special_symbols(cfg, off + 1);
-            if (string_to_attribute(cfg, off, &new_value)) {
-                RISCV_printf(NULL, LOG_ERROR,
-                            "JSON parser error: Wrong dictionary value");
-                out->attr_free();
-                return -1;
+            return error("Wrong dictionary format", out);
+        } else if (parse_value(&item)) {
+            if (top && top->endmarker == '}') {
+                return error(is_key ? "Wrong dictionary key"
+                                    : "Wrong dictionary value", out);
             }
+            out->attr_free();
+            return -1;
+        }
 
-            (*out)[new_key.to_string()] = new_value;
-
-            off = skip_special_symbols(cfg, off);
-            if (cfg[off] == ',') {
-                off = skip_special_symbols(cfg, off + 1);
+        skip();
+        if (!frames_cnt_) {
+            *out = std::move(item);
+            return 0;
+        }
+        // Closed container is an item of the previous frame
+        top = &frames_[frames_cnt_ - 1];
+        is_key = top->endmarker == '}'
+                && ((values_cnt_ - top->base) & 0x1) == 0;
+        if (is_key && !item.is_string()) {
+            return error("Wrong dictionary key", out);
+        }
+        push_value(&item);
+        if (is_key) {
+            if (cfg_[off_] != ':') {
+                return error("Wrong dictionary delimiter", out);
             }
+            off_++;
+        } else if (cfg_[off_] == ',') {
+            off_++;
         }
-        if (cfg[off] != '}') {
+    }
+}
+
+int ConfigParserType::parse_value(AttributeType *out) {
+    const char *cfg = cfg_;
+    int &off = off_;
+    int checkstart = off;
+    if (cfg[off] == '\'' || cfg[off] == '"') {
+        char t1 = cfg[off];
+        const char *pstart = &cfg[++off];
+        const char *pcur = pstart;
+        while (*pcur != t1 && *pcur != '\0') {
+            pcur++;
+        }
+        if (*pcur != t1) {
             RISCV_printf(NULL, LOG_ERROR,
-                        "JSON parser error: Wrong dictionary format");
+                        "JSON parser error: Wrong string format");
             out->attr_free();
             return -1;
         }
-        off = skip_special_symbols(cfg, off + 1);
-
-        if (out->has_key("Type")) {
-            if (strcmp((*out)["Type"].to_string(), IFACE_SERVICE) == 0) {
-                IService *iserv;
-                iserv = static_cast<IService *>(
-                        RISCV_get_service((*out)["ModuleName"].to_string()));
-                out->attr_free();
-                *out = AttributeType(iserv);
-            } else {
-                RISCV_printf(NULL, LOG_ERROR,
-                        "Not implemented string to dict. attribute");
+        out->make_string(pstart, static_cast<unsigned>(pcur - pstart));
+        off += static_cast<int>(pcur - pstart) + 1;
+    } else if (cfg[off] == '(') {
+        // The first pass counts bytes to allocate data once
+        unsigned bytes = 0;
+        const char *pcur = &cfg[off + 1];
+        while (*pcur != ')' && *pcur != '\0') {
+            if (*pcur == ',') {
+                bytes++;
             }
+            pcur++;
         }
-    } else if (cfg[off] == '(') {
-        AutoBuffer buf;
-        char byte_value;
-        off = skip_special_symbols(cfg, off + 1);
-        while (cfg[off] != ')' && cfg[off] != '\0') {
-            byte_value = 0;
+        if (*pcur != ')') {
+            RISCV_printf(NULL, LOG_ERROR,
+                        "JSON parser error: Wrong data format");
+            out->attr_free();
+            return -1;
+        }
+        bytes++;
+        out->make_data(bytes);
+        uint8_t *data = out->data();
+        unsigned cnt = 0;
+        off++;
+        skip();
+        while (cfg[off] != ')' && cnt < bytes) {
+            uint8_t byte_value = 0;
             if (cfg[off] == '0' && cfg[off + 1] == 'x') {
                 off += 2;
             }
@@ -693,9 +878,9 @@ int string_to_attribute(const char *cfg, int &off,
                 }
                 off++;
             }
-            buf.write_bin(&byte_value, 1);
+            data[cnt++] = byte_value;
 
-            off = skip_special_symbols(cfg, off);
+            skip();
             if (cfg[off] == ')') {
                 break;
             }
@@ -705,7 +890,8 @@ int string_to_attribute(const char *cfg, int &off,
                 out->attr_free();
                 return -1;
             }
-            off = skip_special_symbols(cfg, off + 1);
+            off++;
+            skip();
         }
         if (cfg[off] != ')') {
             RISCV_printf(NULL, LOG_ERROR,
@@ -713,21 +899,23 @@ int string_to_attribute(const char *cfg, int &off,
             out->attr_free();
             return -1;
         }
-        out->make_data(buf.size(), buf.getBuffer());
-        off = skip_special_symbols(cfg, off + 1);
+        if (cnt != bytes) {
+            out->realloc_data(cnt);
+        }
+        off++;
     } else if (cfg[off] == 'N' && cfg[off + 1] == 'o' && cfg[off + 2] == 'n'
                 && cfg[off + 3] == 'e') {
         out->make_nil();
-        off = skip_special_symbols(cfg, off + 4);
+        off += 4;
     } else if ((cfg[off] == 'f' || cfg[off] == 'F') && cfg[off + 1] == 'a'
             && cfg[off + 2] == 'l' && cfg[off + 3] == 's'
             && cfg[off + 4] == 'e') {
         out->make_boolean(false);
-        off = skip_special_symbols(cfg, off + 5);
+        off += 5;
     } else if ((cfg[off] == 't' || cfg[off] == 'T') && cfg[off + 1] == 'r'
             && cfg[off + 2] == 'u' && cfg[off + 3] == 'e') {
         out->make_boolean(true);
-        off = skip_special_symbols(cfg, off + 4);
+        off += 4;
     } else {
         char digits[64] = {0};
         int digits_cnt = 0;
@@ -777,7 +965,6 @@ int string_to_attribute(const char *cfg, int &off,
             }
             out->make_int64(t1);
         }
-        off = skip_special_symbols(cfg, off);
     }
     /** Guard to skip wrong formatted string and avoid hanging: */
     if (off == checkstart) {
@@ -39,6 +39,7 @@ enum KindType {
 };
 
 class AttributePairType;
+class AutoBuffer;
 
 class AttributeType : public IAttribute {
  public:
@@ -53,6 +54,7 @@ class AttributeType : public IAttribute {
         AttributePairType *dict;
         uint8_t *data;
         uint8_t data_bytes[8];  // Data without allocation
+        char string_bytes[8];   // String shorter than 8 chars
         void *py_object;
         IFace *iface;
         char *uobject;
@@ -63,6 +65,16 @@ class AttributeType : public IAttribute {
         clone(&other);
     }
 
+    /** Take the value without copying, 'other' becomes Attr_Invalid */
+    AttributeType(AttributeType &&other) {
+        kind_ = other.kind_;
+        size_ = other.size_;
+        u_ = other.u_;
+        other.kind_ = Attr_Invalid;
+        other.size_ = 0;
+        other.u_.integer = 0;
+    }
+
     AttributeType() {
         kind_ = Attr_Invalid;
         size_ = 0;
@@ -81,6 +93,8 @@ class AttributeType : public IAttribute {
     void attr_free();
 
     explicit AttributeType(const char *str) {
+        kind_ = Attr_Invalid;
+        size_ = 0;
         make_string(str);
     }
 
@@ -158,6 +172,9 @@ class AttributeType : public IAttribute {
     }
 
     const char * to_string() const {
+        if (kind_ == Attr_String && size_ < sizeof(u_)) {
+            return u_.string_bytes;
+        }
         return u_.string;
     }
 
@@ -168,14 +185,14 @@ class AttributeType : public IAttribute {
         if (kind_ != Attr_String) {
             return 0;
         }
-        char *p = u_.string;
+        char *p = const_cast<char *>(to_string());
         while (*p) {
             if (p[0] >= 'a' && p[0] <= 'z') {
                 p[0] = p[0] - 'a' + 'A';
             }
             p++;
         }
-        return u_.string;
+        return to_string();
     }
 
     bool is_list() const {
@@ -249,6 +266,7 @@ class AttributeType : public IAttribute {
     }
 
     void make_string(const char *value);
+    void make_string(const char *value, unsigned len);
 
     void make_data(unsigned size);
 
@@ -260,10 +278,7 @@ class AttributeType : public IAttribute {
 
     void make_list(unsigned size);
 
-    void add_to_list(const AttributeType *item) {
-        realloc_list(size()+1);
-        (*this)[size()-1] = (*item);
-    }
+    void add_to_list(const AttributeType *item);
 
     void insert_to_list(unsigned idx, const AttributeType *item);
 
@@ -283,7 +298,7 @@ class AttributeType : public IAttribute {
 
     int64_t integer() const { return u_.integer; }
 
-    const char *string() const { return u_.string; }
+    const char *string() const { return to_string(); }
 
     bool boolean() const { return u_.boolean; }
 
@@ -319,6 +334,7 @@ class AttributeType : public IAttribute {
     }
 
     AttributeType& operator=(const AttributeType& other);
+    AttributeType& operator=(AttributeType &&other);
 
     /**
      * @brief Access to the single element of the 'list' attribute:
@@ -340,6 +356,8 @@ class AttributeType : public IAttribute {
     const uint8_t& operator()(unsigned idx) const;
 
     const AttributeType& to_config();
+    /** Append configuration string into buffer without intermediate copy */
+    void to_config(AutoBuffer *buf) const;
     void from_config(const char *str);
 };
 
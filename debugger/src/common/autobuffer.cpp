@@ -37,16 +37,16 @@ void AutoBuffer::write_bin(const char *p, int sz) {
     if (buf_len_ + sz >= buf_size_) {
         if (buf_size_ == 0) {
             buf_size_ = 1024;
-            buf_ = new char[buf_size_];
-        } else {
-            while (buf_len_ + sz >= buf_size_) {
-                buf_size_ <<= 1;
-            }
-            char *t1 = new char[buf_size_];
+        }
+        while (buf_len_ + sz >= buf_size_) {
+            buf_size_ <<= 1;
+        }
+        char *t1 = new char[buf_size_];
+        if (buf_) {
             memcpy(t1, buf_, buf_len_);
             delete [] buf_;
-            buf_ = t1;
         }
+        buf_ = t1;
     }
     memcpy(&buf_[buf_len_], p, sz);
     buf_len_ += sz;
@@ -62,15 +62,22 @@ void AutoBuffer::write_string(const char *s) {
 }
 
 void AutoBuffer::write_uint64(uint64_t v) {
-    char tmp[128];
-    int sz = RISCV_sprintf(tmp, sizeof(tmp), "0x%" RV_PRI64 "x", v);
-    write_bin(tmp, sz);
+    static const char HEX[] = "0123456789abcdef";
+    char tmp[20];
+    int pos = sizeof(tmp);
+    do {
+        tmp[--pos] = HEX[v & 0xf];
+        v >>= 4;
+    } while (v);
+    tmp[--pos] = 'x';
+    tmp[--pos] = '0';
+    write_bin(&tmp[pos], static_cast<int>(sizeof(tmp)) - pos);
 }
 
 void AutoBuffer::write_byte(uint8_t v) {
-    char tmp[8];
-    int sz = RISCV_sprintf(tmp, sizeof(tmp), "0x%02X", v);
-    write_bin(tmp, sz);
+    static const char HEX[] = "0123456789ABCDEF";
+    char tmp[4] = {'0', 'x', HEX[v >> 4], HEX[v & 0xf]};
+    write_bin(tmp, 4);
 }
 
 }  // namespace debugger
@@ -0,0 +1,51 @@
+/*
+ *  Copyright 2020 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_COMMON_BITSCAN_H__
+#define __DEBUGGER_COMMON_BITSCAN_H__
+
+#include <inttypes.h>
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace debugger {
+
+/** Index of the least significant set bit. Argument must be non-zero. */
+static inline int bitscan32(uint32_t v) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, v);
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctz(v);
+#endif
+}
+
+static inline int bitscan64(uint64_t v) {
+#if defined(_MSC_VER)
+    if (static_cast<uint32_t>(v)) {
+        return bitscan32(static_cast<uint32_t>(v));
+    }
+    return 32 + bitscan32(static_cast<uint32_t>(v >> 32));
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_BITSCAN_H__
@@ -36,6 +36,9 @@ class ICmdExecutor : public IFace {
     /** Execute string as a command */
     virtual void exec(const char *line, AttributeType *res, bool silent) = 0;
 
+    /** Execute command from the prepared list [name, arg1, ...] */
+    virtual void exec(AttributeType *args, AttributeType *res) = 0;
+
     /** Get list of supported comands starting with substring 'substr' */
     virtual void commands(const char *substr, AttributeType *res) = 0;
 };
@@ -19,6 +19,7 @@
 
 #include <iface.h>
 #include <attribute.h>
+#include <api_core.h>
 #include "coreservices/itap.h"
 
 namespace debugger {
@@ -34,17 +35,33 @@ class ICommand : public IFace {
     ICommand(const char *name, ITap *tap)
         : IFace(IFACE_COMMAND) {
         cmdName_.make_string(name);
+        cmdAliases_.make_list(0);
         tap_ = tap;
+        RISCV_mutex_init(&mutexExec_);
+    }
+    virtual ~ICommand() {
+        RISCV_mutex_destroy(&mutexExec_);
     }
-    virtual ~ICommand() {}
 
     virtual const char *cmdName() { return cmdName_.to_string(); }
+    /** Other names accepted by isValid(), used to index the command */
+    virtual const AttributeType &cmdAliases() { return cmdAliases_; }
     virtual const char *briefDescr() { return briefDescr_.to_string(); }
     virtual const char *detailedDescr() { return detailedDescr_.to_string(); }
 
     virtual int isValid(AttributeType *args) = 0;
     virtual void exec(AttributeType *args, AttributeType *res) = 0;
 
+    /**
+     * Read-only calls don't change the target or services state and run
+     * concurrently with each other. Other calls run exclusively.
+     */
+    virtual bool isReadOnly(AttributeType *args) { return false; }
+
+    /** Calls of the same command are serialized */
+    virtual void lockExec() { RISCV_mutex_lock(&mutexExec_); }
+    virtual void unlockExec() { RISCV_mutex_unlock(&mutexExec_); }
+
     virtual void generateError(AttributeType *res, const char *descr) {
         res->make_list(3);
         (*res)[0u].make_string("ERROR");
@@ -56,7 +73,9 @@ class ICommand : public IFace {
     AttributeType cmdName_;
     AttributeType briefDescr_;
     AttributeType detailedDescr_;
+    AttributeType cmdAliases_;
     ITap *tap_;
+    mutex_def mutexExec_;
 };
 
 }  // namespace debugger
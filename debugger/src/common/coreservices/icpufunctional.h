@@ -37,7 +37,18 @@ class IInstruction : public IFace {
 
 class GenericInstruction : public IInstruction {
  public:
-    GenericInstruction() : IInstruction() {}
+    GenericInstruction() : IInstruction(), execCnt_(0) {}
+
+    /** Conditional branches are split on taken/not-taken in statistic */
+    virtual bool isConditionalBranch() { return false; }
+
+    /** Per-handler counter of the instruction mix statistic */
+    uint64_t getExecCounter() { return execCnt_; }
+    uint64_t incrExecCounter() { return ++execCnt_; }
+    void resetExecCounter() { execCnt_ = 0; }
+
+ protected:
+    uint64_t execCnt_;
 };
 
 enum EEndianessType {
@@ -52,6 +52,12 @@ class ICpuGeneric : public IFace {
     virtual void lowerSignal(int idx) = 0;
     virtual void nb_transport_debug_port(DebugPortTransactionType *trans,
                                          IDbgNbResponse *cb) = 0;
+    /**
+     * Vector of requests serviced by the CPU thread in one pass. Response
+     * is called once with the first item when all of them are done.
+     */
+    virtual void nb_transport_debug_port(DebugPortTransactionType *trans,
+                                         int cnt, IDbgNbResponse *cb) = 0;
 };
 
 }  // namespace debugger
@@ -0,0 +1,60 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_COMMON_CORESERVICES_ICPUSTAT_H__
+#define __DEBUGGER_COMMON_CORESERVICES_ICPUSTAT_H__
+
+#include <inttypes.h>
+#include <iface.h>
+#include <attribute.h>
+
+namespace debugger {
+
+static const char *const IFACE_CPU_STATISTIC = "ICpuStatistic";
+
+/**
+ * @brief Execution statistic collected by the functional CPU models.
+ *
+ * Counters are incremented in the CPU dispatch loop only when collection
+ * is enabled (attribute 'CollectStatistic' or 'stats enable' command).
+ */
+class ICpuStatistic : public IFace {
+ public:
+    ICpuStatistic() : IFace(IFACE_CPU_STATISTIC) {}
+
+    virtual void enableStatistic(bool en) = 0;
+    virtual bool isStatisticEnabled() = 0;
+    /** Clear all counters, e.g. between benchmark phases */
+    virtual void resetStatistic() = 0;
+    /**
+     * Output dictionary:
+     *     {'Enabled':b,
+     *      'Instructions':i,
+     *      'InstrMix':[['name',i],..],     sorted by counter descending
+     *      'BranchTaken':i,
+     *      'BranchNotTaken':i,
+     *      'Jumps':i,
+     *      'LoadCount':i, 'LoadBytes':i,
+     *      'StoreCount':i, 'StoreBytes':i,
+     *      'IllegalOpcodes':i,
+     *      'Traps':[[idx,i],..]}
+     */
+    virtual void getStatistic(AttributeType *res) = 0;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_CORESERVICES_ICPUSTAT_H__
@@ -19,6 +19,7 @@
 
 #include <inttypes.h>
 #include <iface.h>
+#include "coreservices/icpugen.h"
 
 namespace debugger {
 
@@ -31,6 +32,22 @@ class IDsuGeneric : public IFace {
     /** Bus utilization statistic methods */
     virtual void incrementRdAccess(int mst_id) = 0;
     virtual void incrementWrAccess(int mst_id) = 0;
+
+    /**
+     * Debug port access of the specified hart without switching of the
+     * DSU context. Index of the hart is the bit position in haltsum0.
+     */
+    virtual unsigned getCpuTotal() = 0;
+    /** Hart selected by dmcontrol, used by the TAP access */
+    virtual unsigned getCpuContext() = 0;
+    virtual bool isCpuHalted(unsigned idx) = 0;
+    virtual uint64_t nb_debug_read(unsigned hartid, uint16_t addr) = 0;
+    virtual void nb_debug_write(unsigned hartid, uint16_t addr,
+                                uint64_t wdata) = 0;
+    /** Many reads and writes of the hart in a single handshake */
+    virtual void nb_debug_vector(unsigned hartid,
+                                 DebugPortTransactionType *trans,
+                                 int cnt) = 0;
 };
 
 }  // namespace debugger
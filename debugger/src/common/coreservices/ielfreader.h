@@ -40,6 +40,15 @@ class IElfReader : public IFace {
     virtual uint64_t sectionSize(unsigned idx) = 0;
 
     virtual uint8_t *sectionData(unsigned idx) = 0;
+
+    /**
+     * Source file and line of the address from the DWARF line table,
+     * which is parsed on the first request.
+     *
+     * @return 0 if the address is found in the line table
+     */
+    virtual int addressToLine(uint64_t addr, const char **file,
+                              int *line) = 0;
 };
 
 }  // namespace debugger
@@ -0,0 +1,57 @@
+/*
+ *  Copyright 2020 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_COMMON_CORESERVICES_IIRQCTRL_H__
+#define __DEBUGGER_COMMON_CORESERVICES_IIRQCTRL_H__
+
+#include <inttypes.h>
+#include <iface.h>
+
+namespace debugger {
+
+static const char *const IFACE_IRQ_CONTROLLER = "IIrqController";
+
+/**
+ * @brief Interrupt controller connected to the CPU.
+ *
+ * Controller signals the CPU with the single line of the most urgent
+ * enabled and pending interrupt. The CPU uses priority to decide on
+ * preemption and reports entering and leaving the handler.
+ *
+ * Negative index selects system exception (16 + idx) as CMSIS IRQn does,
+ * e.g. SysTick is -1. System exceptions bypass the enable and pending
+ * registers of the controller, only their priority is kept here.
+ */
+class IIrqController : public IFace {
+ public:
+    IIrqController() : IFace(IFACE_IRQ_CONTROLLER) {}
+
+    /** Set interrupt pending from peripheral or system timer */
+    virtual void requestInterrupt(int idx) = 0;
+
+    /** Lower value is more urgent */
+    virtual int getPriority(int idx) = 0;
+
+    /** Handler entered: pending bit cleared, active bit set */
+    virtual void activateInterrupt(int idx) = 0;
+
+    /** Handler returned: active bit cleared */
+    virtual void deactivateInterrupt(int idx) = 0;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_CORESERVICES_IIRQCTRL_H__
@@ -87,6 +87,10 @@ class ISourceCode : public IFace {
 
     virtual void addressToSymbol(uint64_t addr, AttributeType *info) = 0;
 
+    /** Symbol lookup without allocation: returns 0 if address isn't
+     *  covered by any symbol or the name and the offset inside of it */
+    virtual const char *addressToSymbol(uint64_t addr, uint64_t *offset) = 0;
+
     virtual int symbol2Address(const char *name, uint64_t *addr) = 0;
 
     /** Disasm input data buffer.
@@ -22,6 +22,8 @@
 #include <inttypes.h>
 #include <iface.h>
 #include <attribute.h>
+#include <api_core.h>
+#include <ihap.h>
 
 namespace debugger {
 
@@ -46,6 +48,57 @@ class ITap : public IFace {
 
     virtual int read(uint64_t addr, int bytes, uint8_t *obuf) = 0;
     virtual int write(uint64_t addr, int bytes, uint8_t *ibuf) = 0;
+
+    /**
+     * Vectored access to 64-bit registers with the list of addresses in
+     * one request. Adjacent addresses are merged into block transfers so
+     * the register file is a single read on any link.
+     */
+    virtual int readRegs(const uint64_t *addr, int cnt, uint64_t *obuf) {
+        int n;
+        for (int i = 0; i < cnt; i += n) {
+            n = adjacentRegs(&addr[i], cnt - i);
+            if (read(addr[i], 8 * n,
+                     reinterpret_cast<uint8_t *>(&obuf[i])) == TAP_ERROR) {
+                return TAP_ERROR;
+            }
+        }
+        return 8 * cnt;
+    }
+
+    virtual int writeRegs(const uint64_t *addr, int cnt, uint64_t *ibuf) {
+        int n;
+        for (int i = 0; i < cnt; i += n) {
+            n = adjacentRegs(&addr[i], cnt - i);
+            if (write(addr[i], 8 * n,
+                      reinterpret_cast<uint8_t *>(&ibuf[i])) == TAP_ERROR) {
+                return TAP_ERROR;
+            }
+        }
+        return 8 * cnt;
+    }
+
+ protected:
+    int adjacentRegs(const uint64_t *addr, int cnt) {
+        int n = 1;
+        while (n < cnt && addr[n] == addr[0] + 8 * static_cast<uint64_t>(n)) {
+            n++;
+        }
+        return n;
+    }
+
+    /** Notify subscribers (GUI, remote clients) about modified memory */
+    void postMemDirty(uint64_t addr, int bytes) {
+        uint64_t page = addr & ~(HAP_MEMDIRTY_PAGE - 1);
+        uint64_t end = addr + static_cast<uint64_t>(bytes);
+        if (end - page > HAP_MEMDIRTY_PAGES_MAX * HAP_MEMDIRTY_PAGE) {
+            RISCV_post_hap(HAP_MemDirty, ~0ull, "Memory write");
+            return;
+        }
+        for (; page < end; page += HAP_MEMDIRTY_PAGE) {
+            RISCV_post_hap(HAP_MemDirty, page, "Memory write");
+        }
+    }
 };
 
 }  // namespace debugger
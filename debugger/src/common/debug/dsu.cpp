@@ -28,10 +28,12 @@ DSU::DSU(const char *name) :
     registerAttribute("CPU", &cpu_);
     icpulist_.make_list(0);
     RISCV_event_create(&nb_event_, "DSU_event_nb");
+    RISCV_mutex_init(&mutex_nb_);
 }
 
 DSU::~DSU() {
     RISCV_event_close(&nb_event_);
+    RISCV_mutex_destroy(&mutex_nb_);
 }
 
 void DSU::postinitService() {
@@ -60,19 +62,45 @@ void DSU::nb_response_debug_port(DebugPortTransactionType *trans) {
 }
 
 void DSU::nb_debug_write(unsigned hartid, uint16_t addr, uint64_t wdata) {
+    DebugPortTransactionType trans;
+    trans.addr = addr;
+    trans.wdata = wdata;
+    trans.write = 1;
+    trans.bytes = 8;
+    nb_debug_vector(hartid, &trans, 1);
+}
+
+uint64_t DSU::nb_debug_read(unsigned hartid, uint16_t addr) {
+    DebugPortTransactionType trans;
+    trans.addr = addr;
+    trans.wdata = 0;
+    trans.write = 0;
+    trans.bytes = 8;
+    trans.rdata = 0;
+    nb_debug_vector(hartid, &trans, 1);
+    return trans.rdata;
+}
+
+void DSU::nb_debug_vector(unsigned hartid, DebugPortTransactionType *trans,
+                          int cnt) {
     if (hartid >= getCpuTotal()) {
         RISCV_error("Debug Access index out of range %d", hartid);
         return;
     }
     ICpuGeneric *icpu = static_cast<ICpuGeneric *>(icpulist_[hartid].to_iface());
-    nb_trans_.addr = addr;
-    nb_trans_.wdata = wdata;
-    nb_trans_.write = 1;
-    nb_trans_.bytes = 8;
-
+    RISCV_mutex_lock(&mutex_nb_);
     RISCV_event_clear(&nb_event_);
-    icpu->nb_transport_debug_port(&nb_trans_, static_cast<IDbgNbResponse *>(this));
+    icpu->nb_transport_debug_port(trans, cnt,
+                                  static_cast<IDbgNbResponse *>(this));
     RISCV_event_wait(&nb_event_);
+    RISCV_mutex_unlock(&mutex_nb_);
+
+    for (int i = 0; i < cnt; i++) {
+        if (trans[i].write) {
+            RISCV_post_hap(HAP_RegChanged, hartid, "Debug port write");
+            break;
+        }
+    }
 }
 
 void DSU::incrementRdAccess(int mst_id) {
@@ -106,7 +134,7 @@ void DSU::setCpuContext(unsigned n) {
     }
     ICpuGeneric *pcpu = static_cast<ICpuGeneric *>(icpulist_[n].to_iface());
     hartsel_ = n;
-    dport_region_.setCpu(pcpu);
+    dport_region_.setCpu(pcpu, n);
 }
 
 bool DSU::isCpuHalted(unsigned idx) {
@@ -47,18 +47,22 @@ class DSU : public RegMemBankGeneric,
     /** IDsuGeneric */
     virtual void incrementRdAccess(int mst_id);
     virtual void incrementWrAccess(int mst_id);
+    virtual unsigned getCpuTotal() { return icpulist_.size(); }
+    virtual unsigned getCpuContext() { return hartsel_; }
+    virtual bool isCpuHalted(unsigned idx);
+    virtual uint64_t nb_debug_read(unsigned hartid, uint16_t addr);
+    virtual void nb_debug_write(unsigned hartid, uint16_t addr,
+                                uint64_t wdata);
+    virtual void nb_debug_vector(unsigned hartid,
+                                 DebugPortTransactionType *trans,
+                                 int cnt);
 
     /** IDbgNbResponse */
     virtual void nb_response_debug_port(DebugPortTransactionType *trans);
 
     void softReset(bool val);
-    bool isCpuHalted(unsigned idx);
 
-    unsigned getCpuTotal() { return icpulist_.size(); }
     void setCpuContext(unsigned n);
-    unsigned getCpuContext() { return hartsel_; }
-
-    void nb_debug_write(unsigned hartid, uint16_t addr, uint64_t wdata);
 
  private:
     AttributeType cpu_;
@@ -67,6 +71,7 @@ class DSU : public RegMemBankGeneric,
     unsigned hartsel_;
     ICpuGeneric *icpu_context_;     // current cpu context
     event_def nb_event_;
+    mutex_def mutex_nb_;            // nb_event_ is shared by all harts
 };
 
 DECLARE_CLASS(DSU)
@@ -54,6 +54,7 @@ DsuRegisters::DPORT_REGION_BANK64::nb_transport(Axi4TransactionType *trans,
     if (trans->action == MemAction_Write) {
         nb_trans_.dbg_trans.write = 1;
         nb_trans_.dbg_trans.wdata = trans->wpayload.b64[0];
+        RISCV_post_hap(HAP_RegChanged, hartidx_, "Debug port write");
     }
 
     ETransStatus ret = TRANS_OK;
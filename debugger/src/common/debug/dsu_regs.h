@@ -37,6 +37,7 @@ class DsuRegisters {
             uint64_t addr, int len) :
             GenericReg64Bank(parent, name, addr, len) {
                 icpu_ = 0;
+                hartidx_ = 0;
             }
 
         /** IMemoryOperation methods */
@@ -48,7 +49,10 @@ class DsuRegisters {
         virtual void nb_response_debug_port(DebugPortTransactionType *trans);
 
         /** Switch CPU context methods: */
-        void setCpu(ICpuGeneric *icpu) { icpu_ = icpu; }
+        void setCpu(ICpuGeneric *icpu, unsigned hartidx) {
+            icpu_ = icpu;
+            hartidx_ = hartidx;
+        }
 
      protected:
         IFace *getInterface(const char *name) {
@@ -60,6 +64,7 @@ class DsuRegisters {
 
      private:
         ICpuGeneric *icpu_;
+        unsigned hartidx_;         // index of the CPU in DSU list
 
         struct nb_trans_type {
             Axi4TransactionType *p_axi_trans;
@@ -74,8 +79,6 @@ class DsuRegisters {
     DMSTATUS_TYPE dmstatus_;
     HALTSUM_TYPE haltsum0_;
     GenericReg64Bank bus_util_;
-
-    DebugPortTransactionType nb_trans_;
 };
 
 }  // namespace debugger
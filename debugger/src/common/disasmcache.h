@@ -0,0 +1,108 @@
+/*
+ *  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_COMMON_DISASMCACHE_H__
+#define __DEBUGGER_COMMON_DISASMCACHE_H__
+
+#include <inttypes.h>
+#include "attribute.h"
+
+namespace debugger {
+
+/**
+ * @brief Disassembled lines cache of the source code services.
+ *
+ * Direct mapped table indexed by the instruction address. Each line keeps
+ * the code bytes it was decoded from, so a line is never returned after
+ * the memory was modified (software breakpoint insertion included).
+ * Mnemonics and comments depend on the debug symbols: all lines are
+ * dropped by invalidate() when the symbols are changed.
+ */
+class DisasmCacheType {
+ public:
+    struct LineType {
+        uint64_t addr;
+        uint32_t code;              // code bytes masked by the codesz
+        uint32_t tag;               // decoder mode (ARM/Thumb)
+        uint32_t gen;               // 0 is an empty line
+        int codesz;
+        AttributeType mnemonic;
+        AttributeType comment;
+    };
+
+    DisasmCacheType() : gen_(1) {
+        tbl_ = new LineType[CACHE_LINES];
+        for (unsigned i = 0; i < CACHE_LINES; i++) {
+            tbl_[i].gen = 0;
+        }
+    }
+    ~DisasmCacheType() {
+        delete [] tbl_;
+    }
+
+    /** Returns 0 if the line is absent or was decoded from other bytes */
+    const LineType *get(uint64_t addr, uint32_t code, uint32_t tag) const {
+        const LineType *e = &tbl_[index(addr)];
+        if (e->gen != gen_ || e->addr != addr || e->tag != tag
+            || (code & mask(e->codesz)) != e->code) {
+            return 0;
+        }
+        return e;
+    }
+
+    /** Store the decoded line, mnemonic and comment are copied */
+    void put(uint64_t addr, uint32_t code, uint32_t tag, int codesz,
+             const AttributeType &mnemonic, const AttributeType &comment) {
+        LineType *e = &tbl_[index(addr)];
+        e->addr = addr;
+        e->codesz = codesz;
+        e->code = code & mask(codesz);
+        e->tag = tag;
+        e->gen = gen_;
+        e->mnemonic = mnemonic;
+        e->comment = comment;
+    }
+
+    /** Drop all lines */
+    void invalidate() {
+        if (++gen_ == 0) {
+            for (unsigned i = 0; i < CACHE_LINES; i++) {
+                tbl_[i].gen = 0;
+            }
+            gen_ = 1;
+        }
+    }
+
+ private:
+    static const unsigned CACHE_LINES = 1 << 12;
+
+    static unsigned index(uint64_t addr) {
+        return static_cast<unsigned>(addr >> 1) & (CACHE_LINES - 1);
+    }
+    static uint32_t mask(int codesz) {
+        return codesz >= 4 ? ~0u : (1u << (8 * codesz)) - 1;
+    }
+
+    DisasmCacheType(const DisasmCacheType &);
+    DisasmCacheType &operator=(const DisasmCacheType &);
+
+    LineType *tbl_;
+    uint32_t gen_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_DISASMCACHE_H__
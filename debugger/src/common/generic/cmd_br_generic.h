@@ -35,6 +35,9 @@ class CmdBrGeneric : public ICommand,
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) {
+        return args->size() == 1;
+    }
 
     /** IHap */
     virtual void hapTriggered(EHapType type,
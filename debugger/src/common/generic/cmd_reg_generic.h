@@ -30,6 +30,9 @@ class CmdRegGeneric : public ICommand  {
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) {
+        return args->size() == 2;
+    }
 
  protected:
     virtual const ECpuRegMapping *getpMappedReg() = 0;
@@ -32,6 +32,8 @@ CmdRegsGeneric::CmdRegsGeneric(ITap *tap) : ICommand ("regs", tap) {
         "Example:\n"
         "    regs\n"
         "    regs a0 s0 sp\n");
+    idsu_ = 0;
+    dsuChecked_ = false;
 }
 
 int CmdRegsGeneric::isValid(AttributeType *args) {
@@ -45,24 +47,91 @@ int CmdRegsGeneric::isValid(AttributeType *args) {
 }
 
 void CmdRegsGeneric::exec(AttributeType *args, AttributeType *res) {
-    Reg64Type u;
+    const ECpuRegMapping *preg = getpMappedReg();
+    unsigned total = 0;
     if (args->size() != 1) {
-        res->make_list(args->size() - 1);
-        for (unsigned i = 1; i < args->size(); i++) {
-            const char *name = (*args)[i].to_string();
-            tap_->read(reg2addr(name), 8, u.buf);
-            (*res)[i - 1].make_uint64(u.val);
+        total = args->size() - 1;
+    } else {
+        while (preg[total].name[0]) {
+            total++;
         }
-        return;
     }
 
-    const ECpuRegMapping *preg = getpMappedReg();
+    // All registers are read in one vectored request
+    AttributeType tbuf;
+    tbuf.make_data(16 * total);
+    uint64_t *addr = reinterpret_cast<uint64_t *>(tbuf.data());
+    uint64_t *val = &addr[total];
+    for (unsigned i = 0; i < total; i++) {
+        if (args->size() != 1) {
+            addr[i] = reg2addr((*args)[i + 1].to_string());
+        } else {
+            addr[i] = preg[i].offset;
+        }
+        val[i] = 0;
+    }
+    if (!readDport(addr, total, val)) {
+        tap_->readRegs(addr, static_cast<int>(total), val);
+    }
+
+    if (args->size() != 1) {
+        res->make_list(total);
+        for (unsigned i = 0; i < total; i++) {
+            (*res)[i].make_uint64(val[i]);
+        }
+        return;
+    }
     res->make_dict();
-    while (preg->name[0]) {
-        tap_->read(preg->offset, 8, u.buf);
-        (*res)[preg->name].make_uint64(u.val);
-        preg++;
+    for (unsigned i = 0; i < total; i++) {
+        (*res)[preg[i].name].make_uint64(val[i]);
+    }
+}
+
+/**
+ * Simulated DSU reads all registers of the selected hart in one debug port
+ * handshake instead of an access per register through the DSU bank.
+ */
+bool CmdRegsGeneric::readDport(const uint64_t *addr, unsigned cnt,
+                               uint64_t *obuf) {
+    if (!dsuChecked_) {
+        // DSU may be created after this command
+        AttributeType lstServ;
+        RISCV_get_services_with_iface(IFACE_DSU_GENERIC, &lstServ);
+        if (lstServ.size() != 0) {
+            IService *iserv = static_cast<IService *>(lstServ[0u].to_iface());
+            idsu_ = static_cast<IDsuGeneric *>(
+                                iserv->getInterface(IFACE_DSU_GENERIC));
+            if (idsu_->getCpuTotal() == 0) {
+                idsu_ = 0;
+            }
+        }
+        dsuChecked_ = true;
+    }
+    if (!idsu_ || idsu_->getCpuContext() >= idsu_->getCpuTotal()) {
+        return false;
+    }
+
+    AttributeType tbuf;
+    tbuf.make_data(cnt * sizeof(DebugPortTransactionType));
+    DebugPortTransactionType *trans =
+        reinterpret_cast<DebugPortTransactionType *>(tbuf.data());
+    for (unsigned i = 0; i < cnt; i++) {
+        // Only the CPU regions of the DSU map onto the debug port
+        if (addr[i] < DSU_OFFSET || addr[i] >= DSU_OFFSET + DSUREG(ulocal)) {
+            return false;
+        }
+        trans[i].write = 0;
+        trans[i].addr = static_cast<uint16_t>((addr[i] - DSU_OFFSET) >> 3);
+        trans[i].bytes = 8;
+        trans[i].wdata = 0;
+        trans[i].rdata = 0;
+    }
+    idsu_->nb_debug_vector(idsu_->getCpuContext(), trans,
+                           static_cast<int>(cnt));
+    for (unsigned i = 0; i < cnt; i++) {
+        obuf[i] = trans[i].rdata;
     }
+    return true;
 }
 
 uint64_t CmdRegsGeneric::reg2addr(const char *name) {
@@ -18,7 +18,9 @@
 #define __DEBUGGER_SRC_COMMON_GENERIC_CMD_REGS_GENERIC_H__
 
 #include "api_core.h"
+#include "iservice.h"
 #include "coreservices/icommand.h"
+#include "coreservices/idsugen.h"
 #include "debug/dsumap.h"
 
 namespace debugger {
@@ -30,10 +32,16 @@ class CmdRegsGeneric : public ICommand  {
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) { return true; }
 
  protected:
     virtual uint64_t reg2addr(const char *name);
     virtual const ECpuRegMapping *getpMappedReg() = 0;
+    bool readDport(const uint64_t *addr, unsigned cnt, uint64_t *obuf);
+
+ private:
+    IDsuGeneric *idsu_;         // not available on real hardware
+    bool dsuChecked_;
 };
 
 }  // namespace debugger
@@ -0,0 +1,85 @@
+/*
+ *  Copyright 2018 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "cmd_stats_generic.h"
+
+namespace debugger {
+
+CmdStatsGeneric::CmdStatsGeneric(ITap *tap, ICpuStatistic *istat)
+    : ICommand ("stats", tap) {
+    istat_ = istat;
+
+    briefDescr_.make_string("Instruction mix and execution statistic");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Read per-instruction execution counters, taken/not-taken\n"
+        "    branches, load/store bytes and trap counters collected by\n"
+        "    the functional CPU model. Collection is disabled by default\n"
+        "    and could be enabled by 'CollectStatistic' attribute or\n"
+        "    in run-time. Use 'reset' between benchmark phases.\n"
+        "Response:\n"
+        "    Dictionary {'Enabled':b,'Instructions':i,\n"
+        "                'InstrMix':[['s',i],..],'BranchTaken':i,\n"
+        "                'BranchNotTaken':i,'Jumps':i,'LoadCount':i,\n"
+        "                'LoadBytes':i,'StoreCount':i,'StoreBytes':i,\n"
+        "                'IllegalOpcodes':i,'Traps':[[i,i],..]}\n"
+        "    Nil in a case of enable/disable/reset\n"
+        "Usage:\n"
+        "    stats\n"
+        "    stats enable\n"
+        "    stats disable\n"
+        "    stats reset\n"
+        "Example:\n"
+        "    stats enable\n"
+        "    stats\n");
+}
+
+int CmdStatsGeneric::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if (args->size() == 1) {
+        return CMD_VALID;
+    }
+    if (args->size() == 2 && (*args)[1].is_string()) {
+        if ((*args)[1].is_equal("enable")
+            || (*args)[1].is_equal("disable")
+            || (*args)[1].is_equal("reset")) {
+            return CMD_VALID;
+        }
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdStatsGeneric::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+    if (args->size() == 1) {
+        istat_->getStatistic(res);
+        return;
+    }
+
+    AttributeType &action = (*args)[1];
+    if (action.is_equal("enable")) {
+        istat_->enableStatistic(true);
+    } else if (action.is_equal("disable")) {
+        istat_->enableStatistic(false);
+    } else if (action.is_equal("reset")) {
+        istat_->resetStatistic();
+    }
+}
+
+}  // namespace debugger
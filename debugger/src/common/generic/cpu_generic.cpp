@@ -42,6 +42,7 @@ CpuGeneric::CpuGeneric(const char *name)
     registerInterface(static_cast<ICpuFunctional *>(this));
     registerInterface(static_cast<IPower *>(this));
     registerInterface(static_cast<IResetListener *>(this));
+    registerInterface(static_cast<ICpuStatistic *>(this));
     registerInterface(static_cast<IHap *>(this));
     registerAttribute("Enable", &isEnable_);
     registerAttribute("SysBus", &sysBus_);
@@ -57,8 +58,11 @@ CpuGeneric::CpuGeneric(const char *name)
     registerAttribute("SysBusMasterID", &sysBusMasterID_);
     registerAttribute("CacheBaseAddress", &cacheBaseAddr_);
     registerAttribute("CacheAddressMask", &cacheAddrMask_);
+    registerAttribute("CacheRegions", &cacheRegions_);
+    registerAttribute("CachePagesMax", &cachePagesMax_);
     registerAttribute("CoverageTracker", &coverageTracker_);
     registerAttribute("ResetState", &resetState_);
+    registerAttribute("CollectStatistic", &collectStatistic_);
 
     char tstr[256];
     RISCV_sprintf(tstr, sizeof(tstr), "eventConfigDone_%s", name);
@@ -78,16 +82,30 @@ CpuGeneric::CpuGeneric(const char *name)
     do_not_cache_ = false;
 
     dport_.valid = 0;
+    dport_.rcnt = 0;
+    dport_.wcnt = 0;
+    RISCV_mutex_init(&mutexDport_);
     trace_file_ = 0;
     memset(&trace_data_, 0, sizeof(trace_data_));
-    icache_ = 0;
-    memcache_sz_ = 0;
+    cacheRegion_ = 0;
+    cacheRegionCnt_ = 0;
+    memset(icacheHash_, 0, sizeof(icacheHash_));
+    icachePool_ = 0;
+    icachePoolMax_ = 0;
+    icachePoolTotal_ = 0;
+    icachePoolUsed_ = 0;
+    icacheStamp_ = 0;
+    icachePage_ = 0;
+    icacheLine_ = 0;
+    payload_ = cacheline_;
     fetch_addr_ = 0;
-    cache_offset_ = 0;
-    cachable_pc_ = false;
-    CACHE_BASE_ADDR_ = 0;
-    CACHE_MASK_ = 0;
+    smcAddr_ = ~0ull;
     oplen_ = 0;
+    statEnable_ = false;
+    statMemop_ = false;
+    statInstrCnt_ = 0;
+    memset(&stat_, 0, sizeof(stat_));
+    pcmd_stats_ = 0;
     RISCV_set_default_clock(static_cast<IClock *>(this));
 
     R = portRegs_.getpR64();
@@ -98,8 +116,15 @@ CpuGeneric::CpuGeneric(const char *name)
 CpuGeneric::~CpuGeneric() {
     RISCV_set_default_clock(0);
     RISCV_event_close(&eventConfigDone_);
-    if (icache_) {
-        delete [] icache_;
+    RISCV_mutex_destroy(&mutexDport_);
+    for (int i = 0; i < icachePoolTotal_; i++) {
+        delete icachePool_[i];
+    }
+    if (icachePool_) {
+        delete [] icachePool_;
+    }
+    if (cacheRegion_) {
+        delete [] cacheRegion_;
     }
     if (trace_file_) {
         trace_file_->close();
@@ -166,12 +191,34 @@ void CpuGeneric::postinitService() {
 
     stackTraceBuf_.setRegTotal(2 * stackTraceSize_.to_int());
 
-    CACHE_BASE_ADDR_ = cacheBaseAddr_.to_uint64();
-    CACHE_MASK_ = ~cacheAddrMask_.to_uint64();
-    if (cacheAddrMask_.to_uint64()) {
-        memcache_sz_ = cacheAddrMask_.to_int() + 1;
-        icache_ = new ICacheType[memcache_sz_];
-        memset(icache_, 0, memcache_sz_*sizeof(ICacheType));
+    if (collectStatistic_.is_bool()) {
+        statEnable_ = collectStatistic_.to_bool();
+    }
+    pcmd_stats_ = new CmdStatsGeneric(itap_,
+                                      static_cast<ICpuStatistic *>(this));
+    icmdexec_->registerCommand(static_cast<ICommand *>(pcmd_stats_));
+
+    if (cacheRegions_.is_list() && cacheRegions_.size()) {
+        cacheRegionCnt_ = static_cast<int>(cacheRegions_.size());
+        cacheRegion_ = new CacheRegionType[cacheRegionCnt_];
+        for (int i = 0; i < cacheRegionCnt_; i++) {
+            const AttributeType &item = cacheRegions_[i];
+            cacheRegion_[i].addr = item[0u].to_uint64();
+            cacheRegion_[i].size = item[1].to_uint64();
+        }
+    } else if (cacheAddrMask_.to_uint64()) {
+        // Legacy single window
+        cacheRegionCnt_ = 1;
+        cacheRegion_ = new CacheRegionType[1];
+        cacheRegion_[0].addr = cacheBaseAddr_.to_uint64();
+        cacheRegion_[0].size = cacheAddrMask_.to_uint64() + 1;
+    }
+    icachePoolMax_ = 256;
+    if (cachePagesMax_.is_integer() && cachePagesMax_.to_int() > 0) {
+        icachePoolMax_ = cachePagesMax_.to_int();
+    }
+    if (cacheRegionCnt_) {
+        icachePool_ = new ICachePageType *[icachePoolMax_];
     }
 
     // Get global settings:
@@ -187,6 +234,14 @@ void CpuGeneric::postinitService() {
     }
 }
 
+void CpuGeneric::predeleteService() {
+    if (pcmd_stats_) {
+        icmdexec_->unregisterCommand(static_cast<ICommand *>(pcmd_stats_));
+        delete pcmd_stats_;
+        pcmd_stats_ = 0;
+    }
+}
+
 void CpuGeneric::hapTriggered(EHapType type,
                               uint64_t param,
                               const char *descr) {
@@ -204,7 +259,6 @@ void CpuGeneric::busyLoop() {
 
 void CpuGeneric::updatePipeline() {
     if (dport_.valid) {
-        dport_.valid = 0;
         updateDebugPort();
     }
 
@@ -218,15 +272,22 @@ void CpuGeneric::updatePipeline() {
 
     if (!checkHwBreakpoint()) {
         fetchILine();
-        instr_ = decodeInstruction(cacheline_);
+        if (!instr_) {
+            instr_ = decodeInstruction(cacheline_);
+        }
 
         trackContextStart();
         if (instr_) {
-            oplen_ = instr_->exec(cacheline_);
+            statMemop_ = statEnable_;
+            oplen_ = instr_->exec(payload_);
+            statMemop_ = false;
         } else {
             generateIllegalOpcode();
         }
         trackContextEnd();
+        if (statEnable_) {
+            updateStatistic();
+        }
 
         pc_z_ = getPC();
     }
@@ -278,15 +339,29 @@ void CpuGeneric::updateQueue() {
 
 void CpuGeneric::fetchILine() {
     fetch_addr_ = fetchingAddress();
-    cachable_pc_ = false;
+    icacheLine_ = 0;
+    payload_ = cacheline_;
     instr_ = 0;
-    if ((fetch_addr_ & CACHE_MASK_) == CACHE_BASE_ADDR_) {
-        cachable_pc_ = true;
-        cache_offset_ = fetch_addr_ - CACHE_BASE_ADDR_;
-        instr_ = icache_[cache_offset_].instr;
-        cacheline_[0].buf32[0] = icache_[cache_offset_].buf;  // for tracer
+    if (!icachePage_ || ((fetch_addr_ ^ icachePage_->addr) & CODE_PAGE_MASK)) {
+        icachePage_ = 0;
+        if (cacheRegionCnt_) {
+            icachePage_ = getCachePage(fetch_addr_);
+            if (!icachePage_ && isCachable(fetch_addr_)) {
+                icachePage_ = allocCachePage(fetch_addr_);
+            }
+        }
+        if (icachePage_) {
+            icachePage_->lru = ++icacheStamp_;
+        }
+    }
+    if (icachePage_ && (fetch_addr_ & CODE_LINE_ALIGN) == 0) {
+        icacheLine_ = &icachePage_->line[cacheLineIdx(fetch_addr_)];
+        instr_ = icacheLine_->instr;
+        if (instr_) {
+            payload_ = icacheLine_->payload;
+            cacheline_[0].buf32[0] = payload_[0].buf32[0];  // for tracer
+        }
     }
-    
 
     if (!instr_) {
         trans_.action = MemAction_Read;
@@ -300,16 +375,61 @@ void CpuGeneric::fetchILine() {
     }
 }
 
-void CpuGeneric::flush(uint64_t addr) {
-    if (icache_ == 0) {
-        return;
+bool CpuGeneric::isCachable(uint64_t addr) {
+    for (int i = 0; i < cacheRegionCnt_; i++) {
+        if (addr >= cacheRegion_[i].addr
+            && addr < cacheRegion_[i].addr + cacheRegion_[i].size) {
+            return true;
+        }
     }
+    return false;
+}
+
+CpuGeneric::ICachePageType *CpuGeneric::allocCachePage(uint64_t addr) {
+    ICachePageType *p;
+    ICachePageType **pprev;
+    if (icachePoolUsed_ < icachePoolTotal_) {
+        // Released by flush
+        p = icachePool_[icachePoolUsed_++];
+    } else if (icachePoolTotal_ < icachePoolMax_) {
+        p = new ICachePageType;
+        icachePool_[icachePoolTotal_++] = p;
+        icachePoolUsed_++;
+    } else {
+        // Evict least recently used page
+        p = icachePool_[0];
+        for (int i = 1; i < icachePoolTotal_; i++) {
+            if (icachePool_[i]->lru < p->lru) {
+                p = icachePool_[i];
+            }
+        }
+        pprev = &icacheHash_[(p->addr >> CODE_PAGE_SHIFT)
+                             & (CODE_HASH_SIZE - 1)];
+        while (*pprev != p) {
+            pprev = &(*pprev)->next;
+        }
+        *pprev = p->next;
+    }
+    memset(p->line, 0, sizeof(p->line));
+    p->addr = addr & CODE_PAGE_MASK;
+    pprev = &icacheHash_[(addr >> CODE_PAGE_SHIFT) & (CODE_HASH_SIZE - 1)];
+    p->next = *pprev;
+    *pprev = p;
+    return p;
+}
+
+void CpuGeneric::flush(uint64_t addr) {
     if (addr == ~0ull) {
-        memset(icache_, 0, memcache_sz_*sizeof(ICacheType));
-    } else if ((addr & CACHE_MASK_) == CACHE_BASE_ADDR_) {
+        // Pages stay allocated and will be re-used without new allocation
+        memset(icacheHash_, 0, sizeof(icacheHash_));
+        icachePoolUsed_ = 0;
+        icachePage_ = 0;
+        icacheLine_ = 0;
+    } else if (cacheRegionCnt_) {
         /** SW breakpoint manager must call this flush operation */
-        if ((addr & CACHE_MASK_) == CACHE_BASE_ADDR_) {
-            icache_[addr - CACHE_BASE_ADDR_].instr = 0;
+        ICachePageType *p = getCachePage(addr);
+        if (p) {
+            p->line[cacheLineIdx(addr)].instr = 0;
         }
     }
 }
@@ -325,23 +445,64 @@ void CpuGeneric::trackContextStart() {
 }
 
 void CpuGeneric::trackContextEnd() {
+    if (smcAddr_ < fetch_addr_ + oplen_) {
+        // Executing instruction modifies itself
+        do_not_cache_ = true;
+    }
+    smcAddr_ = ~0ull;
     if (do_not_cache_) {
-        if (cachable_pc_) {
-            icache_[cache_offset_].instr = 0;
+        if (icacheLine_) {
+            icacheLine_->instr = 0;
         }
     } else {
         if (icovtracker_) {
             icovtracker_->markAddress(fetch_addr_,
                                       static_cast<uint8_t>(oplen_));
         }
-        if (cachable_pc_) {
-            icache_[cache_offset_].instr = instr_;
-            icache_[cache_offset_].buf = cacheline_[0].buf32[0];
+        if (icacheLine_ && payload_ == cacheline_) {
+            icacheLine_->instr = instr_;
+            memcpy(icacheLine_->payload, cacheline_,
+                   sizeof(icacheLine_->payload));
         }
     }
     do_not_cache_ = false;
 }
 
+void CpuGeneric::invalidateCode(uint64_t addr, unsigned sz) {
+    // Instruction started before the written address may overlap it
+    uint64_t start = addr - (INSTR_MAX_BYTES - 1);
+    uint64_t end = addr + sz;
+    ICachePageType *p;
+    if (start > addr) {
+        start = 0;
+    }
+    start &= ~CODE_LINE_ALIGN;
+    // Range is shorter than a page: check both ends and skip data stores
+    p = getCachePage(start);
+    if (!p && !getCachePage(end - 1)) {
+        return;
+    }
+    for (uint64_t a = start; a < end; a += (CODE_LINE_ALIGN + 1)) {
+        if (!p || ((a ^ p->addr) & CODE_PAGE_MASK)) {
+            p = getCachePage(a);
+            if (!p) {
+                continue;
+            }
+        }
+        p->line[cacheLineIdx(a)].instr = 0;
+    }
+    // Store may hit the executing instruction. Its length is known only
+    // after exec(), so the lowest written byte is checked in
+    // trackContextEnd().
+    if (icacheLine_ && addr < fetch_addr_ + INSTR_MAX_BYTES
+        && end > fetch_addr_) {
+        start = addr > fetch_addr_ ? addr : fetch_addr_;
+        if (start < smcAddr_) {
+            smcAddr_ = start;
+        }
+    }
+}
+
 void CpuGeneric::traceRegister(int idx, uint64_t v) {
     if (trace_data_.action_cnt >= 64) {
         return;
@@ -364,6 +525,99 @@ void CpuGeneric::traceMemop(uint64_t addr, int we, uint64_t v, uint32_t sz) {
     p->memop_size = sz;
 }
 
+void CpuGeneric::updateStatistic() {
+    stat_.instructions++;
+    if (!instr_) {
+        stat_.illegal++;
+        return;
+    }
+    if (instr_->incrExecCounter() == 1 && statInstrCnt_ < STAT_INSTR_MAX) {
+        statInstr_[statInstrCnt_++] = instr_;
+    }
+    if (instr_->isConditionalBranch()) {
+        if (branch_) {
+            stat_.br_taken++;
+        } else {
+            stat_.br_not_taken++;
+        }
+    } else if (branch_) {
+        stat_.jumps++;
+    }
+}
+
+/** Called by handleTrap() when the handler of the trap is entered */
+void CpuGeneric::updateTrapStatistic(int idx) {
+    if (statEnable_ && idx < STAT_TRAPS_MAX) {
+        stat_.traps[idx]++;
+    }
+}
+
+void CpuGeneric::resetStatistic() {
+    int total = statInstrCnt_;
+    statInstrCnt_ = 0;
+    for (int i = 0; i < total; i++) {
+        statInstr_[i]->resetExecCounter();
+    }
+    memset(&stat_, 0, sizeof(stat_));
+}
+
+void CpuGeneric::getStatistic(AttributeType *res) {
+    AttributeType mix;
+    AttributeType item;
+    int total = statInstrCnt_;
+
+    // Handlers with the same name (different encodings) are merged
+    mix.make_list(0);
+    for (int i = 0; i < total; i++) {
+        const char *name = statInstr_[i]->name();
+        uint64_t cnt = statInstr_[i]->getExecCounter();
+        bool found = false;
+        for (unsigned n = 0; n < mix.size(); n++) {
+            if (mix[n][0u].is_equal(name)) {
+                mix[n][1].make_uint64(mix[n][1].to_uint64() + cnt);
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            item.make_list(2);
+            item[0u].make_string(name);
+            item[1].make_uint64(cnt);
+            mix.add_to_list(&item);
+        }
+    }
+    mix.sort(1);
+    // descending order
+    for (unsigned i = 0; i < mix.size() / 2; i++) {
+        mix.swap_list_item(i, mix.size() - 1 - i);
+    }
+
+    res->make_dict();
+    (*res)["Enabled"].make_boolean(statEnable_);
+    (*res)["Instructions"].make_uint64(stat_.instructions);
+    (*res)["InstrMix"] = mix;
+    (*res)["BranchTaken"].make_uint64(stat_.br_taken);
+    (*res)["BranchNotTaken"].make_uint64(stat_.br_not_taken);
+    (*res)["Jumps"].make_uint64(stat_.jumps);
+    (*res)["LoadCount"].make_uint64(stat_.load_cnt);
+    (*res)["LoadBytes"].make_uint64(stat_.load_bytes);
+    (*res)["StoreCount"].make_uint64(stat_.store_cnt);
+    (*res)["StoreBytes"].make_uint64(stat_.store_bytes);
+    (*res)["IllegalOpcodes"].make_uint64(stat_.illegal);
+
+    AttributeType &traps = (*res)["Traps"];
+    traps.make_list(0);
+    for (int i = 0; i < STAT_TRAPS_MAX; i++) {
+        if (stat_.traps[i] == 0) {
+            continue;
+        }
+        item.make_list(2);
+        item[0u].make_uint64(i);
+        item[1].make_uint64(stat_.traps[i]);
+        traps.add_to_list(&item);
+    }
+}
+
 void CpuGeneric::registerStepCallback(IClockListener *cb,
                                                uint64_t t) {
     if (!isEnabled() && t <= step_cnt_) {
@@ -433,6 +687,20 @@ ETransStatus CpuGeneric::dma_memop(Axi4TransactionType *tr) {
         }
     }
 
+    if (tr->action == MemAction_Write && icachePoolUsed_) {
+        invalidateCode(tr->addr, tr->xsize);
+    }
+
+    if (statMemop_) {
+        if (tr->action == MemAction_Write) {
+            stat_.store_cnt++;
+            stat_.store_bytes += tr->xsize;
+        } else {
+            stat_.load_cnt++;
+            stat_.load_bytes += tr->xsize;
+        }
+    }
+
     if (trace_file_) {
         int we = tr->action == MemAction_Write ? 1 : 0;
         Reg64Type memop_data;
@@ -493,6 +761,12 @@ void CpuGeneric::halt(EHaltCause cause, const char *descr) {
                        getPC(), strop, descr);
     }
     estate_ = CORE_Halted;
+
+    // Subscribers are notified without waiting for the status polling
+    if (cause == HaltSwBreakpoint || cause == HaltHwTrigger) {
+        RISCV_post_hap(HAP_Breakpoint, getPC(), "Breakpoint hit");
+    }
+    RISCV_post_hap(HAP_CpuHalted, cause, "CPU halted");
 }
 
 void CpuGeneric::power(EPowerAction onoff) {
@@ -527,30 +801,57 @@ void CpuGeneric::reset(IFace *isource) {
 }
 
 void CpuGeneric::updateDebugPort() {
-    DebugPortTransactionType *trans = dport_.trans;
+    RISCV_mutex_lock(&mutexDport_);
+    DebugPortType::RequestType req =
+        dport_.queue[dport_.rcnt % DPORT_QUEUE_SIZE];
+    dport_.rcnt++;
+    dport_.valid = dport_.rcnt != dport_.wcnt;
+    RISCV_mutex_unlock(&mutexDport_);
+
+    DebugPortTransactionType *trans;
     Axi4TransactionType tr;
     tr.xsize = 8;
     tr.source_idx = 0;
-    if (trans->write) {
-        tr.action = MemAction_Write;
-        tr.wpayload.b64[0] = trans->wdata;
-        tr.wstrb = 0xFF;
-    } else {
-        tr.action = MemAction_Read;
-        tr.rpayload.b64[0] = 0;
+    for (int i = 0; i < req.cnt; i++) {
+        trans = &req.trans[i];
+        if (trans->write) {
+            tr.action = MemAction_Write;
+            tr.wpayload.b64[0] = trans->wdata;
+            tr.wstrb = 0xFF;
+        } else {
+            tr.action = MemAction_Read;
+            tr.rpayload.b64[0] = 0;
+        }
+        tr.addr = static_cast<uint64_t>(trans->addr) << 3;
+        idbgbus_->b_transport(&tr);
+        trans->rdata = tr.rpayload.b64[0];
     }
-    tr.addr = static_cast<uint64_t>(trans->addr) << 3;
-    idbgbus_->b_transport(&tr);
-
-    trans->rdata = tr.rpayload.b64[0];
-    dport_.cb->nb_response_debug_port(trans);
+    req.cb->nb_response_debug_port(req.trans);
 }
 
 void CpuGeneric::nb_transport_debug_port(DebugPortTransactionType *trans,
                                          IDbgNbResponse *cb) {
-    dport_.trans = trans;
-    dport_.cb = cb;
+    nb_transport_debug_port(trans, 1, cb);
+}
+
+void CpuGeneric::nb_transport_debug_port(DebugPortTransactionType *trans,
+                                         int cnt, IDbgNbResponse *cb) {
+    RISCV_mutex_lock(&mutexDport_);
+    if (dport_.wcnt - dport_.rcnt >= DPORT_QUEUE_SIZE) {
+        RISCV_mutex_unlock(&mutexDport_);
+        RISCV_error("Debug port queue overflow", NULL);
+        for (int i = 0; i < cnt; i++) {
+            trans[i].rdata = 0;
+        }
+        cb->nb_response_debug_port(trans);
+        return;
+    }
+    dport_.queue[dport_.wcnt % DPORT_QUEUE_SIZE].trans = trans;
+    dport_.queue[dport_.wcnt % DPORT_QUEUE_SIZE].cnt = cnt;
+    dport_.queue[dport_.wcnt % DPORT_QUEUE_SIZE].cb = cb;
+    dport_.wcnt++;
     dport_.valid = true;
+    RISCV_mutex_unlock(&mutexDport_);
 }
 
 void CpuGeneric::addHwBreakpoint(uint64_t addr) {
@@ -31,7 +31,9 @@
 #include "coreservices/icmdexec.h"
 #include "coreservices/itap.h"
 #include "coreservices/icoveragetracker.h"
+#include "coreservices/icpustat.h"
 #include "generic/mapreg.h"
+#include "generic/cmd_stats_generic.h"
 #include <fstream>
 
 namespace debugger {
@@ -149,6 +151,7 @@ class CpuGeneric : public IService,
                    public IClock,
                    public IPower,
                    public IResetListener,
+                   public ICpuStatistic,
                    public IHap {
  public:
     explicit CpuGeneric(const char *name);
@@ -156,6 +159,7 @@ class CpuGeneric : public IService,
 
     /** IService interface */
     virtual void postinitService();
+    virtual void predeleteService();
 
     /** ICpuGeneric interface */
     virtual bool isHalt() { return estate_ == CORE_Halted; }
@@ -163,6 +167,8 @@ class CpuGeneric : public IService,
     virtual void lowerSignal(int idx) = 0;
     virtual void nb_transport_debug_port(DebugPortTransactionType *trans,
                                          IDbgNbResponse *cb);
+    virtual void nb_transport_debug_port(DebugPortTransactionType *trans,
+                                         int cnt, IDbgNbResponse *cb);
 
     /** ICpuFunctional */
     virtual uint64_t *getpRegs() { return R; }
@@ -218,6 +224,12 @@ class CpuGeneric : public IService,
     /** IResetListener interface */
     virtual void reset(IFace *isource);
 
+    /** ICpuStatistic */
+    virtual void enableStatistic(bool en) { statEnable_ = en; }
+    virtual bool isStatisticEnabled() { return statEnable_; }
+    virtual void resetStatistic();
+    virtual void getStatistic(AttributeType *res);
+
     /** IHap */
     virtual void hapTriggered(EHapType type, uint64_t param,
                               const char *descr);
@@ -233,6 +245,10 @@ class CpuGeneric : public IService,
     virtual void updateDebugPort();
     virtual void updateQueue();
     virtual bool checkHwBreakpoint();
+    virtual void updateStatistic();
+    virtual void invalidateCode(uint64_t addr, unsigned sz);
+    virtual bool isCachable(uint64_t addr);
+    virtual void updateTrapStatistic(int idx);
 
  protected:
     AttributeType isEnable_;
@@ -250,8 +266,11 @@ class CpuGeneric : public IService,
     AttributeType hwBreakpoints_;
     AttributeType cacheBaseAddr_;
     AttributeType cacheAddrMask_;
+    AttributeType cacheRegions_;
+    AttributeType cachePagesMax_;
     AttributeType coverageTracker_;
     AttributeType resetState_;
+    AttributeType collectStatistic_;
 
     ISourceCode *isrc_;
     ICoverageTracker *icovtracker_;
@@ -304,23 +323,99 @@ class CpuGeneric : public IService,
     Axi4TransactionType trans_;
     Reg64Type cacheline_[512/4];
     
-    // Simple memory cache to avoid access to sysbus and speed-up simulation
+    // Decoded instructions cache to avoid access to sysbus and speed-up
+    // simulation. Pages are allocated on first execution inside of any
+    // cachable region and evicted (LRU) when CachePagesMax is reached.
+    // CPU stores into allocated page invalidate overlapped entries only
+    // (self-modifying code).
+    static const int CODE_PAGE_SHIFT = 12;
+    static const int CODE_PAGE_SIZE = 1 << CODE_PAGE_SHIFT;
+    static const uint64_t CODE_PAGE_MASK = ~0ull << CODE_PAGE_SHIFT;
+    // One entry per halfword, the minimum instruction alignment
+    static const int CODE_LINE_SHIFT = 1;
+    static const uint64_t CODE_LINE_ALIGN = (1ull << CODE_LINE_SHIFT) - 1;
+    static const int CODE_PAGE_LINES = CODE_PAGE_SIZE >> CODE_LINE_SHIFT;
+    static const int CODE_HASH_SIZE = 256;
+    static const int INSTR_MAX_BYTES = 4;
+    // Instruction and operands pre-extracted by decodeInstruction()
+    static const int ICACHE_PAYLOAD_WORDS = 3;
     struct ICacheType {
         GenericInstruction *instr;
-        uint32_t buf;
-    } *icache_;            // parsed instructions storage
-    int memcache_sz_;               // allocated size
-    uint64_t CACHE_BASE_ADDR_;
-    uint64_t CACHE_MASK_;
+        Reg64Type payload[ICACHE_PAYLOAD_WORDS];
+    };
+    struct ICachePageType {
+        uint64_t addr;                  // page base address
+        uint64_t lru;                   // last switch to this page
+        ICachePageType *next;           // hash chain
+        ICacheType line[CODE_PAGE_LINES];
+    };
+    struct CacheRegionType {
+        uint64_t addr;
+        uint64_t size;
+    } *cacheRegion_;
+    int cacheRegionCnt_;
+
+    ICachePageType *getCachePage(uint64_t addr) {
+        uint64_t page_addr = addr & CODE_PAGE_MASK;
+        ICachePageType *p = icacheHash_[(addr >> CODE_PAGE_SHIFT)
+                                        & (CODE_HASH_SIZE - 1)];
+        while (p && p->addr != page_addr) {
+            p = p->next;
+        }
+        return p;
+    }
+    ICachePageType *allocCachePage(uint64_t addr);
+    static int cacheLineIdx(uint64_t addr) {
+        return static_cast<int>((addr & (CODE_PAGE_SIZE - 1))
+                                >> CODE_LINE_SHIFT);
+    }
+
+    ICachePageType *icacheHash_[CODE_HASH_SIZE];
+    ICachePageType **icachePool_;   // allocated pages
+    int icachePoolMax_;
+    int icachePoolTotal_;           // allocated
+    int icachePoolUsed_;            // mapped into hash since last flush
+    uint64_t icacheStamp_;
+    ICachePageType *icachePage_;    // page of the last fetch
+    ICacheType *icacheLine_;        // entry of the fetching instruction
+    Reg64Type *payload_;            // cached entry or cacheline_ on miss
     uint64_t fetch_addr_;
-    uint64_t cache_offset_;         // instruction pointer - CACHE_BASE_ADDR
-    bool cachable_pc_;              // fetched_pc hit into cachable region
+    uint64_t smcAddr_;              // lowest stored byte of executing instr.
 
+    // DSU context access and per-hart access may overlap in time
+    static const int DPORT_QUEUE_SIZE = 4;
     struct DebugPortType {
         bool valid;
-        DebugPortTransactionType *trans;
-        IDbgNbResponse *cb;
+        int rcnt;
+        int wcnt;
+        struct RequestType {
+            DebugPortTransactionType *trans;
+            int cnt;
+            IDbgNbResponse *cb;
+        } queue[DPORT_QUEUE_SIZE];
     } dport_;
+    mutex_def mutexDport_;
+
+    // Execution statistic counters (enabled by CollectStatistic attribute)
+    static const int STAT_INSTR_MAX = 1024;
+    static const int STAT_TRAPS_MAX = 128;
+    struct StatisticType {
+        uint64_t instructions;
+        uint64_t br_taken;          // conditional branches
+        uint64_t br_not_taken;
+        uint64_t jumps;             // unconditional control transfers
+        uint64_t load_cnt;
+        uint64_t load_bytes;
+        uint64_t store_cnt;
+        uint64_t store_bytes;
+        uint64_t illegal;
+        uint64_t traps[STAT_TRAPS_MAX];
+    } stat_;
+    bool statEnable_;
+    bool statMemop_;                // count memory access of executing instr.
+    int statInstrCnt_;
+    GenericInstruction *statInstr_[STAT_INSTR_MAX]; // executed at least once
+    CmdStatsGeneric *pcmd_stats_;
 
     uint64_t cur_prv_level;
 
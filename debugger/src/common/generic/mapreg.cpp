@@ -96,7 +96,7 @@ ETransStatus MappedReg32Type::b_transport(Axi4TransactionType *trans) {
     uint64_t off = trans->addr - getBaseAddress();
     int xsz = trans->xsize >= 4 ? 4 : static_cast<int>(trans->xsize);
     int roff = static_cast<int>(off & 0x3);
-    int rsz = xsz - roff;
+    int rsz = roff + xsz > 4 ? 4 - roff : xsz;
     Reg32Type cur;
     if (trans->action == MemAction_Read) {
         cur.val = aboutToRead(value_.val);
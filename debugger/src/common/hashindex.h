@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_COMMON_HASHINDEX_H__
+#define __DEBUGGER_COMMON_HASHINDEX_H__
+
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+#include <iface.h>
+
+namespace debugger {
+
+/**
+ * @brief Name to interface index with open addressing.
+ *
+ * Used by IService to find interfaces and attributes without strcmp over
+ * the whole list. Key strings are not copied: they must live as long as
+ * the registered object (IFACE_* constants, allocated attribute names).
+ * Names declared as 'static const char *const' usually share the same
+ * pointer, so pointer comparison is checked before strcmp.
+ */
+class HashIndexType {
+ public:
+    HashIndexType() : tbl_(0), size_(0), cnt_(0) {}
+    ~HashIndexType() {
+        free(tbl_);
+    }
+
+    static uint32_t hash(const char *name) {
+        uint32_t h = 2166136261u;           // FNV-1a
+        while (*name) {
+            h = (h ^ static_cast<uint8_t>(*name++)) * 16777619u;
+        }
+        return h;
+    }
+
+    /** The first registered object with the same name is kept */
+    void add(const char *name, IFace *iface) {
+        if ((cnt_ + 1) * 2 > size_) {
+            rehash(size_ ? 2 * size_ : 16);
+        }
+        uint32_t h = hash(name);
+        EntryType *e = find(name, h);
+        if (e->iface) {
+            return;
+        }
+        e->name = name;
+        e->hash = h;
+        e->iface = iface;
+        cnt_++;
+    }
+
+    IFace *get(const char *name) {
+        if (!cnt_) {
+            return 0;
+        }
+        return find(name, hash(name))->iface;
+    }
+
+    void clear() {
+        if (tbl_) {
+            memset(tbl_, 0, size_ * sizeof(EntryType));
+        }
+        cnt_ = 0;
+    }
+
+ private:
+    struct EntryType {
+        const char *name;
+        uint32_t hash;
+        IFace *iface;
+    };
+
+    /** Returns matched or first empty entry. Table is never full. */
+    EntryType *find(const char *name, uint32_t h) {
+        unsigned mask = size_ - 1;
+        for (unsigned i = h & mask; ; i = (i + 1) & mask) {
+            EntryType *e = &tbl_[i];
+            if (!e->iface) {
+                return e;
+            }
+            if (e->name == name
+                || (e->hash == h && strcmp(e->name, name) == 0)) {
+                return e;
+            }
+        }
+    }
+
+    void rehash(unsigned sz) {
+        EntryType *old = tbl_;
+        unsigned oldsz = size_;
+        tbl_ = static_cast<EntryType *>(calloc(sz, sizeof(EntryType)));
+        size_ = sz;
+        for (unsigned i = 0; i < oldsz; i++) {
+            if (old[i].iface) {
+                *find(old[i].name, old[i].hash) = old[i];
+            }
+        }
+        free(old);
+    }
+
+    HashIndexType(const HashIndexType &);
+    HashIndexType &operator=(const HashIndexType &);
+
+    EntryType *tbl_;
+    unsigned size_;
+    unsigned cnt_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_HASHINDEX_H__
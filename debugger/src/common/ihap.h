@@ -29,13 +29,22 @@ enum EHapType {
     HAP_All,
     HAP_ConfigDone,
     HAP_CpuContextChanged,  // command to switch CPU context was executed
-    HAP_Resume,             // received command to go
-    HAP_Halt,               // CPU halted
+    HAP_Resume,             // received command to go, param: harts mask
+    HAP_Halt,               // CPU halted, param: hart index
     HAP_BreakSimulation,    // close and exit simulation
     HAP_CpuTurnON,
-    HAP_CpuTurnOFF
+    HAP_CpuTurnOFF,
+    HAP_CpuHalted,          // CPU model entered halt state, param: cause
+    HAP_Breakpoint,         // breakpoint hit, param: breakpoint address
+    HAP_RegChanged,         // registers written by debugger, param: hart index
+    HAP_MemDirty            // memory written by debugger, param: page address
 };
 
+/** Page granularity of HAP_MemDirty notifications */
+static const uint64_t HAP_MEMDIRTY_PAGE = 4096;
+/** More pending dirty pages are coalesced into one HAP_MemDirty(~0ull) */
+static const unsigned HAP_MEMDIRTY_PAGES_MAX = 64;
+
 class IHap : public IFace {
  public:
     explicit IHap(EHapType type = HAP_All) : IFace(IFACE_HAP), type_(type) {}
@@ -18,6 +18,7 @@
 #define __DEBUGGER_COMMON_ISERVICE_H__
 
 #include <api_core.h>
+#include <hashindex.h>
 #include "coreservices/imemop.h"
 
 namespace debugger {
@@ -81,6 +82,7 @@ class IService : public IFace {
     virtual void registerInterface(IFace *iface) {
         AttributeType item(iface);
         listInterfaces_.add_to_list(&item);
+        hashInterfaces_.add(iface->getFaceName(), iface);
         if (strcmp(iface->getFaceName(), IFACE_MEMORY_OPERATION) == 0) {
             IMemoryOperation *imemop = static_cast<IMemoryOperation *>(iface);
             registerAttribute("MapList", &imemop->listMap_);
@@ -104,17 +106,16 @@ class IService : public IFace {
                 break;
             }
         }
+        // Rare operation: rebuild index to keep order of the list
+        hashInterfaces_.clear();
+        for (unsigned i = 0; i < listInterfaces_.size(); i++) {
+            IFace *tmp = listInterfaces_[i].to_iface();
+            hashInterfaces_.add(tmp->getFaceName(), tmp);
+        }
     }
 
     virtual IFace *getInterface(const char *name) {
-        IFace *tmp;
-        for (unsigned i = 0; i < listInterfaces_.size(); i++) {
-            tmp = listInterfaces_[i].to_iface();
-            if (strcmp(name, tmp->getFaceName()) == 0) {
-                return tmp;
-            }
-        }
-        return NULL;
+        return hashInterfaces_.get(name);
     }
 
     virtual IFace *getPortInterface(const char *portname,
@@ -139,19 +140,21 @@ class IService : public IFace {
         AttributeType item(iface);
         iface->allocAttrName(name);
         listAttributes_.add_to_list(&item);
+        hashAttributes_.add(iface->getAttrName(), iface);
     }
 
+    /**
+     * Attributes are members of the service and never move, so the returned
+     * pointer is a stable handle: resolve it once and keep it instead of
+     * repeating the lookup on hot paths.
+     */
     virtual IAttribute *getAttribute(const char *name) {
-        IAttribute *tmp;
-        for (unsigned i = 0; i < listAttributes_.size(); i++) {
-            tmp = static_cast<IAttribute *>(listAttributes_[i].to_iface());
-            if (strcmp(name, tmp->getAttrName()) == 0) {
-                return tmp;
-            }
-        }
-        return NULL;
+        return static_cast<IAttribute *>(hashAttributes_.get(name));
     }
 
+    /** Pre-resolved 'LogLevel' attribute used by RISCV_printf() */
+    int getLogLevel() { return static_cast<int>(logLevel_.to_int64()); }
+
     virtual const char *getObjName() { return obj_name_.to_string(); }
 
     virtual AttributeType getConfiguration() {
@@ -176,6 +179,8 @@ class IService : public IFace {
     AttributeType listInterfaces_;
     AttributeType listPorts_;       // [['portname',iface],*]
     AttributeType listAttributes_;
+    HashIndexType hashInterfaces_;
+    HashIndexType hashAttributes_;
     AttributeType logLevel_;
     AttributeType obj_name_;
     AttributeType obj_descr_;       // Describe service in JSON config
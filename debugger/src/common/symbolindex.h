@@ -0,0 +1,203 @@
+/*
+ *  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_COMMON_SYMBOLINDEX_H__
+#define __DEBUGGER_COMMON_SYMBOLINDEX_H__
+
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+#include "hashindex.h"
+
+namespace debugger {
+
+/**
+ * @brief Debug symbols index used by the source code services.
+ *
+ * Symbols are stored in flat arrays: entries sorted by address and a pool
+ * of names. Address lookup is a binary search that takes the symbol size
+ * into account, name lookup is an open addressing hash table with entry
+ * indexes. Symbols are appended with add() and become visible after
+ * build(), which the owner calls once after a batch of changes.
+ */
+class SymbolIndexType {
+ public:
+    SymbolIndexType() : list_(0), cnt_(0), cap_(0), names_(0), namesz_(0),
+        namecap_(0), hash_(0), hashsz_(0) {}
+    ~SymbolIndexType() {
+        free(list_);
+        free(names_);
+        free(hash_);
+    }
+
+    void clear() {
+        cnt_ = 0;
+        namesz_ = 0;
+        if (hash_) {
+            memset(hash_, 0, hashsz_ * sizeof(uint32_t));
+        }
+    }
+
+    void add(const char *name, uint64_t addr, uint64_t sz, uint32_t type) {
+        size_t len = strlen(name) + 1;
+        if (cnt_ == cap_) {
+            cap_ = cap_ ? 2 * cap_ : 256;
+            list_ = static_cast<EntryType *>(
+                    realloc(list_, cap_ * sizeof(EntryType)));
+        }
+        if (namesz_ + len > namecap_) {
+            while (namesz_ + len > namecap_) {
+                namecap_ = namecap_ ? 2 * namecap_ : 4096;
+            }
+            names_ = static_cast<char *>(realloc(names_, namecap_));
+        }
+        EntryType &e = list_[cnt_++];
+        e.addr = addr;
+        e.size = sz;
+        e.name = static_cast<uint32_t>(namesz_);
+        e.type = type;
+        memcpy(&names_[namesz_], name, len);
+        namesz_ += len;
+    }
+
+    /** Sort entries and rebuild the name hash */
+    void build() {
+        qsort(list_, cnt_, sizeof(EntryType), compareAddr);
+        unsigned sz = 16;
+        while (sz < 2 * cnt_) {
+            sz <<= 1;
+        }
+        if (sz != hashsz_) {
+            free(hash_);
+            hash_ = static_cast<uint32_t *>(calloc(sz, sizeof(uint32_t)));
+            hashsz_ = sz;
+        } else {
+            memset(hash_, 0, hashsz_ * sizeof(uint32_t));
+        }
+        for (unsigned i = 0; i < cnt_; i++) {
+            uint32_t *slot = findSlot(&names_[list_[i].name]);
+            if (*slot == 0) {
+                *slot = i + 1;      // the first symbol with this name is kept
+            }
+        }
+    }
+
+    /**
+     * Returns the symbol containing the address and the offset inside it.
+     * Symbols without size cover the range up to the next symbol.
+     */
+    const char *find(uint64_t addr, uint64_t *offset) const {
+        unsigned lo = 0;
+        unsigned hi = cnt_;
+        unsigned mid;
+        while (lo < hi) {
+            mid = (lo + hi) >> 1;
+            if (list_[mid].addr <= addr) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == 0) {
+            return 0;
+        }
+        const EntryType *e = &list_[lo - 1];
+        if (e->size == 0) {
+            uint64_t end = lo < cnt_ ? list_[lo].addr : e->addr + 1;
+            if (addr >= end) {
+                return 0;
+            }
+            *offset = addr - e->addr;
+            return &names_[e->name];
+        }
+        // Nested symbols: a few previous entries may contain the address
+        for (unsigned i = 0; i < LOOKBACK_MAX && i < lo; i++) {
+            e = &list_[lo - 1 - i];
+            if (addr < e->addr + e->size) {
+                *offset = addr - e->addr;
+                return &names_[e->name];
+            }
+        }
+        return 0;
+    }
+
+    /** Returns 0 if symbol was found, -1 otherwise */
+    int find(const char *name, uint64_t *addr) const {
+        if (!cnt_ || !hashsz_) {
+            return -1;
+        }
+        uint32_t idx = *findSlot(name);
+        if (idx == 0) {
+            return -1;
+        }
+        *addr = list_[idx - 1].addr;
+        return 0;
+    }
+
+    unsigned size() const { return cnt_; }
+
+ private:
+    static const unsigned LOOKBACK_MAX = 8;
+
+    struct EntryType {
+        uint64_t addr;
+        uint64_t size;
+        uint32_t name;              // offset in the names pool
+        uint32_t type;              // ESymbolType
+    };
+
+    /** Equal addresses ordered by size, the largest one is found first */
+    static int compareAddr(const void *a, const void *b) {
+        const EntryType *ea = static_cast<const EntryType *>(a);
+        const EntryType *eb = static_cast<const EntryType *>(b);
+        if (ea->addr != eb->addr) {
+            return ea->addr < eb->addr ? -1 : 1;
+        }
+        if (ea->size != eb->size) {
+            return ea->size < eb->size ? -1 : 1;
+        }
+        return 0;
+    }
+
+    /** Returns matched or empty slot. Table is never full. */
+    uint32_t *findSlot(const char *name) const {
+        unsigned mask = hashsz_ - 1;
+        for (unsigned i = HashIndexType::hash(name) & mask; ;
+            i = (i + 1) & mask) {
+            uint32_t *slot = &hash_[i];
+            if (*slot == 0
+                || strcmp(&names_[list_[*slot - 1].name], name) == 0) {
+                return slot;
+            }
+        }
+    }
+
+    SymbolIndexType(const SymbolIndexType &);
+    SymbolIndexType &operator=(const SymbolIndexType &);
+
+    EntryType *list_;
+    unsigned cnt_;
+    unsigned cap_;
+    char *names_;
+    size_t namesz_;
+    size_t namecap_;
+    uint32_t *hash_;                // entry index + 1, 0 is an empty slot
+    unsigned hashsz_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_COMMON_SYMBOLINDEX_H__
@@ -618,9 +618,28 @@ enum EIsaArmV7 {
     ARMV7_Total
 };
 
+/**
+ * Operands of the 16-bit Thumb encodings extracted once by decoder_thumb()
+ * and stored in ICache together with the instruction (payload[1]). The
+ * 32-bit encodings still decode their fields from payload[0].
+ */
+struct ThumbOperandsType {
+    uint8_t d;                  // Rd, Rt or Rdn
+    uint8_t n;                  // Rn or Rdn
+    uint8_t m;                  // Rm
+    uint8_t cond;               // B<c> condition
+    uint32_t imm32;             // scaled and sign-extended immediate
+};
+
+static inline ThumbOperandsType *thumbOperands(Reg64Type *payload) {
+    return reinterpret_cast<ThumbOperandsType *>(&payload[1]);
+}
+
 EIsaArmV7 decoder_arm(uint32_t ti, char *errmsg, size_t errsz);
-EIsaArmV7 decoder_thumb(uint32_t ti, uint32_t *tio,
+EIsaArmV7 decoder_thumb(uint32_t ti, ThumbOperandsType *ops,
                         char *errmsg, size_t errsz);
+/** Build the Thumb decode table, must be called before decoder_thumb() */
+void decoder_thumb_init();
 
 /** Internal simulation bits only */
 static const uint64_t Interrupt_SoftwareIdx = 0;
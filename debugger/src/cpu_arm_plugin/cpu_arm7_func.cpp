@@ -17,6 +17,7 @@
 #include <api_core.h>
 #include "cpu_arm7_func.h"
 #include "srcproc/thumb_disasm.h"
+#include "bitscan.h"
 
 namespace debugger {
 
@@ -25,9 +26,17 @@ CpuCortex_Functional::CpuCortex_Functional(const char *name) :
     registerInterface(static_cast<ICpuArm *>(this));
     registerAttribute("VectorTable", &vectorTable_);
     registerAttribute("DefaultMode", &defaultMode_);
+    registerAttribute("IrqController", &irqController_);
     p_psr_ = reinterpret_cast<ProgramStatusRegsiterType *>(
             &R[Reg_cpsr]);
     PC_ = &R[Reg_pc];   // redefine location of PC register in bank
+    lazyFlags_ = LazyFlags_None;
+    lazyX_ = 0;
+    lazyY_ = 0;
+    lazyCin_ = 0;
+    lazyRes_ = 0;
+    iirq_ = 0;
+    excDepth_ = 0;
 }
 
 CpuCortex_Functional::~CpuCortex_Functional() {
@@ -40,6 +49,7 @@ void CpuCortex_Functional::postinitService() {
     }
     addArm7tmdiIsa();
     addThumb2Isa();
+    decoder_thumb_init();
 
     CpuGeneric::postinitService();
 
@@ -55,6 +65,16 @@ void CpuCortex_Functional::postinitService() {
     if (defaultMode_.is_equal("Thumb")) {
         setInstrMode(THUMB_mode);
     }
+
+    if (irqController_.is_string() && irqController_.size()) {
+        iirq_ = static_cast<IIrqController *>(
+            RISCV_get_service_iface(irqController_.to_string(),
+                                    IFACE_IRQ_CONTROLLER));
+        if (!iirq_) {
+            RISCV_error("Can't find IIrqController interface %s",
+                        irqController_.to_string());
+        }
+    }
 }
 
 void CpuCortex_Functional::predeleteService() {
@@ -115,26 +135,56 @@ void CpuCortex_Functional::handleTrap() {
         return;
     }
 
-    int irq_idx;
-    for (int i = 0; i < 2; i++) {
-        if (interrupt_pending_[i] == 0) {
-            continue;
+    // System exceptions are ordered by priority, then by number. Interrupt
+    // controller keeps only the line of its most urgent request raised.
+    uint64_t sys = interrupt_pending_[0] & 0xFFFFull;
+    uint64_t ext = interrupt_pending_[0] & ~0xFFFFull;
+    int idx = -1;
+    int prio = EXC_PRIORITY_THREAD;
+    int ext_idx;
+    int ext_prio;
+    for (uint64_t t = sys; t; t &= t - 1) {
+        int sys_idx = bitscan64(t);
+        int sys_prio = systemPriority(sys_idx);
+        if (sys_prio < prio) {
+            idx = sys_idx;
+            prio = sys_prio;
         }
-
-        for (int n = 0; n < 64; n++) {
-            if ((interrupt_pending_[i] & (1ull << n)) == 0) {
-                continue;
-            }
-            irq_idx = 64*i + n;
-            if (irq_idx < 16) {
-                enterException(irq_idx);
-            } else {
-                RISCV_error("Interrupts from NVIC not supported %d", irq_idx);
+    }
+    if (ext || interrupt_pending_[1]) {
+        ext_idx = ext ? bitscan64(ext) : 64 + bitscan64(interrupt_pending_[1]);
+        if (!iirq_) {
+            RISCV_error("Interrupts from NVIC not supported %d", ext_idx);
+            interrupt_pending_[ext_idx >> 6] &= ~(1ull << (ext_idx & 0x3F));
+        } else {
+            ext_prio = iirq_->getPriority(ext_idx - 16);
+            if (ext_prio < prio) {
+                idx = ext_idx;
+                prio = ext_prio;
             }
         }
-        interrupt_pending_[i] = 0;
     }
-    interrupt_pending_[0] = 0;
+    if (idx == -1) {
+        return;
+    }
+
+    // Preemption
+    if (excDepth_ && prio >= excStack_[excDepth_ - 1].priority) {
+        return;
+    }
+    if (excDepth_ == EXC_NESTING_MAX) {
+        return;
+    }
+    excStack_[excDepth_].idx = idx;
+    excStack_[excDepth_].priority = prio;
+    excDepth_++;
+
+    interrupt_pending_[idx >> 6] &= ~(1ull << (idx & 0x3F));
+    if (idx >= 16) {
+        iirq_->activateInterrupt(idx - 16);
+    }
+    enterException(idx);
+    updateTrapStatistic(idx);
 }
 
 void CpuCortex_Functional::enterException(int idx) {
@@ -174,6 +224,7 @@ void CpuCortex_Functional::enterException(int idx) {
     dma_memop(&trans_);
 
     trans_.addr -= 4;
+    flushFlags();
     trans_.wpayload.b32[0] = static_cast<uint32_t>(R[Reg_cpsr]);
     dma_memop(&trans_);
 
@@ -198,12 +249,20 @@ void CpuCortex_Functional::enterException(int idx) {
 }
 
 void CpuCortex_Functional::exitException(uint32_t exc_return) {
+    if (excDepth_) {
+        excDepth_--;
+        if (excStack_[excDepth_].idx >= 16) {
+            iirq_->deactivateInterrupt(excStack_[excDepth_].idx - 16);
+        }
+    }
+
     trans_.action = MemAction_Read;
     trans_.addr = R[Reg_sp];
     trans_.xsize = 4; 
     trans_.wstrb = 0;
 
     dma_memop(&trans_);
+    lazyFlags_ = LazyFlags_None;
     R[Reg_cpsr] = trans_.rpayload.b32[0];
     trans_.addr += 4;
 
@@ -253,6 +312,8 @@ uint64_t CpuCortex_Functional::getResetAddress() {
 void CpuCortex_Functional::reset(IFace *isource) {
     Axi4TransactionType tr;
     CpuGeneric::reset(isource);
+    lazyFlags_ = LazyFlags_None;
+    excDepth_ = 0;
     ITBlockEnabled = false;
     ITBlockBaseCond_ = 0;
     ITBlockMask_ = 0;
@@ -316,15 +377,37 @@ void CpuCortex_Functional::trackContextEnd() {
     ITBlockEnabled = false;     // Just to skip IT instruction
 }
 
+void CpuCortex_Functional::updateDebugPort() {
+    // Registers bank is accessed directly
+    flushFlags();
+    CpuGeneric::updateDebugPort();
+}
+
+void CpuCortex_Functional::materializeFlags() {
+    uint32_t res = lazyRes_;
+    p_psr_->u.N = res >> 31;
+    p_psr_->u.Z = res == 0 ? 1 : 0;
+    if (lazyFlags_ == LazyFlags_NZCV) {
+        p_psr_->u.C = carryFlag();
+        p_psr_->u.V = ((lazyX_ ^ res) & (lazyY_ ^ res)) >> 31;
+    }
+    lazyFlags_ = LazyFlags_None;
+}
+
+void CpuCortex_Functional::fetchILine() {
+    CpuGeneric::fetchILine();
+    // Decoding is skipped on ICache hit, PC register updated here
+    portRegs_.getp()[Reg_pc].val = getPC();
+}
+
 GenericInstruction *CpuCortex_Functional::decodeInstruction(Reg64Type *cache) {
     GenericInstruction *instr = NULL;
     uint32_t ti = cacheline_[0].buf32[0];
 
     EIsaArmV7 etype;
     if (getInstrMode() == THUMB_mode) {
-        uint32_t tio;
-        etype = decoder_thumb(ti, &tio, errmsg_, sizeof(errmsg_));
-        //cacheline_[0].buf32[0] = tio;
+        etype = decoder_thumb(ti, thumbOperands(cache),
+                              errmsg_, sizeof(errmsg_));
     } else {
         etype = decoder_arm(ti, errmsg_, sizeof(errmsg_));
     }
@@ -335,7 +418,6 @@ GenericInstruction *CpuCortex_Functional::decodeInstruction(Reg64Type *cache) {
         RISCV_error("ARM decoder error [%08" RV_PRI64 "x] %08x",
                     getPC(), ti);
     }
-    portRegs_.getp()[Reg_pc].val = getPC();
     return instr;
 }
 
@@ -390,14 +472,18 @@ void CpuCortex_Functional::traceOutput() {
 void CpuCortex_Functional::raiseSignal(int idx) {
     if (idx >= 128) {
         RISCV_error("Raise unsupported signal %d", idx);
+        return;
     }
     RISCV_debug("Request Interrupt %d", idx);
     interrupt_pending_[idx >> 6] |= (1ull << (idx & 0x3F));
 }
 
 void CpuCortex_Functional::lowerSignal(int idx) {
+    if (idx >= 128) {
+        RISCV_error("Lower unsupported signal %d", idx);
+        return;
+    }
     interrupt_pending_[idx >> 6] &= ~(1ull << (idx & 0x3F));
-    RISCV_error("Lower unsupported signal %d", idx);
 }
 
 void CpuCortex_Functional::raiseSoftwareIrq() {
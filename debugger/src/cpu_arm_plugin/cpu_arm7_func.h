@@ -21,6 +21,7 @@
 #include "instructions.h"
 #include "generic/cpu_generic.h"
 #include "coreservices/icpuarm.h"
+#include "coreservices/iirqctrl.h"
 #include "cmds/cmd_br_arm7.h"
 #include "cmds/cmd_reg_arm7.h"
 #include "cmds/cmd_regs_arm7.h"
@@ -59,14 +60,44 @@ class CpuCortex_Functional : public CpuGeneric,
         const EInstructionModes MODE[2] = {ARM_mode, THUMB_mode};
         return MODE[p_psr_->u.T];
     }
-    virtual uint32_t getZ() { return p_psr_->u.Z; }
-    virtual void setZ(uint32_t z) { p_psr_->u.Z = z; }
-    virtual uint32_t getC() { return p_psr_->u.C; }
-    virtual void setC(uint32_t c) { p_psr_->u.C = c; }
-    virtual uint32_t getN() { return p_psr_->u.N; }
-    virtual void setN(uint32_t n) { p_psr_->u.N = n; }
-    virtual uint32_t getV() { return p_psr_->u.V; }
-    virtual void setV(uint32_t v) { p_psr_->u.V = v; }
+    virtual uint32_t getZ() {
+        flushFlags();
+        return p_psr_->u.Z;
+    }
+    virtual void setZ(uint32_t z) {
+        flushFlags();
+        p_psr_->u.Z = z;
+    }
+    virtual uint32_t getC() {
+        flushFlags();
+        return p_psr_->u.C;
+    }
+    virtual void setC(uint32_t c) {
+        if (lazyFlags_ == LazyFlags_NZCV) {
+            p_psr_->u.V = ((lazyX_ ^ lazyRes_) & (lazyY_ ^ lazyRes_)) >> 31;
+            lazyFlags_ = LazyFlags_NZ;
+        }
+        p_psr_->u.C = c;
+    }
+    virtual uint32_t getN() {
+        flushFlags();
+        return p_psr_->u.N;
+    }
+    virtual void setN(uint32_t n) {
+        flushFlags();
+        p_psr_->u.N = n;
+    }
+    virtual uint32_t getV() {
+        flushFlags();
+        return p_psr_->u.V;
+    }
+    virtual void setV(uint32_t v) {
+        if (lazyFlags_ == LazyFlags_NZCV) {
+            p_psr_->u.C = carryFlag();
+            lazyFlags_ = LazyFlags_NZ;
+        }
+        p_psr_->u.V = v;
+    }
     virtual uint32_t getA() { return p_psr_->u.A; }
     virtual void setA(uint32_t v) { p_psr_->u.A = v; }
     virtual uint32_t getI() { return p_psr_->u.I; }
@@ -85,14 +116,44 @@ class CpuCortex_Functional : public CpuGeneric,
     virtual void enterException(int idx);
     virtual void exitException(uint32_t exc_return);
 
+    /**
+     * Lazy condition flags. Flag-setting instructions record operands of
+     * the last operation and N, Z, C, V are written into CPSR only when
+     * they are read (conditions, IT block, exception entry, debug port).
+     */
+    void setFlagsNZCV(uint32_t x, uint32_t y, uint32_t carry_in,
+                      uint32_t result) {
+        lazyX_ = x;
+        lazyY_ = y;
+        lazyCin_ = carry_in;
+        lazyRes_ = result;
+        lazyFlags_ = LazyFlags_NZCV;
+    }
+    /** N and Z from the result, C and V aren't changed */
+    void setFlagsNZ(uint32_t result) {
+        if (lazyFlags_ == LazyFlags_NZCV) {
+            p_psr_->u.C = carryFlag();
+            p_psr_->u.V = ((lazyX_ ^ lazyRes_) & (lazyY_ ^ lazyRes_)) >> 31;
+        }
+        lazyRes_ = result;
+        lazyFlags_ = LazyFlags_NZ;
+    }
+    void flushFlags() {
+        if (lazyFlags_ != LazyFlags_None) {
+            materializeFlags();
+        }
+    }
+
  protected:
     /** CpuGeneric common methods */
     virtual uint64_t getResetAddress();
     virtual EEndianessType endianess() { return LittleEndian; }
+    virtual void fetchILine() override;
     virtual GenericInstruction *decodeInstruction(Reg64Type *cache);
     virtual void generateIllegalOpcode();
     virtual void handleTrap();
     virtual void trackContextEnd() override;
+    virtual void updateDebugPort() override;
     virtual void traceOutput() override;
     
     void addArm7tmdiIsa();
@@ -100,10 +161,36 @@ class CpuCortex_Functional : public CpuGeneric,
     unsigned addSupportedInstruction(ArmInstruction *instr);
     uint32_t hash32(uint32_t val) { return (val >> 24) & 0xf; }
 
+ private:
+    void materializeFlags();
+    /** Reset, NMI and HardFault are fixed, others are set in SCB SHPRx */
+    int systemPriority(int idx) {
+        if (idx < 4 || !iirq_) {
+            return idx < 4 ? idx - 4 : 0;
+        }
+        return iirq_->getPriority(idx - 16);
+    }
+    uint32_t carryFlag() {
+        return static_cast<uint32_t>((static_cast<uint64_t>(lazyX_)
+                + static_cast<uint64_t>(lazyY_) + lazyCin_) >> 32);
+    }
+
  private:
     AttributeType defaultMode_;
     AttributeType vendorID_;
     AttributeType vectorTable_;
+    AttributeType irqController_;
+
+    IIrqController *iirq_;
+
+    /** Priorities of taken exceptions, preemption only by more urgent one */
+    static const int EXC_PRIORITY_THREAD = 256;
+    static const int EXC_NESTING_MAX = 32;
+    struct ActiveExceptionType {
+        int idx;
+        int priority;
+    } excStack_[EXC_NESTING_MAX];
+    int excDepth_;
 
     static const int INSTR_HASH_TABLE_SIZE = 1 << 4;
     AttributeType listInstr_[INSTR_HASH_TABLE_SIZE];
@@ -111,6 +198,16 @@ class CpuCortex_Functional : public CpuGeneric,
 
     ProgramStatusRegsiterType *p_psr_;
 
+    enum ELazyFlags {
+        LazyFlags_None,
+        LazyFlags_NZ,           // N, Z from lazyRes_
+        LazyFlags_NZCV          // all flags of lazyX_ + lazyY_ + lazyCin_
+    } lazyFlags_;
+    uint32_t lazyX_;
+    uint32_t lazyY_;
+    uint32_t lazyCin_;
+    uint32_t lazyRes_;
+
     char errmsg_[256];
 
     CmdBrArm *pcmd_br_;
@@ -20,323 +20,390 @@
 
 namespace debugger {
 
-static EIsaArmV7 decoder_w(uint32_t ti, uint32_t *tio,
-                         char *errmsg, size_t errsz) {
-    EIsaArmV7 ret = ARMV7_Total;
-    if ((ti & 0xFFF0FFF0) == 0xF000E8D0) {
-        ret = T1_TBB;
-    } else if ((ti & 0xF0F0FFF0) == 0xF0F0FB90) {
-        ret = T1_SDIV;
-    } else if ((ti & 0xF0F0FFF0) == 0xF0F0FBB0) {
-        ret = T1_UDIV;
-    } else if ((ti & 0xF0F0FFF0) == 0xF000FB00) {
-        ret = T2_MUL;
-    } else if ((ti & 0x8020FFF0) == 0x0000F340) {
-        ret = T1_SBFX;
-    } else if ((ti & 0x8020FFF0) == 0x0000F3C0) {
-        ret = T1_UBFX;
-    } else if ((ti & 0x8F00FBF0) == 0x0F00F110) {
-        // T3_ADD_I => T1_CMN_I
-    } else if ((ti & 0x8F00FFF0) == 0x0F00EB10) {
-        // T3_ADD_R => T2_CMN_R
-    } else if ((ti & 0xF0F0FFEF) == 0x0000EA4F) {
-        // T3_MOV_R
-    } else if ((ti & 0x8000FFEF) == 0x0000EB0D) {
-        // T3_ADD_R => T3_ADDSP_R
-    } else if ((ti & 0x8000FBEF) == 0x0000F10D) {
-        // T3_ADD_I => T3_ADDSP_I
-    } else if ((ti & 0x8000FBEF) == 0x0000F1AD) {
-        // T2_SUBSP_I
-    } else if ((ti & 0x0000FF7F) == 0x0000F85F) { // highest
-        ret = T2_LDR_L;
-    } else if ((ti & 0x0F00FFF0) == 0x0E00F850) { // < T2_LDR_L
-        // T1_LDRT
-    } else if ((ti & 0x0D00FFF0) == 0x0800F850) { // < T2_LDR_L
-        // T4_LDR_I: undefined
-    } else if ((ti & 0xF000FF7F) == 0xF000F81F) { // highest
-        // T3_PLD_I
-    } else if ((ti & 0xFF00FFF0) == 0xFC00F810) { // < T3_PLD_I
-        // T2_PLD_I
-    } else if ((ti & 0xF000FFF0) == 0xF000F890) { // < T3_PLD_I
-        // T1_PLD_I
-    } else if ((ti & 0xFFC0FFF0) == 0xF000F810) { // < T3_PLD_I
-        // T1_PLD_R
-    } else if ((ti & 0xF000FF7F) == 0xF000F91F) { // highest
-        // T3_PLI_I
-    } else if ((ti & 0xFF00FFF0) == 0xFC00F910) { // < T3_PLI_I
-        // T2_PLI_I
-    } else if ((ti & 0xF000FFF0) == 0xF000F990) { // < T3_PLI_I
-        // T1_PLI_I
-    } else if ((ti & 0xFFC0FFF0) == 0xF000F910) { // < T3_PLI_I
-        // T1_PLI_R
-    } else if ((ti & 0x0FC0FF7F) == 0x0000F81F) { // < T3_PLD_I
-        // T1_LDRB_L
-    } else if ((ti & 0x0000FF7F) == 0x0000F91F) { // < T3_PLI_I
-        // T1_LDRSB_L
-    } else if ((ti & 0x2000FFFF) == 0x0000E8BD) { // highest
-        ret = T2_POP;
-    } else if ((ti & 0x0FC0FFF0) == 0x0000F800) { // highest
-        ret = T2_STRB_R;
-    } else if ((ti & 0x0FC0FFF0) == 0x0000F810) { // < T1_PLD_R, T1_LDRB_L
-        ret = T2_LDRB_R;
-    } else if ((ti & 0x0000FF7F) == 0x0000F83F) { // < Memory hints
-        // T1_LDRH_L;
-    } else if ((ti & 0x0FC0FFF0) == 0x0000F830) { // < T1_LDRH_L, Memory hints
-        ret = T2_LDRH_R;
-    } else if ((ti & 0x0FC0FFF0) == 0x0000F840) { // Highest
-        ret = T2_STR_R;
-    } else if ((ti & 0x0FC0FFF0) == 0x0000F910) { // < T1_PLI_R, T1_LDRSB_L
-        ret = T2_LDRSB_R;
-    } else if ((ti & 0x0F00FFF0) == 0x0E00F800) { // Highest
-        // T1_STRBT
-    } else if ((ti & 0xF0C0FFFF) == 0xF080FA1F) { // Highest
-        // T2_UXTH;
-    } else if ((ti & 0xF0C0FFFF) == 0xF080FA4F) { // Highest
-        // T2_SXTB;
-    } else if ((ti & 0xF0C0FFFF) == 0xF080FA5F) { // Highest
-        // T2_UXTB;
-    } else if ((ti & 0x8F00FFF0) == 0x0F00EA10) { // Highest
-        // T2_TST_R
-    } else if ((ti & 0x8F00FFF0) == 0x0F00EBB0) { // Highest
-        // T3_CMP_R
-    } else if ((ti & 0xF0C0FFF0) == 0xF080FA10) { // < T2_UXTH
-        ret = T1_UXTAH;
-    } else if ((ti & 0xF0C0FFF0) == 0xF080FA40) { // < T2_SXTB
-        ret = T1_SXTAB;
-    } else if ((ti & 0xF0C0FFF0) == 0xF080FA50) { // < T2_UXTB
-        ret = T1_UXTAB;
-    } else if ((ti & 0x00F0FFF0) == 0x0010FB00) { // Highest
-        ret = T1_MLS;
-    } else if ((ti & 0x0F00FFF0) == 0x0E00F810) { // < T1_LDRB_L
-        // T1_LDRBT
-    } else if ((ti & 0x0F00FFF0) == 0x0E00F820) { // Highest
-        // T1_STRHT;
-    } else if ((ti & 0x0800FFF0) == 0x0800F800) { // < T1_STRBT
-        ret = T3_STRB_I;
-    } else if ((ti & 0x0800FFF0) == 0x0800F810) { // < T1_LDRB_L, T3_PLD_I, T1_LDRBT
-        ret = T3_LDRB_I;
-    } else if ((ti & 0x0800FFF0) == 0x0800F820) { // < T1_STRHT
-        ret = T3_STRH_I;
-    } else if ((ti & 0x0800FFF0) == 0x0800F850) { // < T2_LDR_L, T1_LDRT
-        ret = T4_LDR_I;
-    } else if ((ti & 0x0FC0FFF0) == 0x0000F850) { // < T2_LDR_L
-        ret = T2_LDR_R;
-    } else if ((ti & 0x00F0FFF0) == 0x0000FB00) {
-        ret = T1_MLA;
-    } else if ((ti & 0x00F0FFF0) == 0x0000FB80) {
-        ret = T1_SMULL;
-    } else if ((ti & 0x00F0FFF0) == 0x0000FBA0) {
-        ret = T1_UMULL;
-    } else if ((ti & 0xF0F0FFE0) == 0xF000FA00) {
-        ret = T2_LSL_R;
-    } else if ((ti & 0xF0F0FFE0) == 0xF000FA20) {
-        ret = T2_LSR_R;
-    } else if ((ti & 0x8F00FBF0) == 0x0F00F010) {
-        ret = T1_TST_I;
-    } else if ((ti & 0x8F00FBF0) == 0x0F00F1B0) {
-        ret = T2_CMP_I;
-    } else if ((ti & 0x2000FFD0) == 0x0000E890) {
-        ret = T2_LDMIA;
-    } else if ((ti & 0xA000FFD0) == 0x0000E900) {
-        ret = T1_STMDB;
-    } else if ((ti & 0x0000FFF0) == 0x0000F880) { // Highest
-        ret = T2_STRB_I;
-    } else if ((ti & 0x0000FFF0) == 0x0000F890) { // < T3_PLD_I, T1_LDRB_L
-        ret = T2_LDRB_I;
-    } else if ((ti & 0x0000FFF0) == 0x0000F8A0) { // Highest
-        ret = T2_STRH_I;
-    } else if ((ti & 0x0000FFF0) == 0x0000F8D0) { // < T2_LDR_L
-        ret = T3_LDR_I;
-    } else if ((ti & 0x0000FFF0) == 0x0000F990) { // < T3_PLI_I, T1_LDRSB_L
-        ret = T1_LDRSB_I;
-    } else if ((ti & 0x8000FFE0) == 0x0000EA00) {
-        ret = T2_AND_R;
-    } else if ((ti & 0x8000FFE0) == 0x0000EA40) {
-        ret = T2_ORR_R;
-    } else if ((ti & 0x8000FFE0) == 0x0000EB00) {
-        ret = T3_ADD_R;
-    } else if ((ti & 0x8000FFEF) == 0x0000EBAD) {
-        // T1_SUBSP_R;
-    } else if ((ti & 0x8000FFE0) == 0x0000EBA0) {
-        ret = T2_SUB_R;
-    } else if ((ti & 0x8000FFE0) == 0x0000EBC0) {
-        ret = T1_RSB_R;
-    } else if ((ti & 0x8000FBF0) == 0x0000F240) {
-        ret = T3_MOV_I;
-    } else if ((ti & 0x8000FBE0) == 0x0000F000) {
-        ret = T1_AND_I;
-    } else if ((ti & 0x8F00FBE0) == 0x0F00F080) {
-        // T1_TEQ_I;
-    } else if ((ti & 0x8000FBE0) == 0x0000F080) {
-        ret = T1_EOR_I;
-    } else if ((ti & 0x8000FBE0) == 0x0000F100) {
-        ret = T3_ADD_I;
-    } else if ((ti & 0x8000FBE0) == 0x0000F140) {
-        ret = T1_ADC_I;
-    } else if ((ti & 0x8000FBE0) == 0x0000F1A0) {
-        ret = T3_SUB_I;
-    } else if ((ti & 0x8000FBE0) == 0x0000F1C0) {
-        ret = T2_RSB_I;
-    } else if ((ti & 0x8000FBEF) == 0x0000F04F) {
-        ret = T2_MOV_I;
-    } else if ((ti & 0x8000FBE0) == 0x0000F040) {
-        ret = T1_ORR_I;
-    } else if ((ti & 0x8000FBE0) == 0x0000F020) {
-        ret = T1_BIC_I;
-    } else if ((ti & 0x0000FF70) == 0x0000E840) {
-        // see Load/Store double and exclusive, and table branch on page 3-28
-    } else if ((ti & 0x0000FE50) == 0x0000E840) {
-        ret = T1_STRD_I;
-    } else if ((ti & 0xD000F800) == 0x8000F000) {
-        ret = T3_B;
-    } else if ((ti & 0xD000F800) == 0x9000F000) {
-        ret = T4_B;
+/**
+ * Operand fields of the 16-bit encodings: register fields with their bit
+ * width and the immediate scaling (H = halfword, W = word). Rdn fields are
+ * stored into both d and n.
+ */
+enum EThumbOperandsFormat {
+    TOPS_None,          // fields are decoded by the instruction itself
+    TOPS_D3N3M3,        // Rd[2:0], Rn[5:3], Rm[8:6]
+    TOPS_D3N3I3,        // Rd[2:0], Rn[5:3], imm3[8:6]
+    TOPS_D3N3I5,        // Rt[2:0], Rn[5:3], imm5[10:6]
+    TOPS_D3N3I5H,       // Rt[2:0], Rn[5:3], imm5[10:6]:'0'
+    TOPS_D3N3I5W,       // Rt[2:0], Rn[5:3], imm5[10:6]:'00'
+    TOPS_D3M3I5,        // Rd[2:0], Rm[5:3], imm5[10:6]
+    TOPS_D3N3,          // Rdm[2:0], Rn[5:3]
+    TOPS_DN3M3,         // Rdn[2:0], Rm[5:3]
+    TOPS_DN4M4,         // Rdn[7,2:0], Rm[6:3]
+    TOPS_DN3I8,         // Rdn[10:8], imm8[7:0]
+    TOPS_D3I8W,         // Rd[10:8], imm8[7:0]:'00'
+    TOPS_I7W,           // imm7[6:0]:'00'
+    TOPS_N3I6H,         // Rn[2:0], i[9]:imm5[7:3]:'0'
+    TOPS_C4I8H,         // cond[11:8], SignExtend(imm8[7:0]:'0')
+    TOPS_I11H,          // SignExtend(imm11[10:0]:'0')
+};
+
+/**
+ * Thumb decoding rules. Rules of each table are checked in order and the
+ * first matched one wins. Rules with ARMV7_Total ret are recognized but
+ * not implemented encodings: they mask the following rules of the table.
+ */
+struct ThumbDecodeRule {
+    uint32_t mask;
+    uint32_t value;
+    EIsaArmV7 ret;
+    const char *errfmt;
+    EThumbOperandsFormat fmt;   // TOPS_None when omitted
+};
+
+/** 16-bit rules checked before the 32-bit encodings */
+static const ThumbDecodeRule THUMB_RULES_PRE[] = {
+    {0xFFFF, 0xBF00, T1_NOP, 0},
+    {0xFF87, 0x4700, T1_BX, 0, TOPS_DN4M4},
+};
+
+/** 32-bit encodings: both halfwords are checked */
+static const ThumbDecodeRule THUMB_RULES_W[] = {
+    {0xFFF0FFF0, 0xF000E8D0, T1_TBB, 0},
+    {0xF0F0FFF0, 0xF0F0FB90, T1_SDIV, 0},
+    {0xF0F0FFF0, 0xF0F0FBB0, T1_UDIV, 0},
+    {0xF0F0FFF0, 0xF000FB00, T2_MUL, 0},
+    {0x8020FFF0, 0x0000F340, T1_SBFX, 0},
+    {0x8020FFF0, 0x0000F3C0, T1_UBFX, 0},
+    {0x8F00FBF0, 0x0F00F110, ARMV7_Total, 0},  // T3_ADD_I => T1_CMN_I
+    {0x8F00FFF0, 0x0F00EB10, ARMV7_Total, 0},  // T3_ADD_R => T2_CMN_R
+    {0xF0F0FFEF, 0x0000EA4F, ARMV7_Total, 0},  // T3_MOV_R
+    {0x8000FFEF, 0x0000EB0D, ARMV7_Total, 0},  // T3_ADD_R => T3_ADDSP_R
+    {0x8000FBEF, 0x0000F10D, ARMV7_Total, 0},  // T3_ADD_I => T3_ADDSP_I
+    {0x8000FBEF, 0x0000F1AD, ARMV7_Total, 0},  // T2_SUBSP_I
+    {0x0000FF7F, 0x0000F85F, T2_LDR_L, 0},  // highest
+    {0x0F00FFF0, 0x0E00F850, ARMV7_Total, 0},  // T1_LDRT (< T2_LDR_L)
+    // T4_LDR_I: undefined (< T2_LDR_L)
+    {0x0D00FFF0, 0x0800F850, ARMV7_Total, 0},
+    {0xF000FF7F, 0xF000F81F, ARMV7_Total, 0},  // T3_PLD_I (highest)
+    {0xFF00FFF0, 0xFC00F810, ARMV7_Total, 0},  // T2_PLD_I (< T3_PLD_I)
+    {0xF000FFF0, 0xF000F890, ARMV7_Total, 0},  // T1_PLD_I (< T3_PLD_I)
+    {0xFFC0FFF0, 0xF000F810, ARMV7_Total, 0},  // T1_PLD_R (< T3_PLD_I)
+    {0xF000FF7F, 0xF000F91F, ARMV7_Total, 0},  // T3_PLI_I (highest)
+    {0xFF00FFF0, 0xFC00F910, ARMV7_Total, 0},  // T2_PLI_I (< T3_PLI_I)
+    {0xF000FFF0, 0xF000F990, ARMV7_Total, 0},  // T1_PLI_I (< T3_PLI_I)
+    {0xFFC0FFF0, 0xF000F910, ARMV7_Total, 0},  // T1_PLI_R (< T3_PLI_I)
+    {0x0FC0FF7F, 0x0000F81F, ARMV7_Total, 0},  // T1_LDRB_L (< T3_PLD_I)
+    {0x0000FF7F, 0x0000F91F, ARMV7_Total, 0},  // T1_LDRSB_L (< T3_PLI_I)
+    {0x2000FFFF, 0x0000E8BD, T2_POP, 0},  // highest
+    {0x0FC0FFF0, 0x0000F800, T2_STRB_R, 0},  // highest
+    {0x0FC0FFF0, 0x0000F810, T2_LDRB_R, 0},  // < T1_PLD_R, T1_LDRB_L
+    {0x0000FF7F, 0x0000F83F, ARMV7_Total, 0},  // T1_LDRH_L (< Memory hints)
+    {0x0FC0FFF0, 0x0000F830, T2_LDRH_R, 0},  // < T1_LDRH_L, Memory hints
+    {0x0FC0FFF0, 0x0000F840, T2_STR_R, 0},  // highest
+    {0x0FC0FFF0, 0x0000F910, T2_LDRSB_R, 0},  // < T1_PLI_R, T1_LDRSB_L
+    {0x0F00FFF0, 0x0E00F800, ARMV7_Total, 0},  // T1_STRBT (highest)
+    {0xF0C0FFFF, 0xF080FA1F, ARMV7_Total, 0},  // T2_UXTH (highest)
+    {0xF0C0FFFF, 0xF080FA4F, ARMV7_Total, 0},  // T2_SXTB (highest)
+    {0xF0C0FFFF, 0xF080FA5F, ARMV7_Total, 0},  // T2_UXTB (highest)
+    {0x8F00FFF0, 0x0F00EA10, ARMV7_Total, 0},  // T2_TST_R (highest)
+    {0x8F00FFF0, 0x0F00EBB0, ARMV7_Total, 0},  // T3_CMP_R (highest)
+    {0xF0C0FFF0, 0xF080FA10, T1_UXTAH, 0},  // < T2_UXTH
+    {0xF0C0FFF0, 0xF080FA40, T1_SXTAB, 0},  // < T2_SXTB
+    {0xF0C0FFF0, 0xF080FA50, T1_UXTAB, 0},  // < T2_UXTB
+    {0x00F0FFF0, 0x0010FB00, T1_MLS, 0},  // highest
+    {0x0F00FFF0, 0x0E00F810, ARMV7_Total, 0},  // T1_LDRBT (< T1_LDRB_L)
+    {0x0F00FFF0, 0x0E00F820, ARMV7_Total, 0},  // T1_STRHT (highest)
+    {0x0800FFF0, 0x0800F800, T3_STRB_I, 0},  // < T1_STRBT
+    {0x0800FFF0, 0x0800F810, T3_LDRB_I, 0},  // < T1_LDRB_L, T3_PLD_I, T1_LDRBT
+    {0x0800FFF0, 0x0800F820, T3_STRH_I, 0},  // < T1_STRHT
+    {0x0800FFF0, 0x0800F850, T4_LDR_I, 0},  // < T2_LDR_L, T1_LDRT
+    {0x0FC0FFF0, 0x0000F850, T2_LDR_R, 0},  // < T2_LDR_L
+    {0x00F0FFF0, 0x0000FB00, T1_MLA, 0},
+    {0x00F0FFF0, 0x0000FB80, T1_SMULL, 0},
+    {0x00F0FFF0, 0x0000FBA0, T1_UMULL, 0},
+    {0xF0F0FFE0, 0xF000FA00, T2_LSL_R, 0},
+    {0xF0F0FFE0, 0xF000FA20, T2_LSR_R, 0},
+    {0x8F00FBF0, 0x0F00F010, T1_TST_I, 0},
+    {0x8F00FBF0, 0x0F00F1B0, T2_CMP_I, 0},
+    {0x2000FFD0, 0x0000E890, T2_LDMIA, 0},
+    {0xA000FFD0, 0x0000E900, T1_STMDB, 0},
+    {0x0000FFF0, 0x0000F880, T2_STRB_I, 0},  // highest
+    {0x0000FFF0, 0x0000F890, T2_LDRB_I, 0},  // < T3_PLD_I, T1_LDRB_L
+    {0x0000FFF0, 0x0000F8A0, T2_STRH_I, 0},  // highest
+    {0x0000FFF0, 0x0000F8D0, T3_LDR_I, 0},  // < T2_LDR_L
+    {0x0000FFF0, 0x0000F990, T1_LDRSB_I, 0},  // < T3_PLI_I, T1_LDRSB_L
+    {0x8000FFE0, 0x0000EA00, T2_AND_R, 0},
+    {0x8000FFE0, 0x0000EA40, T2_ORR_R, 0},
+    {0x8000FFE0, 0x0000EB00, T3_ADD_R, 0},
+    {0x8000FFEF, 0x0000EBAD, ARMV7_Total, 0},  // T1_SUBSP_R
+    {0x8000FFE0, 0x0000EBA0, T2_SUB_R, 0},
+    {0x8000FFE0, 0x0000EBC0, T1_RSB_R, 0},
+    {0x8000FBF0, 0x0000F240, T3_MOV_I, 0},
+    {0x8000FBE0, 0x0000F000, T1_AND_I, 0},
+    {0x8F00FBE0, 0x0F00F080, ARMV7_Total, 0},  // T1_TEQ_I
+    {0x8000FBE0, 0x0000F080, T1_EOR_I, 0},
+    {0x8000FBE0, 0x0000F100, T3_ADD_I, 0},
+    {0x8000FBE0, 0x0000F140, T1_ADC_I, 0},
+    {0x8000FBE0, 0x0000F1A0, T3_SUB_I, 0},
+    {0x8000FBE0, 0x0000F1C0, T2_RSB_I, 0},
+    {0x8000FBEF, 0x0000F04F, T2_MOV_I, 0},
+    {0x8000FBE0, 0x0000F040, T1_ORR_I, 0},
+    {0x8000FBE0, 0x0000F020, T1_BIC_I, 0},
+    // see Load/Store double and exclusive, and table branch on page 3-28
+    {0x0000FF70, 0x0000E840, ARMV7_Total, 0},
+    {0x0000FE50, 0x0000E840, T1_STRD_I, 0},
+    {0xD000F800, 0x8000F000, T3_B, 0},
+    {0xD000F800, 0x9000F000, T4_B, 0},
+};
+
+/** 16-bit encodings */
+static const ThumbDecodeRule THUMB_RULES_N[] = {
+    {0xFFE8, 0xB660, T1_CPS, 0},
+    {0xFF78, 0x4468, ARMV7_Total, 0},  // T1_ADDSP_R
+    {0xFF87, 0x4485, ARMV7_Total, 0},  // T2_ADDSP_R
+    {0xFF87, 0x4780, T1_BLX_R, 0, TOPS_DN4M4},
+    {0xFFC0, 0x0000, T2_MOV_R, 0, TOPS_DN3M3},
+    {0xFFC0, 0x4000, T1_AND_R, 0, TOPS_DN3M3},
+    {0xFFC0, 0x4040, T1_EOR_R, 0, TOPS_DN3M3},
+    {0xFFC0, 0x4080, T1_LSL_R, 0, TOPS_DN3M3},
+    {0xFFC0, 0x40C0, T1_LSR_R, 0, TOPS_DN3M3},
+    {0xFFC0, 0x4200, T1_TST_R, 0, TOPS_DN3M3},
+    {0xFFC0, 0x4240, T1_RSB_I, 0, TOPS_D3N3},
+    {0xFFC0, 0x4280, T1_CMP_R, 0, TOPS_DN3M3},
+    {0xFFC0, 0x4300, T1_ORR_R, 0, TOPS_DN3M3},
+    {0xFFC0, 0x4340, T1_MUL, 0, TOPS_D3N3},
+    {0xFFC0, 0x43C0, T1_MVN_R, 0, TOPS_DN3M3},
+    {0xFFC0, 0xB240, T1_SXTB, 0, TOPS_DN3M3},
+    {0xFFC0, 0xB280, T1_UXTH, 0, TOPS_DN3M3},
+    {0xFFC0, 0xB2C0, T1_UXTB, 0, TOPS_DN3M3},
+    {0xFF80, 0xB000, T2_ADDSP_I, 0, TOPS_I7W},
+    {0xFF80, 0xB080, T1_SUBSP_I, 0, TOPS_I7W},
+    {0xFF00, 0x4400, T2_ADD_R, 0, TOPS_DN4M4},
+    {0xFF00, 0x4500, T2_CMP_R, 0, TOPS_DN4M4},
+    {0xFF00, 0x4600, T1_MOV_R, 0, TOPS_DN4M4},
+    {0xFF00, 0xBE00, T1_BKPT, 0},
+    {0xFF00, 0xBF00, T1_IT, 0},
+    {0xFE00, 0x1800, T1_ADD_R, 0, TOPS_D3N3M3},
+    {0xFE00, 0x1A00, T1_SUB_R, 0, TOPS_D3N3M3},
+    {0xFE00, 0x1C00, T1_ADD_I, 0, TOPS_D3N3I3},
+    {0xFE00, 0x1E00, T1_SUB_I, 0, TOPS_D3N3I3},
+    {0xFE00, 0x5000, T1_STR_R, 0, TOPS_D3N3M3},
+    {0xFE00, 0x5400, T1_STRB_R, 0, TOPS_D3N3M3},
+    {0xFE00, 0x5600, T1_LDRSB_R, 0, TOPS_D3N3M3},
+    {0xFE00, 0x5800, T1_LDR_R, 0, TOPS_D3N3M3},
+    {0xFE00, 0x5C00, T1_LDRB_R, 0, TOPS_D3N3M3},
+    {0xFE00, 0xB400, T1_PUSH, 0},
+    {0xFE00, 0xBC00, T1_POP, 0},
+    {0xFD00, 0xB900, T1_CBNZ, 0, TOPS_N3I6H},
+    {0xFD00, 0xB100, T1_CBZ, 0, TOPS_N3I6H},
+    {0xF800, 0x0000, T1_LSL_I, 0, TOPS_D3M3I5},
+    {0xF800, 0x0800, T1_LSR_I, 0, TOPS_D3M3I5},
+    {0xF800, 0x1000, T1_ASR_I, 0, TOPS_D3M3I5},
+    {0xF800, 0x2000, T1_MOV_I, 0, TOPS_DN3I8},
+    {0xF800, 0x2800, T1_CMP_I, 0, TOPS_DN3I8},
+    {0xF800, 0x3000, T2_ADD_I, 0, TOPS_DN3I8},
+    {0xF800, 0x3800, T2_SUB_I, 0, TOPS_DN3I8},
+    {0xF800, 0x4800, T1_LDR_L, 0, TOPS_D3I8W},
+    {0xF800, 0x6000, T1_STR_I, 0, TOPS_D3N3I5W},
+    {0xF800, 0x6800, T1_LDR_I, 0, TOPS_D3N3I5W},
+    {0xF800, 0x7000, T1_STRB_I, 0, TOPS_D3N3I5},
+    {0xF800, 0x7800, T1_LDRB_I, 0, TOPS_D3N3I5},
+    {0xF800, 0x8000, T1_STRH_I, 0, TOPS_D3N3I5H},
+    {0xF800, 0x8800, T1_LDRH_I, 0, TOPS_D3N3I5H},
+    {0xF800, 0x9000, T2_STR_I, 0, TOPS_D3I8W},
+    {0xF800, 0x9800, T2_LDR_I, 0, TOPS_D3I8W},
+    {0xF800, 0xA000, T1_ADR, 0, TOPS_D3I8W},
+    {0xF800, 0xA800, T1_ADDSP_I, 0, TOPS_D3I8W},
+    {0xF800, 0xC000, T1_STMIA, 0},
+    {0xF800, 0xE000, T2_B, 0, TOPS_I11H},
+    {0xD000F800, 0xD000F000, T1_BL_I, 0},  // 4.6.18 BL, BLX
+    {0xFF00, 0xDE00, ARMV7_Total, "B: See permanently undefined space %04x"},
+    {0xFF00, 0xDF00, ARMV7_Total, "B: See SVC (formely SWI) %04x"},
+    {0xF000, 0xD000, T1_B, 0, TOPS_C4I8H},
+};
+
+/**
+ * Decode table indexed by bits [15:4] of the first halfword. Each bucket
+ * keeps the rules which can match this index in the original order,
+ * split into the three groups above.
+ */
+static const int THUMB_BUCKET_BITS = 12;
+static const int THUMB_BUCKETS = 1 << THUMB_BUCKET_BITS;
+
+struct ThumbBucketType {
+    uint32_t pre;           // first rule of each group in the rules list
+    uint32_t w;
+    uint32_t n;
+    uint32_t end;
+};
+
+static ThumbBucketType *thumbBuckets_ = 0;
+static const ThumbDecodeRule **thumbRules_ = 0;
+
+static uint32_t bucket_add(const ThumbDecodeRule *tbl, int cnt, int idx,
+                           uint32_t pos) {
+    uint32_t key = static_cast<uint32_t>(idx) << 4;
+    for (int i = 0; i < cnt; i++) {
+        if (((key ^ tbl[i].value) & tbl[i].mask & 0xFFF0) != 0) {
+            continue;
+        }
+        if (thumbRules_) {
+            thumbRules_[pos] = &tbl[i];
+        }
+        pos++;
+    }
+    return pos;
+}
+
+void decoder_thumb_init() {
+    if (thumbBuckets_) {
+        return;
+    }
+    const int pre_cnt = sizeof(THUMB_RULES_PRE) / sizeof(ThumbDecodeRule);
+    const int w_cnt = sizeof(THUMB_RULES_W) / sizeof(ThumbDecodeRule);
+    const int n_cnt = sizeof(THUMB_RULES_N) / sizeof(ThumbDecodeRule);
+    ThumbBucketType *buckets = new ThumbBucketType[THUMB_BUCKETS];
+    uint32_t pos;
+
+    // The first pass computes the size of the rules list
+    for (int k = 0; k < 2; k++) {
+        pos = 0;
+        for (int i = 0; i < THUMB_BUCKETS; i++) {
+            buckets[i].pre = pos;
+            pos = bucket_add(THUMB_RULES_PRE, pre_cnt, i, pos);
+            buckets[i].w = pos;
+            pos = bucket_add(THUMB_RULES_W, w_cnt, i, pos);
+            buckets[i].n = pos;
+            pos = bucket_add(THUMB_RULES_N, n_cnt, i, pos);
+            buckets[i].end = pos;
+        }
+        if (k == 0) {
+            thumbRules_ = new const ThumbDecodeRule *[pos];
+        }
     }
-    return ret;
+    thumbBuckets_ = buckets;
 }
 
-EIsaArmV7 decoder_thumb(uint32_t ti, uint32_t *tio,
+static void decode_operands(EThumbOperandsFormat fmt, uint32_t ti,
+                            ThumbOperandsType *ops) {
+    uint32_t imm;
+    ops->d = 0;
+    ops->n = 0;
+    ops->m = 0;
+    ops->cond = 0;
+    ops->imm32 = 0;
+    switch (fmt) {
+    case TOPS_D3N3M3:
+        ops->d = ti & 0x7;
+        ops->n = (ti >> 3) & 0x7;
+        ops->m = (ti >> 6) & 0x7;
+        break;
+    case TOPS_D3N3I3:
+        ops->d = ti & 0x7;
+        ops->n = (ti >> 3) & 0x7;
+        ops->imm32 = (ti >> 6) & 0x7;
+        break;
+    case TOPS_D3N3I5:
+        ops->d = ti & 0x7;
+        ops->n = (ti >> 3) & 0x7;
+        ops->imm32 = (ti >> 6) & 0x1F;
+        break;
+    case TOPS_D3N3I5H:
+        ops->d = ti & 0x7;
+        ops->n = (ti >> 3) & 0x7;
+        ops->imm32 = ((ti >> 6) & 0x1F) << 1;
+        break;
+    case TOPS_D3N3I5W:
+        ops->d = ti & 0x7;
+        ops->n = (ti >> 3) & 0x7;
+        ops->imm32 = ((ti >> 6) & 0x1F) << 2;
+        break;
+    case TOPS_D3M3I5:
+        ops->d = ti & 0x7;
+        ops->m = (ti >> 3) & 0x7;
+        ops->imm32 = (ti >> 6) & 0x1F;
+        break;
+    case TOPS_D3N3:
+        ops->d = ti & 0x7;
+        ops->n = (ti >> 3) & 0x7;
+        ops->m = ops->d;
+        break;
+    case TOPS_DN3M3:
+        ops->d = ti & 0x7;
+        ops->n = ops->d;
+        ops->m = (ti >> 3) & 0x7;
+        break;
+    case TOPS_DN4M4:
+        ops->d = (((ti >> 7) & 0x1) << 3) | (ti & 0x7);
+        ops->n = ops->d;
+        ops->m = (ti >> 3) & 0xF;
+        break;
+    case TOPS_DN3I8:
+        ops->d = (ti >> 8) & 0x7;
+        ops->n = ops->d;
+        ops->imm32 = ti & 0xFF;
+        break;
+    case TOPS_D3I8W:
+        ops->d = (ti >> 8) & 0x7;
+        ops->imm32 = (ti & 0xFF) << 2;
+        break;
+    case TOPS_I7W:
+        ops->imm32 = (ti & 0x7F) << 2;
+        break;
+    case TOPS_N3I6H:
+        ops->n = ti & 0x7;
+        ops->imm32 = (((ti >> 9) & 0x1) << 6) | (((ti >> 3) & 0x1F) << 1);
+        break;
+    case TOPS_C4I8H:
+        ops->cond = (ti >> 8) & 0xF;
+        imm = (ti & 0xFF) << 1;
+        if (ti & 0x80) {
+            imm |= ~0u << 9;
+        }
+        ops->imm32 = imm;
+        break;
+    case TOPS_I11H:
+        imm = (ti & 0x7FF) << 1;
+        if (ti & 0x400) {
+            imm |= ~0u << 12;
+        }
+        ops->imm32 = imm;
+        break;
+    default:;
+    }
+}
+
+EIsaArmV7 decoder_thumb(uint32_t ti, ThumbOperandsType *ops,
                          char *errmsg, size_t errsz) {
-    EIsaArmV7 tret;
-    EIsaArmV7 ret = ARMV7_Total;
-    if ((ti & 0xFFFF) == 0xBF00) {
-        ret = T1_NOP;
-    } else if ((ti & 0xFF87) == 0x4700) {
-        ret = T1_BX;
-    } else if ((tret = decoder_w(ti, tio, errmsg, errsz)) != ARMV7_Total) {
-        ret = tret;
-    } else if ((ti & 0xFFE8) == 0xB660) {
-        ret = T1_CPS;
-    } else if ((ti & 0xFF78) == 0x4468) {
-        //ret = T1_ADDSP_R;
-    } else if ((ti & 0xFF87) == 0x4485) {
-        //ret = T2_ADDSP_R;
-    } else if ((ti & 0xFF87) == 0x4780) {
-        ret = T1_BLX_R;
-    } else if ((ti & 0xFFC0) == 0x0000) {
-        ret = T2_MOV_R;
-    } else if ((ti & 0xFFC0) == 0x4000) {
-        ret = T1_AND_R;
-    } else if ((ti & 0xFFC0) == 0x4040) {
-        ret = T1_EOR_R;
-    } else if ((ti & 0xFFC0) == 0x4080) {
-        ret = T1_LSL_R;
-    } else if ((ti & 0xFFC0) == 0x40C0) {
-        ret = T1_LSR_R;
-    } else if ((ti & 0xFFC0) == 0x4200) {
-        ret = T1_TST_R;
-    } else if ((ti & 0xFFC0) == 0x4240) {
-        ret = T1_RSB_I;
-    } else if ((ti & 0xFFC0) == 0x4280) {
-        ret = T1_CMP_R;
-    } else if ((ti & 0xFFC0) == 0x4300) {
-        ret = T1_ORR_R;
-    } else if ((ti & 0xFFC0) == 0x4340) {
-        ret = T1_MUL;
-    } else if ((ti & 0xFFC0) == 0x43C0) {
-        ret = T1_MVN_R;
-    } else if ((ti & 0xFFC0) == 0xB240) {
-        ret = T1_SXTB;
-    } else if ((ti & 0xFFC0) == 0xB280) {
-        ret = T1_UXTH;
-    } else if ((ti & 0xFFC0) == 0xB2C0) {
-        ret = T1_UXTB;
-    } else if ((ti & 0xFF80) == 0xB000) {
-        ret = T2_ADDSP_I;
-    } else if ((ti & 0xFF80) == 0xB080) {
-        ret = T1_SUBSP_I;
-    } else if ((ti & 0xFF00) == 0x4400) {
-        ret = T2_ADD_R;
-    } else if ((ti & 0xFF00) == 0x4500) {
-        ret = T2_CMP_R;
-    } else if ((ti & 0xFF00) == 0x4600) {
-        ret = T1_MOV_R;
-    } else if ((ti & 0xFF00) == 0xBE00) {
-        ret = T1_BKPT;
-    } else if ((ti & 0xFF00) == 0xBF00) {
-        ret = T1_IT;
-    } else if ((ti & 0xFE00) == 0x1800) {
-        ret = T1_ADD_R;
-    } else if ((ti & 0xFE00) == 0x1A00) {
-        ret = T1_SUB_R;
-    } else if ((ti & 0xFE00) == 0x1C00) {
-        ret = T1_ADD_I;
-    } else if ((ti & 0xFE00) == 0x1E00) {
-        ret = T1_SUB_I;
-    } else if ((ti & 0xFE00) == 0x5000) {
-        ret = T1_STR_R;
-    } else if ((ti & 0xFE00) == 0x5400) {
-        ret = T1_STRB_R;
-    } else if ((ti & 0xFE00) == 0x5600) {
-        ret = T1_LDRSB_R;
-    } else if ((ti & 0xFE00) == 0x5800) {
-        ret = T1_LDR_R;
-    } else if ((ti & 0xFE00) == 0x5C00) {
-        ret = T1_LDRB_R;
-    } else if ((ti & 0xFE00) == 0xB400) {
-        ret = T1_PUSH;
-    } else if ((ti & 0xFE00) == 0xBC00) {
-        ret = T1_POP;
-    } else if ((ti & 0xFD00) == 0xB900) {
-        ret = T1_CBNZ;
-    } else if ((ti & 0xFD00) == 0xB100) {
-        ret = T1_CBZ;
-    } else if ((ti & 0xF800) == 0x0000) {
-        ret = T1_LSL_I;
-    } else if ((ti & 0xF800) == 0x0800) {
-        ret = T1_LSR_I;
-    } else if ((ti & 0xF800) == 0x1000) {
-        ret = T1_ASR_I;
-    } else if ((ti & 0xF800) == 0x2000) {
-        ret = T1_MOV_I;
-    } else if ((ti & 0xF800) == 0x2800) {
-        ret = T1_CMP_I;
-    } else if ((ti & 0xF800) == 0x3000) {
-        ret = T2_ADD_I;
-    } else if ((ti & 0xF800) == 0x3800) {
-        ret = T2_SUB_I;
-    } else if ((ti & 0xF800) == 0x4800) {
-        ret = T1_LDR_L;
-    } else if ((ti & 0xF800) == 0x6000) {
-        ret = T1_STR_I;
-    } else if ((ti & 0xF800) == 0x6800) {
-        ret = T1_LDR_I;
-    } else if ((ti & 0xF800) == 0x7000) {
-        ret = T1_STRB_I;
-    } else if ((ti & 0xF800) == 0x7800) {
-        ret = T1_LDRB_I;
-    } else if ((ti & 0xF800) == 0x8000) {
-        ret = T1_STRH_I;
-    } else if ((ti & 0xF800) == 0x8800) {
-        ret = T1_LDRH_I;
-    } else if ((ti & 0xF800) == 0x9000) {
-        ret = T2_STR_I;
-    } else if ((ti & 0xF800) == 0x9800) {
-        ret = T2_LDR_I;
-    } else if ((ti & 0xF800) == 0xA000) {
-        ret = T1_ADR;
-    } else if ((ti & 0xF800) == 0xA800) {
-        ret = T1_ADDSP_I;
-    } else if ((ti & 0xF800) == 0xC000) {
-        ret = T1_STMIA;
-    } else if ((ti & 0xF800) == 0xE000) {
-        ret = T2_B;
-    } else if ((ti & 0xD000F800) == 0xD000F000) {
-        // 4.6.18 BL, BLX
-        ret = T1_BL_I;
-    } else if ((ti & 0xFF00) == 0xDE00) {
-        RISCV_sprintf(errmsg, errsz,
-            "B: See permanently undefined space %04x", ti & 0xFFFF);
-    } else if ((ti & 0xFF00) == 0xDF00) {
-        RISCV_sprintf(errmsg, errsz,
-            "B: See SVC (formely SWI) %04x", ti & 0xFFFF);
-    } else if ((ti & 0xF000) == 0xD000) {
-        ret = T1_B;
-    } else {
-        RISCV_sprintf(errmsg, errsz,
-            "undefined instruction %04x", ti & 0xFFFF);
+    const ThumbBucketType &b = thumbBuckets_[(ti >> 4) & (THUMB_BUCKETS - 1)];
+    const ThumbDecodeRule *r;
+    uint32_t i;
+    for (i = b.pre; i < b.w; i++) {
+        r = thumbRules_[i];
+        if ((ti & r->mask) == r->value) {
+            decode_operands(r->fmt, ti, ops);
+            return r->ret;
+        }
+    }
+    for (i = b.w; i < b.n; i++) {
+        r = thumbRules_[i];
+        if ((ti & r->mask) == r->value) {
+            if (r->ret != ARMV7_Total) {
+                decode_operands(r->fmt, ti, ops);
+                return r->ret;
+            }
+            break;
+        }
+    }
+    for (i = b.n; i < b.end; i++) {
+        r = thumbRules_[i];
+        if ((ti & r->mask) == r->value) {
+            if (r->errfmt) {
+                RISCV_sprintf(errmsg, errsz, r->errfmt, ti & 0xFFFF);
+            }
+            decode_operands(r->fmt, ti, ops);
+            return r->ret;
+        }
     }
-    return ret;
+    RISCV_sprintf(errmsg, errsz, "undefined instruction %04x", ti & 0xFFFF);
+    return ARMV7_Total;
 }
 
 }  // debugger
@@ -20,6 +20,8 @@
 #include <iclass.h>
 #include <iservice.h>
 #include "coreservices/isrccode.h"
+#include "symbolindex.h"
+#include "disasmcache.h"
 #include "coreservices/icpuarm.h"
 
 namespace debugger {
@@ -44,12 +46,12 @@ class ArmSourceService : public IService,
 
     virtual void clearSymbols();
 
-    virtual void getSymbols(AttributeType *list) {
-        *list = symbolListSortByName_;
-    }
+    virtual void getSymbols(AttributeType *list);
 
     virtual void addressToSymbol(uint64_t addr, AttributeType *info);
 
+    virtual const char *addressToSymbol(uint64_t addr, uint64_t *offset);
+
     virtual int symbol2Address(const char *name, uint64_t *addr);
 
     virtual int disasm(uint64_t pc,
@@ -72,6 +74,8 @@ class ArmSourceService : public IService,
     virtual bool isBreakpoint(uint64_t addr);
 
  private:
+    void invalidateDisasm();
+    void updateSymbols();
     int parseUndefinedInstruction(uint64_t pc, uint32_t instr,
                             AttributeType *mnemonic,
                             AttributeType *comment);
@@ -111,7 +115,11 @@ class ArmSourceService : public IService,
     AttributeType endianess_;
     AttributeType brList_;
     AttributeType symbolListSortByName_;
-    AttributeType symbolListSortByAddr_;
+    SymbolIndexType symbolIndex_;
+    bool symbolsDirty_;             // list isn't sorted, index isn't built
+    mutex_def mutexSymbols_;
+    DisasmCacheType disasmCache_;
+    mutex_def mutexDisasm_;
 
     ICpuArm *iarm_;
 };
@@ -16,11 +16,15 @@
 
 #include "api_core.h"
 #include "stm32l4_nvic.h"
+#include "bitscan.h"
 
 namespace debugger {
 
 STM32L4_NVIC::STM32L4_NVIC(const char *name) : IService(name),
-    NVIC_STIR(this, "NVIC_STIR", 0xF00) {
+    NVIC_STIR(this, "NVIC_STIR", 0xF00),
+    SHPR1(this, "SHPR1", 0xD18, 4),
+    SHPR2(this, "SHPR2", 0xD1C, 8),
+    SHPR3(this, "SHPR3", 0xD20, 12) {
     char tstr[64];
     for (int i = 0; i < 8; i++) {
         RISCV_sprintf(tstr, sizeof(tstr), "NVIC_ISER%d", i);
@@ -42,6 +46,19 @@ STM32L4_NVIC::STM32L4_NVIC(const char *name) : IService(name),
         RISCV_sprintf(tstr, sizeof(tstr), "NVIC_IPR%d", i);
         NVIC_IPRx[i] = new IPR_TYPE(this, tstr, 0x400 + 4*i, 4*i);
     }
+    registerInterface(static_cast<IIrqController *>(this));
+    registerAttribute("CPU", &cpu_);
+
+    icpu_ = 0;
+    memset(enabled_, 0, sizeof(enabled_));
+    memset(pending_, 0, sizeof(pending_));
+    memset(active_, 0, sizeof(active_));
+    memset(prio_, 0, sizeof(prio_));
+    memset(sysprio_, 0, sizeof(sysprio_));
+    levelMask_ = 0;
+    memset(levelWords_, 0, sizeof(levelWords_));
+    memset(levelIrq_, 0, sizeof(levelIrq_));
+    requested_ = -1;
 }
 
 STM32L4_NVIC::~STM32L4_NVIC() {
@@ -69,70 +86,266 @@ void STM32L4_NVIC::postinitService() {
     for (int i = 0; i < 61; i++) {
         NVIC_IPRx[i]->setBaseAddress(baseaddr + 0x400 + 4*i);
     }
+    NVIC_STIR.setBaseAddress(baseaddr + 0xF00);
+    SHPR1.setBaseAddress(baseaddr + 0xD18);
+    SHPR2.setBaseAddress(baseaddr + 0xD1C);
+    SHPR3.setBaseAddress(baseaddr + 0xD20);
+
+    if (!cpu_.is_string() || cpu_.size() == 0) {
+        return;
+    }
+    icpu_ = static_cast<ICpuGeneric *>(
+        RISCV_get_service_iface(cpu_.to_string(), IFACE_CPU_GENERIC));
+    if (!icpu_) {
+        RISCV_error("Can't find ICpuGeneric interface %s", cpu_.to_string());
+    }
 }
 
-void STM32L4_NVIC::enableInterrupt(int idx) {
-    int regidx = idx >> 5;
-    int regoff = idx & 0x1F;
-    uint32_t t = NVIC_IABRx[regidx]->getValue().val;
+/**
+ * System exception is signaled to CPU directly, CPU arbitrates pending
+ * system exceptions and external interrupt using getPriority().
+ */
+void STM32L4_NVIC::requestInterrupt(int idx) {
+    if (idx >= 0) {
+        setPending(idx);
+    } else if (idx >= -16 && icpu_) {
+        icpu_->raiseSignal(16 + idx);
+    }
+}
+
+/** Reset, NMI and HardFault have fixed priorities -3, -2 and -1 */
+int STM32L4_NVIC::getPriority(int idx) {
+    if (idx >= 0) {
+        return idx < IRQ_TOTAL ? prio_[idx] : 0;
+    }
+    int exc = 16 + idx;
+    if (exc < 4) {
+        return exc - 4;
+    }
+    return sysprio_[exc];
+}
+
+void STM32L4_NVIC::activateInterrupt(int idx) {
+    active_[idx >> 5] |= (1ul << (idx & 0x1F));
+    clearPending(idx);
+}
 
+void STM32L4_NVIC::deactivateInterrupt(int idx) {
+    active_[idx >> 5] &= ~(1ul << (idx & 0x1F));
+}
+
+void STM32L4_NVIC::enableInterrupt(int idx) {
+    uint32_t bit = 1ul << (idx & 0x1F);
+    if (idx >= IRQ_TOTAL || (enabled_[idx >> 5] & bit)) {
+        return;
+    }
     // 29  TIM3_IRQn
     // 54  TIM6_DAC_IRQn
     RISCV_info("Enabling Interrupt %d", idx);
-    t |= (1ul << regoff);
-    NVIC_IABRx[regidx]->setValue(t);
+    enabled_[idx >> 5] |= bit;
+    if (pending_[idx >> 5] & bit) {
+        insertReady(idx);
+        updateRequest();
+    }
 }
 
 void STM32L4_NVIC::disableInterrupt(int idx) {
-    int regidx = idx >> 5;
-    int regoff = idx & 0x1F;
-    uint32_t t = NVIC_IABRx[regidx]->getValue().val;
-
+    uint32_t bit = 1ul << (idx & 0x1F);
+    if (idx >= IRQ_TOTAL || (enabled_[idx >> 5] & bit) == 0) {
+        return;
+    }
     RISCV_info("Disabling Interrupt %d", idx);
-    t &= ~(1ul << regoff);
-    NVIC_IABRx[regidx]->setValue(t);
+    enabled_[idx >> 5] &= ~bit;
+    if (pending_[idx >> 5] & bit) {
+        removeReady(idx);
+        updateRequest();
+    }
 }
 
+void STM32L4_NVIC::setPending(int idx) {
+    uint32_t bit = 1ul << (idx & 0x1F);
+    if (idx >= IRQ_TOTAL || (pending_[idx >> 5] & bit)) {
+        return;
+    }
+    pending_[idx >> 5] |= bit;
+    if (enabled_[idx >> 5] & bit) {
+        insertReady(idx);
+        updateRequest();
+    }
+}
+
+void STM32L4_NVIC::clearPending(int idx) {
+    uint32_t bit = 1ul << (idx & 0x1F);
+    if (idx >= IRQ_TOTAL || (pending_[idx >> 5] & bit) == 0) {
+        return;
+    }
+    pending_[idx >> 5] &= ~bit;
+    if (enabled_[idx >> 5] & bit) {
+        removeReady(idx);
+        updateRequest();
+    }
+}
+
+void STM32L4_NVIC::setPriority(int idx, uint32_t prio) {
+    if (idx >= IRQ_TOTAL) {
+        return;
+    }
+    uint8_t level = static_cast<uint8_t>((prio & 0xFF) >> (8 - PRIO_BITS));
+    if (prio_[idx] == level) {
+        return;
+    }
+    uint32_t bit = 1ul << (idx & 0x1F);
+    bool ready = (enabled_[idx >> 5] & pending_[idx >> 5] & bit) != 0;
+    if (ready) {
+        removeReady(idx);
+    }
+    prio_[idx] = level;
+    if (ready) {
+        insertReady(idx);
+        updateRequest();
+    }
+}
+
+uint32_t STM32L4_NVIC::setSystemPriority(int exc, uint32_t prio) {
+    if ((SYS_PRIO_MASK & (1ul << exc)) == 0) {
+        return 0;
+    }
+    sysprio_[exc] = static_cast<uint8_t>((prio & 0xFF) >> (8 - PRIO_BITS));
+    return static_cast<uint32_t>(sysprio_[exc]) << (8 - PRIO_BITS);
+}
+
+void STM32L4_NVIC::insertReady(int idx) {
+    int level = prio_[idx];
+    int w = idx >> 5;
+    levelIrq_[level][w] |= (1ul << (idx & 0x1F));
+    levelWords_[level] |= (1ul << w);
+    levelMask_ |= (1ul << level);
+}
+
+void STM32L4_NVIC::removeReady(int idx) {
+    int level = prio_[idx];
+    int w = idx >> 5;
+    levelIrq_[level][w] &= ~(1ul << (idx & 0x1F));
+    if (levelIrq_[level][w] == 0) {
+        levelWords_[level] &= ~(1ul << w);
+        if (levelWords_[level] == 0) {
+            levelMask_ &= ~(1ul << level);
+        }
+    }
+}
+
+/**
+ * Signal CPU with the most urgent ready interrupt: the lowest priority
+ * level and the lowest number inside of the level.
+ */
+void STM32L4_NVIC::updateRequest() {
+    int next = -1;
+    if (levelMask_) {
+        int level = bitscan32(levelMask_);
+        int w = bitscan32(levelWords_[level]);
+        next = 32*w + bitscan32(levelIrq_[level][w]);
+    }
+    if (next == requested_ || !icpu_) {
+        requested_ = next;
+        return;
+    }
+    if (requested_ != -1) {
+        icpu_->lowerSignal(16 + requested_);
+    }
+    requested_ = next;
+    if (requested_ != -1) {
+        icpu_->raiseSignal(16 + requested_);
+    }
+}
+
+uint32_t STM32L4_NVIC::ISER_TYPE::aboutToRead(uint32_t cur_val) {
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    return p->getEnabled(startidx_ >> 5);
+}
 
 uint32_t STM32L4_NVIC::ISER_TYPE::aboutToWrite(uint32_t cur_val) {
     STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
-    for (int i = 0; i < 32; i++) {
-        if (cur_val & (1 << i)) {
-            p->enableInterrupt(startidx_ + i);
-        }
+    for (uint32_t t = cur_val; t; t &= t - 1) {
+        p->enableInterrupt(startidx_ + bitscan32(t));
     }
-    return cur_val;
+    return p->getEnabled(startidx_ >> 5);
+}
+
+uint32_t STM32L4_NVIC::ICER_TYPE::aboutToRead(uint32_t cur_val) {
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    return p->getEnabled(startidx_ >> 5);
 }
 
 uint32_t STM32L4_NVIC::ICER_TYPE::aboutToWrite(uint32_t cur_val) {
     STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
-    for (int i = 0; i < 32; i++) {
-        if (cur_val & (1 << i)) {
-            p->disableInterrupt(startidx_ + i);
-        }
+    for (uint32_t t = cur_val; t; t &= t - 1) {
+        p->disableInterrupt(startidx_ + bitscan32(t));
     }
-    return cur_val;
+    return p->getEnabled(startidx_ >> 5);
+}
+
+uint32_t STM32L4_NVIC::ISPR_TYPE::aboutToRead(uint32_t cur_val) {
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    return p->getPending(startidx_ >> 5);
 }
 
 uint32_t STM32L4_NVIC::ISPR_TYPE::aboutToWrite(uint32_t cur_val) {
-    return cur_val;
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    for (uint32_t t = cur_val; t; t &= t - 1) {
+        p->setPending(startidx_ + bitscan32(t));
+    }
+    return p->getPending(startidx_ >> 5);
+}
+
+uint32_t STM32L4_NVIC::ICPR_TYPE::aboutToRead(uint32_t cur_val) {
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    return p->getPending(startidx_ >> 5);
 }
 
 uint32_t STM32L4_NVIC::ICPR_TYPE::aboutToWrite(uint32_t cur_val) {
-    return cur_val;
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    for (uint32_t t = cur_val; t; t &= t - 1) {
+        p->clearPending(startidx_ + bitscan32(t));
+    }
+    return p->getPending(startidx_ >> 5);
 }
 
+uint32_t STM32L4_NVIC::IABR_TYPE::aboutToRead(uint32_t cur_val) {
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    return p->getActive(startidx_ >> 5);
+}
+
+// Read-only register
 uint32_t STM32L4_NVIC::IABR_TYPE::aboutToWrite(uint32_t cur_val) {
-    return cur_val;
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    return p->getActive(startidx_ >> 5);
 }
 
 uint32_t STM32L4_NVIC::IPR_TYPE::aboutToWrite(uint32_t cur_val) {
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    // Only bits [7:4] of each byte are implemented
+    cur_val &= 0xF0F0F0F0;
+    for (int i = 0; i < 4; i++) {
+        p->setPriority(startidx_ + i, cur_val >> (8*i));
+    }
     return cur_val;
 }
 
+uint32_t STM32L4_NVIC::SHPR_TYPE::aboutToWrite(uint32_t cur_val) {
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    uint32_t ret = 0;
+    for (int i = 0; i < 4; i++) {
+        ret |= p->setSystemPriority(startidx_ + i, cur_val >> (8*i)) << (8*i);
+    }
+    return ret;
+}
+
 uint32_t STM32L4_NVIC::STIR_TYPE::aboutToWrite(uint32_t cur_val) {
-    return cur_val;
+    STM32L4_NVIC *p = static_cast<STM32L4_NVIC *>(parent_);
+    value_type t;
+    t.v = cur_val;
+    p->setPending(t.b.INTID);
+    return 0;
 }
 
 }  // namespace debugger
-
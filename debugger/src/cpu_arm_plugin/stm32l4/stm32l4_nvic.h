@@ -20,12 +20,15 @@
 #include "iclass.h"
 #include "iservice.h"
 #include "coreservices/imemop.h"
+#include "coreservices/icpugen.h"
+#include "coreservices/iirqctrl.h"
 #include "generic/mapreg.h"
 #include "generic/rmembank_gen1.h"
 
 namespace debugger {
 
-class STM32L4_NVIC : public IService {
+class STM32L4_NVIC : public IService,
+                     public IIrqController {
  public:
     explicit STM32L4_NVIC(const char *name);
     virtual ~STM32L4_NVIC();
@@ -33,9 +36,33 @@ class STM32L4_NVIC : public IService {
     /** IService interface */
     virtual void postinitService() override;
 
-    /** Common methods */
+    /** IIrqController interface */
+    virtual void requestInterrupt(int idx) override;
+    virtual int getPriority(int idx) override;
+    virtual void activateInterrupt(int idx) override;
+    virtual void deactivateInterrupt(int idx) override;
+
+    /** Common methods shared with registers */
     void enableInterrupt(int idx);
     void disableInterrupt(int idx);
+    void setPending(int idx);
+    void clearPending(int idx);
+    void setPriority(int idx, uint32_t prio);
+    uint32_t setSystemPriority(int exc, uint32_t prio);
+    uint32_t getEnabled(int regidx) {
+        return regidx < IRQ_WORDS ? enabled_[regidx] : 0;
+    }
+    uint32_t getPending(int regidx) {
+        return regidx < IRQ_WORDS ? pending_[regidx] : 0;
+    }
+    uint32_t getActive(int regidx) {
+        return regidx < IRQ_WORDS ? active_[regidx] : 0;
+    }
+
+ protected:
+    void insertReady(int idx);
+    void removeReady(int idx);
+    void updateRequest();
 
  protected:
     class ONEBITS_TYPE : public MappedReg32Type {
@@ -57,6 +84,7 @@ class STM32L4_NVIC : public IService {
                     ONEBITS_TYPE(parent, name, addr, startidx) {
         }
      protected:
+        virtual uint32_t aboutToRead(uint32_t cur_val) override;
         virtual uint32_t aboutToWrite(uint32_t cur_val) override;
     };
 
@@ -68,6 +96,7 @@ class STM32L4_NVIC : public IService {
                     ONEBITS_TYPE(parent, name, addr, startidx) {
         }
      protected:
+        virtual uint32_t aboutToRead(uint32_t cur_val) override;
         virtual uint32_t aboutToWrite(uint32_t cur_val) override;
     };
 
@@ -79,6 +108,7 @@ class STM32L4_NVIC : public IService {
                     ONEBITS_TYPE(parent, name, addr, startidx) {
         }
      protected:
+        virtual uint32_t aboutToRead(uint32_t cur_val) override;
         virtual uint32_t aboutToWrite(uint32_t cur_val) override;
     };
 
@@ -90,6 +120,7 @@ class STM32L4_NVIC : public IService {
                     ONEBITS_TYPE(parent, name, addr, startidx) {
         }
      protected:
+        virtual uint32_t aboutToRead(uint32_t cur_val) override;
         virtual uint32_t aboutToWrite(uint32_t cur_val) override;
     };
 
@@ -101,6 +132,7 @@ class STM32L4_NVIC : public IService {
                     ONEBITS_TYPE(parent, name, addr, startidx) {
         }
      protected:
+        virtual uint32_t aboutToRead(uint32_t cur_val) override;
         virtual uint32_t aboutToWrite(uint32_t cur_val) override;
     };
 
@@ -109,6 +141,21 @@ class STM32L4_NVIC : public IService {
      public:
         IPR_TYPE(IService *parent, const char *name, uint64_t addr,
                     int startidx) : MappedReg32Type(parent, name, addr) {
+            startidx_ = startidx;
+        }
+     protected:
+        virtual uint32_t aboutToWrite(uint32_t cur_val) override;
+     protected:
+        int startidx_;
+    };
+
+    // System handler priority of exceptions 4..15 from SCB, the same
+    // 8 bits per one exception as IPR. Fixed or reserved bytes are RAZ/WI.
+    class SHPR_TYPE : public MappedReg32Type {
+     public:
+        SHPR_TYPE(IService *parent, const char *name, uint64_t addr,
+                    int startidx) : MappedReg32Type(parent, name, addr) {
+            startidx_ = startidx;
         }
      protected:
         virtual uint32_t aboutToWrite(uint32_t cur_val) override;
@@ -143,13 +190,44 @@ class STM32L4_NVIC : public IService {
     };
 
 
-    ISER_TYPE *NVIC_ISERx[8];     // interrupt 0 to 239
-    ICER_TYPE *NVIC_ICERx[8];     // interrupt 0 to 239
-    ISPR_TYPE *NVIC_ISPRx[8];     // interrupt 0 to 239
-    ICPR_TYPE *NVIC_ICPRx[8];     // interrupt 0 to 239
-    IABR_TYPE *NVIC_IABRx[8];     // interrupt 0 to 239
+    // Architectural register map for the interrupts 0 to 239, bits above
+    // IRQ_TOTAL are read as zero and writes are ignored
+    ISER_TYPE *NVIC_ISERx[8];
+    ICER_TYPE *NVIC_ICERx[8];
+    ISPR_TYPE *NVIC_ISPRx[8];
+    ICPR_TYPE *NVIC_ICPRx[8];
+    IABR_TYPE *NVIC_IABRx[8];
     IPR_TYPE * NVIC_IPRx[61];
     STIR_TYPE NVIC_STIR;
+    SHPR_TYPE SHPR1;                    // MemManage, BusFault, UsageFault
+    SHPR_TYPE SHPR2;                    // SVCall
+    SHPR_TYPE SHPR3;                    // DebugMonitor, PendSV, SysTick
+
+    // CPU signals 128 exceptions: 16 system and 112 external interrupts
+    static const int IRQ_TOTAL = 112;
+    static const int IRQ_WORDS = (IRQ_TOTAL + 31) / 32;
+    static const int PRIO_BITS = 4;     // implemented bits [7:4] of IPR
+    static const int PRIO_LEVELS = 1 << PRIO_BITS;
+    // Exceptions 4, 5, 6, 11, 12, 14 and 15 with configurable priority
+    static const uint32_t SYS_PRIO_MASK = 0xD870;
+
+    AttributeType cpu_;
+    ICpuGeneric *icpu_;
+
+    uint32_t enabled_[IRQ_WORDS];
+    uint32_t pending_[IRQ_WORDS];
+    uint32_t active_[IRQ_WORDS];
+    uint8_t prio_[IRQ_TOTAL];           // priority level of interrupt
+    uint8_t sysprio_[16];               // priority level of system exception
+    /**
+     * Enabled and pending interrupts grouped by priority level. Non-zero
+     * words are marked in levelWords_ and non-empty levels in levelMask_,
+     * so the most urgent interrupt is found with three bit scans.
+     */
+    uint32_t levelMask_;
+    uint32_t levelWords_[PRIO_LEVELS];
+    uint32_t levelIrq_[PRIO_LEVELS][IRQ_WORDS];
+    int requested_;                     // interrupt signaled to CPU or -1
 };
 
 DECLARE_CLASS(STM32L4_NVIC)
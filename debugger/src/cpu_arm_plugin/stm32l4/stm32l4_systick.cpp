@@ -25,8 +25,11 @@ STM32L4_SysTick::STM32L4_SysTick(const char *name) : IService(name),
     STK_VAL(this, "STK_VAL", 0x08),
     STK_CALIB(this, "STK_CALIB", 0x0C) {
     registerAttribute("CPU", &cpu_);
+    registerAttribute("IrqController", &irqController_);
     registerAttribute("IrqLine", &irqLine_);
 
+    iclk_ = 0;
+    iirq_ = 0;
     lastReloadTime_ = 0;
 }
 
@@ -44,10 +47,12 @@ void STM32L4_SysTick::postinitService() {
         return;
     }
 
-    icpu_ = static_cast<ICpuGeneric *>(
-        RISCV_get_service_iface(cpu_.to_string(), IFACE_CPU_GENERIC));
-    if (!icpu_) {
-        RISCV_error("Can't find ICpuRiscV interface %s", cpu_.to_string());
+    iirq_ = static_cast<IIrqController *>(
+        RISCV_get_service_iface(irqController_.to_string(),
+                                IFACE_IRQ_CONTROLLER));
+    if (!iirq_) {
+        RISCV_error("Can't find IIrqController interface %s",
+                    irqController_.to_string());
         return;
     }
 }
@@ -60,7 +65,8 @@ void STM32L4_SysTick::stepCallback(uint64_t t) {
     ctrl.b.COUNTFLAG = 1;
     STK_CTRL.setValue(ctrl.v);
     if (ctrl.b.TICKINT) {
-        icpu_->raiseSignal(irqLine_.to_int());
+        // Exception number to system IRQn of the controller
+        iirq_->requestInterrupt(irqLine_.to_int() - 16);
     }
     if (ctrl.b.ENABLE) {
         iclk_->moveStepCallback(static_cast<IClockListener *>(this), t + dt);
@@ -76,9 +82,52 @@ uint64_t STM32L4_SysTick::getReloadSteps() {
     return ret;
 }
 
+/**
+ * Counter runs from STK_LOAD down to 0 and reloaded on the next tick,
+ * so the value is computed from the last reload time instead of
+ * updating register on each step.
+ */
+uint32_t STM32L4_SysTick::getCurrentValue() {
+    STK_CTRL_TYPE::value_type ctrl = STK_CTRL.getTyped();
+    uint64_t load = STK_LOAD.getValue().val & 0x00FFFFFF;
+    uint64_t ticks = iclk_->getStepCounter() - lastReloadTime_;
+    if (ctrl.b.CLKSOURCE == 0) {
+        ticks >>= 3;
+    }
+    return static_cast<uint32_t>(load - ticks % (load + 1));
+}
+
+/** Any write clears the counter and restarts it from STK_LOAD */
+void STM32L4_SysTick::clearCurrentValue() {
+    STK_CTRL_TYPE::value_type ctrl = STK_CTRL.getTyped();
+    ctrl.b.COUNTFLAG = 0;
+    STK_CTRL.setValue(ctrl.v);
+    if (ctrl.b.ENABLE) {
+        lastReloadTime_ = iclk_->getStepCounter();
+        iclk_->moveStepCallback(static_cast<IClockListener *>(this),
+                                lastReloadTime_ + getReloadSteps());
+    }
+}
+
+/**
+ * Counter resumes from the value frozen in STK_VAL on disable. The reload
+ * time is moved back, so the next reload happens after STK_VAL + 1 ticks
+ * and the following periods are taken from STK_LOAD. Cleared STK_VAL, or
+ * a value above STK_LOAD, starts a full period.
+ */
 void STM32L4_SysTick::enableCounter() {
+    STK_CTRL_TYPE::value_type ctrl = STK_CTRL.getTyped();
     uint64_t dt = getReloadSteps();
-    lastReloadTime_ = iclk_->getStepCounter();
+    uint64_t load = STK_LOAD.getValue().val & 0x00FFFFFF;
+    uint64_t val = STK_VAL.getValue().val & 0x00FFFFFF;
+    uint64_t elapsed = 0;
+    if (val != 0 && val <= load) {
+        elapsed = load - val;
+        if (ctrl.b.CLKSOURCE == 0) {
+            elapsed *= 8;
+        }
+    }
+    lastReloadTime_ = iclk_->getStepCounter() - elapsed;
     iclk_->moveStepCallback(static_cast<IClockListener *>(this),
          lastReloadTime_ + dt);
 
@@ -87,6 +136,7 @@ void STM32L4_SysTick::enableCounter() {
 }
 
 void STM32L4_SysTick::disableCounter() {
+    STK_VAL.setValue(getCurrentValue());
     RISCV_info("%s", "Disable Counter");
 }
 
@@ -127,6 +177,19 @@ uint32_t STM32L4_SysTick::STK_CTRL_TYPE::aboutToWrite(uint32_t cur_val) {
     return cur_val;
 }
 
+uint32_t STM32L4_SysTick::STK_VAL_TYPE::aboutToRead(uint32_t cur_val) {
+    STM32L4_SysTick *p = static_cast<STM32L4_SysTick *>(parent_);
+    if (p->STK_CTRL.getTyped().b.ENABLE == 0) {
+        return cur_val;
+    }
+    return p->getCurrentValue();
+}
+
+uint32_t STM32L4_SysTick::STK_VAL_TYPE::aboutToWrite(uint32_t cur_val) {
+    STM32L4_SysTick *p = static_cast<STM32L4_SysTick *>(parent_);
+    p->clearCurrentValue();
+    return 0;
+}
 
 }  // namespace debugger
 
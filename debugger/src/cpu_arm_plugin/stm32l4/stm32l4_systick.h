@@ -22,7 +22,7 @@
 #include "coreservices/imemop.h"
 #include "coreservices/iclock.h"
 #include "coreservices/iwire.h"
-#include "coreservices/icpugen.h"
+#include "coreservices/iirqctrl.h"
 #include "generic/mapreg.h"
 #include "generic/rmembank_gen1.h"
 
@@ -45,13 +45,16 @@ class STM32L4_SysTick : public IService,
     void enableInterrupt();
     void disableInterrupt();
     uint64_t getReloadSteps();
+    uint32_t getCurrentValue();
+    void clearCurrentValue();
 
  protected:
     AttributeType cpu_;
+    AttributeType irqController_;
     AttributeType irqLine_;
 
     IClock *iclk_;
-    ICpuGeneric *icpu_;
+    IIrqController *iirq_;
 
     class STK_CTRL_TYPE : public MappedReg32Type {
      public:
@@ -84,9 +87,21 @@ class STM32L4_SysTick : public IService,
     };
 
 
+    // Current value is derived from the step counter on read
+    class STK_VAL_TYPE : public MappedReg32Type {
+     public:
+        STK_VAL_TYPE(IService *parent, const char *name, uint64_t addr) :
+                    MappedReg32Type(parent, name, addr) {
+        }
+     protected:
+        virtual uint32_t aboutToRead(uint32_t cur_val) override;
+        virtual uint32_t aboutToWrite(uint32_t cur_val) override;
+    };
+
+
     STK_CTRL_TYPE STK_CTRL;          // 0x00
     MappedReg32Type STK_LOAD;          // 0x04
-    MappedReg32Type STK_VAL;           // 0x08
+    STK_VAL_TYPE STK_VAL;              // 0x08
     MappedReg32Type STK_CALIB;         // 0x0C
     uint64_t lastReloadTime_;
 };
@@ -37,7 +37,6 @@ class ADC_I_T1 : public T1Instruction {
         uint32_t imm3 = (ti1 >> 12) & 0x7;
         uint32_t d = (ti1 >> 8) & 0xF;
         uint32_t imm8 = ti1 & 0xFF;
-        uint32_t overflow;
         uint32_t carry;
         uint32_t result;
         uint32_t Rn = static_cast<uint32_t>(R[n]);
@@ -47,13 +46,11 @@ class ADC_I_T1 : public T1Instruction {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        result = AddWithCarry(Rn, imm32, icpu_->getC(), &overflow, &carry);
+        uint32_t carry_in = icpu_->getC();
+        result = Rn + imm32 + carry_in;
         icpu_->setReg(d, result);
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(Rn, imm32, carry_in, result);
         }
         return 4;
     }
@@ -68,23 +65,15 @@ class ADD_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint32_t imm32 = (ti >> 6) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t overflow;
-        uint32_t carry;
         uint32_t result;
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
 
-        result = AddWithCarry(Rn, imm32, 0, &overflow, &carry);
-        icpu_->setReg(d, result);
+        result = Rn + op->imm32;
+        icpu_->setReg(op->d, result);
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(Rn, op->imm32, 0, result);
         }
         return 2;
     }
@@ -98,23 +87,16 @@ class ADD_I_T2 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t dn = (ti >> 8) & 0x7;
-        uint32_t imm32 = ti & 0xFF;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t overflow;
-        uint32_t carry;
         uint32_t result;
-        uint32_t Rn = static_cast<uint32_t>(R[dn]);
+        uint32_t Rn = static_cast<uint32_t>(R[op->d]);
 
-        result = AddWithCarry(Rn, imm32, 0, &overflow, &carry);
-        icpu_->setReg(dn, result);
+        result = Rn + op->imm32;
+        icpu_->setReg(op->d, result);
         if (setflags) {
             // Mask 0x7 no need to check on SP or PC
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(Rn, op->imm32, 0, result);
         }
         return 2;
     }
@@ -137,7 +119,6 @@ class ADD_I_T3 : public T1Instruction {
         uint32_t imm3 = (ti1 >> 12) & 0x7;
         uint32_t imm8 = ti1 & 0xFF;
         uint32_t imm12 = (i << 11) | (imm3 << 8) | imm8;
-        uint32_t overflow;
         uint32_t carry;
         uint32_t result;
         uint32_t imm32 = ThumbExpandImmWithC(imm12, &carry);
@@ -147,14 +128,11 @@ class ADD_I_T3 : public T1Instruction {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        result = AddWithCarry(Rn, imm32, 0, &overflow, &carry);
+        result = Rn + imm32;
         icpu_->setReg(d, result);
         if (setflags) {
             // Mask 0x7 no need to check on SP or PC
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(Rn, imm32, 0, result);
         }
         return 4;
     }
@@ -169,25 +147,17 @@ class ADD_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint32_t m = (ti >> 6) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
-        uint32_t carry;
-        uint32_t overflow;
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
         uint32_t result;
 
-        result = AddWithCarry(Rn, Rm, 0, &overflow, &carry);
-        icpu_->setReg(d, result);
+        result = Rn + Rm;
+        icpu_->setReg(op->d, result);
         if (setflags) {
             // Mask 0x7 no need to check on SP or PC
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(Rn, Rm, 0, result);
         }
         return 2;
     }
@@ -201,19 +171,16 @@ class ADD_R_T2 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t m = (ti >> 3) & 0xF;
-        uint32_t DN = (ti >> 7) & 0x1;
-        uint32_t dn = (DN << 3) | (ti & 0x7);
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
-        uint32_t Rn = static_cast<uint32_t>(R[dn]);
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
+        uint32_t Rn = static_cast<uint32_t>(R[op->d]);
         uint32_t carry;
         uint32_t overflow;
         uint32_t result;
 
         result = AddWithCarry(Rn, Rm, 0, &overflow, &carry);
-        icpu_->setReg(dn, result);
-        if (dn == Reg_pc) {
+        icpu_->setReg(op->d, result);
+        if (op->d == Reg_pc) {
             ALUWritePC(result);
         }
         return 2;
@@ -238,7 +205,6 @@ class ADD_R_T3 : public T1Instruction {
         uint32_t imm2 = (ti1 >> 6) & 0x3;
         uint32_t type = (ti1 >> 4) & 0x3;
         uint32_t shift_n;
-        uint32_t overflow;
         uint32_t carry;
         uint32_t result;
         uint32_t shifted;
@@ -252,17 +218,14 @@ class ADD_R_T3 : public T1Instruction {
         }
 
         shifted = Shift_C(Rm, shift_t, shift_n, icpu_->getC(), &carry);
-        result = AddWithCarry(Rn, shifted, 0, &overflow, &carry);
+        result = Rn + shifted;
         icpu_->setReg(d, result);
         if (d == Reg_pc) {
             ALUWritePC(result);     // setflags always FALSE
         } else {
             if (setflags) {
                 // Mask 0x7 no need to check on SP or PC
-                icpu_->setN((result >> 31) & 1);
-                icpu_->setZ(result == 0 ? 1: 0);
-                icpu_->setC(carry);
-                icpu_->setV(overflow);
+                icpu_->setFlagsNZCV(Rn, shifted, 0, result);
             }
         }
         return 4;
@@ -278,16 +241,14 @@ class ADDSP_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = (ti >> 8) & 0x7;
-        uint32_t imm32 = (ti & 0xFF) << 2;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t overflow;
         uint32_t carry;
         uint32_t result;
         uint32_t SP = static_cast<uint32_t>(R[Reg_sp]);
 
-        result = AddWithCarry(SP, imm32, 0, &overflow, &carry);
-        icpu_->setReg(d, result);
+        result = AddWithCarry(SP, op->imm32, 0, &overflow, &carry);
+        icpu_->setReg(op->d, result);
         return 2;
     }
 };
@@ -300,14 +261,13 @@ class ADDSP_I_T2 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t imm32 = (ti & 0x7F) << 2;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t overflow;
         uint32_t carry;
         uint32_t result;
         uint32_t SP = static_cast<uint32_t>(R[Reg_sp]);
 
-        result = AddWithCarry(SP, imm32, 0, &overflow, &carry);
+        result = AddWithCarry(SP, op->imm32, 0, &overflow, &carry);
         icpu_->setReg(Reg_sp, result);
         return 2;
     }
@@ -322,13 +282,11 @@ class ADR_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = (ti >> 8) & 0x7;
-        uint32_t imm32 = (ti & 0xFF) << 2;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t pc = static_cast<uint32_t>(icpu_->getPC()) + 4;
 
         pc &= ~0x3;             // Word-aligned PC
-        icpu_->setReg(d, pc + imm32);
+        icpu_->setReg(op->d, pc + op->imm32);
         return 2;
     }
 };
@@ -363,9 +321,8 @@ class AND_I_T1 : public T1Instruction {
         icpu_->setReg(d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 4;
@@ -381,19 +338,16 @@ class AND_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t dn = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
-        uint32_t Rn = static_cast<uint32_t>(R[dn]);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
+        uint32_t Rn = static_cast<uint32_t>(R[op->d]);
         uint32_t result = Rn & Rm;
 
-        icpu_->setReg(dn, result);
+        icpu_->setReg(op->d, result);
         if (setflags) {
             // Mask 0x7 no need to check on SP or PC
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
+            icpu_->setFlagsNZ(result);
             // C the same because no shoft
             // V unchanged
         }
@@ -435,9 +389,8 @@ class AND_R_T2 : public T1Instruction {
         icpu_->setReg(d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 4;
@@ -453,24 +406,20 @@ class ASR_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t result;
-        uint32_t d = ti  & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
         bool setflags = !icpu_->InITBlock();
-        uint32_t imm5 = (ti >> 6) & 0x1F;
         uint32_t shift_n;
         uint32_t carry;
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
 
-        DecodeImmShift(2, imm5, &shift_n);
+        DecodeImmShift(2, op->imm32, &shift_n);
         result = Shift_C(Rm, SRType_ASR, shift_n, icpu_->getC(), &carry);
-        icpu_->setReg(d, result);
+        icpu_->setReg(op->d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 2;
@@ -482,24 +431,21 @@ class B_T1 : public T1Instruction {
  public:
     B_T1(CpuCortex_Functional *icpu) : T1Instruction(icpu, "B") {}
 
+    virtual bool isConditionalBranch() { return true; }
+
     virtual int exec(Reg64Type *payload) {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t cond = (ti >> 8) & 0xF;
-        uint32_t imm8 = ti & 0xFF;
-        uint32_t imm32 = imm8 << 1;
-        if (ti & 0x80) {
-            imm32 |= (~0ul) << 9;
-        }
+        ThumbOperandsType *op = thumbOperands(payload);
 
         if (icpu_->InITBlock()) {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        if (check_cond(icpu_, cond)) {
-            uint32_t npc = static_cast<uint32_t>(icpu_->getPC()) + 4 + imm32;
+        if (check_cond(icpu_, op->cond)) {
+            uint32_t npc = static_cast<uint32_t>(icpu_->getPC()) + 4
+                         + op->imm32;
             BranchWritePC(npc);
         }
         return 2;
@@ -514,18 +460,13 @@ class B_T2 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t imm11 = ti & 0x7FF;
-        uint32_t imm32 = imm11 << 1;
-        if (ti & 0x400) {
-            imm32 |= (~0ul) << 12;
-        }
+        ThumbOperandsType *op = thumbOperands(payload);
 
         if (icpu_->InITBlock() && !icpu_->LastInITBlock()) {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        uint32_t npc = static_cast<uint32_t>(icpu_->getPC()) + 4 + imm32;
+        uint32_t npc = static_cast<uint32_t>(icpu_->getPC()) + 4 + op->imm32;
         BranchWritePC(npc);
         return 2;
     }
@@ -535,6 +476,8 @@ class B_T3 : public T1Instruction {
  public:
     B_T3(CpuCortex_Functional *icpu) : T1Instruction(icpu, "B.W") {}
 
+    virtual bool isConditionalBranch() { return true; }
+
     virtual int exec(Reg64Type *payload) {
         if (!ConditionPassed()) {
             return 4;
@@ -626,9 +569,8 @@ class BIC_I_T1 : public T1Instruction {
         icpu_->setReg(d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 4;
@@ -691,12 +633,11 @@ class BLX_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t m = (ti >> 3) & 0xF;
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
         uint64_t next_instr_addr = icpu_->getPC() + 4 - 2;
 
-        if (m == Reg_pc) {
+        if (op->m == Reg_pc) {
             RISCV_error("%s", "UNPREDICTABLE");
         }
         if (icpu_->InITBlock() && !icpu_->LastInITBlock()) {
@@ -718,14 +659,13 @@ class BX_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t instr0 = payload->buf16[0];
-        uint32_t m = (instr0 >> 3) & 0xF;
+        ThumbOperandsType *op = thumbOperands(payload);
 
         if (icpu_->InITBlock() && !icpu_->LastInITBlock()) {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
         BXWritePC(Rm);
         return 2;
     }
@@ -736,22 +676,21 @@ class CBNZ_T1 : public T1Instruction {
  public:
     CBNZ_T1(CpuCortex_Functional *icpu) : T1Instruction(icpu, "CBNZ") {}
 
+    virtual bool isConditionalBranch() { return true; }
+
     virtual int exec(Reg64Type *payload) {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t n = ti & 0x7;
-        uint32_t imm5 = (ti >> 3) & 0x1F;
-        uint32_t i = (ti >> 9) & 0x1;
-        uint32_t imm32 = (i << 6) | (imm5 << 1);
+        ThumbOperandsType *op = thumbOperands(payload);
 
         if (icpu_->InITBlock()) {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        if (R[n] != 0) {
-            uint32_t npc = static_cast<uint32_t>(icpu_->getPC()) + 4 + imm32;
+        if (R[op->n] != 0) {
+            uint32_t npc = static_cast<uint32_t>(icpu_->getPC()) + 4
+                         + op->imm32;
             BranchWritePC(npc);
         }
         return 2;
@@ -763,22 +702,21 @@ class CBZ_T1 : public T1Instruction {
  public:
     CBZ_T1(CpuCortex_Functional *icpu) : T1Instruction(icpu, "CBZ") {}
 
+    virtual bool isConditionalBranch() { return true; }
+
     virtual int exec(Reg64Type *payload) {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t n = ti & 0x7;
-        uint32_t imm5 = (ti >> 3) & 0x1F;
-        uint32_t i = (ti >> 9) & 0x1;
-        uint32_t imm32 = (i << 6) | (imm5 << 1);
+        ThumbOperandsType *op = thumbOperands(payload);
 
         if (icpu_->InITBlock()) {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        if (R[n] == 0) {
-            uint32_t npc = static_cast<uint32_t>(icpu_->getPC()) + 4 + imm32;
+        if (R[op->n] == 0) {
+            uint32_t npc = static_cast<uint32_t>(icpu_->getPC()) + 4
+                         + op->imm32;
             BranchWritePC(npc);
         }
         return 2;
@@ -794,20 +732,13 @@ class CMP_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t carry;
-        uint32_t overflow;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t result;
-        uint32_t n = (ti >> 8) & 0x7;
-        uint32_t imm32 = ti & 0xFF;
 
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
-        result = AddWithCarry(Rn, ~imm32, 1, &overflow, &carry);
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
+        result = Rn + ~op->imm32 + 1;
 
-        icpu_->setN((result >> 31) & 1);
-        icpu_->setZ(result == 0 ? 1: 0);
-        icpu_->setC(carry);
-        icpu_->setV(overflow);
+        icpu_->setFlagsNZCV(Rn, ~op->imm32, 1, result);
         return 2;
     }
 };
@@ -823,7 +754,6 @@ class CMP_I_T2 : public T1Instruction {
         uint32_t ti = payload->buf16[0];
         uint32_t ti1 = payload->buf16[1];
         uint32_t carry;
-        uint32_t overflow;
         uint32_t result;
         uint32_t n = ti & 0xF;
         uint32_t i = (ti >> 10) & 1;
@@ -837,12 +767,9 @@ class CMP_I_T2 : public T1Instruction {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        result = AddWithCarry(Rn, ~imm32, 1, &overflow, &carry);
+        result = Rn + ~imm32 + 1;
 
-        icpu_->setN((result >> 31) & 1);
-        icpu_->setZ(result == 0 ? 1: 0);
-        icpu_->setC(carry);
-        icpu_->setV(overflow);
+        icpu_->setFlagsNZCV(Rn, ~imm32, 1, result);
         return 4;
     }
 };
@@ -856,21 +783,14 @@ class CMP_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t carry;
-        uint32_t overflow;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t result;
-        uint32_t n = ti  & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
 
-        uint32_t shifted = static_cast<uint32_t>(R[m]); // no shifting
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
-        result = AddWithCarry(Rn, ~shifted, 1, &overflow, &carry);
+        uint32_t shifted = static_cast<uint32_t>(R[op->m]); // no shifting
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
+        result = Rn + ~shifted + 1;
 
-        icpu_->setN((result >> 31) & 1);
-        icpu_->setZ(result == 0 ? 1: 0);
-        icpu_->setC(carry);
-        icpu_->setV(overflow);
+        icpu_->setFlagsNZCV(Rn, ~shifted, 1, result);
         return 2;
     }
 };
@@ -883,29 +803,21 @@ class CMP_R_T2 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t carry;
-        uint32_t overflow;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t result;
-        uint32_t N = (ti >> 7) & 0x1;
-        uint32_t n = (N << 3) | (ti  & 0x7);
-        uint32_t m = (ti >> 3) & 0xF;
 
-        if (n < 8 && m < 8) {
+        if (op->n < 8 && op->m < 8) {
             RISCV_error("%s", "UNPREDICTABLE");
         }
-        if (n == Reg_pc) {
+        if (op->n == Reg_pc) {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        uint32_t shifted = static_cast<uint32_t>(R[m]); // no shifting
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
-        result = AddWithCarry(Rn, ~shifted, 1, &overflow, &carry);
+        uint32_t shifted = static_cast<uint32_t>(R[op->m]); // no shifting
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
+        result = Rn + ~shifted + 1;
 
-        icpu_->setN((result >> 31) & 1);
-        icpu_->setZ(result == 0 ? 1: 0);
-        icpu_->setC(carry);
-        icpu_->setV(overflow);
+        icpu_->setFlagsNZCV(Rn, ~shifted, 1, result);
         return 2;
     }
 };
@@ -984,9 +896,8 @@ class EOR_I_T1 : public T1Instruction {
         icpu_->setReg(d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 4;
@@ -1002,19 +913,16 @@ class EOR_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t dn = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
-        uint32_t Rn = static_cast<uint32_t>(R[dn]);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
+        uint32_t Rn = static_cast<uint32_t>(R[op->d]);
         uint32_t result = Rn ^ Rm;
 
-        icpu_->setReg(dn, result);
+        icpu_->setReg(op->d, result);
         if (setflags) {
             // Mask 0x7 no need to check on SP or PC
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
+            icpu_->setFlagsNZ(result);
             // C the same because no shoft
             // V unchanged
         }
@@ -1120,13 +1028,10 @@ class LDR_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t instr = payload->buf16[0];
-        uint32_t t = instr & 0x7;
-        uint32_t n = (instr >> 3) & 0x7;
-        uint32_t imm32 = ((instr >> 6) & 0x1F) << 2;
-        uint32_t address = static_cast<uint32_t>(R[n]) + imm32;
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t address = static_cast<uint32_t>(R[op->n]) + op->imm32;
 
-        if (t == Reg_pc) {
+        if (op->d == Reg_pc) {
             if (trans_.addr & 0x3) {
                 RISCV_error("%s", "UNPREDICTABLE");
             } else {
@@ -1138,7 +1043,7 @@ class LDR_I_T1 : public T1Instruction {
             trans_.xsize = 4;
             trans_.wstrb = 0;
             icpu_->dma_memop(&trans_);
-            icpu_->setReg(t, trans_.rpayload.b32[0]);
+            icpu_->setReg(op->d, trans_.rpayload.b32[0]);
         }
 
         return 2;
@@ -1153,18 +1058,16 @@ class LDR_I_T2 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = (ti >> 8) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t Rn = static_cast<uint32_t>(R[Reg_sp]);
-        uint32_t imm32 = (ti & 0xFF) << 2;
 
-        trans_.addr = Rn + imm32;
+        trans_.addr = Rn + op->imm32;
         trans_.action = MemAction_Read;
         trans_.xsize = 4;
         trans_.wstrb = 0;
         icpu_->dma_memop(&trans_);
 
-        icpu_->setReg(t, trans_.rpayload.b32[0]);
+        icpu_->setReg(op->d, trans_.rpayload.b32[0]);
         return 2;
     }
 };
@@ -1264,14 +1167,12 @@ class LDR_L_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = (ti >> 8) & 0x7;
-        uint32_t imm8 = (ti & 0xFF) << 2;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t base = static_cast<uint32_t>(icpu_->getPC()) + 4;
         base &= ~0x3;  // Align(base, 4)
-        uint32_t address = base + imm8;
+        uint32_t address = base + op->imm32;
 
-        if (t == Reg_pc) {
+        if (op->d == Reg_pc) {
             if (address & 0x3) {
                 RISCV_error("%s", "UNPREDICTABLE");
             } else {
@@ -1283,7 +1184,7 @@ class LDR_L_T1 : public T1Instruction {
             trans_.xsize = 4;
             trans_.wstrb = 0;
             icpu_->dma_memop(&trans_);
-            icpu_->setReg(t, trans_.rpayload.b32[0]);
+            icpu_->setReg(op->d, trans_.rpayload.b32[0]);
         }
 
         return 2;
@@ -1340,19 +1241,16 @@ class LDR_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t instr = payload->buf16[0];
-        uint32_t t = instr & 0x7;
-        uint32_t n = (instr >> 3) & 0x7;
-        uint32_t m = (instr >> 6) & 0x7;
-        uint32_t address = static_cast<uint32_t>(R[n])
-                         + static_cast<uint32_t>(R[m]);
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t address = static_cast<uint32_t>(R[op->n])
+                         + static_cast<uint32_t>(R[op->m]);
 
         trans_.addr = address;
         trans_.action = MemAction_Read;
         trans_.xsize = 4;
         trans_.wstrb = 0;
         icpu_->dma_memop(&trans_);
-        icpu_->setReg(t, trans_.rpayload.b32[0]);
+        icpu_->setReg(op->d, trans_.rpayload.b32[0]);
         return 2;
     }
 };
@@ -1410,17 +1308,14 @@ class LDRB_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint32_t imm32 = (ti >> 6) & 0x1F;
+        ThumbOperandsType *op = thumbOperands(payload);
 
-        trans_.addr = static_cast<uint32_t>(R[n]) + imm32;
+        trans_.addr = static_cast<uint32_t>(R[op->n]) + op->imm32;
         trans_.action = MemAction_Read;
         trans_.xsize = 1;
         trans_.wstrb = 0;
         icpu_->dma_memop(&trans_);
-        icpu_->setReg(t, trans_.rpayload.b8[0]);
+        icpu_->setReg(op->d, trans_.rpayload.b8[0]);
         return 2;
     }
 };
@@ -1502,22 +1397,20 @@ class LDRB_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint32_t m = (ti >> 6) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         int shift_n = 0;
         uint32_t c_out;
 
-        uint32_t address = static_cast<uint32_t>(R[n])
-                         + LSL_C(static_cast<uint32_t>(R[m]), shift_n, &c_out);
+        uint32_t address = static_cast<uint32_t>(R[op->n])
+                         + LSL_C(static_cast<uint32_t>(R[op->m]), shift_n,
+                                 &c_out);
 
         trans_.addr = address;
         trans_.action = MemAction_Read;
         trans_.xsize = 1;
         trans_.wstrb = 0;
         icpu_->dma_memop(&trans_);
-        icpu_->setReg(t, trans_.rpayload.b8[0]);
+        icpu_->setReg(op->d, trans_.rpayload.b8[0]);
         return 2;
     }
 };
@@ -1564,17 +1457,14 @@ class LDRH_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint32_t imm32 = ((ti >> 6) & 0x1F) << 1;
+        ThumbOperandsType *op = thumbOperands(payload);
 
-        trans_.addr = static_cast<uint32_t>(R[n]) + imm32;
+        trans_.addr = static_cast<uint32_t>(R[op->n]) + op->imm32;
         trans_.action = MemAction_Read;
         trans_.xsize = 2;
         trans_.wstrb = 0;
         icpu_->dma_memop(&trans_);
-        icpu_->setReg(t, trans_.rpayload.b16[0]);
+        icpu_->setReg(op->d, trans_.rpayload.b16[0]);
         return 2;
     }
 };
@@ -1657,12 +1547,9 @@ class LDRSB_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t m = (ti >> 6) & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint32_t t = ti & 0x7;
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
-        uint32_t shifted = static_cast<uint32_t>(R[m]);  // no shift
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
+        uint32_t shifted = static_cast<uint32_t>(R[op->m]);  // no shift
         uint32_t address = Rn + shifted;
 
         trans_.addr = address;
@@ -1671,7 +1558,7 @@ class LDRSB_R_T1 : public T1Instruction {
         trans_.wstrb = 0;
         icpu_->dma_memop(&trans_);
         int32_t result = static_cast<int8_t>(trans_.rpayload.b8[0]);
-        icpu_->setReg(t, static_cast<uint32_t>(result));
+        icpu_->setReg(op->d, static_cast<uint32_t>(result));
         return 2;
     }
 };
@@ -1720,24 +1607,20 @@ class LSL_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t imm5 = (ti >> 6) & 0x1F;
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
         uint32_t carry;
         uint32_t shift_n;
         uint32_t result;
 
-        DecodeImmShift(0, imm5, &shift_n);
+        DecodeImmShift(0, op->imm32, &shift_n);
         result = Shift_C(Rm, SRType_LSL, shift_n, icpu_->getC(), &carry);
-        icpu_->setReg(d, result);
+        icpu_->setReg(op->d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 2;
@@ -1753,22 +1636,19 @@ class LSL_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t dn = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t shift_n = static_cast<uint32_t>(R[m] & 0xFF);
-        uint32_t Rn = static_cast<uint32_t>(R[dn]);
+        uint32_t shift_n = static_cast<uint32_t>(R[op->m] & 0xFF);
+        uint32_t Rn = static_cast<uint32_t>(R[op->d]);
         uint32_t carry;
         uint32_t result;
 
         result = Shift_C(Rn, SRType_LSL, shift_n, icpu_->getC(), &carry);
-        icpu_->setReg(dn, result);
+        icpu_->setReg(op->d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 2;
@@ -1802,9 +1682,8 @@ class LSL_R_T2 : public T1Instruction {
         icpu_->setReg(d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 4;
@@ -1820,24 +1699,20 @@ class LSR_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t imm5 = (ti >> 6) & 0x1F;
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
         uint32_t carry;
         uint32_t shift_n;
         uint32_t result;
 
-        DecodeImmShift(1, imm5, &shift_n);
+        DecodeImmShift(1, op->imm32, &shift_n);
         result = Shift_C(Rm, SRType_LSR, shift_n, icpu_->getC(), &carry);
-        icpu_->setReg(d, result);
+        icpu_->setReg(op->d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 2;
@@ -1853,22 +1728,19 @@ class LSR_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t dn = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t shift_n = static_cast<uint32_t>(R[m] & 0xFF);
-        uint32_t Rn = static_cast<uint32_t>(R[dn]);
+        uint32_t shift_n = static_cast<uint32_t>(R[op->m] & 0xFF);
+        uint32_t Rn = static_cast<uint32_t>(R[op->d]);
         uint32_t carry;
         uint32_t result;
 
         result = Shift_C(Rn, SRType_LSR, shift_n, icpu_->getC(), &carry);
-        icpu_->setReg(dn, result);
+        icpu_->setReg(op->d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 2;
@@ -1902,9 +1774,8 @@ class LSR_R_T2 : public T1Instruction {
         icpu_->setReg(d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 4;
@@ -1976,18 +1847,15 @@ class MOV_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t instr = payload->buf16[0];
-        uint32_t d = (instr >> 8) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t imm32 = instr  & 0xFF;
         uint32_t carry = icpu_->getC();
 
-        icpu_->setReg(d, imm32);
+        icpu_->setReg(op->d, op->imm32);
 
         if (setflags) {
-            icpu_->setN((imm32 >> 31) & 1);
-            icpu_->setZ(imm32 == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(op->imm32);
             // V unchanged
         }
         return 2;
@@ -2021,9 +1889,8 @@ class MOV_I_T2 : public T1Instruction {
         icpu_->setReg(d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 4;
@@ -2066,17 +1933,14 @@ class MOV_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t D = (ti >> 7) & 1;
-        uint32_t d = (D << 3) | (ti & 0x7);
-        uint32_t m = (ti >> 3) & 0xF;
-        uint32_t result = static_cast<uint32_t>(R[m]);
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t result = static_cast<uint32_t>(R[op->m]);
 
-        if (d == Reg_pc && icpu_->InITBlock() && !icpu_->LastInITBlock()) {
+        if (op->d == Reg_pc && icpu_->InITBlock() && !icpu_->LastInITBlock()) {
             RISCV_error("%s", "UNPREDICTABLE");
         }
-        icpu_->setReg(d, result);
-        if (d == Reg_pc) {
+        icpu_->setReg(op->d, result);
+        if (op->d == Reg_pc) {
             ALUWritePC(result);   // ALUWritePC
         }
         return 2;
@@ -2091,19 +1955,16 @@ class MOV_R_T2 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
-        uint32_t result = static_cast<uint32_t>(R[m]);
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t result = static_cast<uint32_t>(R[op->m]);
 
         if (icpu_->InITBlock()) {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        icpu_->setReg(d, result);           // d < 8 always
-        icpu_->setN((result >> 31) & 1);
-        icpu_->setZ(result == 0 ? 1: 0);
+        icpu_->setReg(op->d, result);       // d < 8 always
         icpu_->setC(0);     // No data in specification
+        icpu_->setFlagsNZ(result);
         return 2;
     }
 };
@@ -2117,19 +1978,16 @@ class MUL_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t n = (ti >> 3) & 0x7;
-        uint32_t dm = ti & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
-        uint32_t Rm = static_cast<uint32_t>(R[dm]);
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
+        uint32_t Rm = static_cast<uint32_t>(R[op->d]);
         uint32_t result;
 
         result = Rn * Rm;
-        icpu_->setReg(dm, result);
+        icpu_->setReg(op->d, result);
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
+            icpu_->setFlagsNZ(result);
         }
         return 2;
     }
@@ -2170,16 +2028,13 @@ class MVN_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t result = ~static_cast<uint32_t>(R[m]);
+        uint32_t result = ~static_cast<uint32_t>(R[op->m]);
 
-        icpu_->setReg(d, result);
+        icpu_->setReg(op->d, result);
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
+            icpu_->setFlagsNZ(result);
             // No shift no C
             // V unchanged
         }
@@ -2227,9 +2082,8 @@ class ORR_I_T1 : public T1Instruction {
         icpu_->setReg(d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 4;
@@ -2245,19 +2099,16 @@ class ORR_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t dn = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
-        uint32_t Rn = static_cast<uint32_t>(R[dn]);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
+        uint32_t Rn = static_cast<uint32_t>(R[op->d]);
         uint32_t result = Rn | Rm;
 
-        icpu_->setReg(dn, result);
+        icpu_->setReg(op->d, result);
         if (setflags) {
             // Mask 0x7 no need to check on SP or PC
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
+            icpu_->setFlagsNZ(result);
             // C the same because no shoft
             // V unchanged
         }
@@ -2299,9 +2150,8 @@ class ORR_R_T2 : public T1Instruction {
         icpu_->setReg(d, result);
 
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
             icpu_->setC(carry);
+            icpu_->setFlagsNZ(result);
             // V unchanged
         }
         return 4;
@@ -2431,23 +2281,16 @@ class RSB_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
         uint32_t imm32 = 0;     // Implicit zero immediate
-        uint32_t overflow;
-        uint32_t carry;
         uint32_t result;
 
-        result = AddWithCarry(~Rn, imm32, 1, &overflow, &carry);
-        icpu_->setReg(d, result);
+        result = ~Rn + imm32 + 1;
+        icpu_->setReg(op->d, result);
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(~Rn, imm32, 1, result);
         }
         return 2;
     }
@@ -2470,7 +2313,6 @@ class RSB_I_T2 : public T1Instruction {
         uint32_t imm3 = (ti1 >> 12) & 0x7;
         uint32_t i = (ti >> 10) & 1;
         uint32_t imm12 = (i << 11) | (imm3 << 8) | imm8;
-        uint32_t overflow;
         uint32_t carry;
         uint32_t result;
         uint32_t Rn = static_cast<uint32_t>(R[n]);
@@ -2480,13 +2322,10 @@ class RSB_I_T2 : public T1Instruction {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        result = AddWithCarry(~Rn, imm32, 1, &overflow, &carry);
+        result = ~Rn + imm32 + 1;
         icpu_->setReg(d, result);
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(~Rn, imm32, 1, result);
         }
         return 4;
     }
@@ -2511,8 +2350,6 @@ class RSB_R_T1 : public T1Instruction {
         uint32_t imm2 = (ti1 >> 6) & 0x3;
         uint32_t type = (ti1 >> 4) & 0x3;
         uint32_t shift_n;
-        uint32_t overflow;
-        uint32_t carry;
         uint32_t result;
         SRType shift_t = DecodeImmShift(type, (imm3 << 2) | imm2, &shift_n);
         uint32_t Rm = static_cast<uint32_t>(R[m]);
@@ -2523,13 +2360,10 @@ class RSB_R_T1 : public T1Instruction {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        result = AddWithCarry(~Rn, shifted, 1, &overflow, &carry);
+        result = ~Rn + shifted + 1;
         icpu_->setReg(d, result);
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(~Rn, shifted, 1, result);
         }
         return 4;
     }
@@ -2739,16 +2573,13 @@ class STR_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint64_t imm32 = ((ti >> 6) & 0x1F) << 2;
+        ThumbOperandsType *op = thumbOperands(payload);
 
-        trans_.addr = R[n] + imm32;
+        trans_.addr = R[op->n] + op->imm32;
         trans_.action = MemAction_Write;
         trans_.xsize = 4;
         trans_.wstrb = 0xF;
-        trans_.wpayload.b32[0] = static_cast<uint32_t>(R[t]);
+        trans_.wpayload.b32[0] = static_cast<uint32_t>(R[op->d]);
         icpu_->dma_memop(&trans_);
         return 2;
     }
@@ -2762,16 +2593,14 @@ class STR_I_T2 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = (ti >> 8) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t n = Reg_sp;
-        uint64_t imm32 = (ti & 0xFF) << 2;
 
-        trans_.addr = static_cast<uint32_t>(R[n]) + imm32;
+        trans_.addr = static_cast<uint32_t>(R[n]) + op->imm32;
         trans_.action = MemAction_Write;
         trans_.xsize = 4;
         trans_.wstrb = 0xF;
-        trans_.wpayload.b32[0] = static_cast<uint32_t>(R[t]);
+        trans_.wpayload.b32[0] = static_cast<uint32_t>(R[op->d]);
         icpu_->dma_memop(&trans_);
         return 2;
     }
@@ -2786,18 +2615,15 @@ class STR_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint32_t m = (ti >> 6) & 0x7;
-        uint32_t address = static_cast<uint32_t>(R[n])
-                         + static_cast<uint32_t>(R[m]);
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t address = static_cast<uint32_t>(R[op->n])
+                         + static_cast<uint32_t>(R[op->m]);
 
         trans_.addr = address;
         trans_.action = MemAction_Write;
         trans_.xsize = 4;
         trans_.wstrb = 0xF;
-        trans_.wpayload.b32[0] = static_cast<uint32_t>(R[t]);
+        trans_.wpayload.b32[0] = static_cast<uint32_t>(R[op->d]);
         icpu_->dma_memop(&trans_);
         return 2;
     }
@@ -2848,16 +2674,13 @@ class STRB_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint64_t imm32 = (ti >> 6) & 0x1F;
+        ThumbOperandsType *op = thumbOperands(payload);
 
-        trans_.addr = R[n] + imm32;
+        trans_.addr = R[op->n] + op->imm32;
         trans_.action = MemAction_Write;
         trans_.xsize = 1;
         trans_.wstrb = 0x1;
-        trans_.wpayload.b32[0] = static_cast<uint8_t>(R[t]);
+        trans_.wpayload.b32[0] = static_cast<uint8_t>(R[op->d]);
         icpu_->dma_memop(&trans_);
         return 2;
     }
@@ -2953,19 +2776,16 @@ class STRB_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint32_t m = (ti >> 6) & 0x7;
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
         // no shift
-        uint32_t address = static_cast<uint32_t>(R[n]);
+        uint32_t address = static_cast<uint32_t>(R[op->n]);
 
         trans_.addr = address + Rm;
         trans_.action = MemAction_Write;
         trans_.xsize = 1;
         trans_.wstrb = 0x1;
-        trans_.wpayload.b32[0] = static_cast<uint8_t>(R[t]);
+        trans_.wpayload.b32[0] = static_cast<uint8_t>(R[op->d]);
         icpu_->dma_memop(&trans_);
         return 2;
     }
@@ -3062,16 +2882,13 @@ class STRH_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t t = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
-        uint64_t imm32 = ((ti >> 6) & 0x1F) << 1;
+        ThumbOperandsType *op = thumbOperands(payload);
 
-        trans_.addr = R[n] + imm32;
+        trans_.addr = R[op->n] + op->imm32;
         trans_.action = MemAction_Write;
         trans_.xsize = 2;
         trans_.wstrb = 0x3;
-        trans_.wpayload.b32[0] = static_cast<uint16_t>(R[t]);
+        trans_.wpayload.b32[0] = static_cast<uint16_t>(R[op->d]);
         icpu_->dma_memop(&trans_);
         return 2;
     }
@@ -3158,23 +2975,15 @@ class SUB_I_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t overflow;
-        uint32_t carry;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t result;
-        uint32_t d = ti & 0x7;
-        uint32_t n = (ti >> 3) & 0x7;
         bool setflags = !icpu_->InITBlock();
-        uint32_t imm32 = (ti >> 6) & 0x7;
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
-        result = AddWithCarry(Rn, ~imm32, 1, &overflow, &carry);
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
+        result = Rn + ~op->imm32 + 1;
 
-        icpu_->setReg(d, result);
+        icpu_->setReg(op->d, result);
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(Rn, ~op->imm32, 1, result);
         }
         return 2;
     }
@@ -3188,22 +2997,15 @@ class SUB_I_T2 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t overflow;
-        uint32_t carry;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t result;
-        uint32_t dn = (ti >> 8) & 0x7;
         bool setflags = !icpu_->InITBlock();
-        uint32_t imm32 = ti & 0xFF;
-        uint32_t Rn = static_cast<uint32_t>(R[dn]);
-        result = AddWithCarry(Rn, ~imm32, 1, &overflow, &carry);
+        uint32_t Rn = static_cast<uint32_t>(R[op->d]);
+        result = Rn + ~op->imm32 + 1;
 
-        icpu_->setReg(dn, result);
+        icpu_->setReg(op->d, result);
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(Rn, ~op->imm32, 1, result);
         }
         return 2;
     }
@@ -3226,7 +3028,6 @@ class SUB_I_T3 : public T1Instruction {
         uint32_t imm3 = (ti1 >> 12) & 0x7;
         uint32_t imm8 = ti1 & 0xFF;
         uint32_t imm12 = (i << 11) | (imm3 << 8) | imm8;
-        uint32_t overflow;
         uint32_t carry;
         uint32_t result;
         uint32_t imm32 = ThumbExpandImmWithC(imm12, &carry);
@@ -3236,14 +3037,11 @@ class SUB_I_T3 : public T1Instruction {
             RISCV_error("%s", "UNPREDICTABLE");
         }
 
-        result = AddWithCarry(Rn, ~imm32, 1, &overflow, &carry);
+        result = Rn + ~imm32 + 1;
         icpu_->setReg(d, result);
         if (setflags) {
             // Mask 0x7 no need to check on SP or PC
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(Rn, ~imm32, 1, result);
         }
         return 4;
     }
@@ -3258,26 +3056,18 @@ class SUB_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t instr = payload->buf16[0];
-        uint32_t d = instr & 0x7;
-        uint32_t n = (instr >> 3) & 0x7;
-        uint32_t m = (instr >> 6) & 0x7;
+        ThumbOperandsType *op = thumbOperands(payload);
         bool setflags = !icpu_->InITBlock();
 
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
         
         uint32_t shifted = Rm;
-        uint32_t overflow;
-        uint32_t carry;
-        uint32_t result = AddWithCarry(Rn, ~shifted, 1, &overflow, &carry);
+        uint32_t result = Rn + ~shifted + 1;
 
-        icpu_->setReg(d, result);
+        icpu_->setReg(op->d, result);
         if (setflags) {
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(Rn, ~shifted, 1, result);
         }
         return 2;
     }
@@ -3301,7 +3091,6 @@ class SUB_R_T2 : public T1Instruction {
         uint32_t type = (ti1 >> 4) & 0x3;
         uint32_t m = ti1 & 0xF;
         uint32_t shift_n;
-        uint32_t overflow;
         uint32_t carry;
         uint32_t result;
         uint32_t shifted;
@@ -3315,15 +3104,12 @@ class SUB_R_T2 : public T1Instruction {
         }
 
         shifted = Shift_C(Rm, shift_t, shift_n, icpu_->getC(), &carry);
-        result = AddWithCarry(Rn, ~shifted, 1, &overflow, &carry);
+        result = Rn + ~shifted + 1;
         // d Cannot be Reg_pc, see CMP (register) T3_CMP_R
         icpu_->setReg(d, result);
         if (setflags) {
             // Mask 0x7 no need to check on SP or PC
-            icpu_->setN((result >> 31) & 1);
-            icpu_->setZ(result == 0 ? 1: 0);
-            icpu_->setC(carry);
-            icpu_->setV(overflow);
+            icpu_->setFlagsNZCV(Rn, ~shifted, 1, result);
         }
         return 4;
     }
@@ -3339,13 +3125,12 @@ class SUBSP_I_T1 : public T1Instruction {
             return 2;
         }
         uint32_t sp = static_cast<uint32_t>(R[Reg_sp]);
-        uint32_t instr = payload->buf16[0];
-        uint32_t imm32 = (instr & 0x7F) << 2;
+        ThumbOperandsType *op = thumbOperands(payload);
         uint32_t overflow;
         uint32_t carry;
         uint32_t result;
 
-        result = AddWithCarry(sp, ~imm32, 1, &overflow, &carry);
+        result = AddWithCarry(sp, ~op->imm32, 1, &overflow, &carry);
         icpu_->setReg(Reg_sp, result);
         // Not modify flags
         return 2;
@@ -3391,12 +3176,10 @@ class SXTB_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
-        int8_t rotated = static_cast<int8_t>(R[m]);  // no rotation
+        ThumbOperandsType *op = thumbOperands(payload);
+        int8_t rotated = static_cast<int8_t>(R[op->m]);  // no rotation
         uint32_t result = static_cast<uint32_t>(static_cast<int32_t>(rotated));
-        icpu_->setReg(d, result);
+        icpu_->setReg(op->d, result);
         return 2;
     }
 };
@@ -3466,9 +3249,8 @@ class TST_I_T1 : public T1Instruction {
         }
         result = Rn & imm32;
 
-        icpu_->setN((result >> 31) & 1);
-        icpu_->setZ(result == 0 ? 1: 0);
         icpu_->setC(carry);
+        icpu_->setFlagsNZ(result);
         // V unchanged
         return 4;
     }
@@ -3483,15 +3265,12 @@ class TST_R_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t n = ti  & 0x7;
-        uint32_t m = (ti >> 3)  & 0x7;
-        uint32_t Rn = static_cast<uint32_t>(R[n]);
-        uint32_t shifted = static_cast<uint32_t>(R[m]);
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t Rn = static_cast<uint32_t>(R[op->n]);
+        uint32_t shifted = static_cast<uint32_t>(R[op->m]);
         uint32_t result = Rn & shifted;
 
-        icpu_->setN((result >> 31) & 1);
-        icpu_->setZ(result == 0 ? 1: 0);
+        icpu_->setFlagsNZ(result);
         // C no shift, no change
         // V unchanged
         return 2;
@@ -3668,13 +3447,11 @@ class UXTB_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
 
         // rotation = 0 no need to call ROR_C
-        icpu_->setReg(d, Rm & 0xFF);
+        icpu_->setReg(op->d, Rm & 0xFF);
         return 2;
     }
 };
@@ -3688,13 +3465,11 @@ class UXTH_T1 : public T1Instruction {
         if (!ConditionPassed()) {
             return 2;
         }
-        uint32_t ti = payload->buf16[0];
-        uint32_t d = ti & 0x7;
-        uint32_t m = (ti >> 3) & 0x7;
-        uint32_t Rm = static_cast<uint32_t>(R[m]);
+        ThumbOperandsType *op = thumbOperands(payload);
+        uint32_t Rm = static_cast<uint32_t>(R[op->m]);
 
         // rotation = 0 no need to call ROR_C
-        icpu_->setReg(d, Rm & 0xFFFF);
+        icpu_->setReg(op->d, Rm & 0xFFFF);
         return 2;
     }
 };
@@ -150,9 +150,12 @@ void CpuRiver_Functional::handleTrap() {
         int entry_idx = 2*static_cast<int>(mcause.value) + 1;
         uint64_t trap = exceptionTable_[entry_idx].to_uint64();
         setNPC(trap);
+        updateTrapStatistic(static_cast<int>(mcause.bits.code));
     } else {
         // Software interrupt handled after instruction was executed
         setNPC(portCSR_.read(CSR_mtvec).val);
+        updateTrapStatistic(INTERRUPT_USoftware
+                            + static_cast<int>(mcause.bits.code));
     }
     interrupt_pending_[0] = 0;
 }
@@ -192,6 +195,9 @@ GenericInstruction *CpuRiver_Functional::decodeInstruction(Reg64Type *cache) {
             instr = NULL;
         }
     }
+    if (instr) {
+        instr->decodeOperands(cacheline_);
+    }
     return instr;
 }
 
@@ -45,4 +45,75 @@ RiscvInstruction::RiscvInstruction(CpuRiver_Functional *icpu, const char *name,
     mask_ ^= ~0;
 }
 
+void RiscvInstruction::decodeOperands(Reg64Type *payload) {
+    RiscvOperandsType *op = operands(payload);
+    uint32_t value = payload[0].buf32[0];
+    uint64_t imm = 0;
+    ISA_R_type r;
+    r.value = value;
+    op->rd = r.bits.rd;
+    op->rs1 = r.bits.rs1;
+    op->rs2 = r.bits.rs2;
+
+    switch (opcode_ & 0x7F) {
+    case 0x03:  // LOAD
+    case 0x07:  // LOAD-FP
+    case 0x0F:  // MISC-MEM
+    case 0x13:  // OP-IMM
+    case 0x1B:  // OP-IMM-32
+    case 0x67:  // JALR
+    case 0x73: {  // SYSTEM
+        ISA_I_type u;
+        u.value = value;
+        imm = u.bits.imm;
+        if (imm & 0x800) {
+            imm |= EXT_SIGN_12;
+        }
+        break;
+    }
+    case 0x23:  // STORE
+    case 0x27: {  // STORE-FP
+        ISA_S_type u;
+        u.value = value;
+        imm = (u.bits.imm11_5 << 5) | u.bits.imm4_0;
+        if (imm & 0x800) {
+            imm |= EXT_SIGN_12;
+        }
+        break;
+    }
+    case 0x63: {  // BRANCH
+        ISA_SB_type u;
+        u.value = value;
+        imm = (u.bits.imm12 << 12) | (u.bits.imm11 << 11)
+            | (u.bits.imm10_5 << 5) | (u.bits.imm4_1 << 1);
+        if (u.bits.imm12) {
+            imm |= EXT_SIGN_12;
+        }
+        break;
+    }
+    case 0x17:  // AUIPC
+    case 0x37: {  // LUI
+        ISA_U_type u;
+        u.value = value;
+        imm = static_cast<uint64_t>(u.bits.imm31_12) << 12;
+        if (imm & (1LL << 31)) {
+            imm |= EXT_SIGN_32;
+        }
+        break;
+    }
+    case 0x6F: {  // JAL
+        ISA_UJ_type u;
+        u.value = value;
+        imm = (u.bits.imm19_12 << 12) | (u.bits.imm11 << 11)
+            | (u.bits.imm10_1 << 1);
+        if (u.bits.imm20) {
+            imm |= 0xfffffffffff00000LL;
+        }
+        break;
+    }
+    default:;   // R-type
+    }
+    op->imm = imm;
+}
+
 }  // namespace debugger
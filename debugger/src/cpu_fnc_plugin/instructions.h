@@ -18,12 +18,30 @@
 #define __DEBUGGER_CPU_RISCV_INSTRUCTIONS_H__
 
 #include <inttypes.h>
+#include <string.h>
 #include "generic/cpu_generic.h"
 
 namespace debugger {
 
 class CpuRiver_Functional;
 
+/**
+ * Operands extracted once on decoding stage and stored in ICache together
+ * with the instruction (payload[1..2]). Compressed instructions are
+ * canonicalized into the fields of the equivalent 32-bits instruction.
+ */
+struct RiscvOperandsType {
+    uint8_t rd;
+    uint8_t rs1;
+    uint8_t rs2;
+    uint8_t rsrv[5];
+    uint64_t imm;               // sign-extended immediate
+};
+
+static inline RiscvOperandsType *operands(Reg64Type *payload) {
+    return reinterpret_cast<RiscvOperandsType *>(&payload[1]);
+}
+
 class RiscvInstruction : public GenericInstruction {
 public:
     RiscvInstruction(CpuRiver_Functional *icpu, const char *name,
@@ -40,6 +58,9 @@ public:
         return (opcode_ >> 2) & 0x1F;
     }
 
+    /** Fill operands of 32-bits instruction using major opcode format */
+    virtual void decodeOperands(Reg64Type *payload);
+
     uint16_t hash16() {
         uint16_t t1 = static_cast<uint16_t>(opcode_) & 0x3;
         return 0x20 | ((static_cast<uint16_t>(opcode_) >> 13) << 2) | t1;
@@ -64,6 +85,11 @@ public:
         uint16_t t1 = static_cast<uint16_t>(opcode_) & 0x3;
         return 0x20 | ((static_cast<uint16_t>(opcode_) >> 13) << 2) | t1;
     }
+
+    /** Instructions without operands, others override it */
+    virtual void decodeOperands(Reg64Type *payload) {
+        memset(operands(payload), 0, sizeof(RiscvOperandsType));
+    }
 };
 
 
@@ -40,14 +40,19 @@ public:
                 && u.bits.rdrs1 && u.bits.rs2;
     }
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CR_type u;
-        uint64_t res;
         u.value = payload->buf16[0];
-        if (u.bits.rdrs1) {
-            res = R[u.bits.rdrs1] + R[u.bits.rs2]; 
-            icpu_->setReg(u.bits.rdrs1, res);
-        }
+        op->rd = u.bits.rdrs1;
+        op->rs1 = u.bits.rdrs1;
+        op->rs2 = u.bits.rs2;
+        op->imm = 0;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] + R[op->rs2]);
         return 2;
     }
 };
@@ -70,15 +75,22 @@ public:
         return RiscvInstruction::parse(payload) && u.bits.rdrs1;
     }
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CI_type u;
         u.value = payload->buf16[0];
-    
-        uint64_t imm = u.bits.imm;
+        op->rd = u.bits.rdrs;
+        op->rs1 = u.bits.rdrs;
+        op->rs2 = 0;
+        op->imm = u.bits.imm;
         if (u.bits.imm6) {
-            imm |= EXT_SIGN_6;
+            op->imm |= EXT_SIGN_6;
         }
-        icpu_->setReg(u.bits.rdrs, R[u.bits.rdrs] + imm);
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] + op->imm);
         return 2;
     }
 };
@@ -98,17 +110,24 @@ public:
     C_ADDI16SP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_ADDI16SP", "????????????????011?00010?????01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CI_type u;
         u.value = payload->buf16[0];
-    
-        uint64_t imm = (u.spbits.imm8_7 << 3) | (u.spbits.imm6 << 2)
-                    | (u.spbits.imm5 << 1) | u.spbits.imm4;
+        op->rd = Reg_sp;
+        op->rs1 = Reg_sp;
+        op->rs2 = 0;
+        op->imm = (u.spbits.imm8_7 << 3) | (u.spbits.imm6 << 2)
+                | (u.spbits.imm5 << 1) | u.spbits.imm4;
         if (u.spbits.imm9) {
-            imm |= EXT_SIGN_6;
+            op->imm |= EXT_SIGN_6;
         }
-        imm <<= 4;
-        icpu_->setReg(Reg_sp, R[Reg_sp] + imm);
+        op->imm <<= 4;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] + op->imm);
         return 2;
     }
 };
@@ -127,14 +146,21 @@ public:
     C_ADDI4SPN(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_ADDI4SPN", "????????????????000???????????00") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CIW_type u;
         u.value = payload->buf16[0];
-    
-        uint64_t imm = (u.bits.imm9_6 << 4) | (u.bits.imm5_4 << 2)
-                    | (u.bits.imm3 << 1) | u.bits.imm2;
-        imm <<= 2;
-        icpu_->setReg(8 + u.bits.rd, R[Reg_sp] + imm);
+        op->rd = 8 + u.bits.rd;
+        op->rs1 = Reg_sp;
+        op->rs2 = 0;
+        op->imm = (u.bits.imm9_6 << 4) | (u.bits.imm5_4 << 2)
+                | (u.bits.imm3 << 1) | u.bits.imm2;
+        op->imm <<= 2;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] + op->imm);
         return 2;
     }
 };
@@ -158,20 +184,27 @@ public:
         return RiscvInstruction::parse(payload) && u.bits.rdrs1;
     }
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CI_type u;
-        uint64_t res;
         u.value = payload->buf16[0];
-    
-        uint64_t imm = u.bits.imm;
+        op->rd = u.bits.rdrs;
+        op->rs1 = u.bits.rdrs;
+        op->rs2 = 0;
+        op->imm = u.bits.imm;
         if (u.bits.imm6) {
-            imm |= EXT_SIGN_6;
+            op->imm |= EXT_SIGN_6;
         }
-        res = (R[u.bits.rdrs] + imm) & 0xFFFFFFFFLL;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        uint64_t res = R[op->rs1] + op->imm;
+        res &= 0xFFFFFFFFLL;
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(u.bits.rdrs, res);
+        icpu_->setReg(op->rd, res);
         return 2;
     }
 };
@@ -188,17 +221,24 @@ public:
     C_ADDW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_ADDW", "????????????????100111???01???01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CS_type u;
-        uint64_t res;
         u.value = payload->buf16[0];
-        res = R[8 + u.bits.rs1] + R[8 + u.bits.rs2];
+        op->rd = 8 + u.bits.rs1;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 8 + u.bits.rs2;
+        op->imm = 0;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        uint64_t res = R[op->rs1] + R[op->rs2];
         res &= 0xFFFFFFFFLL;
-        
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(8 + u.bits.rs1, res);
+        icpu_->setReg(op->rd, res);
         return 2;
     }
 };
@@ -215,12 +255,19 @@ public:
     C_AND(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_AND", "????????????????100011???11???01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CS_type u;
-        uint64_t res;
         u.value = payload->buf16[0];
-        res = R[8 + u.bits.rs1] & R[8 + u.bits.rs2];
-        icpu_->setReg(8 + u.bits.rs1, res);
+        op->rd = 8 + u.bits.rs1;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 8 + u.bits.rs2;
+        op->imm = 0;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] & R[op->rs2]);
         return 2;
     }
 };
@@ -237,17 +284,22 @@ public:
     C_ANDI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_ANDI", "????????????????100?10????????01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CB_type u;
-        uint64_t res;
         u.value = payload->buf16[0];
-    
-        uint64_t imm = u.shbits.shamt;
+        op->rd = 8 + u.bits.rs1;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 0;
+        op->imm = u.shbits.shamt;
         if (u.shbits.shamt5) {
-            imm |= EXT_SIGN_6;
+            op->imm |= EXT_SIGN_6;
         }
-        res = R[8 + u.bits.rs1] & imm;
-        icpu_->setReg(8 + u.bits.rs1, res);
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] & op->imm);
         return 2;
     }
 };
@@ -265,18 +317,27 @@ public:
     C_BEQZ(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_BEQZ", "????????????????110???????????01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual bool isConditionalBranch() { return true; }
+
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CB_type u;
-        u.value = payload->buf32[0];
-    
-        if (R[8 + u.bits.rs1] == 0) {
-            uint64_t imm = (u.bits.off7_6 << 5) | (u.bits.off5 << 4)
-                    | (u.bits.off4_3 << 2) | u.bits.off2_1;
-            imm <<= 1;
-            if (u.bits.off8) {
-                imm |= EXT_SIGN_9;
-            }
-            icpu_->setBranch(icpu_->getPC() + imm);
+        u.value = payload->buf16[0];
+        op->rd = 0;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 0;
+        op->imm = (u.bits.off7_6 << 5) | (u.bits.off5 << 4)
+                | (u.bits.off4_3 << 2) | u.bits.off2_1;
+        op->imm <<= 1;
+        if (u.bits.off8) {
+            op->imm |= EXT_SIGN_9;
+        }
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        if (R[op->rs1] == R[op->rs2]) {
+            icpu_->setBranch(icpu_->getPC() + op->imm);
         }
         return 2;
     }
@@ -294,18 +355,27 @@ public:
     C_BNEZ(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_BNEZ", "????????????????111???????????01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual bool isConditionalBranch() { return true; }
+
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CB_type u;
-        u.value = payload->buf32[0];
-    
-        if (R[8 + u.bits.rs1]) {
-            uint64_t imm = (u.bits.off7_6 << 5) | (u.bits.off5 << 4)
-                    | (u.bits.off4_3 << 2) | u.bits.off2_1;
-            imm <<= 1;
-            if (u.bits.off8) {
-                imm |= EXT_SIGN_9;
-            }
-            icpu_->setBranch(icpu_->getPC() + imm);
+        u.value = payload->buf16[0];
+        op->rd = 0;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 0;
+        op->imm = (u.bits.off7_6 << 5) | (u.bits.off5 << 4)
+                | (u.bits.off4_3 << 2) | u.bits.off2_1;
+        op->imm <<= 1;
+        if (u.bits.off8) {
+            op->imm |= EXT_SIGN_9;
+        }
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        if (R[op->rs1] != R[op->rs2]) {
+            icpu_->setBranch(icpu_->getPC() + op->imm);
         }
         return 2;
     }
@@ -342,18 +412,26 @@ public:
     C_J(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_J", "????????????????101???????????01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CJ_type u;
         u.value = payload->buf16[0];
-        uint64_t off = (u.bits.off10 << 9) | (u.bits.off9_8 << 7)
-                     | (u.bits.off7 << 6) | (u.bits.off6 << 5)
-                     | (u.bits.off5 << 4) | (u.bits.off4 << 3)
-                     | u.bits.off3_1;
-        off <<= 1;
+        op->rd = 0;
+        op->rs1 = 0;
+        op->rs2 = 0;
+        op->imm = (u.bits.off10 << 9) | (u.bits.off9_8 << 7)
+                | (u.bits.off7 << 6) | (u.bits.off6 << 5)
+                | (u.bits.off5 << 4) | (u.bits.off4 << 3)
+                | u.bits.off3_1;
+        op->imm <<= 1;
         if (u.bits.off11) {
-            off |= EXT_SIGN_11;
+            op->imm |= EXT_SIGN_11;
         }
-        icpu_->setBranch(icpu_->getPC() + off);
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setBranch(icpu_->getPC() + op->imm);
         return 2;
     }
 };
@@ -371,19 +449,27 @@ public:
     C_JAL(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_JAL", "????????????????001???????????01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CJ_type u;
         u.value = payload->buf16[0];
-        uint64_t off = (u.bits.off10 << 9) | (u.bits.off9_8 << 7)
-                     | (u.bits.off7 << 6) | (u.bits.off6 << 5)
-                     | (u.bits.off5 << 4) | (u.bits.off4 << 3)
-                     | u.bits.off3_1;
-        off <<= 1;
+        op->rd = Reg_ra;
+        op->rs1 = 0;
+        op->rs2 = 0;
+        op->imm = (u.bits.off10 << 9) | (u.bits.off9_8 << 7)
+                | (u.bits.off7 << 6) | (u.bits.off6 << 5)
+                | (u.bits.off5 << 4) | (u.bits.off4 << 3)
+                | u.bits.off3_1;
+        op->imm <<= 1;
         if (u.bits.off11) {
-            off |= EXT_SIGN_11;
+            op->imm |= EXT_SIGN_11;
         }
-        R[Reg_ra] = icpu_->getPC() + 2;
-        icpu_->setBranch(icpu_->getPC() + off);
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, icpu_->getPC() + 2);
+        icpu_->setBranch(icpu_->getPC() + op->imm);
         icpu_->pushStackTrace();
         return 2;
     }
@@ -408,11 +494,20 @@ public:
         return RiscvInstruction::parse(payload) && u.bits.rdrs1;
     }
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CR_type u;
         u.value = payload->buf16[0];
-        icpu_->setReg(Reg_ra, icpu_->getPC() + 2);
-        icpu_->setBranch(R[u.bits.rdrs1]);
+        op->rd = Reg_ra;
+        op->rs1 = u.bits.rdrs1;
+        op->rs2 = 0;
+        op->imm = 0;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, icpu_->getPC() + 2);
+        icpu_->setBranch(R[op->rs1]);
         icpu_->pushStackTrace();
         return 2;
     }
@@ -435,11 +530,20 @@ public:
         return RiscvInstruction::parse(payload) && u.bits.rdrs1;
     }
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CR_type u;
         u.value = payload->buf16[0];
-        icpu_->setBranch(R[u.bits.rdrs1]);
-        if (u.bits.rdrs1 == Reg_ra) {
+        op->rd = 0;
+        op->rs1 = u.bits.rdrs1;
+        op->rs2 = 0;
+        op->imm = 0;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setBranch(R[op->rs1]);
+        if (op->rs1 == Reg_ra) {
             icpu_->popStackTrace();
         }
         return 2;
@@ -459,15 +563,22 @@ public:
     C_LD(CpuRiver_Functional *icpu) :
         RiscvInstruction16(icpu, "C_LD", "????????????????011???????????00") {}
 
-    virtual int exec(Reg64Type *payload) {
-        Axi4TransactionType trans;
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CL_type u;
         u.value = payload->buf16[0];
-        uint64_t off = (u.bits.imm27 << 4) | (u.bits.imm6 << 3)
-                     | u.bits.imm5_3;
-        off <<= 3;
+        op->rd = 8 + u.bits.rd;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 0;
+        op->imm = (u.bits.imm27 << 4) | (u.bits.imm6 << 3) | u.bits.imm5_3;
+        op->imm <<= 3;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        Axi4TransactionType trans;
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Read;
-        trans.addr = R[8 + u.bits.rs1] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 8;
         if (trans.addr & 0x7) {
             trans.rpayload.b64[0] = 0;
@@ -477,7 +588,7 @@ public:
                 icpu_->exceptionLoadData(&trans);
             }
         }
-        icpu_->setReg(8 + u.bits.rd, trans.rpayload.b64[0]);
+        icpu_->setReg(op->rd, trans.rpayload.b64[0]);
         return 2;
     }
 };
@@ -501,15 +612,23 @@ public:
         return RiscvInstruction::parse(payload) && u.bits.rdrs1;
     }
 
-    virtual int exec(Reg64Type *payload) {
-        Axi4TransactionType trans;
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CI_type u;
         u.value = payload->buf16[0];
-        uint64_t off = (u.ldspbits.off8_6 << 3) | (u.ldspbits.off5 << 2)
-                     | u.ldspbits.off4_3;
-        off <<= 3;
+        op->rd = u.ldspbits.rd;
+        op->rs1 = Reg_sp;
+        op->rs2 = 0;
+        op->imm = (u.ldspbits.off8_6 << 3) | (u.ldspbits.off5 << 2)
+                | u.ldspbits.off4_3;
+        op->imm <<= 3;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        Axi4TransactionType trans;
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Read;
-        trans.addr = R[Reg_sp] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 8;
         if (trans.addr & 0x7) {
             trans.rpayload.b64[0] = 0;
@@ -519,7 +638,7 @@ public:
                 icpu_->exceptionLoadData(&trans);
             }
         }
-        icpu_->setReg(u.ldspbits.rd, trans.rpayload.b64[0]);
+        icpu_->setReg(op->rd, trans.rpayload.b64[0]);
         return 2;
     }
 };
@@ -541,15 +660,22 @@ public:
         return RiscvInstruction::parse(payload) && u.bits.rdrs1;
     }
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CI_type u;
         u.value = payload->buf16[0];
-    
-        uint64_t imm = u.bits.imm;
+        op->rd = u.bits.rdrs;
+        op->rs1 = 0;
+        op->rs2 = 0;
+        op->imm = u.bits.imm;
         if (u.bits.imm6) {
-            imm |= EXT_SIGN_6;
+            op->imm |= EXT_SIGN_6;
         }
-        icpu_->setReg(u.bits.rdrs, imm);
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, op->imm);
         return 2;
     }
 };
@@ -566,17 +692,24 @@ public:
     C_LW(CpuRiver_Functional *icpu) :
         RiscvInstruction16(icpu, "C_LW", "????????????????010???????????00") {}
 
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        ISA_CL_type u;
+        u.value = payload->buf16[0];
+        op->rd = 8 + u.bits.rd;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 0;
+        op->imm = (u.bits.imm6 << 4) | (u.bits.imm5_3 << 1) | u.bits.imm27;
+        op->imm <<= 2;
+    }
+
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
-        ISA_CL_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf16[0];
-        uint64_t off = (u.bits.imm6 << 4) | (u.bits.imm5_3 << 1) | u.bits.imm27;
-        off <<= 2;
         trans.action = MemAction_Read;
-        trans.addr = R[8 + u.bits.rs1] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 4;
-        trans.rpayload.b64[0] = 0;
         if (trans.addr & 0x3) {
             trans.rpayload.b64[0] = 0;
             icpu_->raiseSignal(EXCEPTION_LoadMisalign);
@@ -589,7 +722,7 @@ public:
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(8 + u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 2;
     }
 };
@@ -612,16 +745,24 @@ public:
         return RiscvInstruction::parse(payload) && u.bits.rdrs1;
     }
 
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        ISA_CI_type u;
+        u.value = payload->buf16[0];
+        op->rd = u.lwspbits.rd;
+        op->rs1 = Reg_sp;
+        op->rs2 = 0;
+        op->imm = (u.lwspbits.off7_6 << 4) | (u.lwspbits.off5 << 3)
+                | u.lwspbits.off4_2;
+        op->imm <<= 2;
+    }
+
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
-        ISA_CI_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf16[0];
-        uint64_t off = (u.lwspbits.off7_6 << 4) | (u.lwspbits.off5 << 3)
-                     | u.lwspbits.off4_2;
-        off <<= 2;
         trans.action = MemAction_Read;
-        trans.addr = R[Reg_sp] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 4;
         if (trans.addr & 0x3) {
             trans.rpayload.b64[0] = 0;
@@ -635,7 +776,7 @@ public:
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(u.lwspbits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 2;
     }
 };
@@ -661,16 +802,23 @@ public:
             && u.bits.rdrs1 != Reg_sp;
     }
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CI_type u;
         u.value = payload->buf16[0];
-    
-        uint64_t imm = u.bits.imm;
+        op->rd = u.bits.rdrs;
+        op->rs1 = 0;
+        op->rs2 = 0;
+        op->imm = u.bits.imm;
         if (u.bits.imm6) {
-            imm |= EXT_SIGN_6;
+            op->imm |= EXT_SIGN_6;
         }
-        imm <<= 12;
-        icpu_->setReg(u.bits.rdrs, imm);
+        op->imm <<= 12;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, op->imm);
         return 2;
     }
 };
@@ -693,10 +841,19 @@ public:
             && u.bits.rs2 && u.bits.rdrs1;
     }
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CR_type u;
         u.value = payload->buf16[0];
-        icpu_->setReg(u.bits.rdrs1, R[u.bits.rs2]);
+        op->rd = u.bits.rdrs1;
+        op->rs1 = 0;
+        op->rs2 = u.bits.rs2;
+        op->imm = 0;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs2]);
         return 2;
     }
 };
@@ -730,12 +887,19 @@ public:
     C_OR(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_OR", "????????????????100011???10???01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CS_type u;
-        uint64_t res;
         u.value = payload->buf16[0];
-        res = R[8 + u.bits.rs1] | R[8 + u.bits.rs2];
-        icpu_->setReg(8 + u.bits.rs1, res);
+        op->rd = 8 + u.bits.rs1;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 8 + u.bits.rs2;
+        op->imm = 0;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] | R[op->rs2]);
         return 2;
     }
 };
@@ -753,17 +917,25 @@ public:
     C_SD(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_SD", "????????????????111???????????00") {}
 
-    virtual int exec(Reg64Type *payload) {
-        Axi4TransactionType trans;
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CS_type u;
         u.value = payload->buf16[0];
-        uint64_t off = (u.bits.imm27 << 4) | (u.bits.imm6 << 3) | u.bits.imm5_3;
-        off <<= 3;
+        op->rd = 0;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 8 + u.bits.rs2;
+        op->imm = (u.bits.imm27 << 4) | (u.bits.imm6 << 3) | u.bits.imm5_3;
+        op->imm <<= 3;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        Axi4TransactionType trans;
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Write;
         trans.xsize = 8;
         trans.wstrb = (1 << trans.xsize) - 1;
-        trans.addr = R[8 + u.bits.rs1] + off;
-        trans.wpayload.b64[0] = R[8 + u.bits.rs2];
+        trans.addr = R[op->rs1] + op->imm;
+        trans.wpayload.b64[0] = R[op->rs2];
         if (trans.addr & 0x7) {
             icpu_->raiseSignal(EXCEPTION_StoreMisalign);
         } else {
@@ -788,17 +960,25 @@ public:
     C_SDSP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_SDSP", "????????????????111???????????10") {}
 
-    virtual int exec(Reg64Type *payload) {
-        Axi4TransactionType trans;
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CSS_type u;
         u.value = payload->buf16[0];
-        uint64_t off = (u.dbits.imm8_6 << 3) | u.dbits.imm5_3;
-        off <<= 3;
+        op->rd = 0;
+        op->rs1 = Reg_sp;
+        op->rs2 = u.dbits.rs2;
+        op->imm = (u.dbits.imm8_6 << 3) | u.dbits.imm5_3;
+        op->imm <<= 3;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        Axi4TransactionType trans;
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Write;
         trans.xsize = 8;
         trans.wstrb = (1 << trans.xsize) - 1;
-        trans.addr = R[Reg_sp] + off;
-        trans.wpayload.b64[0] = R[u.dbits.rs2];
+        trans.addr = R[op->rs1] + op->imm;
+        trans.wpayload.b64[0] = R[op->rs2];
         if (trans.addr & 0x7) {
             icpu_->raiseSignal(EXCEPTION_StoreMisalign);
         } else {
@@ -832,12 +1012,19 @@ public:
         return RiscvInstruction::parse(payload) && u.bits.rdrs1;
     }
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CB_type u;
         u.value = payload->buf16[0];
-        uint32_t shamt = (u.shbits.shamt5 << 5) | u.shbits.shamt;
-        uint32_t idx = (u.shbits.funct2 << 3) | u.shbits.rd;
-        icpu_->setReg(idx, R[idx] << shamt);
+        op->rd = (u.shbits.funct2 << 3) | u.shbits.rd;
+        op->rs1 = (u.shbits.funct2 << 3) | u.shbits.rd;
+        op->rs2 = 0;
+        op->imm = (u.shbits.shamt5 << 5) | u.shbits.shamt;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] << op->imm);
         return 2;
     }
 };
@@ -853,13 +1040,20 @@ public:
     C_SRAI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_SRAI", "????????????????100?01????????01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CB_type u;
-        uint64_t res;
         u.value = payload->buf16[0];
-        uint32_t shamt = (u.shbits.shamt5 << 5) | u.shbits.shamt;
-        res = static_cast<int64_t>(R[8 + u.shbits.rd]) >> shamt;
-        icpu_->setReg(8 + u.shbits.rd, res);
+        op->rd = 8 + u.shbits.rd;
+        op->rs1 = 8 + u.shbits.rd;
+        op->rs2 = 0;
+        op->imm = (u.shbits.shamt5 << 5) | u.shbits.shamt;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd,
+                      static_cast<int64_t>(R[op->rs1]) >> op->imm);
         return 2;
     }
 };
@@ -881,11 +1075,19 @@ public:
     C_SRLI(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_SRLI", "????????????????100?00????????01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CB_type u;
         u.value = payload->buf16[0];
-        uint32_t shamt = (u.shbits.shamt5 << 5) | u.shbits.shamt;
-        icpu_->setReg(8 + u.shbits.rd, R[8 + u.shbits.rd] >> shamt);
+        op->rd = 8 + u.shbits.rd;
+        op->rs1 = 8 + u.shbits.rd;
+        op->rs2 = 0;
+        op->imm = (u.shbits.shamt5 << 5) | u.shbits.shamt;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] >> op->imm);
         return 2;
     }
 };
@@ -902,10 +1104,19 @@ public:
     C_SUB(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_SUB", "????????????????100011???00???01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CS_type u;
         u.value = payload->buf16[0];
-        icpu_->setReg(8 + u.bits.rs1, R[8 + u.bits.rs1] - R[8 + u.bits.rs2]);
+        op->rd = 8 + u.bits.rs1;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 8 + u.bits.rs2;
+        op->imm = 0;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] - R[op->rs2]);
         return 2;
     }
 };
@@ -923,17 +1134,24 @@ public:
     C_SUBW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_SUBW", "????????????????100111???00???01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CS_type u;
-        uint64_t res;
         u.value = payload->buf16[0];
-        res = R[8 + u.bits.rs1] - R[8 + u.bits.rs2];
+        op->rd = 8 + u.bits.rs1;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 8 + u.bits.rs2;
+        op->imm = 0;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        uint64_t res = R[op->rs1] - R[op->rs2];
         res &= 0xFFFFFFFFLL;
-        
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(8 + u.bits.rs1, res);
+        icpu_->setReg(op->rd, res);
         return 2;
     }
 };
@@ -950,17 +1168,25 @@ public:
     C_SW(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_SW", "????????????????110???????????00") {}
 
-    virtual int exec(Reg64Type *payload) {
-        Axi4TransactionType trans;
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CS_type u;
         u.value = payload->buf16[0];
-        uint64_t off = (u.bits.imm6 << 4) | (u.bits.imm5_3 << 1) | u.bits.imm27;
-        off <<= 2;
+        op->rd = 0;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 8 + u.bits.rs2;
+        op->imm = (u.bits.imm6 << 4) | (u.bits.imm5_3 << 1) | u.bits.imm27;
+        op->imm <<= 2;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        Axi4TransactionType trans;
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Write;
         trans.xsize = 4;
         trans.wstrb = (1 << trans.xsize) - 1;
-        trans.addr = R[8 + u.bits.rs1] + off;
-        trans.wpayload.b64[0] = R[8 + u.bits.rs2];
+        trans.addr = R[op->rs1] + op->imm;
+        trans.wpayload.b64[0] = R[op->rs2];
         if (trans.addr & 0x3) {
             icpu_->raiseSignal(EXCEPTION_StoreMisalign);
         } else {
@@ -984,17 +1210,25 @@ public:
     C_SWSP(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_SWSP", "????????????????110???????????10") {}
 
-    virtual int exec(Reg64Type *payload) {
-        Axi4TransactionType trans;
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CSS_type u;
         u.value = payload->buf16[0];
-        uint64_t off = (u.wbits.imm7_6 << 4) | u.wbits.imm5_2;
-        off <<= 2;
+        op->rd = 0;
+        op->rs1 = Reg_sp;
+        op->rs2 = u.wbits.rs2;
+        op->imm = (u.wbits.imm7_6 << 4) | u.wbits.imm5_2;
+        op->imm <<= 2;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        Axi4TransactionType trans;
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Write;
         trans.xsize = 4;
         trans.wstrb = (1 << trans.xsize) - 1;
-        trans.addr = R[Reg_sp] + off;
-        trans.wpayload.b64[0] = R[u.wbits.rs2];
+        trans.addr = R[op->rs1] + op->imm;
+        trans.wpayload.b64[0] = R[op->rs2];
         if (trans.addr & 0x3) {
             icpu_->raiseSignal(EXCEPTION_StoreMisalign);
         } else {
@@ -1017,10 +1251,19 @@ public:
     C_XOR(CpuRiver_Functional *icpu) : RiscvInstruction16(icpu,
         "C_XOR", "????????????????100011???01???01") {}
 
-    virtual int exec(Reg64Type *payload) {
+    virtual void decodeOperands(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
         ISA_CS_type u;
         u.value = payload->buf16[0];
-        icpu_->setReg(8 + u.bits.rs1, R[8 + u.bits.rs1] ^ R[8 + u.bits.rs2]);
+        op->rd = 8 + u.bits.rs1;
+        op->rs1 = 8 + u.bits.rs1;
+        op->rs2 = 8 + u.bits.rs2;
+        op->imm = 0;
+    }
+
+    virtual int exec(Reg64Type *payload) {
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] ^ R[op->rs2]);
         return 2;
     }
 };
@@ -31,17 +31,16 @@ class DIV : public RiscvInstruction {
         : RiscvInstruction(icpu, "DIV", "0000001??????????100?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         int64_t res;
-        u.value = payload->buf32[0];
-        int64_t rs1 = static_cast<int64_t>(R[u.bits.rs1]);
-        int64_t rs2 = static_cast<int64_t>(R[u.bits.rs2]);
+        int64_t rs1 = static_cast<int64_t>(R[op->rs1]);
+        int64_t rs2 = static_cast<int64_t>(R[op->rs2]);
         if (rs2) {
             res = rs1 / rs2;
         } else {
             res = -1;
         }
-        icpu_->setReg(u.bits.rd, static_cast<uint64_t>(res));
+        icpu_->setReg(op->rd, static_cast<uint64_t>(res));
         return 4;
     }
 };
@@ -55,16 +54,15 @@ class DIVU : public RiscvInstruction {
         : RiscvInstruction(icpu, "DIVU", "0000001??????????101?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf32[0];
-        if (R[u.bits.rs2]) {
-            res = R[u.bits.rs1] / R[u.bits.rs2];
+        if (R[op->rs2]) {
+            res = R[op->rs1] / R[op->rs2];
         } else {
             // Difference relative x86
             res = ~0ull;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -78,10 +76,9 @@ class DIVUW : public RiscvInstruction {
         RiscvInstruction(icpu, "DIVUW", "0000001??????????101?????0111011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        uint32_t a1 = static_cast<uint32_t>(R[u.bits.rs1]);
-        uint32_t a2 = static_cast<uint32_t>(R[u.bits.rs2]);
+        RiscvOperandsType *op = operands(payload);
+        uint32_t a1 = static_cast<uint32_t>(R[op->rs1]);
+        uint32_t a2 = static_cast<uint32_t>(R[op->rs2]);
         int32_t res;
         if (a2) {
             // DIVUW also sign-extended
@@ -89,7 +86,7 @@ class DIVUW : public RiscvInstruction {
         } else {
             res = -1;
         }
-        icpu_->setReg(u.bits.rd, static_cast<int64_t>(res));
+        icpu_->setReg(op->rd, static_cast<int64_t>(res));
         return 4;
     }
 };
@@ -103,10 +100,9 @@ class DIVW : public RiscvInstruction {
         : RiscvInstruction(icpu, "DIVW", "0000001??????????100?????0111011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        int32_t divident = static_cast<int32_t>(R[u.bits.rs1]);
-        int32_t divisor = static_cast<int32_t>(R[u.bits.rs2]);
+        RiscvOperandsType *op = operands(payload);
+        int32_t divident = static_cast<int32_t>(R[op->rs1]);
+        int32_t divisor = static_cast<int32_t>(R[op->rs2]);
         int64_t res;
         if (divisor) {
             // ! Integer overflow on x86
@@ -117,7 +113,7 @@ class DIVW : public RiscvInstruction {
         }
         res <<= 32;
         res >>= 32;
-        icpu_->setReg(u.bits.rd, static_cast<uint64_t>(res));
+        icpu_->setReg(op->rd, static_cast<uint64_t>(res));
         return 4;
     }
 };
@@ -134,12 +130,11 @@ class MUL : public RiscvInstruction {
         : RiscvInstruction(icpu, "MUL", "0000001??????????000?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         int64_t res;
-        u.value = payload->buf32[0];
-        res = static_cast<int64_t>(R[u.bits.rs1])
-                * static_cast<int64_t>(R[u.bits.rs2]);
-        icpu_->setReg(u.bits.rd, static_cast<uint64_t>(res));
+        res = static_cast<int64_t>(R[op->rs1])
+                * static_cast<int64_t>(R[op->rs2]);
+        icpu_->setReg(op->rd, static_cast<uint64_t>(res));
         return 4;
     }
 };
@@ -157,11 +152,10 @@ class MULH : public RiscvInstruction {
         : RiscvInstruction(icpu, "MULH", "0000001??????????001?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         int64_t res;
-        u.value = payload->buf32[0];
-        uint64_t a1 = R[u.bits.rs1];
-        uint64_t a2 = R[u.bits.rs2];
+        uint64_t a1 = R[op->rs1];
+        uint64_t a2 = R[op->rs2];
         uint64_t a1s = a1;
         uint64_t a2s = a2;
         bool inva1 = 0;
@@ -272,7 +266,7 @@ class MULH : public RiscvInstruction {
         } else {
             res = lvl5.val[1];
         }
-        icpu_->setReg(u.bits.rd, static_cast<uint64_t>(res));
+        icpu_->setReg(op->rd, static_cast<uint64_t>(res));
         return 4;
     }
 };
@@ -283,11 +277,10 @@ class MULHSU : public RiscvInstruction {
         : RiscvInstruction(icpu, "MULHSU", "0000001??????????010?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         int64_t res;
-        u.value = payload->buf32[0];
-        uint64_t a1 = R[u.bits.rs1];
-        uint64_t a2 = R[u.bits.rs2];
+        uint64_t a1 = R[op->rs1];
+        uint64_t a2 = R[op->rs2];
         uint64_t a1s = a1;
         bool inv = 0;
         bool zero;
@@ -390,7 +383,7 @@ class MULHSU : public RiscvInstruction {
         } else {
             res = lvl5.val[1];
         }
-        icpu_->setReg(u.bits.rd, static_cast<uint64_t>(res));
+        icpu_->setReg(op->rd, static_cast<uint64_t>(res));
         return 4;
     }
 };
@@ -401,11 +394,10 @@ class MULHU : public RiscvInstruction {
         : RiscvInstruction(icpu, "MULHU", "0000001??????????011?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         int64_t res;
-        u.value = payload->buf32[0];
-        uint64_t a1 = R[u.bits.rs1];
-        uint64_t a2 = R[u.bits.rs2];
+        uint64_t a1 = R[op->rs1];
+        uint64_t a2 = R[op->rs2];
 
         struct LevelType {
             uint64_t val[2];
@@ -494,7 +486,7 @@ class MULHU : public RiscvInstruction {
         lvl5.val[1] += lvl4[0].val[1] + carry;
 
         res = lvl5.val[1];
-        icpu_->setReg(u.bits.rd, static_cast<uint64_t>(res));
+        icpu_->setReg(op->rd, static_cast<uint64_t>(res));
         return 4;
     }
 };
@@ -514,16 +506,15 @@ class MULW : public RiscvInstruction {
         : RiscvInstruction(icpu, "MULW", "0000001??????????000?????0111011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        int32_t m1 = static_cast<int32_t>(R[u.bits.rs1]);
-        int32_t m2 = static_cast<int32_t>(R[u.bits.rs2]);
+        RiscvOperandsType *op = operands(payload);
+        int32_t m1 = static_cast<int32_t>(R[op->rs1]);
+        int32_t m2 = static_cast<int32_t>(R[op->rs2]);
         int32_t resw;
         int64_t res;
 
         resw = m1 * m2;
         res = static_cast<int64_t>(resw);
-        icpu_->setReg(u.bits.rd, static_cast<uint64_t>(res));
+        icpu_->setReg(op->rd, static_cast<uint64_t>(res));
         return 4;
     }
 };
@@ -537,16 +528,15 @@ public:
         : RiscvInstruction(icpu, "REM", "0000001??????????110?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         int64_t res;
-        u.value = payload->buf32[0];
-        if (R[u.bits.rs2]) {
-            res = static_cast<int64_t>(R[u.bits.rs1])
-                 % static_cast<int64_t>(R[u.bits.rs2]);
+        if (R[op->rs2]) {
+            res = static_cast<int64_t>(R[op->rs1])
+                 % static_cast<int64_t>(R[op->rs2]);
         } else {
-            res = static_cast<int64_t>(R[u.bits.rs1]);
+            res = static_cast<int64_t>(R[op->rs1]);
         }
-        icpu_->setReg(u.bits.rd, static_cast<uint64_t>(res));
+        icpu_->setReg(op->rd, static_cast<uint64_t>(res));
         return 4;
     }
 };
@@ -560,15 +550,14 @@ public:
         : RiscvInstruction(icpu, "REMU", "0000001??????????111?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf32[0];
-        if (R[u.bits.rs2]) {
-            res = R[u.bits.rs1] % R[u.bits.rs2];
+        if (R[op->rs2]) {
+            res = R[op->rs1] % R[op->rs2];
         } else {
-            res = R[u.bits.rs1];
+            res = R[op->rs1];
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -587,18 +576,17 @@ public:
         : RiscvInstruction(icpu, "REMW", "0000001??????????110?????0111011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         int64_t res;
-        u.value = payload->buf32[0];
-        int32_t a1 = static_cast<int32_t>(R[u.bits.rs1]);
-        int32_t a2 = static_cast<int32_t>(R[u.bits.rs2]);
+        int32_t a1 = static_cast<int32_t>(R[op->rs1]);
+        int32_t a2 = static_cast<int32_t>(R[op->rs2]);
         if (a2) {
             // To avoid integer overflow exception on x86 use int64_t
             res = static_cast<int64_t>(a1) % static_cast<int64_t>(a2);
         } else {
             res = a1;
         }
-        icpu_->setReg(u.bits.rd, static_cast<uint64_t>(res));
+        icpu_->setReg(op->rd, static_cast<uint64_t>(res));
         return 4;
     }
 };
@@ -609,20 +597,18 @@ public:
         RiscvInstruction(icpu, "REMUW", "0000001??????????111?????0111011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        uint32_t a1 = static_cast<uint32_t>(R[u.bits.rs1]);
-        uint32_t a2 = static_cast<uint32_t>(R[u.bits.rs2]);
+        RiscvOperandsType *op = operands(payload);
+        uint32_t a1 = static_cast<uint32_t>(R[op->rs1]);
+        uint32_t a2 = static_cast<uint32_t>(R[op->rs2]);
         int32_t resw;
         int64_t res;
-        u.value = payload->buf32[0];
         if (a2) {
             resw = static_cast<int32_t>(a1 % a2);
         } else {
             resw = a1;
         }
         res = static_cast<int64_t>(resw);
-        icpu_->setReg(u.bits.rd, static_cast<uint64_t>(res));
+        icpu_->setReg(op->rd, static_cast<uint64_t>(res));
         return 4;
     }
 };
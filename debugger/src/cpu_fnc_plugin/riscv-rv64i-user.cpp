@@ -31,9 +31,8 @@ public:
         RiscvInstruction(icpu, "ADD", "0000000??????????000?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] + R[u.bits.rs2]);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] + R[op->rs2]);
         return 4;
     }
 };
@@ -52,14 +51,8 @@ public:
         RiscvInstruction(icpu, "ADDI", "?????????????????000?????0010011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-    
-        uint64_t imm = u.bits.imm;
-        if (imm & 0x800) {
-            imm |= EXT_SIGN_12;
-        }
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] + imm);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] + op->imm);
         return 4;
     }
 };
@@ -80,18 +73,12 @@ public:
         RiscvInstruction(icpu, "ADDIW", "?????????????????000?????0011011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-    
-        uint64_t imm = u.bits.imm;
-        if (imm & 0x800) {
-            imm |= EXT_SIGN_12;
-        }
-        uint64_t res = (R[u.bits.rs1] + imm) & 0xFFFFFFFFLL;
+        RiscvOperandsType *op = operands(payload);
+        uint64_t res = (R[op->rs1] + op->imm) & 0xFFFFFFFFLL;
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -110,14 +97,12 @@ public:
         RiscvInstruction(icpu, "ADDW", "0000000??????????000?????0111011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-    
-        uint64_t res = (R[u.bits.rs1] + R[u.bits.rs2]) & 0xFFFFFFFFLL;
+        RiscvOperandsType *op = operands(payload);
+        uint64_t res = (R[op->rs1] + R[op->rs2]) & 0xFFFFFFFFLL;
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -131,9 +116,8 @@ public:
         RiscvInstruction(icpu, "AND", "0000000??????????111?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] & R[u.bits.rs2]);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] & R[op->rs2]);
         return 4;
     }
 };
@@ -151,14 +135,8 @@ public:
         RiscvInstruction(icpu, "ANDI", "?????????????????111?????0010011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint64_t imm = u.bits.imm;
-        if (imm & 0x800) {
-            imm |= EXT_SIGN_12;
-        }
-
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] & imm);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] & op->imm);
         return 4;
     }
 };
@@ -177,14 +155,8 @@ public:
         RiscvInstruction(icpu, "AUIPC", "?????????????????????????0010111") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_U_type u;
-        u.value = payload->buf32[0];
-
-        uint64_t off = u.bits.imm31_12 << 12;
-        if (off & (1LL << 31)) {
-            off |= EXT_SIGN_32;
-        }
-        icpu_->setReg(u.bits.rd, icpu_->getPC() + off);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, icpu_->getPC() + op->imm);
         return 4;
     }
 };
@@ -197,17 +169,12 @@ public:
     BEQ(CpuRiver_Functional *icpu) :
         RiscvInstruction(icpu, "BEQ", "?????????????????000?????1100011") {}
 
+    virtual bool isConditionalBranch() { return true; }
+
     virtual int exec(Reg64Type *payload) {
-        ISA_SB_type u;
-        u.value = payload->buf32[0];
-    
-        if (R[u.bits.rs1] == R[u.bits.rs2]) {
-            uint64_t imm = (u.bits.imm12 << 12) | (u.bits.imm11 << 11)
-                    | (u.bits.imm10_5 << 5) | (u.bits.imm4_1 << 1);
-            if (u.bits.imm12) {
-                imm |= EXT_SIGN_12;
-            }
-            icpu_->setBranch(icpu_->getPC() + imm);
+        RiscvOperandsType *op = operands(payload);
+        if (R[op->rs1] == R[op->rs2]) {
+            icpu_->setBranch(icpu_->getPC() + op->imm);
         }
         return 4;
     }
@@ -226,18 +193,13 @@ public:
     BGE(CpuRiver_Functional *icpu) :
         RiscvInstruction(icpu, "BGE", "?????????????????101?????1100011") {}
 
+    virtual bool isConditionalBranch() { return true; }
+
     virtual int exec(Reg64Type *payload) {
-        ISA_SB_type u;
-        u.value = payload->buf32[0];
-    
-        if (static_cast<int64_t>(R[u.bits.rs1]) >= 
-            static_cast<int64_t>(R[u.bits.rs2])) {
-            uint64_t imm = (u.bits.imm12 << 12) | (u.bits.imm11 << 11)
-                    | (u.bits.imm10_5 << 5) | (u.bits.imm4_1 << 1);
-            if (u.bits.imm12) {
-                imm |= EXT_SIGN_12;
-            }
-            icpu_->setBranch(icpu_->getPC() + imm);
+        RiscvOperandsType *op = operands(payload);
+        if (static_cast<int64_t>(R[op->rs1]) >= 
+            static_cast<int64_t>(R[op->rs2])) {
+            icpu_->setBranch(icpu_->getPC() + op->imm);
         }
         return 4;
     }
@@ -252,17 +214,12 @@ public:
     BGEU(CpuRiver_Functional *icpu) :
         RiscvInstruction(icpu, "BGEU", "?????????????????111?????1100011") {}
 
+    virtual bool isConditionalBranch() { return true; }
+
     virtual int exec(Reg64Type *payload) {
-        ISA_SB_type u;
-        u.value = payload->buf32[0];
-    
-        if (R[u.bits.rs1] >= R[u.bits.rs2]) {
-            uint64_t imm = (u.bits.imm12 << 12) | (u.bits.imm11 << 11)
-                    | (u.bits.imm10_5 << 5) | (u.bits.imm4_1 << 1);
-            if (u.bits.imm12) {
-                imm |= EXT_SIGN_12;
-            }
-            icpu_->setBranch(icpu_->getPC() + imm);
+        RiscvOperandsType *op = operands(payload);
+        if (R[op->rs1] >= R[op->rs2]) {
+            icpu_->setBranch(icpu_->getPC() + op->imm);
         }
         return 4;
     }
@@ -276,18 +233,13 @@ public:
     BLT(CpuRiver_Functional *icpu) :
         RiscvInstruction(icpu, "BLT", "?????????????????100?????1100011") {}
 
+    virtual bool isConditionalBranch() { return true; }
+
     virtual int exec(Reg64Type *payload) {
-        ISA_SB_type u;
-        u.value = payload->buf32[0];
-    
-        if (static_cast<int64_t>(R[u.bits.rs1]) < 
-            static_cast<int64_t>(R[u.bits.rs2])) {
-            uint64_t imm = (u.bits.imm12 << 12) | (u.bits.imm11 << 11)
-                    | (u.bits.imm10_5 << 5) | (u.bits.imm4_1 << 1);
-            if (u.bits.imm12) {
-                imm |= EXT_SIGN_12;
-            }
-            icpu_->setBranch(icpu_->getPC() + imm);
+        RiscvOperandsType *op = operands(payload);
+        if (static_cast<int64_t>(R[op->rs1]) < 
+            static_cast<int64_t>(R[op->rs2])) {
+            icpu_->setBranch(icpu_->getPC() + op->imm);
         }
         return 4;
     }
@@ -301,17 +253,12 @@ public:
     BLTU(CpuRiver_Functional *icpu) :
         RiscvInstruction(icpu, "BLTU", "?????????????????110?????1100011") {}
 
+    virtual bool isConditionalBranch() { return true; }
+
     virtual int exec(Reg64Type *payload) {
-        ISA_SB_type u;
-        u.value = payload->buf32[0];
-    
-        if (R[u.bits.rs1] < R[u.bits.rs2]) {
-            uint64_t imm = (u.bits.imm12 << 12) | (u.bits.imm11 << 11)
-                    | (u.bits.imm10_5 << 5) | (u.bits.imm4_1 << 1);
-            if (u.bits.imm12) {
-                imm |= EXT_SIGN_12;
-            }
-            icpu_->setBranch(icpu_->getPC() + imm);
+        RiscvOperandsType *op = operands(payload);
+        if (R[op->rs1] < R[op->rs2]) {
+            icpu_->setBranch(icpu_->getPC() + op->imm);
         }
         return 4;
     }
@@ -325,17 +272,12 @@ public:
     BNE(CpuRiver_Functional *icpu) :
         RiscvInstruction(icpu, "BNE", "?????????????????001?????1100011") {}
 
+    virtual bool isConditionalBranch() { return true; }
+
     virtual int exec(Reg64Type *payload) {
-        ISA_SB_type u;
-        u.value = payload->buf32[0];
-    
-        if (R[u.bits.rs1] != R[u.bits.rs2]) {
-            uint64_t imm = (u.bits.imm12 << 12) | (u.bits.imm11 << 11)
-                    | (u.bits.imm10_5 << 5) | (u.bits.imm4_1 << 1);
-            if (u.bits.imm12) {
-                imm |= EXT_SIGN_12;
-            }
-            icpu_->setBranch(icpu_->getPC() + imm);
+        RiscvOperandsType *op = operands(payload);
+        if (R[op->rs1] != R[op->rs2]) {
+            icpu_->setBranch(icpu_->getPC() + op->imm);
         }
         return 4;
     }
@@ -358,20 +300,12 @@ public:
         RiscvInstruction(icpu, "JAL", "?????????????????????????1101111") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_UJ_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = 0;
-        if (u.bits.imm20) {
-            off = 0xfffffffffff00000LL;
+        RiscvOperandsType *op = operands(payload);
+        if (op->rd != 0) {
+            icpu_->setReg(op->rd, icpu_->getPC() + 4);
         }
-        off |= (u.bits.imm19_12 << 12);
-        off |= (u.bits.imm11 << 11);
-        off |= (u.bits.imm10_1 << 1);
-        if (u.bits.rd != 0) {
-            icpu_->setReg(u.bits.rd, icpu_->getPC() + 4);
-        }
-        icpu_->setBranch(icpu_->getPC() + off);
-        if (u.bits.rd == Reg_ra) {
+        icpu_->setBranch(icpu_->getPC() + op->imm);
+        if (op->rd == Reg_ra) {
             icpu_->pushStackTrace();
         }
         return 4;
@@ -393,23 +327,17 @@ public:
         RiscvInstruction(icpu, "JALR", "?????????????????000?????1100111") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = u.bits.imm;
-        if (u.bits.imm & 0x800) {
-            off |= 0xfffffffffffff000LL;
-        }
-        off += R[u.bits.rs1];
-        off &= ~0x1LL;
-        if (u.bits.rd != 0) {
-            icpu_->setReg(u.bits.rd, icpu_->getPC() + 4);
+        RiscvOperandsType *op = operands(payload);
+        uint64_t off = (R[op->rs1] + op->imm) & ~0x1LL;
+        if (op->rd != 0) {
+            icpu_->setReg(op->rd, icpu_->getPC() + 4);
         }
         icpu_->setBranch(off);
 
         // Stack trace buffer:
-        if (u.bits.rd == Reg_ra) {
+        if (op->rd == Reg_ra) {
             icpu_->pushStackTrace();
-        } else if (u.bits.imm == 0 && u.bits.rs1 == Reg_ra) {
+        } else if (op->imm == 0 && op->rs1 == Reg_ra) {
             icpu_->popStackTrace();
         }
         return 4;
@@ -433,14 +361,9 @@ public:
 
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = u.bits.imm;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Read;
-        trans.addr = R[u.bits.rs1] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 8;
         if (trans.addr & 0x7) {
             trans.rpayload.b64[0] = 0;
@@ -450,7 +373,7 @@ public:
                 icpu_->exceptionLoadData(&trans);
             }
         }
-        icpu_->setReg(u.bits.rd, trans.rpayload.b64[0]);
+        icpu_->setReg(op->rd, trans.rpayload.b64[0]);
         return 4;
     }
 };
@@ -466,14 +389,9 @@ public:
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
         trans.rpayload.b64[0] = 0;
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = u.bits.imm;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Read;
-        trans.addr = R[u.bits.rs1] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 4;
         if (trans.addr & 0x3) {
             trans.rpayload.b64[0] = 0;
@@ -487,7 +405,7 @@ public:
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -503,14 +421,9 @@ public:
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
         trans.rpayload.b64[0] = 0;
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = u.bits.imm;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Read;
-        trans.addr = R[u.bits.rs1] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 4;
         if (trans.addr & 0x3) {
             trans.rpayload.b64[0] = 0;
@@ -520,7 +433,7 @@ public:
                 icpu_->exceptionLoadData(&trans);
             }
         }
-        icpu_->setReg(u.bits.rd, trans.rpayload.b64[0]);
+        icpu_->setReg(op->rd, trans.rpayload.b64[0]);
         return 4;
     }
 };
@@ -536,14 +449,9 @@ public:
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
         trans.rpayload.b64[0] = 0;
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = u.bits.imm;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Read;
-        trans.addr = R[u.bits.rs1] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 2;
         if (trans.addr & 0x1) {
             trans.rpayload.b64[0] = 0;
@@ -557,7 +465,7 @@ public:
         if (res & (1LL << 15)) {
             res |= EXT_SIGN_16;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -573,14 +481,9 @@ public:
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
         trans.rpayload.b64[0] = 0;
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = u.bits.imm;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Read;
-        trans.addr = R[u.bits.rs1] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 2;
         if (trans.addr & 0x1) {
             trans.rpayload.b64[0] = 0;
@@ -590,7 +493,7 @@ public:
                 icpu_->exceptionLoadData(&trans);
             }
         }
-        icpu_->setReg(u.bits.rd, trans.rpayload.b16[0]);
+        icpu_->setReg(op->rd, trans.rpayload.b16[0]);
         return 4;
     }
 };
@@ -606,14 +509,9 @@ public:
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
         trans.rpayload.b64[0] = 0;
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = u.bits.imm;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Read;
-        trans.addr = R[u.bits.rs1] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 1;
         if (icpu_->dma_memop(&trans) == TRANS_ERROR) {
             icpu_->exceptionLoadData(&trans);
@@ -622,7 +520,7 @@ public:
         if (res & (1LL << 7)) {
             res |= EXT_SIGN_8;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -638,19 +536,14 @@ public:
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
         trans.rpayload.b64[0] = 0;
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = u.bits.imm;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Read;
-        trans.addr = R[u.bits.rs1] + off;
+        trans.addr = R[op->rs1] + op->imm;
         trans.xsize = 1;
         if (icpu_->dma_memop(&trans) == TRANS_ERROR) {
             icpu_->exceptionLoadData(&trans);
         }
-        icpu_->setReg(u.bits.rd, trans.rpayload.b8[0]);
+        icpu_->setReg(op->rd, trans.rpayload.b8[0]);
         return 4;
     }
 };
@@ -668,13 +561,8 @@ public:
         RiscvInstruction(icpu, "LUI", "?????????????????????????0110111") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_U_type u;
-        u.value = payload->buf32[0];
-        uint64_t tmp = u.bits.imm31_12 << 12;
-        if (tmp & 0x80000000) {
-            tmp |= EXT_SIGN_32;
-        }
-        icpu_->setReg(u.bits.rd, tmp);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, op->imm);
         return 4;
     }
 };
@@ -688,9 +576,8 @@ public:
         RiscvInstruction(icpu, "OR", "0000000??????????110?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] | R[u.bits.rs2]);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] | R[op->rs2]);
         return 4;
     }
 };
@@ -704,14 +591,8 @@ public:
         RiscvInstruction(icpu, "ORI", "?????????????????110?????0010011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-    
-        uint64_t imm = u.bits.imm;
-        if (imm & 0x800) {
-            imm |= EXT_SIGN_12;
-        }
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] | imm);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] | op->imm);
         return 4;
     }
 };
@@ -725,10 +606,9 @@ public:
         RiscvInstruction(icpu, "SLLI", "000000???????????001?????0010011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint32_t shamt = u.bits.imm & 0x3f;
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] << shamt);
+        RiscvOperandsType *op = operands(payload);
+        uint32_t shamt = op->imm & 0x3f;
+        icpu_->setReg(op->rd, R[op->rs1] << shamt);
         return 4;
     }
 };
@@ -744,16 +624,15 @@ public:
         RiscvInstruction(icpu, "SLT", "0000000??????????010?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf32[0];
-        if (static_cast<int64_t>(R[u.bits.rs1]) <
-                static_cast<int64_t>(R[u.bits.rs2])) {
+        if (static_cast<int64_t>(R[op->rs1]) <
+                static_cast<int64_t>(R[op->rs2])) {
             res = 1;
         } else {
             res = 0;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -771,21 +650,15 @@ public:
         RiscvInstruction(icpu, "SLTI", "?????????????????010?????0010011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf32[0];
-    
-        uint64_t imm = u.bits.imm;
-        if (imm & 0x800) {
-            imm |= EXT_SIGN_12;
-        }
-        if (static_cast<int64_t>(R[u.bits.rs1]) <
-                static_cast<int64_t>(imm)) {
+        if (static_cast<int64_t>(R[op->rs1]) <
+                static_cast<int64_t>(op->imm)) {
             res = 1;
         } else {
             res = 0;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -803,15 +676,14 @@ public:
         RiscvInstruction(icpu, "SLTU", "0000000??????????011?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf32[0];
-        if (R[u.bits.rs1] < R[u.bits.rs2]) {
+        if (R[op->rs1] < R[op->rs2]) {
             res = 1;
         } else {
             res = 0;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -830,20 +702,14 @@ public:
         RiscvInstruction(icpu, "SLTIU", "?????????????????011?????0010011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf32[0];
-    
-        uint64_t imm = u.bits.imm;
-        if (imm & 0x800) {
-            imm |= EXT_SIGN_12;
-        }
-        if (R[u.bits.rs1] < imm) {
+        if (R[op->rs1] < op->imm) {
             res = 1;
         } else {
             res = 0;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -857,9 +723,8 @@ public:
         RiscvInstruction(icpu, "SLL", "0000000??????????001?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] << (R[u.bits.rs2] & 0x3F));
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] << (R[op->rs2] & 0x3F));
         return 4;
     }
 };
@@ -873,15 +738,14 @@ public:
         RiscvInstruction(icpu, "SLLW", "0000000??????????001?????0111011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf32[0];
-        res = R[u.bits.rs1] << (R[u.bits.rs2] & 0x1F);
+        res = R[op->rs1] << (R[op->rs2] & 0x1F);
         res &= 0xFFFFFFFFLL;
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -899,17 +763,16 @@ public:
         RiscvInstruction(icpu, "SLLIW", "0000000??????????001?????0011011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf32[0];
-        uint32_t shamt = u.bits.imm & 0x1f;
-        res = R[u.bits.rs1] << shamt;
+        uint32_t shamt = op->imm & 0x1f;
+        res = R[op->rs1] << shamt;
         res &= 0xFFFFFFFFLL;
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(u.bits.rd, res);
-        if ((u.bits.imm >> 5) & 0x1) {
+        icpu_->setReg(op->rd, res);
+        if ((op->imm >> 5) & 0x1) {
             icpu_->raiseSignal(EXCEPTION_InstrIllegal);
         }
         return 4;
@@ -925,10 +788,9 @@ public:
         RiscvInstruction(icpu, "SRA", "0100000??????????101?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        icpu_->setReg(u.bits.rd,
-                static_cast<int64_t>(R[u.bits.rs1]) >> (R[u.bits.rs2] & 0x3F));
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd,
+                static_cast<int64_t>(R[op->rs1]) >> (R[op->rs2] & 0x3F));
         return 4;
     }
 };
@@ -942,11 +804,10 @@ public:
         RiscvInstruction(icpu, "SRAW", "0100000??????????101?????0111011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        int32_t t1 = static_cast<int32_t>(R[u.bits.rs1]);
-        icpu_->setReg(u.bits.rd,
-                    static_cast<int64_t>(t1 >> (R[u.bits.rs2] & 0x1F)));
+        RiscvOperandsType *op = operands(payload);
+        int32_t t1 = static_cast<int32_t>(R[op->rs1]);
+        icpu_->setReg(op->rd,
+                    static_cast<int64_t>(t1 >> (R[op->rs2] & 0x1F)));
         return 4;
     }
 };
@@ -963,10 +824,9 @@ public:
         RiscvInstruction(icpu, "SRAI", "010000???????????101?????0010011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint32_t shamt = u.bits.imm & 0x3f;
-        icpu_->setReg(u.bits.rd, static_cast<int64_t>(R[u.bits.rs1]) >> shamt);
+        RiscvOperandsType *op = operands(payload);
+        uint32_t shamt = op->imm & 0x3f;
+        icpu_->setReg(op->rd, static_cast<int64_t>(R[op->rs1]) >> shamt);
         return 4;
     }
 };
@@ -980,12 +840,11 @@ public:
         RiscvInstruction(icpu, "SRAIW", "0100000??????????101?????0011011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        int32_t t1 = static_cast<int32_t>(R[u.bits.rs1]);
-        uint32_t shamt = u.bits.imm & 0x1f;
-        icpu_->setReg(u.bits.rd, static_cast<int64_t>(t1 >> shamt));
-        if ((u.bits.imm >> 5) & 0x1) {
+        RiscvOperandsType *op = operands(payload);
+        int32_t t1 = static_cast<int32_t>(R[op->rs1]);
+        uint32_t shamt = op->imm & 0x1f;
+        icpu_->setReg(op->rd, static_cast<int64_t>(t1 >> shamt));
+        if ((op->imm >> 5) & 0x1) {
             icpu_->raiseSignal(EXCEPTION_InstrIllegal);
         }
         return 4;
@@ -1002,9 +861,8 @@ public:
         RiscvInstruction(icpu, "SRL", "0000000??????????101?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] >> (R[u.bits.rs2] & 0x3F));
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] >> (R[op->rs2] & 0x3F));
         return 4;
     }
 };
@@ -1018,10 +876,9 @@ public:
         RiscvInstruction(icpu, "SRLI", "000000???????????101?????0010011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint32_t shamt = u.bits.imm & 0x3f;
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] >> shamt);
+        RiscvOperandsType *op = operands(payload);
+        uint32_t shamt = op->imm & 0x3f;
+        icpu_->setReg(op->rd, R[op->rs1] >> shamt);
         return 4;
     }
 };
@@ -1035,12 +892,11 @@ public:
         RiscvInstruction(icpu, "SRLIW", "0000000??????????101?????0011011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-        uint32_t shamt = u.bits.imm & 0x1f;
-        uint32_t res = static_cast<uint32_t>(R[u.bits.rs1]);
+        RiscvOperandsType *op = operands(payload);
+        uint32_t shamt = op->imm & 0x1f;
+        uint32_t res = static_cast<uint32_t>(R[op->rs1]);
         res >>= shamt;
-        icpu_->setReg(u.bits.rd, static_cast<int64_t>(static_cast<int32_t>(res)));
+        icpu_->setReg(op->rd, static_cast<int64_t>(static_cast<int32_t>(res)));
         return 4;
     }
 };
@@ -1054,15 +910,14 @@ public:
         RiscvInstruction(icpu, "SRLW", "0000000??????????101?????0111011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf32[0];
-        res = static_cast<uint32_t>(R[u.bits.rs1]) >> (R[u.bits.rs2] & 0x1f);
+        res = static_cast<uint32_t>(R[op->rs1]) >> (R[op->rs2] & 0x1f);
         res &= 0xFFFFFFFFLL;
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -1083,17 +938,12 @@ public:
 
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
-        ISA_S_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = (u.bits.imm11_5 << 5) | u.bits.imm4_0;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Write;
         trans.xsize = 8;
         trans.wstrb = (1 << trans.xsize) - 1;
-        trans.addr = R[u.bits.rs1] + off;
-        trans.wpayload.b64[0] = R[u.bits.rs2];
+        trans.addr = R[op->rs1] + op->imm;
+        trans.wpayload.b64[0] = R[op->rs2];
         if (trans.addr & 0x7) {
             icpu_->raiseSignal(EXCEPTION_StoreMisalign);
         } else {
@@ -1116,17 +966,12 @@ public:
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
         trans.wpayload.b64[0] = 0;
-        ISA_S_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = (u.bits.imm11_5 << 5) | u.bits.imm4_0;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Write;
         trans.xsize = 4;
         trans.wstrb = (1 << trans.xsize) - 1;
-        trans.addr = R[u.bits.rs1] + off;
-        trans.wpayload.b64[0] = R[u.bits.rs2];
+        trans.addr = R[op->rs1] + op->imm;
+        trans.wpayload.b64[0] = R[op->rs2];
         if (trans.addr & 0x3) {
             icpu_->raiseSignal(EXCEPTION_StoreMisalign);
         } else {
@@ -1149,17 +994,12 @@ public:
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
         trans.wpayload.b64[0] = 0;
-        ISA_S_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = (u.bits.imm11_5 << 5) | u.bits.imm4_0;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Write;
         trans.xsize = 2;
         trans.wstrb = (1 << trans.xsize) - 1;
-        trans.addr = R[u.bits.rs1] + off;
-        trans.wpayload.b64[0] = R[u.bits.rs2] & 0xFFFF;
+        trans.addr = R[op->rs1] + op->imm;
+        trans.wpayload.b64[0] = R[op->rs2] & 0xFFFF;
         if (trans.addr & 0x1) {
             icpu_->raiseSignal(EXCEPTION_StoreMisalign);
         } else {
@@ -1182,17 +1022,12 @@ public:
     virtual int exec(Reg64Type *payload) {
         Axi4TransactionType trans;
         trans.wpayload.b64[0] = 0;
-        ISA_S_type u;
-        u.value = payload->buf32[0];
-        uint64_t off = (u.bits.imm11_5 << 5) | u.bits.imm4_0;
-        if (off & 0x800) {
-            off |= EXT_SIGN_12;
-        }
+        RiscvOperandsType *op = operands(payload);
         trans.action = MemAction_Write;
         trans.xsize = 1;
         trans.wstrb = (1 << trans.xsize) - 1;
-        trans.addr = R[u.bits.rs1] + off;
-        trans.wpayload.b64[0] = R[u.bits.rs2] & 0xFF;
+        trans.addr = R[op->rs1] + op->imm;
+        trans.wpayload.b64[0] = R[op->rs2] & 0xFF;
         if (icpu_->dma_memop(&trans) == TRANS_ERROR) {
             icpu_->exceptionStoreData(&trans);
         }
@@ -1209,9 +1044,8 @@ public:
         RiscvInstruction(icpu, "SUB", "0100000??????????000?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] - R[u.bits.rs2]);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] - R[op->rs2]);
         return 4;
     }
 };
@@ -1230,15 +1064,14 @@ public:
         RiscvInstruction(icpu, "SUBW", "0100000??????????000?????0111011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
+        RiscvOperandsType *op = operands(payload);
         uint64_t res;
-        u.value = payload->buf32[0];
         
-        res = (R[u.bits.rs1] - R[u.bits.rs2]) & 0xFFFFFFFFLL;
+        res = (R[op->rs1] - R[op->rs2]) & 0xFFFFFFFFLL;
         if (res & (1LL << 31)) {
             res |= EXT_SIGN_32;
         }
-        icpu_->setReg(u.bits.rd, res);
+        icpu_->setReg(op->rd, res);
         return 4;
     }
 };
@@ -1252,9 +1085,8 @@ public:
         RiscvInstruction(icpu, "XOR", "0000000??????????100?????0110011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_R_type u;
-        u.value = payload->buf32[0];
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] ^ R[u.bits.rs2]);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] ^ R[op->rs2]);
         return 4;
     }
 };
@@ -1271,14 +1103,8 @@ public:
         RiscvInstruction(icpu, "XORI", "?????????????????100?????0010011") {}
 
     virtual int exec(Reg64Type *payload) {
-        ISA_I_type u;
-        u.value = payload->buf32[0];
-    
-        uint64_t imm = u.bits.imm;
-        if (imm & 0x800) {
-            imm |= EXT_SIGN_12;
-        }
-        icpu_->setReg(u.bits.rd, R[u.bits.rs1] ^ imm);
+        RiscvOperandsType *op = operands(payload);
+        icpu_->setReg(op->rd, R[op->rs1] ^ op->imm);
         return 4;
     }
 };
@@ -148,10 +148,14 @@ RiscvSourceService::RiscvSourceService(const char *name) : IService(name) {
 
     brList_.make_list(0);
     symbolListSortByName_.make_list(0);
-    symbolListSortByAddr_.make_list(0);
+    symbolsDirty_ = false;
+    RISCV_mutex_init(&mutexSymbols_);
+    RISCV_mutex_init(&mutexDisasm_);
 }
 
 RiscvSourceService::~RiscvSourceService() {
+    RISCV_mutex_destroy(&mutexSymbols_);
+    RISCV_mutex_destroy(&mutexDisasm_);
 }
 
 void RiscvSourceService::postinitService() {
@@ -165,11 +169,12 @@ void RiscvSourceService::addFileSymbol(const char *name, uint64_t addr,
     symb[Symbol_Addr].make_uint64(addr);
     symb[Symbol_Size].make_int64(sz);
 
+    RISCV_mutex_lock(&mutexSymbols_);
     symbolListSortByName_.add_to_list(&symb);
-    symbolListSortByName_.sort(Symbol_Name);
-
-    symbolListSortByAddr_.add_to_list(&symb);
-    symbolListSortByAddr_.sort(Symbol_Addr);
+    symbolIndex_.add(name, addr, static_cast<uint64_t>(sz), 0);
+    symbolsDirty_ = true;
+    RISCV_mutex_unlock(&mutexSymbols_);
+    invalidateDisasm();
 }
 
 void RiscvSourceService::addFunctionSymbol(const char *name,
@@ -183,93 +188,80 @@ void RiscvSourceService::addDataSymbol(const char *name, uint64_t addr,
 }
 
 void RiscvSourceService::clearSymbols() {
+    RISCV_mutex_lock(&mutexSymbols_);
     symbolListSortByName_.make_list(0);
-    symbolListSortByAddr_.make_list(0);
+    symbolIndex_.clear();
+    symbolsDirty_ = false;
+    RISCV_mutex_unlock(&mutexSymbols_);
+    invalidateDisasm();
 }
 
 void RiscvSourceService::addSymbols(AttributeType *list) {
+    RISCV_mutex_lock(&mutexSymbols_);
     for (unsigned i = 0; i < list->size(); i++) {
         AttributeType &item = (*list)[i];
         symbolListSortByName_.add_to_list(&item);
-        symbolListSortByAddr_.add_to_list(&item);
+        symbolIndex_.add(item[Symbol_Name].to_string(),
+                         item[Symbol_Addr].to_uint64(),
+                         item[Symbol_Size].to_uint64(),
+                         item[Symbol_Type].to_uint32());
+    }
+    symbolsDirty_ = true;
+    RISCV_mutex_unlock(&mutexSymbols_);
+    invalidateDisasm();
+}
+
+/**
+ * Symbols are sorted and indexed once on the first lookup after changes
+ * instead of on each added symbol. Caller holds mutexSymbols_.
+ */
+void RiscvSourceService::updateSymbols() {
+    if (!symbolsDirty_) {
+        return;
     }
     symbolListSortByName_.sort(Symbol_Name);
-    symbolListSortByAddr_.sort(Symbol_Addr);
+    symbolIndex_.build();
+    symbolsDirty_ = false;
 }
 
-void RiscvSourceService::addressToSymbol(uint64_t addr, AttributeType *info) {
-    uint64_t sadr, send;
-    int sz = static_cast<int>(symbolListSortByAddr_.size());
+void RiscvSourceService::getSymbols(AttributeType *list) {
+    RISCV_mutex_lock(&mutexSymbols_);
+    updateSymbols();
+    *list = symbolListSortByName_;
+    RISCV_mutex_unlock(&mutexSymbols_);
+}
 
+void RiscvSourceService::invalidateDisasm() {
+    RISCV_mutex_lock(&mutexDisasm_);
+    disasmCache_.invalidate();
+    RISCV_mutex_unlock(&mutexDisasm_);
+}
+
+void RiscvSourceService::addressToSymbol(uint64_t addr, AttributeType *info) {
+    uint64_t offset = 0;
+    RISCV_mutex_lock(&mutexSymbols_);
+    const char *name = addressToSymbol(addr, &offset);
     info->make_list(SymbInfo_Total);
-    (*info)[SymbInfo_Name].make_string("");
-    (*info)[SymbInfo_Address].make_uint64(0);
-    if (sz == 0) {
-        return;
-    }
-    sadr = symbolListSortByAddr_[0u][Symbol_Addr].to_uint64();
-    if (addr < sadr) {
-        return;
-    }
+    (*info)[SymbInfo_Name].make_string(name ? name : "");
+    (*info)[SymbInfo_Address].make_uint64(offset);
+    RISCV_mutex_unlock(&mutexSymbols_);
+}
 
-    bool search = true;
-    int dist, pos = sz / 2;
-    dist = pos;
-    while (search) {
-        AttributeType &symb = symbolListSortByAddr_[pos];
-        sadr = symb[Symbol_Addr].to_uint64();
-        if (pos < static_cast<int>(symbolListSortByAddr_.size()) - 1) {
-            send = symbolListSortByAddr_[pos + 1][Symbol_Addr].to_uint64();
-        } else {
-            send = sadr + symb[Symbol_Size].to_uint64();
-        }
-        if (sadr <= addr && addr < send) {
-            (*info)[SymbInfo_Name] = symb[Symbol_Name];
-            (*info)[SymbInfo_Address].make_uint64(addr - sadr);
-            return;
-        }
-        
-        if (addr < sadr) {
-            if (dist == 0 || pos == 0) {
-                search = false;
-            } else if (dist == 1) {
-                dist = 0;
-                pos--;
-            } else {
-                int incr = dist / 2;
-                pos -= incr;
-                dist = (dist / 2) + (dist & 0x1);
-                if (pos < 0) {
-                    pos = 0;
-                }
-            }
-        } else {
-            if (dist == 0 || pos == (sz - 1)) {
-                search = false;
-            } else if (dist == 1) {
-                dist = 0;
-                pos++;
-            } else {
-                int incr = dist / 2;
-                pos += incr;
-                dist = (dist / 2) + (dist & 0x1);
-                if (pos >= sz) {
-                    pos = sz - 1;
-                }
-            }
-        }
-    }
+/** Name points into the index and is valid until symbols are changed */
+const char *RiscvSourceService::addressToSymbol(uint64_t addr, uint64_t *offset) {
+    RISCV_mutex_lock(&mutexSymbols_);
+    updateSymbols();
+    const char *name = symbolIndex_.find(addr, offset);
+    RISCV_mutex_unlock(&mutexSymbols_);
+    return name;
 }
 
 int RiscvSourceService::symbol2Address(const char *name, uint64_t *addr) {
-    for (unsigned i = 0; i < symbolListSortByName_.size(); i++) {
-        AttributeType &item = symbolListSortByName_[i];
-        if (item[Symbol_Name].is_equal(name)) {
-            *addr = item[Symbol_Addr].to_uint64();
-            return 0;
-        }
-    }
-    return -1;
+    RISCV_mutex_lock(&mutexSymbols_);
+    updateSymbols();
+    int ret = symbolIndex_.find(name, addr);
+    RISCV_mutex_unlock(&mutexSymbols_);
+    return ret;
 }
 
 void RiscvSourceService::registerBreakpoint(uint64_t addr,
@@ -367,38 +359,65 @@ void RiscvSourceService::disasm(uint64_t pc,
         return;
     }
     uint8_t *data = idata->data();
+    uint64_t total = idata->size();
 
-    AttributeType asm_item, symb_item, info;
+    AttributeType asm_item, symb_item;
+    const char *symb_name;
+    uint64_t symb_off;
     asm_item.make_list(ASM_Total);
     symb_item.make_list(3);
     asm_item[ASM_list_type].make_int64(AsmList_disasm);
     symb_item[ASM_list_type].make_int64(AsmList_symbol);
+    asm_item[ASM_label].make_string("");
     uint64_t off = 0;
     Reg64Type code;
     int codesz;
+    const DisasmCacheType::LineType *line;
 
-    while (static_cast<unsigned>(off) < idata->size()) {
-        code.val = *reinterpret_cast<uint32_t*>(&data[off]);
+    // Breakpoints of the window are selected once
+    AttributeType brwin(Attr_List);
+    for (unsigned i = 0; i < brList_.size(); i++) {
+        uint64_t bradr = brList_[i][BrkList_address].to_uint64();
+        if (bradr >= pc && bradr < pc + total) {
+            brwin.add_to_list(&brList_[i][BrkList_address]);
+        }
+    }
 
-        addressToSymbol(pc + off, &info);
-        if (info[SymbInfo_Name].size() != 0 && 
-            info[SymbInfo_Address].to_int() == 0) {
+    RISCV_mutex_lock(&mutexDisasm_);
+    while (off < total) {
+        // Last instruction may be truncated: never read beyond the buffer
+        code.val = 0;
+        memcpy(code.buf, &data[off], total - off < 4 ? total - off : 4);
+
+        symb_name = addressToSymbol(pc + off, &symb_off);
+        if (symb_name && symb_off == 0) {
             symb_item[1].make_uint64(pc + off);
-            symb_item[2].make_string(info[SymbInfo_Name].to_string());
+            symb_item[2].make_string(symb_name);
             asmlist->add_to_list(&symb_item);
         }
         asm_item[ASM_addrline].make_uint64(pc + off);
         asm_item[ASM_breakpoint].make_boolean(false);
-        asm_item[ASM_label].make_string("");
+        for (unsigned i = 0; i < brwin.size(); i++) {
+            if (brwin[i].to_uint64() == pc + off) {
+                asm_item[ASM_breakpoint].make_boolean(true);
+                break;
+            }
+        }
 
-        if (isBreakpoint(pc + off)) {
-            asm_item[ASM_breakpoint].make_boolean(true);
+        line = disasmCache_.get(pc + off, code.buf32[0], 0);
+        if (line) {
+            codesz = line->codesz;
+            asm_item[ASM_mnemonic] = line->mnemonic;
+            asm_item[ASM_comment] = line->comment;
+        } else {
+            codesz = disasm(pc + off,
+                            code.buf,
+                            0,
+                            &asm_item[ASM_mnemonic],
+                            &asm_item[ASM_comment]);
+            disasmCache_.put(pc + off, code.buf32[0], 0, codesz,
+                             asm_item[ASM_mnemonic], asm_item[ASM_comment]);
         }
-        codesz = disasm(pc + off,
-                        code.buf,
-                        0,
-                        &asm_item[ASM_mnemonic],
-                        &asm_item[ASM_comment]);
 
 #if 1
         uint64_t swap = code.val;
@@ -416,6 +435,7 @@ void RiscvSourceService::disasm(uint64_t pc,
         asmlist->add_to_list(&asm_item);
         off += codesz;
     }
+    RISCV_mutex_unlock(&mutexDisasm_);
 }
 
 int opcode_0x00(ISourceCode *isrc, uint64_t pc, uint32_t code,
@@ -1003,15 +1023,14 @@ int opcode_0x18(ISourceCode *isrc, uint64_t pc, uint32_t code,
     }
 
     if (isrc) {
-        AttributeType info;
-        isrc->addressToSymbol(imm64, &info);
-        if (info[0u].size()) {
-            if (info[1].to_uint32() == 0) {
-                RISCV_sprintf(tcomm, sizeof(tcomm), "%s",
-                        info[0u].to_string());
+        uint64_t symb_off;
+        const char *symb_name = isrc->addressToSymbol(imm64, &symb_off);
+        if (symb_name) {
+            if (symb_off == 0) {
+                RISCV_sprintf(tcomm, sizeof(tcomm), "%s", symb_name);
             } else {
                 RISCV_sprintf(tcomm, sizeof(tcomm), "%s+%xh",
-                        info[0u].to_string(), info[1].to_uint32());
+                        symb_name, static_cast<uint32_t>(symb_off));
             }
         }
     }
@@ -1072,15 +1091,14 @@ int opcode_0x1B(ISourceCode *isrc, uint64_t pc, uint32_t code,
     }
 
     if (isrc) {
-        AttributeType info;
-        isrc->addressToSymbol(pc + imm64, &info);
-        if (info[0u].size()) {
-            if (info[1].to_uint32() == 0) {
-                RISCV_sprintf(tcomm, sizeof(tcomm), "%s",
-                        info[0u].to_string());
+        uint64_t symb_off;
+        const char *symb_name = isrc->addressToSymbol(pc + imm64, &symb_off);
+        if (symb_name) {
+            if (symb_off == 0) {
+                RISCV_sprintf(tcomm, sizeof(tcomm), "%s", symb_name);
             } else {
                 RISCV_sprintf(tcomm, sizeof(tcomm), "%s+%xh",
-                        info[0u].to_string(), info[1].to_uint32());
+                        symb_name, static_cast<uint32_t>(symb_off));
             }
         }
     }
@@ -20,6 +20,8 @@
 #include <iclass.h>
 #include <iservice.h>
 #include "coreservices/isrccode.h"
+#include "symbolindex.h"
+#include "disasmcache.h"
 
 namespace debugger {
 
@@ -50,12 +52,12 @@ public:
 
     virtual void clearSymbols();
 
-    virtual void getSymbols(AttributeType *list) {
-        *list = symbolListSortByName_;
-    }
+    virtual void getSymbols(AttributeType *list);
 
     virtual void addressToSymbol(uint64_t addr, AttributeType *info);
 
+    virtual const char *addressToSymbol(uint64_t addr, uint64_t *offset);
+
     virtual int symbol2Address(const char *name, uint64_t *addr);
 
     virtual int disasm(uint64_t pc,
@@ -77,12 +79,20 @@ public:
 
     virtual bool isBreakpoint(uint64_t addr);
 
+private:
+    void invalidateDisasm();
+    void updateSymbols();
+
 private:
     disasm_opcode_f tblOpcode1_[32];
     disasm_opcode16_f tblCompressed_[32];
     AttributeType brList_;
     AttributeType symbolListSortByName_;
-    AttributeType symbolListSortByAddr_;
+    SymbolIndexType symbolIndex_;
+    bool symbolsDirty_;             // list isn't sorted, index isn't built
+    mutex_def mutexSymbols_;
+    DisasmCacheType disasmCache_;
+    mutex_def mutexDisasm_;
 };
 
 DECLARE_CLASS(RiscvSourceService)
@@ -29,6 +29,9 @@ class CmdCsr : public ICommand  {
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) {
+        return args->size() == 2;
+    }
 
  private:
     void to_string(AttributeType *args, AttributeType *res, AttributeType *out);
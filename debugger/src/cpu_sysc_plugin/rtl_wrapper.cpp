@@ -58,6 +58,7 @@ RtlWrapper::RtlWrapper(IFace *parent, sc_module_name name) : sc_module(name),
     r.clk_cnt = 0;
     RISCV_event_create(&dport_.valid, "dport_valid");
     dport_.trans_idx_up = 0;
+    dport_.cnt = 0;
     dport_.trans_idx_down = 0;
     trans.source_idx = 0;//CFG_NASTI_MASTER_CACHED;
 
@@ -334,7 +335,13 @@ void RtlWrapper::sys_bus_proc() {
                          dport_.trans_idx_up, dport_.trans_idx_down);
             dport_.trans_idx_down = dport_.trans_idx_up;
         }
-        dport_.cb->nb_response_debug_port(dport_.trans);
+        if (--dport_.cnt > 0) {
+            dport_.trans++;
+            dport_.trans_idx_up++;
+            RISCV_event_set(&dport_.valid);
+        } else {
+            dport_.cb->nb_response_debug_port(dport_.first);
+        }
     }
 
 }
@@ -403,7 +410,15 @@ void RtlWrapper::lowerSignal(int idx) {
 
 void RtlWrapper::nb_transport_debug_port(DebugPortTransactionType *trans,
                                          IDbgNbResponse *cb) {
+    nb_transport_debug_port(trans, 1, cb);
+}
+
+/** RTL port accepts one request at a time, vector items are chained */
+void RtlWrapper::nb_transport_debug_port(DebugPortTransactionType *trans,
+                                         int cnt, IDbgNbResponse *cb) {
     dport_.trans = trans;
+    dport_.first = trans;
+    dport_.cnt = cnt;
     dport_.cb = cb;
     dport_.trans_idx_up++;
     RISCV_event_set(&dport_.valid);
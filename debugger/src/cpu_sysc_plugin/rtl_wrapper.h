@@ -123,6 +123,8 @@ class RtlWrapper : public sc_module,
     virtual void lowerSignal(int idx);
     virtual void nb_transport_debug_port(DebugPortTransactionType *trans,
                                         IDbgNbResponse *cb);
+    virtual void nb_transport_debug_port(DebugPortTransactionType *trans,
+                                         int cnt, IDbgNbResponse *cb);
 
     /** ICpuRiscV interface */
     virtual uint64_t readCSR(int idx) { return 0;}
@@ -155,6 +157,8 @@ class RtlWrapper : public sc_module,
     struct DebugPortType {
         event_def valid;
         DebugPortTransactionType *trans;
+        DebugPortTransactionType *first;    // vector start
+        int cnt;                            // items left in vector
         IDbgNbResponse *cb;
         unsigned trans_idx_up;
         unsigned trans_idx_down;
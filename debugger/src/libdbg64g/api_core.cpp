@@ -153,6 +153,11 @@ extern "C" void RISCV_trigger_hap(int type, uint64_t param,
     pcore_->triggerHap(type, param, descr);
 }
 
+extern "C" void RISCV_post_hap(int type, uint64_t param,
+                               const char *descr) {
+    pcore_->postHap(type, param, descr);
+}
+
 extern "C" IFace *RISCV_get_class(const char *name) {
     return pcore_->getClass(name);
 }
@@ -337,6 +342,15 @@ extern "C" int RISCV_printf(void *iface, int level,
     int ret = 0;
     va_list arg;
     IFace *iout = reinterpret_cast<IFace *>(iface);
+    IService *iserv = NULL;
+    if (iout != NULL && (iout->getFaceName() == IFACE_SERVICE
+        || strcmp(iout->getFaceName(), IFACE_SERVICE) == 0)) {
+        iserv = static_cast<IService *>(iout);
+        // Filter before any locking: most of debug messages are skipped
+        if (level > iserv->getLogLevel()) {
+            return 0;
+        }
+    }
     uint64_t cur_t = pcore_->getTimestamp();
 
     char *buf = pcore_->getpBufLog();
@@ -345,14 +359,7 @@ extern "C" int RISCV_printf(void *iface, int level,
     if (iout == NULL) {
         ret = RISCV_sprintf(buf, buf_sz,
                     "[%" RV_PRI64 "d, \"%s\", \"", cur_t, "unknown");
-    } else if (strcmp(iout->getFaceName(), IFACE_SERVICE) == 0) {
-        IService *iserv = static_cast<IService *>(iout);
-        AttributeType *local_level = 
-                static_cast<AttributeType *>(iserv->getAttribute("LogLevel"));
-        if (level > static_cast<int>(local_level->to_int64())) {
-            pcore_->unlockPrintf();
-            return 0;
-        }
+    } else if (iserv) {
         ret = RISCV_sprintf(buf, buf_sz,
                 "[%" RV_PRI64 "d, \"%s\", \"", cur_t, iserv->getObjName());
     } else if (strcmp(iout->getFaceName(), IFACE_CLASS) == 0) {
@@ -399,11 +406,7 @@ extern "C" int RISCV_sscanf(const char *s, const char *fmt, ...) {
     int ret;
     va_list arg;
     va_start(arg, fmt);
-#if defined(_WIN32) || defined(__CYGWIN__)
     ret = vsscanf(s, fmt, arg);
-#else
-    ret = vsscanf(fmt, s, arg);
-#endif
     va_end(arg);
     return ret;
 }
@@ -612,7 +615,7 @@ extern "C" void* RISCV_memshare_map(sharemem_def h, int sz) {
                         sz);
 #else
     ret = mmap(NULL, sz + 1, PROT_READ|PROT_WRITE, MAP_SHARED, h, 0);
-    if (ret < 0) {
+    if (ret == MAP_FAILED) {
         ret = 0;
     }
 #endif
@@ -638,6 +641,60 @@ extern "C" void RISCV_memshare_delete(sharemem_def h) {
 #endif
 }
 
+extern "C" const uint8_t *RISCV_file_map(const char *filename, int64_t *sz) {
+    const uint8_t *ret = 0;
+    *sz = 0;
+#if defined(_WIN32) || defined(__CYGWIN__)
+    HANDLE hfile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hfile == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    LARGE_INTEGER fsz;
+    if (!GetFileSizeEx(hfile, &fsz) || fsz.QuadPart == 0) {
+        CloseHandle(hfile);
+        return 0;
+    }
+    HANDLE hmap = CreateFileMappingA(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (hmap) {
+        ret = static_cast<const uint8_t *>(
+                MapViewOfFile(hmap, FILE_MAP_READ, 0, 0, 0));
+        // The view holds the mapping object
+        CloseHandle(hmap);
+    }
+    CloseHandle(hfile);
+    if (ret) {
+        *sz = fsz.QuadPart;
+    }
+#else
+    struct stat st;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ret = static_cast<const uint8_t *>(p);
+            *sz = st.st_size;
+        }
+    }
+    close(fd);
+#endif
+    return ret;
+}
+
+extern "C" void RISCV_file_unmap(const uint8_t *buf, int64_t sz) {
+    if (!buf) {
+        return;
+    }
+#if defined(_WIN32) || defined(__CYGWIN__)
+    UnmapViewOfFile(buf);
+#else
+    munmap(const_cast<uint8_t *>(buf), static_cast<size_t>(sz));
+#endif
+}
+
 extern "C" int RISCV_mutex_init(mutex_def *mutex) {
 #if defined(_WIN32) || defined(__CYGWIN__)
     InitializeCriticalSection(mutex);
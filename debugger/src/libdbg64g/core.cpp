@@ -36,9 +36,14 @@ CoreService::CoreService(const char *name) : IService("CoreService") {
     listClasses_.make_list(0);
     listHap_.make_list(0);
     listConsole_.make_list(0);
+    hapQueue_.make_list(0);
 
     RISCV_mutex_init(&mutexPrintf_);
     RISCV_mutex_init(&mutexDefaultConsoles_);
+    RISCV_mutex_init(&mutexHapList_);
+    RISCV_mutex_init(&mutexHapQueue_);
+    hapThread_.Handle = 0;
+    hapBusEnable_ = false;
     RISCV_mutex_init(&mutexLogFile_);
     //logLevel_.make_int64(LOG_DEBUG);  // default = LOG_ERROR
     iclk_ = 0;
@@ -53,6 +58,8 @@ CoreService::~CoreService() {
     RISCV_mutex_lock(&mutexDefaultConsoles_);
     RISCV_mutex_destroy(&mutexDefaultConsoles_);
     RISCV_mutex_destroy(&mutexLogFile_);
+    RISCV_mutex_destroy(&mutexHapList_);
+    RISCV_mutex_destroy(&mutexHapQueue_);
     RISCV_event_close(&eventExiting_);
 }
 
@@ -131,10 +138,12 @@ void CoreService::postinitPlatformServices() {
         icls = static_cast<IClass *>(listClasses_[i].to_iface());
         icls->postinitServices();
     }
+    startHapBus();
 }
 
 void CoreService::predeletePlatformServices() {
     IClass *icls;
+    stopHapBus();
     for (unsigned i = 0; i < listClasses_.size(); i++) {
         icls = static_cast<IClass *>(listClasses_[i].to_iface());
         icls->predeleteServices();
@@ -172,11 +181,14 @@ void CoreService::unregisterClass(const char *clsname) {
 
 void CoreService::registerHap(IFace *ihap) {
     AttributeType item(ihap);
+    RISCV_mutex_lock(&mutexHapList_);
     listHap_.add_to_list(&item);
+    RISCV_mutex_unlock(&mutexHapList_);
 }
 
 void CoreService::unregisterHap(IFace *ihap) {
     IFace *iface;
+    RISCV_mutex_lock(&mutexHapList_);
     for (unsigned i = 0; i < listHap_.size(); i++) {
         iface = listHap_[i].to_iface();
         if (ihap == iface) {
@@ -184,6 +196,7 @@ void CoreService::unregisterHap(IFace *ihap) {
             break;
         }
     }
+    RISCV_mutex_unlock(&mutexHapList_);
 }
 
 void CoreService::registerConsole(IFace *iconsole) {
@@ -349,7 +362,9 @@ void CoreService::unload_plugins() {
 void CoreService::triggerHap(int type, uint64_t param, const char *descr) {
     IHap *ihap;
     EHapType etype = static_cast<EHapType>(type);
+    RISCV_mutex_lock(&mutexHapList_);
     AttributeType haplist = listHap_;
+    RISCV_mutex_unlock(&mutexHapList_);
     // Hap handler can unregister itself so we need to las valid list
     for (unsigned i = 0; i < haplist.size(); i++) {
         ihap = static_cast<IHap *>(haplist[i].to_iface());
@@ -360,6 +375,104 @@ void CoreService::triggerHap(int type, uint64_t param, const char *descr) {
     haplist.attr_free();
 }
 
+/**
+ * Haps are queued and delivered by the bus thread. Pending notifications
+ * are coalesced: HAP_RegChanged and HAP_MemDirty with the same parameter
+ * are delivered once, other haps are dropped only if the same hap is the
+ * last in queue so that the order of halt/resume events is kept.
+ */
+void CoreService::postHap(int type, uint64_t param, const char *descr) {
+    unsigned pages = 0;
+    bool drop = false;
+    RISCV_mutex_lock(&mutexHapQueue_);
+    unsigned total = hapQueue_.size();
+    if (type == HAP_RegChanged || type == HAP_MemDirty) {
+        for (unsigned i = 0; i < total; i++) {
+            const AttributeType &item = hapQueue_[i];
+            if (item[0u].to_int() != type) {
+                continue;
+            }
+            if (item[1].to_uint64() == param
+                || (type == HAP_MemDirty && item[1].to_uint64() == ~0ull)) {
+                drop = true;
+                break;
+            }
+            pages++;
+        }
+    } else if (total) {
+        const AttributeType &item = hapQueue_[total - 1];
+        drop = item[0u].to_int() == type && item[1].to_uint64() == param;
+    }
+
+    if (!drop && type == HAP_MemDirty && pages >= HAP_MEMDIRTY_PAGES_MAX) {
+        // Too many pages: the whole memory is reported as modified
+        for (unsigned i = hapQueue_.size(); i > 0; i--) {
+            if (hapQueue_[i - 1][0u].to_int() == HAP_MemDirty) {
+                hapQueue_.remove_from_list(i - 1);
+            }
+        }
+        param = ~0ull;
+    }
+
+    if (!drop) {
+        AttributeType item;
+        item.make_list(3);
+        item[0u].make_int64(type);
+        item[1].make_uint64(param);
+        item[2].make_string(descr ? descr : "");
+        hapQueue_.add_to_list(&item);
+    }
+    RISCV_mutex_unlock(&mutexHapQueue_);
+
+    if (hapBusEnable_) {
+        RISCV_event_set(&eventHapPosted_);
+    }
+}
+
+void CoreService::startHapBus() {
+    RISCV_event_create(&eventHapPosted_, "eventHapPosted");
+    hapBusEnable_ = true;
+    hapThread_.func = reinterpret_cast<lib_thread_func>(runHapBus);
+    hapThread_.args = this;
+    RISCV_thread_create(&hapThread_);
+}
+
+void CoreService::stopHapBus() {
+    if (!hapBusEnable_) {
+        return;
+    }
+    hapBusEnable_ = false;
+    RISCV_event_set(&eventHapPosted_);
+    if (hapThread_.Handle) {
+        RISCV_thread_join(hapThread_.Handle, 5000);
+    }
+    hapThread_.Handle = 0;
+    RISCV_event_close(&eventHapPosted_);
+}
+
+void CoreService::runHapBus(void *arg) {
+    reinterpret_cast<CoreService *>(arg)->hapBusLoop();
+}
+
+void CoreService::hapBusLoop() {
+    AttributeType pending;
+    while (hapBusEnable_) {
+        RISCV_mutex_lock(&mutexHapQueue_);
+        RISCV_event_clear(&eventHapPosted_);
+        pending = std::move(hapQueue_);
+        hapQueue_.make_list(0);
+        RISCV_mutex_unlock(&mutexHapQueue_);
+
+        for (unsigned i = 0; i < pending.size(); i++) {
+            const AttributeType &item = pending[i];
+            triggerHap(item[0u].to_int(), item[1].to_uint64(),
+                       item[2].to_string());
+        }
+        pending.attr_free();
+        RISCV_event_wait(&eventHapPosted_);
+    }
+}
+
 IFace *CoreService::getClass(const char *name) {
     IClass *icls;
     for (unsigned i = 0; i < listClasses_.size(); i++) {
@@ -61,6 +61,7 @@ class CoreService : public IService {
     void registerHap(IFace *ihap);
     void unregisterHap(IFace *ihap);
     void triggerHap(int type, uint64_t param, const char *descr);
+    void postHap(int type, uint64_t param, const char *descr);
     void registerConsole(IFace *iconsole);
     void unregisterConsole(IFace *iconsole);
 
@@ -83,18 +84,30 @@ class CoreService : public IService {
     size_t sizeBufLog() { return sizeof(bufLog_); }
     void generateUniqueName(const char *prefix, char *out, size_t outsz);
 
+ private:
+    void startHapBus();
+    void stopHapBus();
+    static void runHapBus(void *arg);
+    void hapBusLoop();
+
  private:
     AttributeType Config_;
     AttributeType listPlugins_;
     AttributeType listClasses_;
     AttributeType listHap_;
     AttributeType listConsole_;
+    AttributeType hapQueue_;        // posted haps: [[type, param, descr],..]
 
     int active_;
     event_def eventExiting_;
     mutex_def mutexLogFile_;
     mutex_def mutexPrintf_;
     mutex_def mutexDefaultConsoles_;
+    mutex_def mutexHapList_;
+    mutex_def mutexHapQueue_;
+    event_def eventHapPosted_;
+    LibThreadType hapThread_;
+    bool hapBusEnable_;
 
     IFace *iclk_;
     FILE *logFile_;
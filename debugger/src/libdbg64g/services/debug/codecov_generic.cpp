@@ -136,7 +136,8 @@ void GenericCodeCoverage::getCoverageDetailed(AttributeType *resp) {
     unsigned off;
     uint8_t marked;
     AttributeType item;
-    AttributeType symbol;
+    const char *symb_name;
+    uint64_t symb_off;
     bool split_section;
     enum EStage {
         SectionMarked,
@@ -163,9 +164,11 @@ void GenericCodeCoverage::getCoverageDetailed(AttributeType *resp) {
         }
         item[1].make_uint64(sec_start);        // start addess initial value
         item[2].make_uint64(sec_start);        // end address initial value
-        isrc_->addressToSymbol(sec_start, &symbol);
+        symb_off = 0;
+        symb_name = isrc_->addressToSymbol(sec_start, &symb_off);
         RISCV_sprintf(tstr, sizeof(tstr), "%s+0x%x",
-                        symbol[0u].to_string(), symbol[1].to_uint32());
+                        symb_name ? symb_name : "",
+                        static_cast<uint32_t>(symb_off));
         item[3].make_string(tstr);
 
         while (sec_cnt < sec_sz) {
@@ -195,9 +198,11 @@ void GenericCodeCoverage::getCoverageDetailed(AttributeType *resp) {
                 item[0u].make_boolean(marked ? true: false);
                 item[1].make_uint64(off);               // start address
                 item[2].make_uint64(off);               // end address initial value
-                isrc_->addressToSymbol(off, &symbol);
+                symb_off = 0;
+                symb_name = isrc_->addressToSymbol(off, &symb_off);
                 RISCV_sprintf(tstr, sizeof(tstr), "%s+0x%x",
-                              symbol[0u].to_string(), symbol[1].to_uint32());
+                              symb_name ? symb_name : "",
+                              static_cast<uint32_t>(symb_off));
                 item[3].make_string(tstr);
             }
 
@@ -33,6 +33,7 @@ CpuMonitor::CpuMonitor(const char *name)
     registerAttribute("PollingMs", &pollingMs_);
 
     RISCV_event_create(&config_done_, "cpumonitor_config_done");
+    RISCV_event_create(&eventHalted_, "cpumonitor_halted");
     RISCV_mutex_init(&mutex_resume_);
     RISCV_register_hap(static_cast<IHap *>(this));
     hartsel_ = 0;
@@ -40,6 +41,7 @@ CpuMonitor::CpuMonitor(const char *name)
 
 CpuMonitor::~CpuMonitor() {
     RISCV_event_close(&config_done_);
+    RISCV_event_close(&eventHalted_);
     RISCV_mutex_destroy(&mutex_resume_);
 }
 
@@ -65,39 +67,64 @@ void CpuMonitor::hapTriggered(EHapType type,
                               const char *descr) {
     if (type == HAP_ConfigDone) {
         RISCV_event_set(&config_done_);
+    } else if (type == HAP_CpuHalted) {
+        RISCV_event_set(&eventHalted_);
     } else if (type == HAP_CpuContextChanged) {
         hartsel_ = param;
     } else if (type == HAP_Resume) {
-        // CPU can halt faster than than we poll bits
+        // CPU can halt faster than than we poll bits. Param is a mask of
+        // resumed harts, zero means the selected context.
         RISCV_mutex_lock(&mutex_resume_);
-        haltsum_ &= ~(1ull << (hartsel_ & 0x3f));
+        if (param) {
+            haltsum_ &= ~param;
+        } else {
+            haltsum_ &= ~(1ull << (hartsel_ & 0x3f));
+        }
         RISCV_mutex_unlock(&mutex_resume_);
     }
 }
 
+void CpuMonitor::stop() {
+    // Thread may wait CPU notification without timeout (PollingMs = 0)
+    RISCV_event_clear(&loopEnable_);
+    RISCV_event_set(&config_done_);
+    RISCV_event_set(&eventHalted_);
+    IThread::stop();
+}
+
 void CpuMonitor::busyLoop() {
     uint64_t status;
-    uint64_t mask;
+    uint64_t halted;
     uint64_t t1;
     RISCV_event_wait(&config_done_);
 
     while (isEnabled()) {
-        RISCV_sleep_ms(pollingMs_.to_int());
+        // PollingMs = 0: simulated CPU notifies about halt, no polling
+        if (pollingMs_.to_int() == 0) {
+            RISCV_event_wait(&eventHalted_);
+        } else {
+            RISCV_event_wait_ms(&eventHalted_, pollingMs_.to_int());
+        }
+        RISCV_event_clear(&eventHalted_);
+        if (!isEnabled()) {
+            break;
+        }
 
         status = getStatus();
 
         RISCV_mutex_lock(&mutex_resume_);
-        mask = 1ull << (hartsel_ & 0x3f);
         t1 = haltsum_;
         haltsum_ = status;
         RISCV_mutex_unlock(&mutex_resume_);
 
-        if (((t1 ^ status) & mask) != 0) {
-            if (status & mask) {
-                removeBreakpoints();
-                RISCV_trigger_hap(HAP_Halt,
-                                  hartsel_,
-                                  "Selected core is halted");
+        // Every hart is reported separately, param is the hart index
+        halted = ~t1 & status;
+        if (halted) {
+            removeBreakpoints();
+        }
+        for (unsigned i = 0; halted; i++, halted >>= 1) {
+            if (halted & 0x1) {
+                RISCV_trigger_hap(HAP_Halt, i, "Core is halted");
             }
         }
     }
@@ -39,6 +39,9 @@ class CpuMonitor : public IService,
     virtual void hapTriggered(EHapType type, uint64_t param,
                               const char *descr);
 
+    /** IThread interface */
+    virtual void stop();
+
  protected:
     /** IThread interface */
     virtual void busyLoop();
@@ -57,6 +60,7 @@ class CpuMonitor : public IService,
     ICmdExecutor *icmdexec_;
 
     event_def config_done_;
+    event_def eventHalted_;     // CPU model notification, no need to wait
     mutex_def mutex_resume_;
     uint64_t hartsel_;      // context switched Hart index
     uint64_t haltsum_;
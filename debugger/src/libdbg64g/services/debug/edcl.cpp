@@ -23,10 +23,17 @@ EdclService::EdclService(const char *name) : IService(name) {
     registerInterface(static_cast<ITap *>(this));
     registerAttribute("Transport", &transport_);
     registerAttribute("seq_cnt", &seq_cnt_);
+    registerAttribute("WindowSize", &windowSize_);
     seq_cnt_.make_uint64(0);
+    windowSize_.make_int64(8);
     itransport_ = 0;
+    segcnt_ = 0;
 
-    dbgRdTRansactionCnt_ = 0;
+    RISCV_mutex_init(&mutexAccess_);
+}
+
+EdclService::~EdclService() {
+    RISCV_mutex_destroy(&mutexAccess_);
 }
 
 void EdclService::postinitService() {
@@ -43,221 +50,297 @@ void EdclService::postinitService() {
     }
 }
 
+/**
+ * Long transfers are split on aligned chunks and the link is released
+ * between them, so short requests of other threads aren't blocked.
+ */
 int EdclService::read(uint64_t addr, int bytes, uint8_t *obuf) {
-    int txoff, rxoff;
-    UdpEdclCommonType req = {0};
-    UdpEdclCommonType rsp;
-    uint32_t align_addr;
-    uint32_t align_offset;
-    int align_length;
-    uint32_t obuf_len;
-    uint32_t obuf_off = 0;
-
-    align_offset = addr & 0x3ul;
-    align_addr = addr & ~0x3ul;
-    align_length = static_cast<int>((bytes + align_offset + 3) & ~0x3ul);
-
-    if (!itransport_) {
-        RISCV_error("UDP transport not defined, addr=%x", align_addr);
-        return TAP_ERROR;
-    }
-
-    int rd_bytes = 0;
-    while (rd_bytes < align_length && rd_bytes != TAP_ERROR) {
-        req.control.request.seqidx = 
-                    static_cast<uint32_t>(seq_cnt_.to_uint64());
-        req.control.request.write = 0;
-        req.address = static_cast<uint32_t>(align_addr + rd_bytes);
-        if ((align_length - rd_bytes) > EDCL_PAYLOAD_MAX_BYTES) {
-            req.control.request.len = 
-                    static_cast<uint32_t>(EDCL_PAYLOAD_MAX_BYTES);
-        } else {
-            req.control.request.len =
-                static_cast<uint32_t>(align_length - rd_bytes);
+    int off = 0;
+    int chunk;
+    while (off < bytes) {
+        chunk = EDCL_LOCK_CHUNK_BYTES
+              - static_cast<int>((addr + off) & (EDCL_LOCK_CHUNK_BYTES - 1));
+        if (chunk > bytes - off) {
+            chunk = bytes - off;
         }
-
-        txoff = write16(tx_buf_, 0, req.offset);
-        txoff = write32(tx_buf_, txoff, req.control.word);
-        txoff = write32(tx_buf_, txoff, req.address);
-
-        txoff = itransport_->sendData(tx_buf_, txoff);
-        if (txoff == -1) {
-            RISCV_error("Data sending error", NULL);
-            rd_bytes = TAP_ERROR;
-            break;
+        RISCV_mutex_lock(&mutexAccess_);
+        int ret = readTransaction(addr + off, chunk, &obuf[off]);
+        RISCV_mutex_unlock(&mutexAccess_);
+        if (ret == TAP_ERROR) {
+            return TAP_ERROR;
         }
+        off += chunk;
+    }
+    return bytes;
+}
 
-        dbgRdTRansactionCnt_++;
-        rxoff = itransport_->readData(rx_buf_, sizeof(rx_buf_));
-        if (rxoff == -1) {
-            RISCV_error("Data receiving error", NULL);
-            rd_bytes = TAP_ERROR;
-            break;
-        } 
-        if (rxoff == 0) {
-            RISCV_error("No response. Break read transaction[%d] at %08x",
-                        dbgRdTRansactionCnt_, req.address);
-            rd_bytes = TAP_ERROR;
-            break;
+int EdclService::write(uint64_t addr, int bytes, uint8_t *ibuf) {
+    int off = 0;
+    int chunk;
+    while (off < bytes) {
+        chunk = EDCL_LOCK_CHUNK_BYTES
+              - static_cast<int>((addr + off) & (EDCL_LOCK_CHUNK_BYTES - 1));
+        if (chunk > bytes - off) {
+            chunk = bytes - off;
         }
+        RISCV_mutex_lock(&mutexAccess_);
+        int ret = writeTransaction(addr + off, chunk, &ibuf[off]);
+        RISCV_mutex_unlock(&mutexAccess_);
+        if (ret == TAP_ERROR) {
+            return TAP_ERROR;
+        }
+        off += chunk;
+    }
+    postMemDirty(addr, bytes);
+    return bytes;
+}
 
-        rsp.control.word = read32(&rx_buf_[2]);
+int EdclService::readRegs(const uint64_t *addr, int cnt, uint64_t *obuf) {
+    return transferRegs(addr, cnt, obuf, false);
+}
 
-        const char *NAK[2] = {"ACK", "NAK"};
-        RISCV_debug("EDCL read: %s[%d], len = %d", 
-                    NAK[rsp.control.response.nak],
-                    rsp.control.response.seqidx,
-                    rsp.control.response.len);
+int EdclService::writeRegs(const uint64_t *addr, int cnt, uint64_t *ibuf) {
+    return transferRegs(addr, cnt, ibuf, true);
+}
 
-        // Retry with new sequence counter.
-        if (rsp.control.response.nak) {
-            RISCV_info("Sequence counter detected %d. Re-sending transaction.",
-                         rsp.control.response.seqidx);
-            seq_cnt_.make_uint64(rsp.control.response.seqidx);
-            continue;
+/**
+ * Runs of adjacent registers and separate registers of the list are sent
+ * as requests of the same window instead of one round-trip per run.
+ */
+int EdclService::transferRegs(const uint64_t *addr, int cnt, uint64_t *buf,
+                              bool write) {
+    const int REGS_PER_SEGMENT = EDCL_PAYLOAD_MAX_BYTES / 8;
+    int i = 0;
+    int n;
+    int ret;
+    while (i < cnt) {
+        RISCV_mutex_lock(&mutexAccess_);
+        segcnt_ = 0;
+        while (i < cnt && segcnt_ < EDCL_SEGMENTS_MAX) {
+            n = adjacentRegs(&addr[i], cnt - i);
+            if (n > (EDCL_SEGMENTS_MAX - segcnt_) * REGS_PER_SEGMENT) {
+                n = (EDCL_SEGMENTS_MAX - segcnt_) * REGS_PER_SEGMENT;
+            }
+            addSegments(static_cast<uint32_t>(addr[i]), 8 * n,
+                        reinterpret_cast<uint8_t *>(&buf[i]));
+            i += n;
+        }
+        ret = transferWindow(write);
+        RISCV_mutex_unlock(&mutexAccess_);
+        if (ret == TAP_ERROR) {
+            return TAP_ERROR;
         }
+    }
+    if (write) {
+        for (i = 0; i < cnt; i += n) {
+            n = adjacentRegs(&addr[i], cnt - i);
+            postMemDirty(addr[i], 8 * n);
+        }
+    }
+    return 8 * cnt;
+}
 
-        // Try to receive next packet:
-        if (rsp.control.response.seqidx != seq_cnt_.to_uint32()) {
-            RISCV_error("Wrong ID received %d != %d. Try again.",
-                        seq_cnt_.to_uint32(), rsp.control.response.seqidx);
+int EdclService::readTransaction(uint64_t addr, int bytes, uint8_t *obuf) {
+    uint32_t align_addr = static_cast<uint32_t>(addr) & ~0x3u;
+    uint32_t align_offset = static_cast<uint32_t>(addr) & 0x3u;
+    int align_length = static_cast<int>((bytes + align_offset + 3) & ~0x3u);
+    uint8_t *buf = obuf;
 
-            rxoff = itransport_->readData(rx_buf_, sizeof(rx_buf_));
-            if (rxoff <= 0) {
-                rd_bytes = TAP_ERROR;
-                break;
-            }
-            rsp.control.word = read32(&rx_buf_[2]);
-            if (rsp.control.response.seqidx != seq_cnt_.to_uint32()) {
-                rd_bytes = TAP_ERROR;
-                break;
-            }
-        }
+    if (align_offset || align_length != bytes) {
+        buf = chunk_buf_;
+    }
+    segcnt_ = 0;
+    addSegments(align_addr, align_length, buf);
+    if (transferWindow(false) == TAP_ERROR) {
+        return TAP_ERROR;
+    }
+    if (buf != obuf) {
+        memcpy(obuf, &buf[align_offset], bytes);
+    }
+    return bytes;
+}
 
-        obuf_len = rsp.control.response.len;
-        if ((obuf_off + obuf_len) > static_cast<uint32_t>(bytes)) {
-            // exclude alignment bytes from buffer end
-            obuf_len = static_cast<uint32_t>(bytes) - obuf_off;
+int EdclService::writeTransaction(uint64_t addr, int bytes,
+                                  uint8_t *ibuf) {
+    uint32_t align_addr = static_cast<uint32_t>(addr) & ~0x3u;
+    uint32_t align_offset = static_cast<uint32_t>(addr) & 0x3u;
+    int align_length = static_cast<int>((bytes + align_offset + 3) & ~0x3u);
+    uint8_t *buf = ibuf;
+
+    if (align_offset || align_length != bytes) {
+        // Read-modify-write of the partially covered boundary words
+        segcnt_ = 0;
+        addSegments(align_addr, 4, chunk_buf_);
+        if (align_length > 4) {
+            addSegments(align_addr + align_length - 4, 4,
+                        &chunk_buf_[align_length - 4]);
         }
-        if (align_offset) {
-            if (rd_bytes == 0) {
-                memcpy(&obuf[obuf_off], &rx_buf_[10 + align_offset], obuf_len);
-                obuf_off += (rsp.control.response.len - align_offset);
-            } else {
-                memcpy(&obuf[obuf_off], &rx_buf_[10], obuf_len);
-                obuf_off += obuf_len;
-            }
-        } else {
-            memcpy(&obuf[obuf_off], &rx_buf_[10], obuf_len);
-            obuf_off += obuf_len;
+        if (transferWindow(false) == TAP_ERROR) {
+            return TAP_ERROR;
         }
-        rd_bytes += rsp.control.response.len;
-        seq_cnt_.make_uint64((seq_cnt_.to_uint64() + 1) & 0x3FFF);
+        memcpy(&chunk_buf_[align_offset], ibuf, bytes);
+        buf = chunk_buf_;
+    }
+    segcnt_ = 0;
+    addSegments(align_addr, align_length, buf);
+    if (transferWindow(true) == TAP_ERROR) {
+        return TAP_ERROR;
     }
     return bytes;
 }
 
-int EdclService::write(uint64_t addr, int bytes, uint8_t *ibuf) {
-    int off;
-    UdpEdclCommonType req = {0};
+void EdclService::addSegments(uint32_t addr, int bytes, uint8_t *buf) {
+    int len;
+    while (bytes > 0 && segcnt_ < EDCL_SEGMENTS_MAX) {
+        len = bytes;
+        if (len > EDCL_PAYLOAD_MAX_BYTES) {
+            len = EDCL_PAYLOAD_MAX_BYTES;
+        }
+        seg_[segcnt_].addr = addr;
+        seg_[segcnt_].len = len;
+        seg_[segcnt_].buf = buf;
+        segcnt_++;
+        addr += static_cast<uint32_t>(len);
+        buf += len;
+        bytes -= len;
+    }
+}
+
+/**
+ * Up to 'WindowSize' requests are kept in flight. The responder executes
+ * them strictly in the sequence order and answers the others with NAK
+ * carrying the expected counter, so a lost request is recovered by going
+ * back to the first unacknowledged segment (go-back-N). All in-flight
+ * requests sent after the lost one produce the same NAK, only the first
+ * of them re-sends the window.
+ *
+ * Lost responses are detected by the link timeout. The responder could
+ * already execute the following requests, so only one probe is sent to
+ * get the expected counter: re-sending the whole window with the old
+ * numbers may execute a request which response will be then attributed
+ * to another segment.
+ */
+int EdclService::transferWindow(bool write) {
     UdpEdclCommonType rsp;
-    uint32_t align_addr;
-    uint32_t align_offset;
-    uint32_t align_offset0;
-    int align_length;
-    uint32_t ibuf_len;
-    uint32_t ibuf_off = 0;
-    uint32_t ubytes = static_cast<uint32_t>(bytes);
+    uint32_t seq_base = seq_cnt_.to_uint32() & EDCL_SEQ_MASK;
+    uint32_t resync_seq = ~0u;
+    uint64_t done = 0;      // acknowledged segments mask
+    int acked = 0;          // first not acknowledged segment
+    int sent = 0;           // next segment to send
+    int retry = 0;
+    int window = windowSize_.to_int();
+    int inflight;
+    int rxoff;
+    int idx;
 
     if (!itransport_) {
-        RISCV_error("UDP transport not defined, addr=%x", addr);
+        RISCV_error("UDP transport not defined", NULL);
         return TAP_ERROR;
     }
+    if (window < 1) {
+        window = 1;
+    }
+    inflight = window;
 
-    align_offset = addr & 0x3ul;
-    align_addr = addr & ~0x3ul;
-    align_length = static_cast<int>((bytes + align_offset + 3) & ~0x3ul);
-    align_offset0 = align_offset;
-
-    int wr_bytes = 0;
-    while (wr_bytes < align_length && wr_bytes != -1) {
-        req.control.request.seqidx =
-                    static_cast<uint32_t>(seq_cnt_.to_uint64());
-        req.control.request.write = 1;
-        req.address = static_cast<uint32_t>(align_addr + wr_bytes);
-        if ((align_length - wr_bytes) > EDCL_PAYLOAD_MAX_BYTES) {
-            req.control.request.len =
-                    static_cast<uint32_t>(EDCL_PAYLOAD_MAX_BYTES);
-        } else {
-            req.control.request.len =
-                    static_cast<uint32_t>(align_length - wr_bytes);
-        }
-
-        off = write16(tx_buf_, 0, req.offset);
-        off = write32(tx_buf_, off, req.control.word);
-        off = write32(tx_buf_, off, req.address);
-
-        ibuf_len = req.control.request.len;
-        // Alignment at the and of buffer
-        if (ibuf_off + req.control.request.len - align_offset0 > ubytes) {
-            read(req.address, 8, &tx_buf_[off]);
-            ibuf_len = align_offset0 + ubytes - ibuf_off;
-        }
-        // Alignment at the begin of buffer
-        if (align_offset0 != 0) {
-            off += read(align_addr, align_offset, &tx_buf_[off]);
-            ibuf_len -= align_offset;
-        }
-        // seqidx can be modified by alingment reading
-        req.control.request.seqidx =
-                    static_cast<uint32_t>(seq_cnt_.to_uint64());
-        write32(tx_buf_, 2, req.control.word);
-
-        memcpy(&tx_buf_[off], &ibuf[ibuf_off], ibuf_len);
-        ibuf_off += ibuf_len;
-        align_offset0 = 0;      // only for zero step
-
-        off = itransport_->sendData(tx_buf_, 10 + req.control.request.len);
-        if (off == -1) {
-            RISCV_error("Data sending error", NULL);
-            wr_bytes = -1;
-            break;
+    while (acked < segcnt_) {
+        while (sent < segcnt_ && sent - acked < inflight) {
+            if (sendSegment(sent, (seq_base + sent) & EDCL_SEQ_MASK,
+                            write) == TAP_ERROR) {
+                return TAP_ERROR;
+            }
+            sent++;
         }
 
-        off = itransport_->readData(rx_buf_, sizeof(rx_buf_));
-        if (off == -1) {
+        rxoff = itransport_->readData(rx_buf_, sizeof(rx_buf_));
+        if (rxoff == -1) {
             RISCV_error("Data receiving error", NULL);
-            wr_bytes = -1;
-            break;
-        } 
-        if (off == 0) {
-            RISCV_error("No response. Break write transaction.", NULL);
-            wr_bytes = -1;
-            break;
+            return TAP_ERROR;
+        }
+        if (rxoff == 0) {
+            if (++retry > EDCL_RETRY_MAX) {
+                RISCV_error("No response. Break transaction at %08x",
+                            seg_[acked].addr);
+                return TAP_ERROR;
+            }
+            RISCV_info("Response timeout. Re-sending from %08x",
+                       seg_[acked].addr);
+            resync_seq = ~0u;
+            inflight = 1;
+            sent = acked;
+            continue;
         }
 
         rsp.control.word = read32(&rx_buf_[2]);
 
-        // Warning:
-        //   response length = 0;
         const char *NAK[2] = {"ACK", "NAK"};
-        RISCV_debug("EDCL write: %s[%d], len = %d", 
+        RISCV_debug("EDCL %s: %s[%d], len = %d",
+                    write ? "write" : "read",
                     NAK[rsp.control.response.nak],
                     rsp.control.response.seqidx,
-                    req.control.request.len);
+                    rsp.control.response.len);
 
-        // Retry with new sequence counter.
         if (rsp.control.response.nak) {
+            if (rsp.control.response.seqidx == resync_seq) {
+                // NAK of the request sent before re-synchronization
+                continue;
+            }
+            if (++retry > EDCL_RETRY_MAX) {
+                RISCV_error("Sequence counter re-sync failed at %08x",
+                            seg_[acked].addr);
+                return TAP_ERROR;
+            }
             RISCV_info("Sequence counter detected %d. Re-sending transaction.",
                          rsp.control.response.seqidx);
-            seq_cnt_.make_uint64(rsp.control.response.seqidx);
+            resync_seq = rsp.control.response.seqidx;
+            seq_base = (resync_seq - static_cast<uint32_t>(acked))
+                     & EDCL_SEQ_MASK;
+            inflight = window;
+            sent = acked;
             continue;
         }
 
-        wr_bytes += req.control.request.len;
-        seq_cnt_.make_uint64(seq_cnt_.to_uint64() + 1);
+        idx = static_cast<int>((rsp.control.response.seqidx - seq_base)
+                               & EDCL_SEQ_MASK);
+        if (idx >= sent || idx < acked || ((done >> idx) & 0x1)) {
+            // Late response of the re-sent or previous transaction
+            continue;
+        }
+        if (!write) {
+            memcpy(seg_[idx].buf, &rx_buf_[10], seg_[idx].len);
+        }
+        done |= 1ull << idx;
+        while (acked < segcnt_ && ((done >> acked) & 0x1)) {
+            acked++;
+        }
+        inflight = window;
+        retry = 0;
     }
-    return bytes;
+    seq_cnt_.make_uint64((seq_base + segcnt_) & EDCL_SEQ_MASK);
+    return 0;
+}
+
+int EdclService::sendSegment(int idx, uint32_t seqidx, bool write) {
+    UdpEdclCommonType req = {0};
+    int off;
+
+    req.control.request.seqidx = seqidx;
+    req.control.request.write = write ? 1 : 0;
+    req.control.request.len = static_cast<uint32_t>(seg_[idx].len);
+    req.address = seg_[idx].addr;
+
+    off = write16(tx_buf_, 0, req.offset);
+    off = write32(tx_buf_, off, req.control.word);
+    off = write32(tx_buf_, off, req.address);
+    if (write) {
+        memcpy(&tx_buf_[off], seg_[idx].buf, seg_[idx].len);
+        off += seg_[idx].len;
+    }
+
+    if (itransport_->sendData(tx_buf_, off) != off) {
+        RISCV_error("Data sending error", NULL);
+        return TAP_ERROR;
+    }
+    return off;
 }
 
 int EdclService::write16(uint8_t *buf, int off, uint16_t v) {
@@ -29,6 +29,7 @@ class EdclService : public IService,
                     public ITap {
 public:
     EdclService(const char *name);
+    virtual ~EdclService();
 
     /** IService interface */
     virtual void postinitService();
@@ -36,8 +37,17 @@ public:
     /** ITap interface */
     virtual int read(uint64_t addr, int bytes, uint8_t *obuf);
     virtual int write(uint64_t addr, int bytes, uint8_t *ibuf);
+    virtual int readRegs(const uint64_t *addr, int cnt, uint64_t *obuf);
+    virtual int writeRegs(const uint64_t *addr, int cnt, uint64_t *ibuf);
 
 private:
+    int readTransaction(uint64_t addr, int bytes, uint8_t *obuf);
+    int writeTransaction(uint64_t addr, int bytes, uint8_t *ibuf);
+    int transferRegs(const uint64_t *addr, int cnt, uint64_t *buf,
+                     bool write);
+    void addSegments(uint32_t addr, int bytes, uint8_t *buf);
+    int transferWindow(bool write);
+    int sendSegment(int idx, uint32_t seqidx, bool write);
     int write16(uint8_t *buf, int off, uint16_t v);
     int write32(uint8_t *buf, int off, uint32_t v);
     uint32_t read32(uint8_t *buf);
@@ -47,14 +57,32 @@ private:
      * following value up to 242 words. */
     static const int EDCL_PAYLOAD_MAX_WORDS32 = 8;
     static const int EDCL_PAYLOAD_MAX_BYTES  = 4*EDCL_PAYLOAD_MAX_WORDS32;
+    /** Link is released between chunks of the long transfers */
+    static const int EDCL_LOCK_CHUNK_BYTES = 64*EDCL_PAYLOAD_MAX_BYTES;
+    static const int EDCL_SEGMENTS_MAX =
+                        EDCL_LOCK_CHUNK_BYTES / EDCL_PAYLOAD_MAX_BYTES;
+    static const uint32_t EDCL_SEQ_MASK = 0x3FFF;
+    /** Re-sending attempts without progress before the transfer fails */
+    static const int EDCL_RETRY_MAX = 8;
+
+    /** One UDP request of the windowed transfer */
+    struct EdclSegmentType {
+        uint32_t addr;
+        int len;
+        uint8_t *buf;
+    };
 
     uint8_t tx_buf_[4096];
     uint8_t rx_buf_[4096];
+    uint8_t chunk_buf_[EDCL_LOCK_CHUNK_BYTES + 8];  // unaligned transfers
+    EdclSegmentType seg_[EDCL_SEGMENTS_MAX];
+    int segcnt_;
     ILink *itransport_;
     AttributeType transport_;
     AttributeType seq_cnt_;
+    AttributeType windowSize_;
 
-    int dbgRdTRansactionCnt_;
+    mutex_def mutexAccess_;     // TAP is shared by the debugger threads
 };
 
 DECLARE_CLASS(EdclService)
@@ -33,10 +33,12 @@ SerialDbgService::SerialDbgService(const char *name)
     registerAttribute("Port", &port_);
 
     RISCV_event_create(&event_block_, "SerialDbg_event_block");
+    RISCV_mutex_init(&mutexAccess_);
 }
 
 SerialDbgService::~SerialDbgService() {
     RISCV_event_close(&event_block_);
+    RISCV_mutex_destroy(&mutexAccess_);
 }
 
 void SerialDbgService::postinitService() {
@@ -62,7 +64,50 @@ void SerialDbgService::predeleteService() {
     }
 }
 
+/** Port is released between bursts so other threads aren't blocked */
 int SerialDbgService::read(uint64_t addr, int bytes, uint8_t *obuf) {
+    int off = 0;
+    int chunk;
+    while (off < bytes) {
+        chunk = UART_MST_BURST_BYTES_MAX
+            - static_cast<int>((addr + off) % UART_MST_BURST_BYTES_MAX);
+        if (chunk > bytes - off) {
+            chunk = bytes - off;
+        }
+        RISCV_mutex_lock(&mutexAccess_);
+        int ret = readTransaction(addr + off, chunk, &obuf[off]);
+        RISCV_mutex_unlock(&mutexAccess_);
+        if (ret == TAP_ERROR) {
+            return TAP_ERROR;
+        }
+        off += chunk;
+    }
+    return bytes;
+}
+
+int SerialDbgService::write(uint64_t addr, int bytes, uint8_t *ibuf) {
+    int off = 0;
+    int chunk;
+    while (off < bytes) {
+        chunk = UART_MST_BURST_BYTES_MAX
+            - static_cast<int>((addr + off) % UART_MST_BURST_BYTES_MAX);
+        if (chunk > bytes - off) {
+            chunk = bytes - off;
+        }
+        RISCV_mutex_lock(&mutexAccess_);
+        int ret = writeTransaction(addr + off, chunk, &ibuf[off]);
+        RISCV_mutex_unlock(&mutexAccess_);
+        if (ret == TAP_ERROR) {
+            return TAP_ERROR;
+        }
+        off += chunk;
+    }
+    postMemDirty(addr, bytes);
+    return bytes;
+}
+
+int SerialDbgService::readTransaction(uint64_t addr, int bytes,
+                                      uint8_t *obuf) {
     uint32_t align_addr;
     uint32_t align_offset;
     int align_length;
@@ -125,7 +170,8 @@ int SerialDbgService::read(uint64_t addr, int bytes, uint8_t *obuf) {
     return bytes;
 }
 
-int SerialDbgService::write(uint64_t addr, int bytes, uint8_t *ibuf) {
+int SerialDbgService::writeTransaction(uint64_t addr, int bytes,
+                                       uint8_t *ibuf) {
     uint32_t align_addr;
     uint32_t align_offset;
     uint32_t align_offset0;
@@ -62,12 +62,17 @@ public:
     /** IRawListener interface */
     virtual int updateData(const char *buf, int buflen);
 
+private:
+    int readTransaction(uint64_t addr, int bytes, uint8_t *obuf);
+    int writeTransaction(uint64_t addr, int bytes, uint8_t *ibuf);
+
 private:
     AttributeType timeout_;
     AttributeType port_;
 
     ISerial *iserial_;
     event_def event_block_;
+    mutex_def mutexAccess_;     // TAP is shared by the debugger threads
     PacketType pkt_;
     int rd_count_;
     int req_count_;
@@ -27,12 +27,15 @@ UdpService::UdpService(const char *name)
     registerAttribute("HostIP", &hostIP_);
     registerAttribute("BoardIP", &boardIP_);
     registerAttribute("SimTarget", &simTarget_);
+    registerAttribute("LossPeriod", &lossPeriod_);
     RISCV_register_hap(static_cast<IHap *>(this));
 
     timeout_.make_int64(0);
     blockmode_.make_boolean(true);
     hostIP_.make_string("192.168.0.53");
     boardIP_.make_string("192.168.0.51");
+    lossPeriod_.make_int64(0);
+    txcnt_ = 0;
 }
 
 UdpService::~UdpService() {
@@ -218,6 +221,13 @@ bool UdpService::setBlockingMode(bool mode) {
 }
 
 int UdpService::sendData(const uint8_t *msg, int len) {
+    // Loss injection to test retransmission: every N-th datagram is lost
+    txcnt_++;
+    if (lossPeriod_.to_int64() > 0
+        && (txcnt_ % lossPeriod_.to_uint64()) == 0) {
+        RISCV_debug("drop %d bytes", len);
+        return len;
+    }
     int tx_bytes = sendto(hsock_, reinterpret_cast<const char *>(msg), len, 0,
                   reinterpret_cast<struct sockaddr *>(&remote_sockaddr_ipv4_),
                   static_cast<int>(sizeof(remote_sockaddr_ipv4_)));
@@ -56,6 +56,7 @@ class UdpService : public IService,
     AttributeType hostIP_;
     AttributeType boardIP_;
     AttributeType simTarget_;
+    AttributeType lossPeriod_;
     
     struct sockaddr_in sockaddr_ipv4_;
     char               sockaddr_ipv4_str_[16];
@@ -63,6 +64,7 @@ class UdpService : public IService,
     struct sockaddr_in remote_sockaddr_ipv4_;
     socket_def hsock_;
     char rcvbuf[4096];
+    uint64_t txcnt_;            // sent datagrams, used for loss injection
 };
 
 DECLARE_CLASS(UdpService)
@@ -0,0 +1,507 @@
+/*
+ *  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "api_core.h"
+#include "dwarfline.h"
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+
+namespace debugger {
+
+/** Line number program opcodes (DWARF 5, section 6.2.5) */
+enum EDwarfLineOpcode {
+    DW_LNS_extended = 0,
+    DW_LNS_copy = 1,
+    DW_LNS_advance_pc = 2,
+    DW_LNS_advance_line = 3,
+    DW_LNS_set_file = 4,
+    DW_LNS_const_add_pc = 8,
+    DW_LNS_fixed_advance_pc = 9
+};
+
+enum EDwarfLineExtOpcode {
+    DW_LNE_end_sequence = 1,
+    DW_LNE_set_address = 2,
+    DW_LNE_define_file = 3
+};
+
+/** Entry formats of the DWARF 5 directory and file tables */
+static const uint64_t DW_LNCT_path = 1;
+static const uint64_t DW_LNCT_directory_index = 2;
+
+static const uint64_t DW_FORM_data2 = 0x05;
+static const uint64_t DW_FORM_data4 = 0x06;
+static const uint64_t DW_FORM_data8 = 0x07;
+static const uint64_t DW_FORM_string = 0x08;
+static const uint64_t DW_FORM_block = 0x09;
+static const uint64_t DW_FORM_data1 = 0x0b;
+static const uint64_t DW_FORM_strp = 0x0e;
+static const uint64_t DW_FORM_udata = 0x0f;
+static const uint64_t DW_FORM_data16 = 0x1e;
+static const uint64_t DW_FORM_line_strp = 0x1f;
+
+DwarfLineIndex::DwarfLineIndex() {
+    rows_ = 0;
+    cnt_ = 0;
+    cap_ = 0;
+    files_.make_list(0);
+    ranges_.make_list(0);
+    lineStr_ = 0;
+    lineStrSz_ = 0;
+    str_ = 0;
+    strSz_ = 0;
+}
+
+DwarfLineIndex::~DwarfLineIndex() {
+    free(rows_);
+}
+
+void DwarfLineIndex::clear() {
+    cnt_ = 0;
+    files_.make_list(0);
+    ranges_.make_list(0);
+}
+
+void DwarfLineIndex::addCodeRange(uint64_t addr, uint64_t sz) {
+    AttributeType t1;
+    t1.make_list(2);
+    t1[0u].make_uint64(addr);
+    t1[1].make_uint64(sz);
+    ranges_.add_to_list(&t1);
+}
+
+void DwarfLineIndex::parse(const uint8_t *sec, uint64_t sz,
+                           const uint8_t *line_str, uint64_t line_str_sz,
+                           const uint8_t *str, uint64_t str_sz, bool msb) {
+    CursorType c;
+    c.p = sec;
+    c.end = sec + sz;
+    c.msb = msb;
+    c.error = false;
+    lineStr_ = line_str;
+    lineStrSz_ = line_str_sz;
+    str_ = str;
+    strSz_ = str_sz;
+
+    cnt_ = 0;
+    files_.make_list(0);
+    while (c.p < c.end) {
+        if (!parseUnit(&c)) {
+            RISCV_printf(0, LOG_ERROR, "Wrong '.debug_line' unit at offset "
+                        "%" RV_PRI64 "x", static_cast<uint64_t>(c.p - sec));
+            break;
+        }
+    }
+    qsort(rows_, cnt_, sizeof(RowType), compareRow);
+}
+
+int DwarfLineIndex::find(uint64_t addr, const char **file, int *line) {
+    unsigned lo = 0;
+    unsigned hi = cnt_;
+    unsigned mid;
+    while (lo < hi) {
+        mid = (lo + hi) >> 1;
+        if (rows_[mid].addr <= addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0 || rows_[lo - 1].file == ROW_END_SEQUENCE) {
+        return -1;
+    }
+    *file = files_[rows_[lo - 1].file].to_string();
+    *line = static_cast<int>(rows_[lo - 1].line);
+    return 0;
+}
+
+/**
+ * Returns false if the unit length is corrupted and the rest of the
+ * section cannot be parsed. Units with unsupported content are skipped.
+ */
+bool DwarfLineIndex::parseUnit(CursorType *c) {
+    int offsz = 4;
+    uint64_t len = readU(c, 4);
+    if (len == 0xffffffffull) {
+        len = readU(c, 8);
+        offsz = 8;
+    }
+    if (c->error || len > static_cast<uint64_t>(c->end - c->p)) {
+        return false;
+    }
+    CursorType u;
+    u.p = c->p;
+    u.end = c->p + len;
+    u.msb = c->msb;
+    u.error = false;
+    c->p = u.end;
+
+    unsigned version = static_cast<unsigned>(readU(&u, 2));
+    if (version < 2 || version > 5) {
+        return true;
+    }
+    if (version >= 5) {
+        readU(&u, 1);               // address_size
+        readU(&u, 1);               // segment_selector_size
+    }
+    uint64_t hdrlen = readU(&u, offsz);
+    if (u.error || hdrlen > static_cast<uint64_t>(u.end - u.p)) {
+        return true;
+    }
+    const uint8_t *prog = u.p + hdrlen;
+    uint64_t min_inst = readU(&u, 1);
+    if (version >= 4) {
+        readU(&u, 1);               // maximum_operations_per_instruction
+    }
+    readU(&u, 1);                   // default_is_stmt
+    int64_t line_base = static_cast<int8_t>(readU(&u, 1));
+    uint64_t line_range = readU(&u, 1);
+    unsigned opcode_base = static_cast<unsigned>(readU(&u, 1));
+    uint8_t oplen[256];
+    for (unsigned i = 1; i < opcode_base; i++) {
+        oplen[i] = static_cast<uint8_t>(readU(&u, 1));
+    }
+    if (u.error || line_range == 0 || opcode_base == 0) {
+        return true;
+    }
+
+    // File numbers are 1-based before DWARF 5
+    uint64_t filebase = files_.size();
+    uint64_t filefirst = version >= 5 ? 0 : 1;
+    uint64_t fileidx;
+    AttributeType dirs;
+    dirs.make_list(0);
+    if (version >= 5) {
+        if (!parseEntryTable(&u, true, offsz, &dirs)
+            || !parseEntryTable(&u, false, offsz, &dirs)) {
+            return true;
+        }
+    } else {
+        AttributeType t1;
+        t1.make_string("");         // compilation directory isn't known
+        dirs.add_to_list(&t1);
+        const char *name;
+        while ((name = readStr(&u)) != 0 && name[0]) {
+            t1.make_string(name);
+            dirs.add_to_list(&t1);
+        }
+        while ((name = readStr(&u)) != 0 && name[0]) {
+            uint64_t dir = readUleb(&u);
+            readUleb(&u);           // modification time
+            readUleb(&u);           // file length
+            addFile(dirName(&dirs, dir), name);
+        }
+        if (u.error) {
+            return true;
+        }
+    }
+
+    uint64_t addr = 0;
+    uint64_t file = 1;
+    int64_t line = 1;
+    uint64_t adj;
+    const uint8_t *next;
+    unsigned seqstart = cnt_;       // first row of the current sequence
+    u.p = prog;
+    while (u.p < u.end && !u.error) {
+        unsigned op = static_cast<unsigned>(readU(&u, 1));
+        if (op >= opcode_base) {
+            adj = op - opcode_base;
+            addr += (adj / line_range) * min_inst;
+            line += line_base + static_cast<int64_t>(adj % line_range);
+            op = DW_LNS_copy;
+        }
+        switch (op) {
+        case DW_LNS_extended:
+            len = readUleb(&u);
+            if (u.error || len == 0
+                || len > static_cast<uint64_t>(u.end - u.p)) {
+                return true;
+            }
+            next = u.p + len;
+            switch (readU(&u, 1)) {
+            case DW_LNE_end_sequence:
+                if (cnt_ == seqstart || addr <= rows_[seqstart].addr
+                    || !isCodeAddress(rows_[seqstart].addr)) {
+                    cnt_ = seqstart;
+                } else {
+                    addRow(addr, ROW_END_SEQUENCE, 0);
+                }
+                seqstart = cnt_;
+                addr = 0;
+                file = 1;
+                line = 1;
+                break;
+            case DW_LNE_set_address:
+                addr = readU(&u, static_cast<int>(len - 1));
+                break;
+            case DW_LNE_define_file:
+                if (const char *name = readStr(&u)) {
+                    uint64_t dir = readUleb(&u);
+                    addFile(dirName(&dirs, dir), name);
+                }
+                break;
+            default:;
+            }
+            u.p = next;
+            break;
+        case DW_LNS_copy:
+            fileidx = filebase + file - filefirst;
+            if (file >= filefirst && fileidx < files_.size()) {
+                addRow(addr, static_cast<uint32_t>(fileidx),
+                       static_cast<uint32_t>(line));
+            }
+            break;
+        case DW_LNS_advance_pc:
+            addr += readUleb(&u) * min_inst;
+            break;
+        case DW_LNS_advance_line:
+            line += readSleb(&u);
+            break;
+        case DW_LNS_set_file:
+            file = readUleb(&u);
+            break;
+        case DW_LNS_const_add_pc:
+            addr += ((255 - opcode_base) / line_range) * min_inst;
+            break;
+        case DW_LNS_fixed_advance_pc:
+            addr += readU(&u, 2);
+            break;
+        default:
+            for (unsigned i = 0; i < oplen[op]; i++) {
+                readUleb(&u);
+            }
+        }
+    }
+    return true;
+}
+
+/** DWARF 5 directory or file names table described by entry formats */
+bool DwarfLineIndex::parseEntryTable(CursorType *c, bool dirs, int offsz,
+                                     AttributeType *dirlist) {
+    uint64_t fmt[2 * 16];
+    unsigned fmtcnt = static_cast<unsigned>(readU(c, 1));
+    if (fmtcnt > 16) {
+        return false;
+    }
+    for (unsigned i = 0; i < 2 * fmtcnt; i++) {
+        fmt[i] = readUleb(c);
+    }
+    uint64_t cnt = readUleb(c);
+    for (uint64_t n = 0; n < cnt && !c->error; n++) {
+        const char *path = "";
+        uint64_t dir = 0;
+        for (unsigned i = 0; i < fmtcnt; i++) {
+            uint64_t val = 0;
+            const char *s = readForm(c, fmt[2 * i + 1], offsz, &val);
+            if (fmt[2 * i] == DW_LNCT_path && s) {
+                path = s;
+            } else if (fmt[2 * i] == DW_LNCT_directory_index) {
+                dir = val;
+            }
+        }
+        if (dirs) {
+            AttributeType t1;
+            t1.make_string(path);
+            dirlist->add_to_list(&t1);
+        } else {
+            addFile(dirName(dirlist, dir), path);
+        }
+    }
+    return !c->error;
+}
+
+/** Returns string forms, integer forms are written into 'val' */
+const char *DwarfLineIndex::readForm(CursorType *c, uint64_t form,
+                                     int offsz, uint64_t *val) {
+    uint64_t off;
+    switch (form) {
+    case DW_FORM_string:
+        return readStr(c);
+    case DW_FORM_line_strp:
+    case DW_FORM_strp:
+        off = readU(c, offsz);
+        if (form == DW_FORM_line_strp && off < lineStrSz_
+            && memchr(&lineStr_[off], 0, lineStrSz_ - off)) {
+            return reinterpret_cast<const char *>(&lineStr_[off]);
+        }
+        if (form == DW_FORM_strp && off < strSz_
+            && memchr(&str_[off], 0, strSz_ - off)) {
+            return reinterpret_cast<const char *>(&str_[off]);
+        }
+        return 0;
+    case DW_FORM_udata:
+        *val = readUleb(c);
+        break;
+    case DW_FORM_data1:
+        *val = readU(c, 1);
+        break;
+    case DW_FORM_data2:
+        *val = readU(c, 2);
+        break;
+    case DW_FORM_data4:
+        *val = readU(c, 4);
+        break;
+    case DW_FORM_data8:
+        *val = readU(c, 8);
+        break;
+    case DW_FORM_data16:
+        readU(c, 8);
+        readU(c, 8);
+        break;
+    case DW_FORM_block:
+        off = readUleb(c);
+        if (off > static_cast<uint64_t>(c->end - c->p)) {
+            c->error = true;
+        } else {
+            c->p += off;
+        }
+        break;
+    default:
+        c->error = true;
+    }
+    return 0;
+}
+
+const char *DwarfLineIndex::dirName(AttributeType *dirs, uint64_t idx) {
+    if (idx >= dirs->size()) {
+        return "";
+    }
+    return (*dirs)[static_cast<unsigned>(idx)].to_string();
+}
+
+void DwarfLineIndex::addFile(const char *dir, const char *name) {
+    std::string path(name);
+    if (dir[0] && name[0] != '/' && name[0] != '\\'
+        && !(name[0] && name[1] == ':')) {
+        path = std::string(dir) + "/" + path;
+    }
+    AttributeType t1;
+    t1.make_string(path.c_str());
+    files_.add_to_list(&t1);
+}
+
+void DwarfLineIndex::addRow(uint64_t addr, uint32_t file, uint32_t line) {
+    if (cnt_ == cap_) {
+        cap_ = cap_ ? 2 * cap_ : 4096;
+        rows_ = static_cast<RowType *>(realloc(rows_, cap_ * sizeof(RowType)));
+    }
+    rows_[cnt_].addr = addr;
+    rows_[cnt_].file = file;
+    rows_[cnt_].line = line;
+    cnt_++;
+}
+
+/** Any address is accepted when the ranges aren't defined */
+bool DwarfLineIndex::isCodeAddress(uint64_t addr) {
+    if (ranges_.size() == 0) {
+        return true;
+    }
+    for (unsigned i = 0; i < ranges_.size(); i++) {
+        AttributeType &r = ranges_[i];
+        if (addr >= r[0u].to_uint64()
+            && addr - r[0u].to_uint64() < r[1].to_uint64()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t DwarfLineIndex::readU(CursorType *c, int bytes) {
+    uint64_t ret = 0;
+    if (bytes > 8 || c->end - c->p < bytes) {
+        c->error = true;
+        c->p = c->end;
+        return 0;
+    }
+    for (int i = 0; i < bytes; i++) {
+        if (c->msb) {
+            ret = (ret << 8) | c->p[i];
+        } else {
+            ret |= static_cast<uint64_t>(c->p[i]) << (8 * i);
+        }
+    }
+    c->p += bytes;
+    return ret;
+}
+
+uint64_t DwarfLineIndex::readUleb(CursorType *c) {
+    uint64_t ret = 0;
+    int shift = 0;
+    uint8_t b;
+    do {
+        if (c->p >= c->end) {
+            c->error = true;
+            return 0;
+        }
+        b = *c->p++;
+        if (shift < 64) {
+            ret |= static_cast<uint64_t>(b & 0x7f) << shift;
+        }
+        shift += 7;
+    } while (b & 0x80);
+    return ret;
+}
+
+int64_t DwarfLineIndex::readSleb(CursorType *c) {
+    int64_t ret = 0;
+    int shift = 0;
+    uint8_t b;
+    do {
+        if (c->p >= c->end) {
+            c->error = true;
+            return 0;
+        }
+        b = *c->p++;
+        if (shift < 64) {
+            ret |= static_cast<int64_t>(b & 0x7f) << shift;
+        }
+        shift += 7;
+    } while (b & 0x80);
+    if (shift < 64 && (b & 0x40)) {
+        ret |= -(static_cast<int64_t>(1) << shift);
+    }
+    return ret;
+}
+
+const char *DwarfLineIndex::readStr(CursorType *c) {
+    const uint8_t *p = static_cast<const uint8_t *>(
+                memchr(c->p, 0, static_cast<size_t>(c->end - c->p)));
+    if (!p) {
+        c->error = true;
+        c->p = c->end;
+        return 0;
+    }
+    const char *ret = reinterpret_cast<const char *>(c->p);
+    c->p = p + 1;
+    return ret;
+}
+
+/** End of a sequence goes before the next sequence at the same address */
+int DwarfLineIndex::compareRow(const void *a, const void *b) {
+    const RowType *ra = static_cast<const RowType *>(a);
+    const RowType *rb = static_cast<const RowType *>(b);
+    if (ra->addr != rb->addr) {
+        return ra->addr < rb->addr ? -1 : 1;
+    }
+    if ((ra->file == ROW_END_SEQUENCE) != (rb->file == ROW_END_SEQUENCE)) {
+        return ra->file == ROW_END_SEQUENCE ? -1 : 1;
+    }
+    return 0;
+}
+
+}  // namespace debugger
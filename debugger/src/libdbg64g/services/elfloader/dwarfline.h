@@ -0,0 +1,99 @@
+/*
+ *  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_ELFLOADER_DWARFLINE_H__
+#define __DEBUGGER_ELFLOADER_DWARFLINE_H__
+
+#include <inttypes.h>
+#include "attribute.h"
+
+namespace debugger {
+
+/**
+ * @brief Address to source line index built from the '.debug_line'.
+ *
+ * Line number programs of all compilation units (DWARF versions 2..5) are
+ * executed once and the produced rows are stored in one array sorted by
+ * address. Sections data are used in place and must stay mapped while
+ * parse() is running. Sequences that are empty or start out of the code
+ * ranges (discarded by the linker and relocated to 0) are dropped.
+ */
+class DwarfLineIndex {
+ public:
+    DwarfLineIndex();
+    ~DwarfLineIndex();
+
+    void clear();
+
+    /** Loadable section range, sequences outside of all ranges are dropped */
+    void addCodeRange(uint64_t addr, uint64_t sz);
+
+    /** '.debug_line_str' and '.debug_str' are used by DWARF 5 only */
+    void parse(const uint8_t *sec, uint64_t sz,
+               const uint8_t *line_str, uint64_t line_str_sz,
+               const uint8_t *str, uint64_t str_sz, bool msb);
+
+    int find(uint64_t addr, const char **file, int *line);
+
+    unsigned size() { return cnt_; }
+
+ private:
+    struct RowType {
+        uint64_t addr;
+        uint32_t file;              // index in files_, ROW_END_SEQUENCE
+        uint32_t line;
+    };
+
+    /** Bounded reader of the section data */
+    struct CursorType {
+        const uint8_t *p;
+        const uint8_t *end;
+        bool msb;
+        bool error;
+    };
+
+    static const uint32_t ROW_END_SEQUENCE = ~0u;
+
+    bool parseUnit(CursorType *c);
+    bool parseEntryTable(CursorType *c, bool dirs, int offsz,
+                         AttributeType *dirlist);
+    const char *readForm(CursorType *c, uint64_t form, int offsz,
+                         uint64_t *val);
+    void addFile(const char *dir, const char *name);
+    void addRow(uint64_t addr, uint32_t file, uint32_t line);
+    bool isCodeAddress(uint64_t addr);
+
+    static const char *dirName(AttributeType *dirs, uint64_t idx);
+    static uint64_t readU(CursorType *c, int bytes);
+    static uint64_t readUleb(CursorType *c);
+    static int64_t readSleb(CursorType *c);
+    static const char *readStr(CursorType *c);
+    static int compareRow(const void *a, const void *b);
+
+    RowType *rows_;
+    unsigned cnt_;
+    unsigned cap_;
+    AttributeType files_;           // full path strings
+    AttributeType ranges_;          // [addr, size] of loadable sections
+    const uint8_t *lineStr_;
+    uint64_t lineStrSz_;
+    const uint8_t *str_;
+    uint64_t strSz_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_ELFLOADER_DWARFLINE_H__
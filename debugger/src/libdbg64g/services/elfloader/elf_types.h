@@ -128,7 +128,7 @@ static ElfDWord SwapBytes(ElfDWord v) {
 
 class ElfHeaderType {
  public:
-    ElfHeaderType(uint8_t *img) {
+    ElfHeaderType(const uint8_t *img) {
         pimg_ = img;
         isElf_ = true;
         for (int i = 0; i < 4; i++) {
@@ -139,43 +139,50 @@ class ElfHeaderType {
         is32b_ = pimg_[EI_CLASS] == ELFCLASS32;
         isMsb_ = pimg_[EI_DATA] == ELFDATA2MSB;
         if (is32b_) {
-            Elf32_Ehdr *h = reinterpret_cast<Elf32_Ehdr *>(pimg_);
+            const Elf32_Ehdr *h = reinterpret_cast<const Elf32_Ehdr *>(pimg_);
             if (isMsb_) {
                 e_shoff_ = SwapBytes(h->e_shoff);
                 e_shnum_ = SwapBytes(h->e_shnum);
+                e_shstrndx_ = SwapBytes(h->e_shstrndx);
                 e_phoff_ = SwapBytes(h->e_phoff);
             } else {
                 e_shoff_ = h->e_shoff;
                 e_shnum_ = h->e_shnum;
+                e_shstrndx_ = h->e_shstrndx;
                 e_phoff_ = h->e_phoff;
             }
         } else {
-            Elf64_Ehdr *h = reinterpret_cast<Elf64_Ehdr *>(pimg_);
+            const Elf64_Ehdr *h = reinterpret_cast<const Elf64_Ehdr *>(pimg_);
             if (isMsb_) {
                 e_shoff_ = SwapBytes(h->e_shoff);
                 e_shnum_ = SwapBytes(h->e_shnum);
+                e_shstrndx_ = SwapBytes(h->e_shstrndx);
                 e_phoff_ = SwapBytes(h->e_phoff);
             } else {
                 e_shoff_ = h->e_shoff;
                 e_shnum_ = h->e_shnum;
+                e_shstrndx_ = h->e_shstrndx;
                 e_phoff_ = h->e_phoff;
             }
         }
     }
 
+    virtual ~ElfHeaderType() {}
     virtual bool isElf() { return isElf_; }
     virtual bool isElf32() { return is32b_; }
     virtual bool isElfMsb() { return isMsb_; }
     virtual uint64_t get_shoff() { return e_shoff_; }
     virtual ElfHalf get_shnum() { return e_shnum_; }
+    virtual ElfHalf get_shstrndx() { return e_shstrndx_; }
     virtual uint64_t get_phoff() { return e_phoff_; }
  protected:
-    uint8_t *pimg_;
+    const uint8_t *pimg_;
     bool isElf_;
     bool is32b_;
     bool isMsb_;
     uint64_t e_shoff_;
     ElfHalf e_shnum_;
+    ElfHalf e_shstrndx_;
     uint64_t e_phoff_;
 };
 
@@ -233,9 +240,9 @@ struct Elf64_Shdr {
 
 class SectionHeaderType {
  public:
-    SectionHeaderType(uint8_t *img, ElfHeaderType *h) {
+    SectionHeaderType(const uint8_t *img, ElfHeaderType *h) {
         if (h->isElf32()) {
-            Elf32_Shdr *sh = reinterpret_cast<Elf32_Shdr *>(img);
+            const Elf32_Shdr *sh = reinterpret_cast<const Elf32_Shdr *>(img);
             if (h->isElfMsb()) {
                 sh_name_ = SwapBytes(sh->sh_name);
                 sh_type_ = SwapBytes(sh->sh_type);
@@ -243,6 +250,7 @@ class SectionHeaderType {
                 sh_addr_ = SwapBytes(sh->sh_addr);
                 sh_offset_ = SwapBytes(sh->sh_offset);
                 sh_size_ = SwapBytes(sh->sh_size);
+                sh_link_ = SwapBytes(sh->sh_link);
                 sh_entsize_ = SwapBytes(sh->sh_entsize);
             } else {
                 sh_name_ = sh->sh_name;
@@ -251,10 +259,11 @@ class SectionHeaderType {
                 sh_addr_ = sh->sh_addr;
                 sh_offset_ = sh->sh_offset;
                 sh_size_ = sh->sh_size;
+                sh_link_ = sh->sh_link;
                 sh_entsize_ = sh->sh_entsize;
             }
         } else {
-            Elf64_Shdr *sh = reinterpret_cast<Elf64_Shdr *>(img);
+            const Elf64_Shdr *sh = reinterpret_cast<const Elf64_Shdr *>(img);
             if (h->isElfMsb()) {
                 sh_name_ = SwapBytes(sh->sh_name);
                 sh_type_ = SwapBytes(sh->sh_type);
@@ -262,6 +271,7 @@ class SectionHeaderType {
                 sh_addr_ = SwapBytes(sh->sh_addr);
                 sh_offset_ = SwapBytes(sh->sh_offset);
                 sh_size_ = SwapBytes(sh->sh_size);
+                sh_link_ = SwapBytes(sh->sh_link);
                 sh_entsize_ = SwapBytes(sh->sh_entsize);
             } else {
                 sh_name_ = sh->sh_name;
@@ -270,16 +280,19 @@ class SectionHeaderType {
                 sh_addr_ = sh->sh_addr;
                 sh_offset_ = sh->sh_offset;
                 sh_size_ = sh->sh_size;
+                sh_link_ = sh->sh_link;
                 sh_entsize_ = sh->sh_entsize;
             }
         }
     }
+    virtual ~SectionHeaderType() {}
     virtual ElfWord get_name() { return sh_name_; }
     virtual ElfWord get_type() { return sh_type_; }
     virtual uint64_t get_offset() { return sh_offset_; }
     virtual uint64_t get_size() { return sh_size_; }
     virtual uint64_t get_addr() { return sh_addr_; }
     virtual uint64_t get_flags() { return sh_flags_; }
+    virtual ElfWord get_link() { return sh_link_; }
     virtual uint64_t get_entsize() { return sh_entsize_; }
  protected:
     ElfWord sh_name_;
@@ -288,6 +301,7 @@ class SectionHeaderType {
     uint64_t sh_size_;
     uint64_t sh_addr_;
     uint64_t sh_flags_;
+    ElfWord sh_link_;
     uint64_t sh_entsize_;
 };
 
@@ -330,9 +344,9 @@ struct Elf64_Sym {
 
 class SymbolTableType {
  public:
-    SymbolTableType(uint8_t *img, ElfHeaderType *h) {
+    SymbolTableType(const uint8_t *img, ElfHeaderType *h) {
         if (h->isElf32()) {
-            Elf32_Sym *st = reinterpret_cast<Elf32_Sym *>(img);
+            const Elf32_Sym *st = reinterpret_cast<const Elf32_Sym *>(img);
             if (h->isElfMsb()) {
                 st_name_ = SwapBytes(st->st_name);
                 st_value_ = SwapBytes(st->st_value);
@@ -344,7 +358,7 @@ class SymbolTableType {
             }
             st_info_ = st->st_info;
         } else {
-            Elf64_Sym *st = reinterpret_cast<Elf64_Sym *>(img);
+            const Elf64_Sym *st = reinterpret_cast<const Elf64_Sym *>(img);
             if (h->isElfMsb()) {
                 st_name_ = SwapBytes(st->st_name);
                 st_value_ = SwapBytes(st->st_value);
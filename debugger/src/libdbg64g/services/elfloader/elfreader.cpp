@@ -23,17 +23,29 @@ ElfReaderService::ElfReaderService(const char *name) : IService(name) {
     registerInterface(static_cast<IElfReader *>(this));
     registerAttribute("SourceProc", &sourceProc_);
     image_ = NULL;
+    imageSize_ = 0;
+    header_ = NULL;
+    sh_tbl_ = NULL;
     sectionNames_ = NULL;
+    symbolNames_ = NULL;
+    symbolNamesSize_ = 0;
     symbolList_.make_list(0);
-    loadSectionList_.make_list(0);
+    loadSections_ = NULL;
+    loadSectionCnt_ = 0;
+    zeroData_ = NULL;
+    zeroDataSize_ = 0;
+    memset(&debugLine_, 0, sizeof(debugLine_));
+    memset(&debugLineStr_, 0, sizeof(debugLineStr_));
+    memset(&debugStr_, 0, sizeof(debugStr_));
+    lineIndexReady_ = false;
     sourceProc_.make_string("");
     isrc_ = 0;
+    RISCV_mutex_init(&mutexLines_);
 }
 
 ElfReaderService::~ElfReaderService() {
-    if (image_) {
-        delete image_;
-    }
+    closeFile();
+    RISCV_mutex_destroy(&mutexLines_);
 }
 
 void ElfReaderService::postinitService() {
@@ -46,81 +58,50 @@ void ElfReaderService::postinitService() {
     }
 }
 
+/**
+ * The file is mapped into memory and stays mapped until the next file is
+ * read. Section headers are walked once, loadable sections reference the
+ * mapped data and the DWARF line table is parsed on the first request.
+ */
 int ElfReaderService::readFile(const char *filename) {
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
+    closeFile();
+    image_ = RISCV_file_map(filename, &imageSize_);
+    if (!image_) {
         RISCV_error("File '%s' not found", filename);
         return -1;
     }
-    fseek(fp, 0, SEEK_END);
-    int sz = ftell(fp);
-    rewind(fp);
-
-    if (image_) {
-        delete image_;
-        sectionNames_ = NULL;
-        sourceProc_.make_list(0);
-        symbolList_.make_list(0);
-        loadSectionList_.make_list(0);
-    }
-    image_ = new uint8_t[sz];
-    fread(image_, 1, sz, fp);
 
     if (readElfHeader() != 0) {
-        fclose(fp);
         return 0;
     }
 
-    symbolNames_ = 0;
     if (!header_->get_shoff()) {
-        fclose(fp);
         return 0;
     }
 
-    sh_tbl_ = new SectionHeaderType *[header_->get_shnum()];
+    uint64_t shentsize = header_->isElf32() ? sizeof(Elf32_Shdr)
+                                            : sizeof(Elf64_Shdr);
+    int shnum = header_->get_shnum();
+    if (header_->get_shoff() + shnum * shentsize
+        > static_cast<uint64_t>(imageSize_)) {
+        RISCV_error("Section headers are out of file", NULL);
+        return 0;
+    }
 
-    /** Search .shstrtab section */
-    uint8_t *psh = &image_[header_->get_shoff()];
-    for (int i = 0; i < header_->get_shnum(); i++) {
+    sh_tbl_ = new SectionHeaderType *[shnum];
+    const uint8_t *psh = &image_[header_->get_shoff()];
+    for (int i = 0; i < shnum; i++) {
         sh_tbl_[i] = new SectionHeaderType(psh, header_);
-
-        sectionNames_ = reinterpret_cast<char *>(&image_[sh_tbl_[i]->get_offset()]);
-        if (sh_tbl_[i]->get_type() == SHT_STRTAB && 
-            strcmp(sectionNames_ + sh_tbl_[i]->get_name(), ".shstrtab") != 0) {
-            sectionNames_ = NULL;
-        }
-
-        if (header_->isElf32()) {
-            psh += sizeof(Elf32_Shdr);
-        } else {
-            psh += sizeof(Elf64_Shdr);
-        }
-    }
-    if (!sectionNames_) {
-        printf("err: section .shstrtab not found.\n");
+        psh += shentsize;
     }
 
-    /** Search ".strtab" section with Debug symbols */
-    SectionHeaderType *sh;
-    for (int i = 0; i < header_->get_shnum(); i++) {
-        sh = sh_tbl_[i];
-        if (sectionNames_ == NULL || sh->get_type() != SHT_STRTAB) {
-            continue;
-        }
-        if (strcmp(sectionNames_ + sh->get_name(), ".strtab")) {
-            continue;
-        }
-        /** 
-            * This section holds strings, most commonly the strings that
-            * represent the names associated with symbol table entries. 
-            * If the file has a loadable segment that includes the symbol
-            * string table, the section's attributes will include the
-            * SHF_ALLOC bit; otherwise, that bit will be turned off.
-            */
-        symbolNames_ = reinterpret_cast<char *>(&image_[sh->get_offset()]);
-    }
-    if (!symbolNames_) {
-        printf("err: section .strtab not found. No debug symbols.\n");
+    /** Section names string table is referenced by the ELF header */
+    int shstrndx = header_->get_shstrndx();
+    if (shstrndx < shnum && sh_tbl_[shstrndx]->get_type() == SHT_STRTAB) {
+        sectionNames_ = reinterpret_cast<const char *>(
+                &image_[sh_tbl_[shstrndx]->get_offset()]);
+    } else {
+        RISCV_error("Section '.shstrtab' not found", NULL);
     }
 
     /** Direct loading via tap interface: */
@@ -130,12 +111,55 @@ int ElfReaderService::readFile(const char *filename) {
     if (header_->get_phoff()) {
         //readProgramHeader();
     }
-
-    fclose(fp);
     return 0;
 }
 
+void ElfReaderService::closeFile() {
+    RISCV_mutex_lock(&mutexLines_);
+    lineIndex_.clear();
+    lineIndexReady_ = false;
+    memset(&debugLine_, 0, sizeof(debugLine_));
+    memset(&debugLineStr_, 0, sizeof(debugLineStr_));
+    memset(&debugStr_, 0, sizeof(debugStr_));
+    RISCV_mutex_unlock(&mutexLines_);
+
+    if (sh_tbl_) {
+        for (int i = 0; i < header_->get_shnum(); i++) {
+            delete sh_tbl_[i];
+        }
+        delete [] sh_tbl_;
+        sh_tbl_ = NULL;
+    }
+    if (header_) {
+        delete header_;
+        header_ = NULL;
+    }
+    if (loadSections_) {
+        delete [] loadSections_;
+        loadSections_ = NULL;
+    }
+    loadSectionCnt_ = 0;
+    if (zeroData_) {
+        delete [] zeroData_;
+        zeroData_ = NULL;
+    }
+    zeroDataSize_ = 0;
+    if (image_) {
+        RISCV_file_unmap(image_, imageSize_);
+        image_ = NULL;
+    }
+    imageSize_ = 0;
+    sectionNames_ = NULL;
+    symbolNames_ = NULL;
+    symbolNamesSize_ = 0;
+    symbolList_.make_list(0);
+}
+
 int ElfReaderService::readElfHeader() {
+    if (imageSize_ < static_cast<int64_t>(sizeof(Elf64_Ehdr))) {
+        RISCV_error("File format is not ELF", NULL);
+        return -1;
+    }
     header_ = new ElfHeaderType(image_);
     if (header_->isElf()) {
         return 0;
@@ -147,17 +171,25 @@ int ElfReaderService::readElfHeader() {
 int ElfReaderService::loadSections() {
     SectionHeaderType *sh;
     uint64_t total_bytes = 0;
-    AttributeType tsymb;
+    const char *name;
 
+    loadSections_ = new LoadSectionType[header_->get_shnum()];
     for (int i = 0; i < header_->get_shnum(); i++) {
         sh = sh_tbl_[i];
 
         if (sh->get_size() == 0) {
             continue;
         }
+        name = sectionNames_ ? &sectionNames_[sh->get_name()] : "unknown";
+        if (sh->get_type() != SHT_NOBITS
+            && sh->get_offset() + sh->get_size()
+                > static_cast<uint64_t>(imageSize_)) {
+            RISCV_error("Section '%s' is out of file", name);
+            continue;
+        }
 
         if (sectionNames_ && (sh->get_flags() & SHF_ALLOC)) {
-            RISCV_info("Reading '%s' section", &sectionNames_[sh->get_name()]);
+            RISCV_info("Reading '%s' section", name);
         }
 
         if ((sh->get_type() == SHT_PROGBITS ||
@@ -171,18 +203,11 @@ int ElfReaderService::loadSections() {
              *          whose format and meaning are determined solely by the
              *          program.
              */
-            AttributeType loadsec;
-            loadsec.make_list(LoadSh_Total);
-            if (sectionNames_) {
-                loadsec[LoadSh_name].make_string(&sectionNames_[sh->get_name()]);
-            } else {
-                loadsec[LoadSh_name].make_string("unknown");
-            }
-            loadsec[LoadSh_addr].make_uint64(sh->get_addr());
-            loadsec[LoadSh_size].make_uint64(sh->get_size());
-            loadsec[LoadSh_data].make_data(static_cast<unsigned>(sh->get_size()),
-                                           &image_[sh->get_offset()]);
-            loadSectionList_.add_to_list(&loadsec);
+            LoadSectionType &sec = loadSections_[loadSectionCnt_++];
+            sec.name = name;
+            sec.addr = sh->get_addr();
+            sec.size = sh->get_size();
+            sec.data = &image_[sh->get_offset()];
             total_bytes += sh->get_size();
         } else if (sh->get_type() == SHT_NOBITS
                     && (sh->get_flags() & SHF_ALLOC) != 0) {
@@ -193,78 +218,127 @@ int ElfReaderService::loadSections() {
              *          section contains no bytes, the sh_offset member
              *          contains the conceptual file offset.
              */
-            AttributeType loadsec;
-            loadsec.make_list(LoadSh_Total);
-            if (sectionNames_) {
-                loadsec[LoadSh_name].make_string(&sectionNames_[sh->get_name()]);
-            } else {
-                loadsec[LoadSh_name].make_string("unknown");
+            LoadSectionType &sec = loadSections_[loadSectionCnt_++];
+            sec.name = name;
+            sec.addr = sh->get_addr();
+            sec.size = sh->get_size();
+            sec.data = NULL;
+            if (zeroDataSize_ < sh->get_size()) {
+                zeroDataSize_ = sh->get_size();
             }
-            loadsec[LoadSh_addr].make_uint64(sh->get_addr());
-            loadsec[LoadSh_size].make_uint64(sh->get_size());
-            loadsec[LoadSh_data].make_data(static_cast<unsigned>(sh->get_size()));
-            memset(loadsec[LoadSh_data].data(), 
-                        0, static_cast<size_t>(sh->get_size()));
-            loadSectionList_.add_to_list(&loadsec);
             total_bytes += sh->get_size();
         } else if (sh->get_type() == SHT_SYMTAB || sh->get_type() == SHT_DYNSYM) {
             processDebugSymbol(sh);
+        } else if (sectionNames_ && (sh->get_flags() & SHF_ALLOC) == 0) {
+            DebugSectionType *dbg = NULL;
+            if (strcmp(name, ".debug_line") == 0) {
+                dbg = &debugLine_;
+            } else if (strcmp(name, ".debug_line_str") == 0) {
+                dbg = &debugLineStr_;
+            } else if (strcmp(name, ".debug_str") == 0) {
+                dbg = &debugStr_;
+            }
+            if (dbg) {
+                dbg->data = &image_[sh->get_offset()];
+                dbg->size = sh->get_size();
+            }
         }
     }
-    symbolList_.sort(LoadSh_name);
+    symbolList_.sort(Symbol_Name);
     if (isrc_) {
         isrc_->addSymbols(&symbolList_);
     }
     return static_cast<int>(total_bytes);
 }
 
+/** SHT_NOBITS sections share one zero buffer allocated on demand */
+uint8_t *ElfReaderService::sectionData(unsigned idx) {
+    if (loadSections_[idx].data) {
+        return const_cast<uint8_t *>(loadSections_[idx].data);
+    }
+    if (!zeroData_) {
+        zeroData_ = new uint8_t[zeroDataSize_];
+        memset(zeroData_, 0, static_cast<size_t>(zeroDataSize_));
+    }
+    return zeroData_;
+}
+
+int ElfReaderService::addressToLine(uint64_t addr, const char **file,
+                                    int *line) {
+    int ret;
+    RISCV_mutex_lock(&mutexLines_);
+    if (!lineIndexReady_) {
+        lineIndexReady_ = true;
+        if (debugLine_.data) {
+            uint64_t t1 = RISCV_get_time_ms();
+            for (unsigned i = 0; i < loadSectionCnt_; i++) {
+                if (loadSections_[i].data) {
+                    lineIndex_.addCodeRange(loadSections_[i].addr,
+                                            loadSections_[i].size);
+                }
+            }
+            lineIndex_.parse(debugLine_.data, debugLine_.size,
+                             debugLineStr_.data, debugLineStr_.size,
+                             debugStr_.data, debugStr_.size,
+                             header_->isElfMsb());
+            RISCV_info("Line table: %d rows in %d ms", lineIndex_.size(),
+                       static_cast<int>(RISCV_get_time_ms() - t1));
+        } else {
+            RISCV_info("Section '.debug_line' not found", NULL);
+        }
+    }
+    ret = lineIndex_.find(addr, file, line);
+    RISCV_mutex_unlock(&mutexLines_);
+    return ret;
+}
+
 void ElfReaderService::processDebugSymbol(SectionHeaderType *sh) {
     uint64_t symbol_off = 0;
-    SymbolTableType *st;
+    uint64_t entsize;
     AttributeType tsymb;
     uint8_t st_type;
     const char *symb_name;
-    //const char *file_name = 0;
 
-    if (!symbolNames_) {
+    /** Names are in the string table linked to the symbol table */
+    if (sh->get_link() >= header_->get_shnum()) {
+        return;
+    }
+    SectionHeaderType *strsh = sh_tbl_[sh->get_link()];
+    if (strsh->get_type() != SHT_STRTAB || strsh->get_offset()
+        + strsh->get_size() > static_cast<uint64_t>(imageSize_)) {
+        RISCV_error("Symbols string table not found", NULL);
         return;
     }
+    symbolNames_ = reinterpret_cast<const char *>(
+                &image_[strsh->get_offset()]);
+    symbolNamesSize_ = strsh->get_size();
+
+    entsize = sh->get_entsize();
+    if (!entsize) {
+        entsize = header_->isElf32() ? sizeof(Elf32_Sym) : sizeof(Elf64_Sym);
+    }
+    while (symbol_off + entsize <= sh->get_size()) {
+        SymbolTableType st(&image_[sh->get_offset() + symbol_off], header_);
+        symbol_off += entsize;
 
-    while (symbol_off < sh->get_size()) {
-        st = new SymbolTableType(&image_[sh->get_offset() + symbol_off],
-                                header_);
-        
-        symb_name = &symbolNames_[st->get_name()];
+        if (st.get_name() >= symbolNamesSize_) {
+            continue;
+        }
+        symb_name = &symbolNames_[st.get_name()];
 
-        st_type = st->get_info() & 0xF;
-        if ((st_type == STT_OBJECT || st_type == STT_FUNC) && st->get_value()) {
+        st_type = st.get_info() & 0xF;
+        if ((st_type == STT_OBJECT || st_type == STT_FUNC) && st.get_value()) {
             tsymb.make_list(Symbol_Total);
             tsymb[Symbol_Name].make_string(symb_name);
-            tsymb[Symbol_Addr].make_uint64(st->get_value() & ~1ull);
-            tsymb[Symbol_Size].make_uint64(st->get_size());
+            tsymb[Symbol_Addr].make_uint64(st.get_value() & ~1ull);
+            tsymb[Symbol_Size].make_uint64(st.get_size());
             if (st_type == STT_FUNC) {
                 tsymb[Symbol_Type].make_uint64(SYMBOL_TYPE_FUNCTION);
             } else {
                 tsymb[Symbol_Type].make_uint64(SYMBOL_TYPE_DATA);
             }
             symbolList_.add_to_list(&tsymb);
-        } else if (st_type == STT_FILE) {
-            //file_name = symb_name;
-        }
-
-        if (sh->get_entsize()) {
-            // section with elements of fixed size
-            symbol_off += sh->get_entsize(); 
-        } else if (st->get_size()) {
-            symbol_off += st->get_size();
-        } else {
-            if (header_->isElf32()) {
-                symbol_off += sizeof(Elf32_Sym);
-            } else {
-                symbol_off += sizeof(Elf64_Sym);
-            }
         }
-        delete st;
     }
 }
 
@@ -23,6 +23,7 @@
 #include "coreservices/ielfreader.h"
 #include "coreservices/isrccode.h"
 #include "elf_types.h"
+#include "dwarfline.h"
 
 namespace debugger {
 
@@ -39,37 +40,44 @@ public:
     virtual int readFile(const char *filename);
 
     virtual unsigned loadableSectionTotal() {
-        return loadSectionList_.size();
+        return loadSectionCnt_;
     }
 
     virtual const char *sectionName(unsigned idx) {
-        return loadSectionList_[idx][LoadSh_name].to_string();
+        return loadSections_[idx].name;
     }
 
     virtual uint64_t sectionAddress(unsigned idx)  {
-        return loadSectionList_[idx][LoadSh_addr].to_uint64();
+        return loadSections_[idx].addr;
     }
 
     virtual uint64_t sectionSize(unsigned idx)  {
-        return loadSectionList_[idx][LoadSh_size].to_uint64();
+        return loadSections_[idx].size;
     }
 
-    virtual uint8_t *sectionData(unsigned idx)  {
-        return loadSectionList_[idx][LoadSh_data].data();
-    }
+    virtual uint8_t *sectionData(unsigned idx);
+
+    virtual int addressToLine(uint64_t addr, const char **file, int *line);
 
 private:
     int readElfHeader();
     int loadSections();
     void processDebugSymbol(SectionHeaderType *sh);
+    void closeFile();
 
 private:
-    enum ELoadSectionItem {
-        LoadSh_name,
-        LoadSh_addr,
-        LoadSh_size,
-        LoadSh_data,
-        LoadSh_Total,
+    /** Loadable section, data point into the mapped file */
+    struct LoadSectionType {
+        const char *name;
+        uint64_t addr;
+        uint64_t size;
+        const uint8_t *data;        // 0 for SHT_NOBITS
+    };
+
+    /** Not loadable section used on demand */
+    struct DebugSectionType {
+        const uint8_t *data;
+        uint64_t size;
     };
 
     enum EMode {
@@ -79,14 +87,27 @@ private:
 
     AttributeType sourceProc_;
     AttributeType symbolList_;
-    AttributeType loadSectionList_;
 
     ISourceCode *isrc_;
-    uint8_t *image_;
+    const uint8_t *image_;
+    int64_t imageSize_;
     ElfHeaderType *header_;
     SectionHeaderType **sh_tbl_;
-    char *sectionNames_;
-    char *symbolNames_;
+    const char *sectionNames_;
+    const char *symbolNames_;
+    uint64_t symbolNamesSize_;
+
+    LoadSectionType *loadSections_;
+    unsigned loadSectionCnt_;
+    uint8_t *zeroData_;             // shared by all SHT_NOBITS sections
+    uint64_t zeroDataSize_;
+
+    DebugSectionType debugLine_;
+    DebugSectionType debugLineStr_;
+    DebugSectionType debugStr_;
+    DwarfLineIndex lineIndex_;
+    bool lineIndexReady_;
+    mutex_def mutexLines_;
 };
 
 DECLARE_CLASS(ElfReaderService)
@@ -35,6 +35,7 @@ class CmdBusUtil : public ICommand  {
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) { return true; }
 
  private:
     uint64_t clock_cnt_z_;
@@ -30,6 +30,7 @@ class CmdCpi : public ICommand  {
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) { return true; }
 
  private:
     uint64_t stepCnt_z;
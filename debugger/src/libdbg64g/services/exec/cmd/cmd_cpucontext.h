@@ -31,6 +31,9 @@ class CmdCpuContext : public ICommand  {
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) {
+        return args->size() == 1;
+    }
 };
 
 }  // namespace debugger
@@ -32,6 +32,7 @@ class CmdDisas : public ICommand  {
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) { return true; }
 
  private:
     void format(AttributeType *asmbuf, AttributeType *fmtstr);
@@ -30,6 +30,10 @@ CmdHalt::CmdHalt(ITap *tap) : ICommand ("halt", tap) {
         "    halt\n"
         "    stop\n"
         "    s\n");
+    cmdAliases_.make_list(3);
+    cmdAliases_[0u].make_string("break");
+    cmdAliases_[1].make_string("stop");
+    cmdAliases_[2].make_string("s");
 }
 
 
@@ -46,9 +46,9 @@ void CmdIsRunning::exec(AttributeType *args, AttributeType *res) {
     uint64_t addr = DSUREGBASE(ulocal.v.dmstatus);
     tap_->read(addr, 8, t1.buf);
     if (t1.bits.b11) {      // allrunning
-        res->make_boolean(false);
-    } else {
         res->make_boolean(true);
+    } else {
+        res->make_boolean(false);
     }
 }
 
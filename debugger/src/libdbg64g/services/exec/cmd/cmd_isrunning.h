@@ -30,6 +30,7 @@ class CmdIsRunning : public ICommand  {
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) { return true; }
 };
 
 }  // namespace debugger
@@ -0,0 +1,88 @@
+/*
+ *  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "iservice.h"
+#include "cmd_line.h"
+#include "coreservices/ielfreader.h"
+#include "coreservices/isrccode.h"
+
+namespace debugger {
+
+CmdLine::CmdLine(ITap *tap) : ICommand ("line", tap) {
+
+    briefDescr_.make_string("Source line of the address");
+    detailedDescr_.make_string(
+        "Description:\n"
+        "    Get source file and line of the address or symbol from the\n"
+        "    DWARF line table of the last loaded ELF-file.\n"
+        "Response:\n"
+        "    List ['file',line] or nil if address isn't found\n"
+        "Usage:\n"
+        "    line <addr|symbol>\n"
+        "Example:\n"
+        "    line 0x10000126\n"
+        "    line main\n");
+}
+
+int CmdLine::isValid(AttributeType *args) {
+    if (!cmdName_.is_equal((*args)[0u].to_string())) {
+        return CMD_INVALID;
+    }
+    if (args->size() == 2) {
+        return CMD_VALID;
+    }
+    return CMD_WRONG_ARGS;
+}
+
+void CmdLine::exec(AttributeType *args, AttributeType *res) {
+    res->attr_free();
+    res->make_nil();
+
+    AttributeType lstServ;
+    RISCV_get_services_with_iface(IFACE_ELFREADER, &lstServ);
+    if (lstServ.size() == 0) {
+        generateError(res, "Elf-service not found");
+        return;
+    }
+    IService *iserv = static_cast<IService *>(lstServ[0u].to_iface());
+    IElfReader *elf = static_cast<IElfReader *>(
+                        iserv->getInterface(IFACE_ELFREADER));
+
+    uint64_t addr = (*args)[1].to_uint64();
+    if ((*args)[1].is_string()) {
+        RISCV_get_services_with_iface(IFACE_SOURCE_CODE, &lstServ);
+        ISourceCode *isrc = 0;
+        if (lstServ.size()) {
+            iserv = static_cast<IService *>(lstServ[0u].to_iface());
+            isrc = static_cast<ISourceCode *>(
+                        iserv->getInterface(IFACE_SOURCE_CODE));
+        }
+        if (!isrc || isrc->symbol2Address((*args)[1].to_string(), &addr)) {
+            generateError(res, "Symbol not found");
+            return;
+        }
+    }
+
+    const char *file;
+    int line;
+    if (elf->addressToLine(addr, &file, &line) == 0) {
+        res->make_list(2);
+        (*res)[0u].make_string(file);
+        (*res)[1].make_int64(line);
+    }
+}
+
+}  // namespace debugger
@@ -16,25 +16,35 @@
 
 #include "iservice.h"
 #include "cmd_loadbin.h"
+#include "imageloader.h"
 #include <iostream>
 
 namespace debugger {
 
+/** Files larger than int range are passed to the loader by parts */
+static const int64_t LOADBIN_BLOCK_BYTES = 1 << 30;
+
 CmdLoadBin::CmdLoadBin(ITap *tap) : ICommand ("loadbin", tap) {
 
     briefDescr_.make_string("Load binary file");
     detailedDescr_.make_string(
         "Description:\n"
         "    Load BIN-file to SOC target memory with specified address.\n"
+        "    Optional key 'verify' reads back written data and compares\n"
+        "    checksums.\n"
+        "Usage:\n"
+        "    loadbin filename address [verify]\n"
         "Example:\n"
-        "    loadsrec /home/hc08/image.bin 0x04000\n");
+        "    loadbin /home/hc08/image.bin 0x04000\n"
+        "    loadbin /home/hc08/image.bin 0x04000 verify\n");
 }
 
 int CmdLoadBin::isValid(AttributeType *args) {
     if (!cmdName_.is_equal((*args)[0u].to_string())) {
         return CMD_INVALID;
     }
-    if (args->size() == 3) {
+    if (args->size() == 3
+        || (args->size() == 4 && (*args)[3].is_equal("verify"))) {
         return CMD_VALID;
     }
     return CMD_WRONG_ARGS;
@@ -42,27 +52,41 @@ int CmdLoadBin::isValid(AttributeType *args) {
 
 void CmdLoadBin::exec(AttributeType *args, AttributeType *res) {
     res->make_nil();
-    if (!isValid(args)) {
+    if (isValid(args) != CMD_VALID) {
         generateError(res, "Wrong argument list");
         return;
     }
 
     const char *filename = (*args)[1].to_string();
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
+    int64_t sz;
+    const uint8_t *image = RISCV_file_map(filename, &sz);
+    if (!image) {
         generateError(res, "File not found");
         return;
     }
-    fseek(fp, 0, SEEK_END);
-    int sz = ftell(fp);
-    rewind(fp);
-    uint8_t *image = new uint8_t[sz];
-    fread(image, 1, sz, fp);
-    fclose(fp);
+
+    ImageLoader loader(tap_, cmdName_.to_string(), args->size() == 4);
+    if (!loader.start()) {
+        RISCV_file_unmap(image, sz);
+        generateError(res, "Can't create thread");
+        return;
+    }
 
     uint64_t addr = (*args)[2].to_uint64();
-    tap_->write(addr, sz, image);
-    delete [] image;
+    int64_t off = 0;
+    int64_t n;
+    while (off < sz) {
+        n = sz - off;
+        if (n > LOADBIN_BLOCK_BYTES) {
+            n = LOADBIN_BLOCK_BYTES;
+        }
+        loader.write(addr + off, &image[off], static_cast<int>(n));
+        off += n;
+    }
+    if (!loader.finish()) {
+        generateError(res, "Loading failed");
+    }
+    RISCV_file_unmap(image, sz);
 }
 
 }  // namespace debugger
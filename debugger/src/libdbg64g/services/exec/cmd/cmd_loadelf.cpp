@@ -18,6 +18,7 @@
 #include "cmd_loadelf.h"
 #include "coreservices/ielfreader.h"
 #include "debug/dsumap.h"
+#include "imageloader.h"
 
 namespace debugger {
 
@@ -28,20 +29,23 @@ CmdLoadElf::CmdLoadElf(ITap *tap) : ICommand ("loadelf", tap) {
         "Description:\n"
         "    Load ELF-file to SOC target memory. Optional key 'nocode'\n"
         "    allows to read debug information from the elf-file without\n"
-        "    target programming.\n"
+        "    target programming. Optional key 'verify' reads back written\n"
+        "    data and compares checksums.\n"
         "Usage:\n"
-        "    loadelf filename [nocode]\n"
+        "    loadelf filename [nocode|verify]\n"
         "Example:\n"
         "    loadelf /home/riscv/image.elf\n"
-        "    loadelf /home/riscv/image.elf nocode\n");
+        "    loadelf /home/riscv/image.elf nocode\n"
+        "    loadelf /home/riscv/image.elf verify\n");
 }
 
 int CmdLoadElf::isValid(AttributeType *args) {
     if (!cmdName_.is_equal((*args)[0u].to_string())) {
         return CMD_INVALID;
     }
-    if (args->size() == 2 
-        || (args->size() == 3 && (*args)[2].is_equal("nocode"))) {
+    if (args->size() == 2
+        || (args->size() == 3 && (*args)[2].is_equal("nocode"))
+        || (args->size() == 3 && (*args)[2].is_equal("verify"))) {
         return CMD_VALID;
     }
     return CMD_WRONG_ARGS;
@@ -51,10 +55,15 @@ void CmdLoadElf::exec(AttributeType *args, AttributeType *res) {
     res->attr_free();
     res->make_nil();
     bool program = true;
+    bool verify = false;
     if (args->size() == 3 
         && (*args)[2].is_string() && (*args)[2].is_equal("nocode")) {
         program = false;
     }
+    if (args->size() == 3
+        && (*args)[2].is_string() && (*args)[2].is_equal("verify")) {
+        verify = true;
+    }
 
     /**
      *  @todo Elf Loader service change on elf-reader
@@ -81,12 +90,21 @@ void CmdLoadElf::exec(AttributeType *args, AttributeType *res) {
     uint64_t addr = DSUREGBASE(ulocal.v.dmcontrol);
     tap_->write(addr, 8, t1.buf);
 
+    ImageLoader loader(tap_, cmdName_.to_string(), verify);
+    if (!loader.start()) {
+        generateError(res, "Can't create thread");
+        return;
+    }
+
     uint64_t sec_addr;
     int sec_sz;
     for (unsigned i = 0; i < elf->loadableSectionTotal(); i++) {
         sec_addr = elf->sectionAddress(i);
         sec_sz = static_cast<int>(elf->sectionSize(i));
-        tap_->write(sec_addr, sec_sz, elf->sectionData(i));
+        loader.write(sec_addr, elf->sectionData(i), sec_sz);
+    }
+    if (!loader.finish()) {
+        generateError(res, "Loading failed");
     }
 
     //soft_reset = 0;
@@ -17,24 +17,24 @@
 #include "iservice.h"
 #include "cmd_loadh86.h"
 #include "debug/dsumap.h"
+#include "imageloader.h"
 #include <iostream>
 
 namespace debugger {
 
-//char bindata[1 << 24] = {0};
-//char flgdata[1 << 24] = {0};
-
 CmdLoadH86::CmdLoadH86(ITap *tap) : ICommand ("loadh86", tap) {
 
     briefDescr_.make_string("Load Intel HEX file");
     detailedDescr_.make_string(
         "Description:\n"
-        "    Load H86-file (Intel Hex) to SOC target memory.\n"
+        "    Load H86-file (Intel Hex) to SOC target memory. Optional key\n"
+        "    'verify' reads back written data and compares checksums.\n"
         "Arguments: This command supports conversion of h86 to binary file\n"
         "           For this use the following argument list:"
         "    loadh86 [ifile] [osize] [ofile]"
         "Example:\n"
         "    loadh86 /home/c166/image.h86\n"
+        "    loadh86 /home/c166/image.h86 verify\n"
         "    loadh86 /home/c166/image.h86 34603008 image.bin\n");
     addr_msb_ = 0;
 }
@@ -46,6 +46,9 @@ int CmdLoadH86::isValid(AttributeType *args) {
     if (args->size() == 2) {
         return CMD_VALID;
     }
+    if (args->size() == 3 && (*args)[2].is_equal("verify")) {
+        return CMD_VALID;
+    }
     if (args->size() == 4 && (*args)[2].is_integer()) {
         return CMD_VALID;
     }
@@ -57,24 +60,20 @@ void CmdLoadH86::exec(AttributeType *args, AttributeType *res) {
     res->make_nil();
 
     const char *filename = (*args)[1].to_string();
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
+    int64_t imgsz;
+    const uint8_t *image = RISCV_file_map(filename, &imgsz);
+    if (!image) {
         generateError(res, "File not found");
         return;
     }
-    fseek(fp, 0, SEEK_END);
-    int sz = ftell(fp);
-    rewind(fp);
-    uint8_t *image = new uint8_t[sz];
-    fread(image, 1, sz, fp);
-    fclose(fp);
 
-    int off = 0;
+    int64_t off = 0;
     uint64_t sec_addr;
     int sec_sz;
-    uint8_t sec_data[1024];
+    uint8_t sec_data[256];
     int code = 0;
     int maxadr = 0;
+    addr_msb_ = 0;
 
     uint8_t *binFileBuf = 0;
     unsigned binFileSz = 0;
@@ -92,14 +91,19 @@ void CmdLoadH86::exec(AttributeType *args, AttributeType *res) {
         tap_->write(addr, 8, t1.buf);
     }
 
+    ImageLoader loader(tap_, cmdName_.to_string(), args->size() == 3);
+    if (binFileBuf == 0 && !loader.start()) {
+        RISCV_file_unmap(image, imgsz);
+        generateError(res, "Can't create thread");
+        return;
+    }
+
     while (code != -1) {
-        code = readline(image, off, sec_addr, sec_sz, sec_data);
+        code = readline(image, imgsz, off, sec_addr, sec_sz, sec_data);
         switch (code) {
         case 0:
             if (binFileBuf == 0) {
-                tap_->write(sec_addr, sec_sz, sec_data);
-                //memcpy(&bindata[sec_addr & 0xFFFFFF], sec_data, sec_sz);
-                //memset(&flgdata[sec_addr & 0xFFFFFF], 0xff, sec_sz);
+                loader.write(sec_addr, sec_data, sec_sz);
             } else if ((sec_addr + sec_sz) <= binFileSz) {
                 memcpy(&binFileBuf[sec_addr], sec_data, sec_sz);
             } else {
@@ -116,10 +120,6 @@ void CmdLoadH86::exec(AttributeType *args, AttributeType *res) {
             if (addr_msb_ > maxadr) {
                 maxadr = addr_msb_;
             }
-            //if (addr_msb_ >= 0x00c0 && addr_msb_ < 0x0100) {
-                //addr_msb_ -= 0x00c0;
-                //bool st = true;
-            //}
             break;
         case 5:
             //generateError(res, "EIP not supported");
@@ -136,47 +136,36 @@ void CmdLoadH86::exec(AttributeType *args, AttributeType *res) {
             fwrite(binFileBuf, 1, binFileSz, fw);
             fclose(fw);
         }
+        delete [] binFileBuf;
+    } else if (!loader.finish() && res->is_nil()) {
+        generateError(res, "Loading failed");
     }
 
-    delete [] image;
-}
-
-uint8_t CmdLoadH86::str2byte(uint8_t *pair) {
-    uint8_t ret = 0;
-    for (int i = 0; i < 2; i++) {
-        ret <<= 4;
-        if (pair[i] >= '0' && pair[i] <= '9') {
-            ret |= pair[i] - '0';
-        } else if (pair[i] >= 'A' && pair[i] <= 'F') {
-            ret |= pair[i] - 'A' + 10;
-        } else if (pair[i] >= 'a' && pair[i] <= 'f') {
-            ret |= pair[i] - 'a' + 10;
-        }
-    }
-    return ret;
+    RISCV_file_unmap(image, imgsz);
 }
 
-bool CmdLoadH86::check_crc(uint8_t *str, int sz) {
+bool CmdLoadH86::check_crc(const uint8_t *str, int sz) {
     uint8_t sum = 0;
-    uint8_t *cur = str;
+    const uint8_t *cur = str;
     for (int i = 0; i < sz; i++) {
-        sum += str2byte(cur);
+        sum += ImageLoader::hex2byte(cur);
         cur += 2;
     }
     sum = ~sum + 1;
-    uint8_t ctrl = str2byte(cur);
+    uint8_t ctrl = ImageLoader::hex2byte(cur);
     return ctrl == sum;
 }
 
-int CmdLoadH86::readline(uint8_t *img, int &off,
+int CmdLoadH86::readline(const uint8_t *img, int64_t imgsz, int64_t &off,
                          uint64_t &addr, int &sz, uint8_t *out) {
     int retcode = -1;
-    if (img[off++] != ':') {
+    if (off + 3 > imgsz || img[off++] != ':') {
         return retcode;
     }
 
-    sz = str2byte(&img[off]);
-    if (!check_crc(&img[off], sz + 4)) {
+    sz = ImageLoader::hex2byte(&img[off]);
+    // count, address, type, data and checksum
+    if (off + 2 * (sz + 5) > imgsz || !check_crc(&img[off], sz + 4)) {
         return retcode;
     }
     off += 2;
@@ -184,23 +173,23 @@ int CmdLoadH86::readline(uint8_t *img, int &off,
     addr = addr_msb_;
     for (int i = 0; i < 2; i++) {
         addr <<= 8;
-        addr += str2byte(&img[off]);
+        addr += ImageLoader::hex2byte(&img[off]);
         off += 2;
     }
 
-    retcode = str2byte(&img[off]);
+    retcode = ImageLoader::hex2byte(&img[off]);
     off += 2;
 
     for (int i = 0; i < sz; i++) {
-        out[i] = static_cast<char>(str2byte(&img[off]));
+        out[i] = ImageLoader::hex2byte(&img[off]);
         off += 2;
     }
     off += 2;  // skip checksum
-    if (img[off] == '\r' && img[off + 1] == '\n') {
+    if (off + 1 < imgsz && img[off] == '\r' && img[off + 1] == '\n') {
         off += 2;
-    } else if (img[off] == '\n') {
+    } else if (off < imgsz && img[off] == '\n') {
         off += 1;
-    } else {
+    } else if (off != imgsz) {
         return -1;
     }
     return retcode;
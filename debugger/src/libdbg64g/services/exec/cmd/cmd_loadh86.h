@@ -32,9 +32,8 @@ class CmdLoadH86 : public ICommand  {
     virtual void exec(AttributeType *args, AttributeType *res);
 
  private:
-    uint8_t str2byte(uint8_t *pair);
-    bool check_crc(uint8_t *str, int sz);
-    int readline(uint8_t *img, int &off,
+    bool check_crc(const uint8_t *str, int sz);
+    int readline(const uint8_t *img, int64_t imgsz, int64_t &off,
                  uint64_t &addr, int &sz, uint8_t *out);
 
  private:
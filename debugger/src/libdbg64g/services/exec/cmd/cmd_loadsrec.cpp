@@ -17,6 +17,7 @@
 #include "iservice.h"
 #include "cmd_loadsrec.h"
 #include "debug/dsumap.h"
+#include "imageloader.h"
 #include <iostream>
 
 namespace debugger {
@@ -25,9 +26,9 @@ namespace debugger {
 
 #ifdef SHOW_USAGE_INFO
 #define ADDR_SPACE  (1 << 16)
-char mark_[ADDR_SPACE] = {0};
+static char mark_[ADDR_SPACE] = {0};
 
-void mark_addr(uint64_t addr, int len) {
+static void mark_addr(uint64_t addr, int len) {
     for (int i = 0; i < len; i++) {
         if ((addr + i) >= ADDR_SPACE) {
             continue;
@@ -36,7 +37,7 @@ void mark_addr(uint64_t addr, int len) {
     }
 }
 
-bool is_flash(unsigned addr) {
+static bool is_flash(unsigned addr) {
     if (addr >= 0x0450 && addr < 0x0500) {
         return true;
     }
@@ -49,7 +50,7 @@ bool is_flash(unsigned addr) {
     return false;
 }
 
-void print_flash_usage() {
+static void print_flash_usage() {
     unsigned start_addr = 0;
     int cnt = 0;
     int total_cnt = 0;
@@ -91,19 +92,24 @@ CmdLoadSrec::CmdLoadSrec(ITap *tap) : ICommand ("loadsrec", tap) {
     briefDescr_.make_string("Load SREC-file");
     detailedDescr_.make_string(
         "Description:\n"
-        "    Load SREC-file to SOC target memory.\n"
+        "    Load SREC-file to SOC target memory. Optional key 'verify'\n"
+        "    reads back written data and compares checksums.\n"
+        "Usage:\n"
+        "    loadsrec filename [verify]\n"
         "Example:\n"
-        "    loadsrec /home/hc08/image.s19\n");
+        "    loadsrec /home/hc08/image.s19\n"
+        "    loadsrec /home/hc08/image.s19 verify\n");
 }
 
 int CmdLoadSrec::isValid(AttributeType *args) {
     if (!cmdName_.is_equal((*args)[0u].to_string())) {
         return CMD_INVALID;
     }
-    if (args->size() != 2) {
-        return CMD_WRONG_ARGS;
+    if (args->size() == 2
+        || (args->size() == 3 && (*args)[2].is_equal("verify"))) {
+        return CMD_VALID;
     }
-    return CMD_VALID;
+    return CMD_WRONG_ARGS;
 }
 
 void CmdLoadSrec::exec(AttributeType *args, AttributeType *res) {
@@ -111,21 +117,16 @@ void CmdLoadSrec::exec(AttributeType *args, AttributeType *res) {
     res->make_nil();
 
     const char *filename = (*args)[1].to_string();
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
+    int64_t sz;
+    const uint8_t *image = RISCV_file_map(filename, &sz);
+    if (!image) {
         char tstr[1024];
         RISCV_sprintf(tstr, sizeof(tstr), "can't open file %s", filename);
         generateError(res, tstr);
         return;
     }
-    fseek(fp, 0, SEEK_END);
-    int sz = ftell(fp);
-    rewind(fp);
-    uint8_t *image = new uint8_t[sz];
-    fread(image, 1, sz, fp);
-    fclose(fp);
 
-    int off = check_header(image);
+    int64_t off = check_header(image, sz);
 
     Reg64Type t1;
     t1.val = 0;
@@ -133,89 +134,94 @@ void CmdLoadSrec::exec(AttributeType *args, AttributeType *res) {
     uint64_t addr = DSUREGBASE(ulocal.v.dmcontrol);
     tap_->write(addr, 8, t1.buf);
 
+    ImageLoader loader(tap_, cmdName_.to_string(), args->size() == 3);
+    if (!loader.start()) {
+        RISCV_file_unmap(image, sz);
+        generateError(res, "Can't create thread");
+        return;
+    }
+
     uint64_t sec_addr;
     int sec_sz;
-    uint8_t sec_data[1024];
-    while ((off = readline(image, off, sec_addr, sec_sz, sec_data)) != 0) {
-        tap_->write(sec_addr, sec_sz, sec_data);
+    uint8_t sec_data[256];
+    while ((off = readline(image, sz, off, sec_addr, sec_sz, sec_data)) != 0) {
+        loader.write(sec_addr, sec_data, sec_sz);
 #ifdef SHOW_USAGE_INFO
         mark_addr(sec_addr, sec_sz);
 #endif
     }
+    if (!loader.finish()) {
+        generateError(res, "Loading failed");
+    }
 
 //    soft_reset = 0;
 //    tap_->write(addr, 8, reinterpret_cast<uint8_t *>(&soft_reset));
-    delete [] image;
+    RISCV_file_unmap(image, sz);
 
 #ifdef SHOW_USAGE_INFO
     print_flash_usage();
 #endif
 }
 
-uint8_t CmdLoadSrec::str2byte(uint8_t *pair) {
-    uint8_t ret = 0;
-    for (int i = 0; i < 2; i++) {
-        ret <<= 4;
-        if (pair[i] >= '0' && pair[i] <= '9') {
-            ret |= pair[i] - '0';
-        } else if (pair[i] >= 'A' && pair[i] <= 'F') {
-            ret |= pair[i] - 'A' + 10;
-        } else if (pair[i] >= 'a' && pair[i] <= 'f') {
-            ret |= pair[i] - 'a' + 10;
-        }
-    }
-    return ret;
-}
-
-bool CmdLoadSrec::check_crc(uint8_t *str, int sz) {
+bool CmdLoadSrec::check_crc(const uint8_t *str, int sz) {
     uint8_t sum = 0;
-    uint8_t *cur = str;
+    const uint8_t *cur = str;
     for (int i = 0; i < sz; i++) {
-        sum += str2byte(cur);
+        sum += ImageLoader::hex2byte(cur);
         cur += 2;
     }
     sum = ~sum;
-    uint8_t ctrl = str2byte(cur);
+    uint8_t ctrl = ImageLoader::hex2byte(cur);
     return ctrl == sum;
 }
 
-int CmdLoadSrec::check_header(uint8_t *img) {
-    int off = 2;
-    if (img[0] != 'S' || img[1] != '0') {
+/** Skip end of line: both CRLF and LF are accepted. Returns 0 on error. */
+int64_t CmdLoadSrec::skip_eol(const uint8_t *img, int64_t imgsz,
+                              int64_t off) {
+    if (off < imgsz && img[off] == '\r') {
+        off++;
+    }
+    if (off < imgsz && img[off] == '\n') {
+        return off + 1;
+    }
+    return 0;
+}
+
+int64_t CmdLoadSrec::check_header(const uint8_t *img, int64_t imgsz) {
+    int64_t off = 2;
+    if (imgsz < 4 || img[0] != 'S' || img[1] != '0') {
         return 0;
     }
-    uint8_t sz = str2byte(&img[off]);
-    if (!check_crc(&img[off], sz)) {
+    uint8_t sz = ImageLoader::hex2byte(&img[off]);
+    if (sz < 3 || off + 2 * (sz + 1) > imgsz
+        || !check_crc(&img[off], sz)) {
         return 0;
     }
 
     off += 2;
-    uint16_t addr = str2byte(&img[off]);
+    uint16_t addr = ImageLoader::hex2byte(&img[off]);
     off += 2;
-    addr = (addr << 8) + str2byte(&img[off]);
+    addr = (addr << 8) + ImageLoader::hex2byte(&img[off]);
     off += 2;
     if (addr != 0) {
         return 0;
     }
     for (int i = 0; i < sz - 3; i++) {  // size (1) + addr (2) = 3
-        header_data_[i] = static_cast<char>(str2byte(&img[off]));
+        header_data_[i] = static_cast<char>(ImageLoader::hex2byte(&img[off]));
         header_data_[i + 1] = 0;
         off += 2;
     }
     off += 2;  // skip checksum
-    if (img[off] != '\r' || img[off + 1] != '\n') {
-        return 0;
-    }
-    return off + 2;
+    return skip_eol(img, imgsz, off);
 }
 
-int CmdLoadSrec::readline(uint8_t *img, int off,
-                          uint64_t &addr, int &sz, uint8_t *out) {
-    if (img[off++] != 'S') {
+int64_t CmdLoadSrec::readline(const uint8_t *img, int64_t imgsz, int64_t off,
+                              uint64_t &addr, int &sz, uint8_t *out) {
+    if (off + 4 > imgsz || img[off++] != 'S') {
         return 0;
     }
     int bytes4addr = 0;
-    switch (img[off++]) {    // 16-bits address only
+    switch (img[off++]) {
     case '1':
         bytes4addr = 2; // 16-bits address
         break;
@@ -228,8 +234,9 @@ int CmdLoadSrec::readline(uint8_t *img, int off,
     default:
         return 0;
     }
-    sz = str2byte(&img[off]);
-    if (!check_crc(&img[off], sz)) {
+    sz = ImageLoader::hex2byte(&img[off]);
+    if (sz <= bytes4addr || off + 2 * (sz + 1) > imgsz
+        || !check_crc(&img[off], sz)) {
         return 0;
     }
     sz -= 1;
@@ -238,20 +245,17 @@ int CmdLoadSrec::readline(uint8_t *img, int off,
     addr = 0;
     for (int i = 0; i < bytes4addr; i++) {
         addr <<= 8;
-        addr += str2byte(&img[off]);
+        addr += ImageLoader::hex2byte(&img[off]);
         off += 2;
         sz--;
     }
 
     for (int i = 0; i < sz; i++) {
-        out[i] = static_cast<char>(str2byte(&img[off]));
+        out[i] = ImageLoader::hex2byte(&img[off]);
         off += 2;
     }
     off += 2;  // skip checksum
-    if (img[off] != '\r' || img[off + 1] != '\n') {
-        return 0;
-    }
-    return off + 2;
+    return skip_eol(img, imgsz, off);
 }
 
 }  // namespace debugger
@@ -32,11 +32,11 @@ class CmdLoadSrec : public ICommand  {
     virtual void exec(AttributeType *args, AttributeType *res);
 
  private:
-    uint8_t str2byte(uint8_t *pair);
-    bool check_crc(uint8_t *str, int sz);
-    int check_header(uint8_t *img);
-    int readline(uint8_t *img, int off,
-                 uint64_t &addr, int &sz, uint8_t *out);
+    bool check_crc(const uint8_t *str, int sz);
+    int64_t skip_eol(const uint8_t *img, int64_t imgsz, int64_t off);
+    int64_t check_header(const uint8_t *img, int64_t imgsz);
+    int64_t readline(const uint8_t *img, int64_t imgsz, int64_t off,
+                     uint64_t &addr, int &sz, uint8_t *out);
 
  private:
     char header_data_[1024];
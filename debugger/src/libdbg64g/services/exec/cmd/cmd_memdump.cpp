@@ -15,77 +15,264 @@
  */
 
 #include "cmd_memdump.h"
+#include "imageloader.h"
 #include <string>
 
 namespace debugger {
 
+/** Hex line: 16 bytes as a 128-bit word with the MSB first and '\n' */
+static const int MEMDUMP_HEX_LINE = 33;
+
+static int fseek64(FILE *fd, uint64_t off) {
+#if defined(_WIN32)
+    return _fseeki64(fd, static_cast<int64_t>(off), SEEK_SET);
+#else
+    return fseeko(fd, static_cast<off_t>(off), SEEK_SET);
+#endif
+}
+
+static uint64_t fsize64(FILE *fd) {
+#if defined(_WIN32)
+    _fseeki64(fd, 0, SEEK_END);
+    return static_cast<uint64_t>(_ftelli64(fd));
+#else
+    fseeko(fd, 0, SEEK_END);
+    return static_cast<uint64_t>(ftello(fd));
+#endif
+}
+
+static bool isZeroChunk(const uint8_t *data, int sz) {
+    const uint64_t *d64 = reinterpret_cast<const uint64_t *>(data);
+    int i;
+    for (i = 0; i < sz / 8; i++) {
+        if (d64[i]) {
+            return false;
+        }
+    }
+    for (i *= 8; i < sz; i++) {
+        if (data[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
 CmdMemDump::CmdMemDump(ITap *tap) : ICommand ("memdump", tap) {
 
     briefDescr_.make_string("Dump memory to file");
     detailedDescr_.make_string(
         "Description:\n"
         "    Dump memory to file (default in Binary format).\n"
+        "    Memory is read by chunks in a separate thread, so any size\n"
+        "    could be dumped. All-zero chunks of the binary dump are left\n"
+        "    as holes of the sparse file.\n"
+        "    Key 'update' compares the data with the existing binary dump\n"
+        "    of the same range and rewrites only the changed chunks. The\n"
+        "    list of changed regions [[addr,bytes],...] is returned.\n"
         "Usage:\n"
-        "    memdump <addr> <bytes> [filepath] [bin|hex]\n"
+        "    memdump <addr> <bytes> <filepath> [bin|hex] [update]\n"
         "Example:\n"
         "    memdump 0x0 8192 dump.bin\n"
         "    memdump 0x40000000 524288 dump.hex hex\n"
+        "    memdump 0x80000000 0x40000000 ddr.bin update\n"
         "    memdump 0x10000000 128 \"c:/My Documents/dump.bin\"\n");
+
+    const char hexchar[] = "0123456789abcdef";
+    for (int i = 0; i < 256; i++) {
+        hexPair_[i][0] = hexchar[i >> 4];
+        hexPair_[i][1] = hexchar[i & 0xf];
+    }
 }
 
 int CmdMemDump::isValid(AttributeType *args) {
     if (!cmdName_.is_equal((*args)[0u].to_string())) {
         return CMD_INVALID;
     }
-    if (args->size() == 4 || args->size() == 5) {
-        return CMD_VALID;
+    if (args->size() < 4 || args->size() > 6) {
+        return CMD_WRONG_ARGS;
+    }
+    for (unsigned i = 4; i < args->size(); i++) {
+        if (!(*args)[i].is_equal("bin") && !(*args)[i].is_equal("hex")
+            && !(*args)[i].is_equal("update")) {
+            return CMD_WRONG_ARGS;
+        }
     }
-    return CMD_WRONG_ARGS;
+    return CMD_VALID;
 }
 
 void CmdMemDump::exec(AttributeType *args, AttributeType *res) {
     res->attr_free();
     res->make_nil();
+    if (isValid(args) != CMD_VALID) {
+        generateError(res, "Wrong argument list");
+        return;
+    }
+
+    bool hex = false;
+    bool update = false;
+    for (unsigned i = 4; i < args->size(); i++) {
+        if ((*args)[i].is_equal("hex")) {
+            hex = true;
+        } else if ((*args)[i].is_equal("update")) {
+            update = true;
+        }
+    }
+    if (hex && update) {
+        generateError(res, "Update is supported for binary dumps only");
+        return;
+    }
 
     const char *filename = (*args)[3].to_string();
-    FILE *fd = fopen(filename, "wb");
+    uint64_t addr = (*args)[1].to_uint64();
+    uint64_t len = (*args)[2].to_uint64();
+    FILE *fd = 0;
+    if (update) {
+        fd = fopen(filename, "r+b");
+        if (fd && fsize64(fd) != len) {
+            // Not a dump of this range: write it completely
+            fclose(fd);
+            fd = 0;
+        }
+        if (fd) {
+            res->make_list(0);
+        } else {
+            update = false;
+        }
+    }
+    if (!fd) {
+        fd = fopen(filename, "wb");
+    }
     if (fd == NULL) {
         char tst[256];
         RISCV_sprintf(tst, sizeof(tst), "Can't open '%s' file", filename);
         generateError(res, tst);
         return;
     }
-    uint64_t addr = (*args)[1].to_uint64();
-    int len = static_cast<int>((*args)[2].to_uint64());
-    res->make_data(len);
-
-    tap_->read(addr, len, res->data());
-    uint8_t *dumpbuf = res->data();
-
-    if (args->size() == 5 && (*args)[4].is_equal("hex")) {
-        char t1[256];
-        int t1_cnt = 0;
-        int idx;
-        for (int i = 0; i < ((len + 0xf) & ~0xf); i++) {
-            idx = (i & ~0xf) | (0xf - (i & 0xf));
-            if (idx > len) {
-                t1[t1_cnt++] = ' ';
-                t1[t1_cnt++] = ' ';
+
+    ImageReader reader(tap_, cmdName_.to_string(), addr, len);
+    if (!reader.start()) {
+        fclose(fd);
+        generateError(res, "Can't create thread");
+        return;
+    }
+
+    int bufsz = ImageReader::READER_CHUNK_BYTES;
+    if (hex) {
+        bufsz = (bufsz / 16) * MEMDUMP_HEX_LINE;
+    }
+    char *obuf = new char[bufsz];
+    uint64_t t_start = RISCV_get_time_ms();
+    uint64_t fpos = 0;          // current file position
+    uint64_t chunk_addr;
+    uint64_t off;
+    int chunk_sz;
+    int chunks_changed = 0;
+    int chunks_total = 0;
+    int n;
+    bool error = false;
+    const uint8_t *chunk;
+    while ((chunk = reader.next(&chunk_addr, &chunk_sz)) != 0) {
+        off = chunk_addr - addr;
+        chunks_total++;
+        if (hex) {
+            n = formatHex(chunk, chunk_sz, off + chunk_sz == len, obuf);
+            error = fwrite(obuf, 1, n, fd) != static_cast<size_t>(n);
+        } else if (update) {
+            fseek64(fd, off);
+            n = static_cast<int>(fread(obuf, 1, chunk_sz, fd));
+            if (n == chunk_sz && memcmp(obuf, chunk, chunk_sz) == 0) {
                 continue;
             }
-            t1_cnt += RISCV_sprintf(&t1[t1_cnt], sizeof(t1) - t1_cnt, "%02x",
-                                    dumpbuf[idx]);
-            if ((i & 0xf) != 0xf) {
-                continue;
+            chunks_changed++;
+            fseek64(fd, off);
+            error = fwrite(chunk, 1, chunk_sz, fd)
+                    != static_cast<size_t>(chunk_sz);
+
+            AttributeType *last = res->size() ? &(*res)[res->size() - 1] : 0;
+            if (last && (*last)[0u].to_uint64() + (*last)[1].to_uint64()
+                        == chunk_addr) {
+                (*last)[1].make_uint64((*last)[1].to_uint64() + chunk_sz);
+            } else {
+                AttributeType item;
+                item.make_list(2);
+                item[0u].make_uint64(chunk_addr);
+                item[1].make_uint64(chunk_sz);
+                res->add_to_list(&item);
             }
-            t1_cnt += RISCV_sprintf(&t1[t1_cnt], sizeof(t1) - t1_cnt, "\n");
-            fwrite(t1, t1_cnt, 1, fd);
-            t1_cnt = 0;
+        } else if (isZeroChunk(chunk, chunk_sz)) {
+            continue;
+        } else {
+            if (fpos != off) {
+                fseek64(fd, off);
+            }
+            error = fwrite(chunk, 1, chunk_sz, fd)
+                    != static_cast<size_t>(chunk_sz);
+            fpos = off + chunk_sz;
+        }
+        if (error) {
+            break;
         }
-    } else {
-        fwrite(dumpbuf, len, 1, fd);
+    }
+    reader.finish();
+
+    if (!hex && !update && !error && fpos != len) {
+        // Trailing hole: extend the file up to the dump size
+        fseek64(fd, len - 1);
+        error = fputc(0, fd) == EOF;
     }
     fclose(fd);
+    delete [] obuf;
+
+    if (reader.isError()) {
+        generateError(res, "Reading failed");
+        return;
+    }
+    if (error) {
+        generateError(res, "File writing error");
+        return;
+    }
+
+    uint64_t dt = RISCV_get_time_ms() - t_start;
+    if (dt == 0) {
+        dt = 1;
+    }
+    RISCV_printf(0, LOG_INFO, "%s: %" RV_PRI64 "d KB in %" RV_PRI64 "d ms, "
+                "%" RV_PRI64 "d KB/s", cmdName_.to_string(), len >> 10, dt,
+                (len * 1000 / dt) >> 10);
+    if (update) {
+        RISCV_printf(0, LOG_INFO, "%s: %d of %d chunks changed",
+                    cmdName_.to_string(), chunks_changed, chunks_total);
+    }
+}
+
+/**
+ * Table driven formatting of the whole lines. Missing bytes of the last
+ * line are printed as spaces.
+ */
+int CmdMemDump::formatHex(const uint8_t *data, int sz, bool last,
+                          char *obuf) {
+    char *p = obuf;
+    int full = sz & ~0xf;
+    for (int i = 0; i < full; i += 16) {
+        for (int j = 15; j >= 0; j--) {
+            memcpy(p, hexPair_[data[i + j]], 2);
+            p += 2;
+        }
+        *p++ = '\n';
+    }
+    if (last && full != sz) {
+        for (int j = 15; j >= 0; j--) {
+            if (full + j >= sz) {
+                p[0] = ' ';
+                p[1] = ' ';
+            } else {
+                memcpy(p, hexPair_[data[full + j]], 2);
+            }
+            p += 2;
+        }
+        *p++ = '\n';
+    }
+    return static_cast<int>(p - obuf);
 }
 
 }  // namespace debugger
@@ -29,6 +29,13 @@ class CmdMemDump : public ICommand  {
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) { return true; }
+
+ private:
+    int formatHex(const uint8_t *data, int sz, bool last, char *obuf);
+
+ private:
+    char hexPair_[256][2];
 };
 
 }  // namespace debugger
@@ -29,6 +29,7 @@ class CmdRead : public ICommand  {
     /** ICommand */
     virtual int isValid(AttributeType *args);
     virtual void exec(AttributeType *args, AttributeType *res);
+    virtual bool isReadOnly(AttributeType *args) { return true; }
 
  private:
     void to_string(AttributeType *args, AttributeType *res, AttributeType *out);
@@ -35,6 +35,9 @@ CmdRun::CmdRun(ITap *tap) : ICommand ("run", tap) {
         "    run\n"
         "    go 1000\n"
         "    c 1\n");
+    cmdAliases_.make_list(2);
+    cmdAliases_[0u].make_string("c");
+    cmdAliases_[1].make_string("go");
 
     AttributeType lstServ;
     RISCV_get_services_with_iface(IFACE_SOURCE_CODE, &lstServ);
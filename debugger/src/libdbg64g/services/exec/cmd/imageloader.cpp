@@ -0,0 +1,316 @@
+/*
+ *  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "imageloader.h"
+
+namespace debugger {
+
+ImageLoader::ImageLoader(ITap *tap, const char *name, bool verify)
+    : IThread() {
+    tap_ = tap;
+    name_ = name;
+    verify_ = verify;
+    queue_ = new ChunkType[LOADER_QUEUE_DEPTH];
+    rdbuf_ = verify ? new uint8_t[LOADER_CHUNK_BYTES] : 0;
+    cur_ = 0;
+    wrcnt_ = 0;
+    rdcnt_ = 0;
+    eof_ = false;
+    t_start_ = 0;
+    t_report_ = 0;
+    bytesTotal_ = 0;
+    chunksTotal_ = 0;
+    error_ = false;
+    verifyErrAddr_ = 0;
+
+    // Filled here: both threads compute CRC
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int n = 0; n < 8; n++) {
+            c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : (c >> 1);
+        }
+        crcTable_[i] = c;
+    }
+
+    RISCV_mutex_init(&mutexQueue_);
+    RISCV_event_create(&eventReady_, "ImageLoader_ready");
+    RISCV_event_create(&eventFree_, "ImageLoader_free");
+    RISCV_event_create(&eventDone_, "ImageLoader_done");
+}
+
+ImageLoader::~ImageLoader() {
+    stop();
+    RISCV_event_close(&eventReady_);
+    RISCV_event_close(&eventFree_);
+    RISCV_event_close(&eventDone_);
+    RISCV_mutex_destroy(&mutexQueue_);
+    delete [] queue_;
+    if (rdbuf_) {
+        delete [] rdbuf_;
+    }
+}
+
+bool ImageLoader::start() {
+    t_start_ = RISCV_get_time_ms();
+    t_report_ = t_start_;
+    RISCV_event_clear(&eventDone_);
+    return run();
+}
+
+void ImageLoader::write(uint64_t addr, const uint8_t *data, int sz) {
+    int n;
+    while (sz > 0) {
+        if (cur_ && (cur_->sz == LOADER_CHUNK_BYTES
+                    || cur_->addr + cur_->sz != addr)) {
+            submit();
+        }
+        if (!cur_) {
+            RISCV_mutex_lock(&mutexQueue_);
+            while (wrcnt_ - rdcnt_ == LOADER_QUEUE_DEPTH) {
+                RISCV_event_clear(&eventFree_);
+                RISCV_mutex_unlock(&mutexQueue_);
+                RISCV_event_wait(&eventFree_);
+                RISCV_mutex_lock(&mutexQueue_);
+            }
+            cur_ = &queue_[wrcnt_ % LOADER_QUEUE_DEPTH];
+            RISCV_mutex_unlock(&mutexQueue_);
+            cur_->addr = addr;
+            cur_->sz = 0;
+        }
+        n = LOADER_CHUNK_BYTES - cur_->sz;
+        if (n > sz) {
+            n = sz;
+        }
+        memcpy(&cur_->data[cur_->sz], data, n);
+        cur_->sz += n;
+        addr += static_cast<uint64_t>(n);
+        data += n;
+        sz -= n;
+    }
+}
+
+void ImageLoader::submit() {
+    if (verify_) {
+        cur_->crc = crc32(cur_->data, cur_->sz, 0);
+    }
+    RISCV_mutex_lock(&mutexQueue_);
+    wrcnt_++;
+    RISCV_event_set(&eventReady_);
+    RISCV_mutex_unlock(&mutexQueue_);
+    cur_ = 0;
+}
+
+bool ImageLoader::finish() {
+    if (cur_ && cur_->sz) {
+        submit();
+    }
+    cur_ = 0;
+    RISCV_mutex_lock(&mutexQueue_);
+    eof_ = true;
+    RISCV_event_set(&eventReady_);
+    RISCV_mutex_unlock(&mutexQueue_);
+
+    RISCV_event_wait(&eventDone_);
+    stop();
+    report(true);
+    return !error_;
+}
+
+void ImageLoader::busyLoop() {
+    ChunkType *chunk;
+    while (isEnabled()) {
+        RISCV_mutex_lock(&mutexQueue_);
+        if (rdcnt_ == wrcnt_) {
+            if (eof_) {
+                RISCV_mutex_unlock(&mutexQueue_);
+                break;
+            }
+            RISCV_event_clear(&eventReady_);
+            RISCV_mutex_unlock(&mutexQueue_);
+            RISCV_event_wait_ms(&eventReady_, 100);
+            continue;
+        }
+        chunk = &queue_[rdcnt_ % LOADER_QUEUE_DEPTH];
+        RISCV_mutex_unlock(&mutexQueue_);
+
+        // After an error the queue is only drained to release the parser
+        if (!error_) {
+            if (tap_->write(chunk->addr, chunk->sz, chunk->data)
+                == TAP_ERROR) {
+                RISCV_printf(0, LOG_ERROR, "%s: write error at %08" RV_PRI64
+                            "x", name_, chunk->addr);
+                error_ = true;
+            } else if (verify_) {
+                if (tap_->read(chunk->addr, chunk->sz, rdbuf_) == TAP_ERROR
+                    || crc32(rdbuf_, chunk->sz, 0) != chunk->crc) {
+                    verifyErrAddr_ = chunk->addr;
+                    RISCV_printf(0, LOG_ERROR, "%s: verify failed in "
+                                "[%08" RV_PRI64 "x..%08" RV_PRI64 "x]",
+                                name_, chunk->addr,
+                                chunk->addr + chunk->sz - 1);
+                    error_ = true;
+                }
+            }
+            bytesTotal_ += static_cast<uint64_t>(chunk->sz);
+            chunksTotal_++;
+        }
+
+        RISCV_mutex_lock(&mutexQueue_);
+        rdcnt_++;
+        RISCV_event_set(&eventFree_);
+        RISCV_mutex_unlock(&mutexQueue_);
+        report(false);
+    }
+    RISCV_event_set(&eventDone_);
+}
+
+void ImageLoader::report(bool final) {
+    uint64_t t = RISCV_get_time_ms();
+    if (!final && t - t_report_ < LOADER_PROGRESS_MS) {
+        return;
+    }
+    t_report_ = t;
+    uint64_t dt = t - t_start_;
+    if (dt == 0) {
+        dt = 1;
+    }
+    RISCV_printf(0, LOG_INFO, "%s: %s %" RV_PRI64 "d KB in %d chunks, "
+                "%" RV_PRI64 "d ms, %" RV_PRI64 "d KB/s%s",
+                name_, final ? "loaded" : "loading",
+                bytesTotal_ >> 10, chunksTotal_, dt,
+                (bytesTotal_ * 1000 / dt) >> 10,
+                verify_ && !error_ ? ", verified" : "");
+}
+
+/** CRC-32 (IEEE 802.3), reflected */
+uint32_t ImageLoader::crc32(const uint8_t *buf, int sz, uint32_t crc) {
+    crc = ~crc;
+    for (int i = 0; i < sz; i++) {
+        crc = (crc >> 8) ^ crcTable_[(crc ^ buf[i]) & 0xff];
+    }
+    return ~crc;
+}
+
+ImageReader::ImageReader(ITap *tap, const char *name, uint64_t addr,
+                         uint64_t sz) : IThread() {
+    tap_ = tap;
+    name_ = name;
+    addr_ = addr;
+    sz_ = sz;
+    queue_ = new uint8_t[READER_QUEUE_DEPTH * READER_CHUNK_BYTES];
+    wrcnt_ = 0;
+    rdcnt_ = 0;
+    busy_ = false;
+    done_ = false;
+    abort_ = false;
+    error_ = false;
+
+    RISCV_mutex_init(&mutexQueue_);
+    RISCV_event_create(&eventReady_, "ImageReader_ready");
+    RISCV_event_create(&eventFree_, "ImageReader_free");
+}
+
+ImageReader::~ImageReader() {
+    finish();
+    RISCV_event_close(&eventReady_);
+    RISCV_event_close(&eventFree_);
+    RISCV_mutex_destroy(&mutexQueue_);
+    delete [] queue_;
+}
+
+bool ImageReader::start() {
+    return run();
+}
+
+const uint8_t *ImageReader::next(uint64_t *addr, int *sz) {
+    const uint8_t *ret = 0;
+    uint64_t off;
+    RISCV_mutex_lock(&mutexQueue_);
+    if (busy_) {
+        busy_ = false;
+        rdcnt_++;
+        RISCV_event_set(&eventFree_);
+    }
+    while (rdcnt_ == wrcnt_ && !done_) {
+        RISCV_event_clear(&eventReady_);
+        RISCV_mutex_unlock(&mutexQueue_);
+        RISCV_event_wait(&eventReady_);
+        RISCV_mutex_lock(&mutexQueue_);
+    }
+    if (rdcnt_ != wrcnt_) {
+        off = static_cast<uint64_t>(rdcnt_) * READER_CHUNK_BYTES;
+        *addr = addr_ + off;
+        *sz = READER_CHUNK_BYTES;
+        if (sz_ - off < static_cast<uint64_t>(READER_CHUNK_BYTES)) {
+            *sz = static_cast<int>(sz_ - off);
+        }
+        ret = &queue_[(rdcnt_ % READER_QUEUE_DEPTH) * READER_CHUNK_BYTES];
+        busy_ = true;
+    }
+    RISCV_mutex_unlock(&mutexQueue_);
+    return ret;
+}
+
+void ImageReader::finish() {
+    RISCV_mutex_lock(&mutexQueue_);
+    abort_ = true;
+    RISCV_event_set(&eventFree_);
+    RISCV_mutex_unlock(&mutexQueue_);
+    stop();
+}
+
+void ImageReader::busyLoop() {
+    uint64_t off = 0;
+    int sz;
+    uint8_t *buf;
+    while (isEnabled() && off < sz_) {
+        RISCV_mutex_lock(&mutexQueue_);
+        while (wrcnt_ - rdcnt_ == READER_QUEUE_DEPTH && !abort_) {
+            RISCV_event_clear(&eventFree_);
+            RISCV_mutex_unlock(&mutexQueue_);
+            RISCV_event_wait(&eventFree_);
+            RISCV_mutex_lock(&mutexQueue_);
+        }
+        buf = &queue_[(wrcnt_ % READER_QUEUE_DEPTH) * READER_CHUNK_BYTES];
+        RISCV_mutex_unlock(&mutexQueue_);
+        if (abort_) {
+            break;
+        }
+
+        sz = READER_CHUNK_BYTES;
+        if (sz_ - off < static_cast<uint64_t>(READER_CHUNK_BYTES)) {
+            sz = static_cast<int>(sz_ - off);
+        }
+        if (tap_->read(addr_ + off, sz, buf) == TAP_ERROR) {
+            RISCV_printf(0, LOG_ERROR, "%s: read error at %08" RV_PRI64
+                        "x", name_, addr_ + off);
+            error_ = true;
+            break;
+        }
+        off += static_cast<uint64_t>(sz);
+
+        RISCV_mutex_lock(&mutexQueue_);
+        wrcnt_++;
+        RISCV_event_set(&eventReady_);
+        RISCV_mutex_unlock(&mutexQueue_);
+    }
+    RISCV_mutex_lock(&mutexQueue_);
+    done_ = true;
+    RISCV_event_set(&eventReady_);
+    RISCV_mutex_unlock(&mutexQueue_);
+}
+
+}  // namespace debugger
@@ -0,0 +1,157 @@
+/*
+ *  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_CMD_IMAGELOADER_H__
+#define __DEBUGGER_CMD_IMAGELOADER_H__
+
+#include "api_core.h"
+#include "coreservices/itap.h"
+#include "coreservices/ithread.h"
+
+namespace debugger {
+
+/**
+ * @brief Write pipeline shared by the image loading commands.
+ *
+ * The command thread parses the input file and passes records to write().
+ * Contiguous records are merged into chunks, which go through a bounded
+ * queue to the writer thread. Parsing of the next chunk overlaps with the
+ * transport of the previous one. With 'verify' enabled, each chunk is read
+ * back and its CRC is compared with the one computed while parsing.
+ */
+class ImageLoader : public IThread {
+ public:
+    ImageLoader(ITap *tap, const char *name, bool verify);
+    virtual ~ImageLoader();
+
+    /** Start the writer thread */
+    bool start();
+
+    /** Queue record data. Blocks while the queue is full. */
+    void write(uint64_t addr, const uint8_t *data, int sz);
+
+    /** Flush the last chunk, wait for the writer and print the summary.
+     *  Returns false on transport or verification error. */
+    bool finish();
+
+    uint64_t verifyErrorAddress() { return verifyErrAddr_; }
+
+    /** Two hex digits to byte. Other characters aren't checked here, they
+     *  are detected by the record checksum. */
+    static uint8_t hex2byte(const uint8_t *pair) {
+        return static_cast<uint8_t>(
+            (((pair[0] & 0xF) + 9 * (pair[0] >> 6)) << 4)
+            | ((pair[1] & 0xF) + 9 * (pair[1] >> 6)));
+    }
+
+ protected:
+    /** IThread */
+    virtual void busyLoop();
+
+ private:
+    void submit();
+    void report(bool final);
+    uint32_t crc32(const uint8_t *buf, int sz, uint32_t crc);
+
+ private:
+    static const int LOADER_CHUNK_BYTES = 1 << 16;
+    static const int LOADER_QUEUE_DEPTH = 4;
+    static const uint64_t LOADER_PROGRESS_MS = 1000;
+
+    struct ChunkType {
+        uint64_t addr;
+        int sz;
+        uint32_t crc;
+        uint8_t data[LOADER_CHUNK_BYTES];
+    };
+
+    ITap *tap_;
+    const char *name_;
+    bool verify_;
+
+    ChunkType *queue_;
+    uint8_t *rdbuf_;            // verification read-back
+    ChunkType *cur_;            // chunk being filled by the parser
+    int wrcnt_;                 // submitted chunks
+    int rdcnt_;                 // written chunks
+    bool eof_;
+
+    mutex_def mutexQueue_;
+    event_def eventReady_;
+    event_def eventFree_;
+    event_def eventDone_;
+
+    uint64_t t_start_;
+    uint64_t t_report_;
+    uint64_t bytesTotal_;
+    int chunksTotal_;
+    bool error_;
+    uint64_t verifyErrAddr_;
+    uint32_t crcTable_[256];
+};
+
+/**
+ * @brief Read pipeline of the memory dump.
+ *
+ * The reader thread fetches chunks via TAP ahead of the command thread,
+ * so the file output of one chunk overlaps with the transport of the next.
+ */
+class ImageReader : public IThread {
+ public:
+    ImageReader(ITap *tap, const char *name, uint64_t addr, uint64_t sz);
+    virtual ~ImageReader();
+
+    /** Start the reader thread */
+    bool start();
+
+    /** Returns the next chunk or 0 when all data were read or on error.
+     *  The previously returned chunk is released. */
+    const uint8_t *next(uint64_t *addr, int *sz);
+
+    /** Stop reading, could be called before the end of the range */
+    void finish();
+
+    bool isError() { return error_; }
+
+    static const int READER_CHUNK_BYTES = 1 << 16;
+
+ protected:
+    /** IThread */
+    virtual void busyLoop();
+
+ private:
+    static const int READER_QUEUE_DEPTH = 4;
+
+    ITap *tap_;
+    const char *name_;
+    uint64_t addr_;
+    uint64_t sz_;
+    uint8_t *queue_;
+    int wrcnt_;                 // read chunks
+    int rdcnt_;                 // released chunks
+    bool busy_;                 // chunk is used by the command thread
+    bool done_;
+    bool abort_;
+    bool error_;
+
+    mutex_def mutexQueue_;
+    event_def eventReady_;
+    event_def eventFree_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_CMD_IMAGELOADER_H__
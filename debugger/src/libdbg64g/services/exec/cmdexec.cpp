@@ -21,6 +21,7 @@
 #include "cmd/cmd_loadsrec.h"
 #include "cmd/cmd_log.h"
 #include "cmd/cmd_isrunning.h"
+#include "cmd/cmd_line.h"
 #include "cmd/cmd_read.h"
 #include "cmd/cmd_write.h"
 #include "cmd/cmd_run.h"
@@ -48,17 +49,22 @@ CmdExecutor::CmdExecutor(const char *name)
     //console_.make_list(0);
     tap_.make_string("");
     cmds_.make_list(0);
+    for (int i = 0; i < CMD_HASH_SIZE; i++) {
+        cmdHash_[i].make_list(0);
+    }
 
+    RISCV_mutex_init(&mutexCmds_);
     RISCV_mutex_init(&mutexExec_);
-
-    tmpbuf_ = new uint8_t[tmpbuf_size_ = 4096];
-    outbuf_ = new char[outbuf_size_ = 4096];
+    RISCV_mutex_init(&mutexReaders_);
+    readers_ = 0;
+    RISCV_event_create(&eventNoReaders_, "cmdexec_noreaders");
 }
 
 CmdExecutor::~CmdExecutor() {
+    RISCV_mutex_destroy(&mutexCmds_);
     RISCV_mutex_destroy(&mutexExec_);
-    delete [] tmpbuf_;
-    delete [] outbuf_;
+    RISCV_mutex_destroy(&mutexReaders_);
+    RISCV_event_close(&eventNoReaders_);
     for (unsigned i = 0; i < cmds_.size(); i++) {
         delete cmds_[i].to_iface();
     }
@@ -77,6 +83,7 @@ void CmdExecutor::postinitService() {
     registerCommand(new CmdExit(itap_));
     registerCommand(new CmdHalt(itap_));
     registerCommand(new CmdIsRunning(itap_));
+    registerCommand(new CmdLine(itap_));
     registerCommand(new CmdLoadBin(itap_));
     registerCommand(new CmdLoadElf(itap_));
     registerCommand(new CmdLoadH86(itap_));
@@ -94,21 +101,29 @@ void CmdExecutor::postinitService() {
 
 void CmdExecutor::registerCommand(ICommand *icmd) {
     AttributeType t1(icmd);
+    RISCV_mutex_lock(&mutexCmds_);
     cmds_.add_to_list(&t1);
+    addToHash(icmd->cmdName(), icmd);
+    const AttributeType &aliases = icmd->cmdAliases();
+    for (unsigned i = 0; i < aliases.size(); i++) {
+        addToHash(aliases[i].to_string(), icmd);
+    }
+    RISCV_mutex_unlock(&mutexCmds_);
 }
 
 void CmdExecutor::unregisterCommand(ICommand *icmd) {
+    RISCV_mutex_lock(&mutexCmds_);
     for (unsigned i = 0; i < cmds_.size(); i++) {
         if (cmds_[i].to_iface() == icmd) {
             cmds_.remove_from_list(i);
             break;
         }
     }
+    removeFromHash(icmd);
+    RISCV_mutex_unlock(&mutexCmds_);
 }
 
 void CmdExecutor::exec(const char *line, AttributeType *res, bool silent) {
-    RISCV_mutex_lock(&mutexExec_);
-
     AttributeType cmd;
     if (line[0] == '[' || line[0] == '}') {
         cmd.from_config(line);
@@ -124,14 +139,10 @@ void CmdExecutor::exec(const char *line, AttributeType *res, bool silent) {
         cmd_parsed = &cmd;
     }
     processSimple(cmd_parsed, res);
+}
 
-    RISCV_mutex_unlock(&mutexExec_);
-
-    /** Do not output any information into console in silent mode: */
-    if (silent) {
-        return;
-    }
-    //RISCV_printf0("%s", outbuf_);
+void CmdExecutor::exec(AttributeType *args, AttributeType *res) {
+    processSimple(args, res);
 }
 
 void CmdExecutor::commands(const char *substr, AttributeType *res) {
@@ -140,6 +151,7 @@ void CmdExecutor::commands(const char *substr, AttributeType *res) {
     }
     AttributeType item;
     item.make_list(3);
+    RISCV_mutex_lock(&mutexCmds_);
     for (unsigned i = 0; i < cmds_.size(); i++) {
         ICommand *icmd = static_cast<ICommand *>(cmds_[i].to_iface());
         if (strstr(icmd->cmdName(), substr)) {
@@ -149,10 +161,10 @@ void CmdExecutor::commands(const char *substr, AttributeType *res) {
             res->add_to_list(&item);
         }
     }
+    RISCV_mutex_unlock(&mutexCmds_);
 }
 
 void CmdExecutor::processSimple(AttributeType *cmd, AttributeType *res) {
-    outbuf_[outbuf_cnt_ = 0] = '\0';
     if (cmd->size() == 0) {
         return;
     }
@@ -170,11 +182,13 @@ void CmdExecutor::processSimple(AttributeType *cmd, AttributeType *res) {
         res->make_nil();
         if (cmd->size() == 1) {
             RISCV_printf0("** List of supported commands: **", NULL);
+            RISCV_mutex_lock(&mutexCmds_);
             for (unsigned i = 0; i < cmds_.size(); i++) {
                 icmd = static_cast<ICommand *>(cmds_[i].to_iface());
                 RISCV_printf0("%13s   - %s",
                         icmd->cmdName(), icmd->briefDescr());
             }
+            RISCV_mutex_unlock(&mutexCmds_);
         } else {
             AttributeType helparg;
             helparg.make_list(1);
@@ -204,7 +218,20 @@ void CmdExecutor::processSimple(AttributeType *cmd, AttributeType *res) {
             (*cmd)[0u].to_string(), (*cmd)[0u].to_string());
         return;
     }
+    bool rdonly = icmd->isReadOnly(cmd);
+    if (rdonly) {
+        beginRead();
+    } else {
+        beginWrite();
+    }
+    icmd->lockExec();
     icmd->exec(cmd, res);
+    icmd->unlockExec();
+    if (rdonly) {
+        endRead();
+    } else {
+        endWrite();
+    }
 
     if (cmdIsError(res)) {
         RISCV_error("Command '%s' error: '%s'", 
@@ -212,6 +239,40 @@ void CmdExecutor::processSimple(AttributeType *cmd, AttributeType *res) {
     }
 }
 
+void CmdExecutor::beginRead() {
+    RISCV_mutex_lock(&mutexExec_);
+    RISCV_mutex_lock(&mutexReaders_);
+    readers_++;
+    RISCV_mutex_unlock(&mutexReaders_);
+    RISCV_mutex_unlock(&mutexExec_);
+}
+
+void CmdExecutor::endRead() {
+    RISCV_mutex_lock(&mutexReaders_);
+    if (--readers_ == 0) {
+        RISCV_event_set(&eventNoReaders_);
+    }
+    RISCV_mutex_unlock(&mutexReaders_);
+}
+
+void CmdExecutor::beginWrite() {
+    RISCV_mutex_lock(&mutexExec_);
+    while (true) {
+        RISCV_mutex_lock(&mutexReaders_);
+        if (readers_ == 0) {
+            RISCV_mutex_unlock(&mutexReaders_);
+            break;
+        }
+        RISCV_event_clear(&eventNoReaders_);
+        RISCV_mutex_unlock(&mutexReaders_);
+        RISCV_event_wait(&eventNoReaders_);
+    }
+}
+
+void CmdExecutor::endWrite() {
+    RISCV_mutex_unlock(&mutexExec_);
+}
+
 bool CmdExecutor::cmdIsError(AttributeType *res) {
     if (!res->is_list() || res->size() != 3) {
         return false;
@@ -226,6 +287,22 @@ int CmdExecutor::getICommand(AttributeType *args, ICommand **pcmd) {
     *pcmd = 0;
     int err = CMD_INVALID;
     ICommand *iitem;
+    RISCV_mutex_lock(&mutexCmds_);
+    AttributeType &bucket = cmdHash_[hashName((*args)[0u].to_string())];
+    for (unsigned i = 0; i < bucket.size(); i++) {
+        if (!bucket[i][0u].is_equal((*args)[0u].to_string())) {
+            continue;
+        }
+        iitem = static_cast<ICommand *>(bucket[i][1].to_iface());
+        err = iitem->isValid(args);
+        if (err != CMD_INVALID) {
+            *pcmd = iitem;
+            RISCV_mutex_unlock(&mutexCmds_);
+            return err;
+        }
+    }
+
+    // Commands accepting names that aren't declared as aliases
     for (unsigned i = 0; i < cmds_.size(); i++) {
         iitem = static_cast<ICommand *>(cmds_[i].to_iface());
         if (!iitem) {
@@ -234,10 +311,38 @@ int CmdExecutor::getICommand(AttributeType *args, ICommand **pcmd) {
         err = iitem->isValid(args);
         if (err != CMD_INVALID) {
             *pcmd = iitem;
-            return err;
+            break;
+        }
+    }
+    RISCV_mutex_unlock(&mutexCmds_);
+    return err;
+}
+
+unsigned CmdExecutor::hashName(const char *name) {
+    unsigned h = 5381;
+    while (*name) {
+        h = 33 * h + static_cast<uint8_t>(*name++);
+    }
+    return h % CMD_HASH_SIZE;
+}
+
+void CmdExecutor::addToHash(const char *name, ICommand *icmd) {
+    AttributeType item;
+    item.make_list(2);
+    item[0u].make_string(name);
+    item[1].make_iface(icmd);
+    cmdHash_[hashName(name)].add_to_list(&item);
+}
+
+void CmdExecutor::removeFromHash(ICommand *icmd) {
+    for (int n = 0; n < CMD_HASH_SIZE; n++) {
+        AttributeType &bucket = cmdHash_[n];
+        for (unsigned i = bucket.size(); i > 0; i--) {
+            if (bucket[i - 1][1].to_iface() == icmd) {
+                bucket.remove_from_list(i - 1);
+            }
         }
     }
-    return CMD_INVALID;
 }
 
 void CmdExecutor::splitLine(char *str, AttributeType *listArgs) {
@@ -281,19 +386,4 @@ void CmdExecutor::splitLine(char *str, AttributeType *listArgs) {
     }
 }
 
-int CmdExecutor::outf(const char *fmt, ...) {
-    if (outbuf_cnt_ > (outbuf_size_ - 128)) {
-        char *t = new char [2*outbuf_size_];
-        memcpy(t, outbuf_, outbuf_size_);
-        delete [] outbuf_;
-        outbuf_size_ *= 2;
-        outbuf_ = t;
-    }
-    va_list arg;
-    va_start(arg, fmt);
-    outbuf_cnt_ += vsprintf(&outbuf_[outbuf_cnt_], fmt, arg);
-    va_end(arg);
-    return outbuf_cnt_;
-}
-
 }  // namespace debugger
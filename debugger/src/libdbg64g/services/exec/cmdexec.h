@@ -28,6 +28,9 @@
 
 namespace debugger {
 
+/** Number of buckets in the command names hash table */
+static const int CMD_HASH_SIZE = 64;
+
 class CmdExecutor : public IService,
                     public ICmdExecutor {
  public:
@@ -41,6 +44,7 @@ class CmdExecutor : public IService,
     virtual void registerCommand(ICommand *icmd);
     virtual void unregisterCommand(ICommand *icmd);
     virtual void exec(const char *line, AttributeType *res, bool silent);
+    virtual void exec(AttributeType *args, AttributeType *res);
     virtual void commands(const char *substr, AttributeType *res);
 
  private:
@@ -48,24 +52,33 @@ class CmdExecutor : public IService,
     void processScript(AttributeType *cmd, AttributeType *res);
     void splitLine(char *str, AttributeType *listArgs);
 
-    int outf(const char *fmt, ...);
     bool cmdIsError(AttributeType *res);
     int getICommand(AttributeType *args, ICommand **pcmd);
+    unsigned hashName(const char *name);
+    void addToHash(const char *name, ICommand *icmd);
+    void removeFromHash(ICommand *icmd);
+    void beginRead();
+    void endRead();
+    void beginWrite();
+    void endWrite();
 
  private:
     AttributeType tap_;
     AttributeType cmds_;
+    AttributeType cmdHash_[CMD_HASH_SIZE];  // buckets of [name, iface]
 
     ITap *itap_;
 
+    mutex_def mutexCmds_;       // commands list and hash table
+    /**
+     * Read-only commands run concurrently, other commands run exclusively.
+     * A writer holds mutexExec_ for the whole call, so new readers wait,
+     * and then waits until the running readers are done.
+     */
     mutex_def mutexExec_;
-
-    char cmdbuf_[4096];
-    char *outbuf_;
-    int outbuf_size_;
-    int outbuf_cnt_;
-    uint8_t *tmpbuf_;
-    int tmpbuf_size_;
+    mutex_def mutexReaders_;
+    int readers_;
+    event_def eventNoReaders_;
 };
 
 DECLARE_CLASS(CmdExecutor)
@@ -0,0 +1,196 @@
+/*
+ *  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "bincmd.h"
+#include "tcpclient.h"
+
+namespace debugger {
+
+static const int BIN_HEADER_SIZE =
+    static_cast<int>(sizeof(BinFrameHeaderType));
+
+BinCommands::BinCommands(IService *parent) : TcpCommandsGen(parent) {
+    payloadcnt_ = 0;
+    memset(&hdr_, 0, sizeof(hdr_));
+}
+
+int BinCommands::updateData(const char *buf, int buflen) {
+    int i = 0;
+    int n;
+    while (i < buflen) {
+        if (rxcnt_ < BIN_HEADER_SIZE) {
+            n = BIN_HEADER_SIZE - rxcnt_;
+            if (n > buflen - i) {
+                n = buflen - i;
+            }
+            rxbuf_.write_bin(&buf[i], n);
+            rxcnt_ += n;
+            i += n;
+            if (rxcnt_ < BIN_HEADER_SIZE) {
+                break;
+            }
+            memcpy(&hdr_, rxbuf_.getBuffer(), BIN_HEADER_SIZE);
+            if (hdr_.magic != BIN_FRAME_MAGIC) {
+                // Re-synchronization: shift header on one byte
+                char tbuf[BIN_HEADER_SIZE];
+                memcpy(tbuf, &rxbuf_.getBuffer()[1], BIN_HEADER_SIZE - 1);
+                rxbuf_.clear();
+                rxbuf_.write_bin(tbuf, BIN_HEADER_SIZE - 1);
+                rxcnt_ = BIN_HEADER_SIZE - 1;
+                continue;
+            }
+        }
+
+        // Oversized payload isn't stored, request fails with error
+        n = buflen - i;
+        if (static_cast<uint32_t>(n) > hdr_.len - payloadcnt_) {
+            n = static_cast<int>(hdr_.len - payloadcnt_);
+        }
+        if (hdr_.len <= BIN_PAYLOAD_MAX) {
+            rxbuf_.write_bin(&buf[i], n);
+        }
+        payloadcnt_ += static_cast<uint32_t>(n);
+        i += n;
+        if (payloadcnt_ == hdr_.len) {
+            processCommand(rxbuf_.getBuffer(), rxbuf_.size());
+            rxbuf_.clear();
+            rxcnt_ = 0;
+            payloadcnt_ = 0;
+            // Response should be sent before the next command
+            return i;
+        }
+    }
+    return 0;
+}
+
+int BinCommands::processCommand(const char *cmdbuf, int bufsz) {
+    BinFrameHeaderType resp;
+    uint8_t *payload = reinterpret_cast<uint8_t *>(
+                        const_cast<char *>(&cmdbuf[BIN_HEADER_SIZE]));
+    uint32_t bytes;
+    char *rdbuf;
+    AttributeType res;
+
+    memset(&resp, 0, sizeof(resp));
+    resp.magic = BIN_FRAME_MAGIC;
+    resp.seqnum = hdr_.seqnum;
+    resp.cmd = hdr_.cmd;
+    resp.param = hdr_.param;
+    resp.addr = hdr_.addr;
+    resp.status = BinStatus_OK;
+
+    if (hdr_.len > BIN_PAYLOAD_MAX) {
+        RISCV_error("Payload %d bytes exceeds limit", hdr_.len);
+        resp.status = BinStatus_Error;
+    } else if (hdr_.cmd == BinCmd_MemRead || hdr_.cmd == BinCmd_RegRead) {
+        bytes = hdr_.param;
+        if (hdr_.cmd == BinCmd_RegRead) {
+            bytes *= 8;
+        }
+        if (!itap_ || bytes > BIN_PAYLOAD_MAX) {
+            resp.status = BinStatus_Error;
+        } else {
+            rdbuf = reserveResponse(static_cast<int>(bytes));
+            if (itap_->read(hdr_.addr, static_cast<int>(bytes),
+                            reinterpret_cast<uint8_t *>(rdbuf)) == TAP_ERROR) {
+                resp.status = BinStatus_Error;
+            } else {
+                resp.len = bytes;
+            }
+        }
+    } else if (hdr_.cmd == BinCmd_MemWrite || hdr_.cmd == BinCmd_RegWrite) {
+        if (!itap_ || (hdr_.cmd == BinCmd_RegWrite && (hdr_.len & 0x7))) {
+            resp.status = BinStatus_Error;
+        } else if (itap_->write(hdr_.addr, static_cast<int>(hdr_.len),
+                                payload) == TAP_ERROR) {
+            resp.status = BinStatus_Error;
+        }
+    } else if (hdr_.cmd == BinCmd_BrAdd || hdr_.cmd == BinCmd_BrRemove) {
+        breakpoint(hdr_.cmd == BinCmd_BrAdd, hdr_.addr, &resp);
+    } else if (hdr_.cmd == BinCmd_Go) {
+        runCmd(hdr_.param, &res);
+    } else if (hdr_.cmd == BinCmd_Halt) {
+        AttributeType args;
+        args.make_list(1);
+        args[0u].make_string("halt");
+        iexec_->exec(&args, &res);
+    } else {
+        resp.status = BinStatus_Unsupported;
+    }
+
+    reserveResponse(static_cast<int>(resp.len));
+    memcpy(respbuf_, &resp, BIN_HEADER_SIZE);
+    respcnt_ = BIN_HEADER_SIZE + static_cast<int>(resp.len);
+    return bufsz;
+}
+
+char *BinCommands::reserveResponse(int payloadsz) {
+    if (BIN_HEADER_SIZE + payloadsz > resptotal_) {
+        delete [] respbuf_;
+        resptotal_ = BIN_HEADER_SIZE + payloadsz;
+        respbuf_ = new char[resptotal_];
+    }
+    return &respbuf_[BIN_HEADER_SIZE];
+}
+
+void BinCommands::breakpoint(bool add, uint64_t addr,
+                             BinFrameHeaderType *resp) {
+    AttributeType t1, res;
+    t1.make_uint64(addr);
+    if (add) {
+        br_add(t1, &res);
+    } else {
+        br_rm(t1, &res);
+    }
+    if (res.is_list() && res.size() && res[0u].is_equal("ERROR")) {
+        resp->status = BinStatus_Error;
+    }
+}
+
+void BinCommands::hapTriggered(EHapType type, uint64_t param,
+                               const char *descr) {
+    TcpCommandsGen::hapTriggered(type, param, descr);
+    if (type == HAP_Halt) {
+        sendEvent(BinEvent_Halt, icpufunc_ ? icpufunc_->getPC() : 0);
+    } else if (type == HAP_Resume) {
+        sendEvent(BinEvent_Resume, 0);
+    }
+}
+
+void BinCommands::sendEvent(uint8_t ev, uint64_t addr) {
+    TcpClient *client = static_cast<TcpClient *>(parent_);
+    if (client->isClosed()) {
+        return;
+    }
+    BinFrameHeaderType hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = BIN_FRAME_MAGIC;
+    hdr.cmd = ev;
+    hdr.addr = addr;
+    client->writeData(reinterpret_cast<char *>(&hdr), BIN_HEADER_SIZE);
+}
+
+void BinCommands::formatConsole(const char *buf, int sz, AutoBuffer *out) {
+    BinFrameHeaderType hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = BIN_FRAME_MAGIC;
+    hdr.cmd = BinEvent_Console;
+    hdr.len = static_cast<uint32_t>(sz);
+    out->write_bin(reinterpret_cast<char *>(&hdr), BIN_HEADER_SIZE);
+    out->write_bin(buf, sz);
+}
+
+}  // namespace debugger
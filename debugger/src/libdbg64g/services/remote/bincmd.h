@@ -0,0 +1,102 @@
+/*
+ *  Copyright 2019 Sergey Khabarov, sergeykhbr@gmail.com
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef __DEBUGGER_SERVICES_REMOTE_BINCMD_H__
+#define __DEBUGGER_SERVICES_REMOTE_BINCMD_H__
+
+#include "tcpcmd_gen.h"
+
+namespace debugger {
+
+/** Every frame starts with this value, little-endian 'RBIN' */
+static const uint32_t BIN_FRAME_MAGIC = 0x4E494252;
+/** Payload limit, larger memory blocks should be split by client */
+static const uint32_t BIN_PAYLOAD_MAX = 1 << 24;
+
+enum EBinCommand {
+    BinCmd_MemRead = 0x01,      // addr, param = bytes; response: data
+    BinCmd_MemWrite = 0x02,     // addr, payload: data
+    BinCmd_RegRead = 0x03,      // addr = first register, param = count
+    BinCmd_RegWrite = 0x04,     // addr = first register, payload: uint64[]
+    BinCmd_BrAdd = 0x05,        // addr
+    BinCmd_BrRemove = 0x06,     // addr
+    BinCmd_Go = 0x07,           // param = steps, 0 to run without limit
+    BinCmd_Halt = 0x08,
+    // Notifications sent by the simulator, seqnum is always 0
+    BinEvent_Halt = 0x80,       // addr = pc
+    BinEvent_Resume = 0x81,
+    BinEvent_Console = 0x82     // payload: text
+};
+
+enum EBinStatus {
+    BinStatus_OK = 0,
+    BinStatus_Error = 1,        // transaction failed or wrong arguments
+    BinStatus_Unsupported = 2
+};
+
+/**
+ * Request, response and notification header. Response copies seqnum and
+ * cmd of the request, 'len' bytes of payload follow the header.
+ */
+struct BinFrameHeaderType {
+    uint32_t magic;
+    uint32_t seqnum;
+    uint8_t cmd;
+    uint8_t status;
+    uint16_t rsrv;
+    uint32_t param;
+    uint64_t addr;
+    uint32_t len;
+    uint32_t rsrv2;
+};
+
+/**
+ * @brief Length-prefixed binary protocol.
+ * @details Memory and register blocks are transferred as is via the ITap
+ *          interface. Read data is placed directly
+ *          into the response buffer without text encoding.
+ */
+class BinCommands : public TcpCommandsGen {
+ public:
+    explicit BinCommands(IService *parent);
+
+    /** IRawListener: frame length is known from the header */
+    virtual int updateData(const char *buf, int buflen);
+
+    /** IHap */
+    virtual void hapTriggered(EHapType type, uint64_t param,
+                              const char *descr);
+
+    virtual void formatConsole(const char *buf, int sz, AutoBuffer *out);
+
+ protected:
+    virtual int processCommand(const char *cmdbuf, int bufsz);
+    virtual bool isStartMarker(char s) { return true; }
+    virtual bool isEndMarker(const char *s, int sz) { return false; }
+
+ private:
+    char *reserveResponse(int payloadsz);
+    void breakpoint(bool add, uint64_t addr, BinFrameHeaderType *resp);
+    void sendEvent(uint8_t ev, uint64_t addr);
+
+ private:
+    BinFrameHeaderType hdr_;    // header of the frame being received
+    uint32_t payloadcnt_;       // received payload bytes
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_SERVICES_REMOTE_BINCMD_H__
@@ -93,6 +93,7 @@ DpiClient::DpiClient(const char *name) : IService(name),
 
     RISCV_event_create(&event_cmd_, name);
     RISCV_mutex_init(&mutex_tx_);
+    RISCV_mutex_init(&mutexAccess_);
 
     char tstr[256];
     RISCV_sprintf(tstr, sizeof(tstr), "['%s','HartBeat']", name);
@@ -106,6 +107,7 @@ DpiClient::DpiClient(const char *name) : IService(name),
 
 DpiClient::~DpiClient() {
     RISCV_mutex_destroy(&mutex_tx_);
+    RISCV_mutex_destroy(&mutexAccess_);
     RISCV_event_close(&event_cmd_);
 }
 
@@ -339,7 +341,9 @@ void DpiClient::axi4_write(uint64_t addr, int bytes, uint64_t data) {
             "}"
         "]",
         getObjName(), addr, bytes, data);
+    RISCV_mutex_lock(&mutexAccess_);
     syncRequest(tstr, sz + 1);
+    RISCV_mutex_unlock(&mutexAccess_);
 }
 
 void DpiClient::axi4_read(uint64_t addr, int bytes, uint64_t *data) {
@@ -356,12 +360,13 @@ void DpiClient::axi4_read(uint64_t addr, int bytes, uint64_t *data) {
         "]",
         getObjName(), addr, bytes);
 
-    if (!syncRequest(tstr, sz + 1)) {
-        return;
+    RISCV_mutex_lock(&mutexAccess_);
+    if (syncRequest(tstr, sz + 1)) {
+        AttributeType &d = syncResponse_[DpiResp_Data];
+        AttributeType &rdata = d["rdata"];
+        *data = rdata[0u].to_uint64();
     }
-    AttributeType &d = syncResponse_[DpiResp_Data];
-    AttributeType &rdata = d["rdata"];
-    *data = rdata[0u].to_uint64();
+    RISCV_mutex_unlock(&mutexAccess_);
 }
 
 void DpiClient::msgRead(uint64_t addr, int bytes) {
@@ -430,7 +435,25 @@ void DpiClient::msgWrite(uint64_t addr, int bytes, uint8_t *buf) {
     }
 }
 
+/**
+ * Request buffer and response are shared, so the whole transaction is
+ * done under lock.
+ */
 int DpiClient::read(uint64_t addr, int bytes, uint8_t *obuf) {
+    RISCV_mutex_lock(&mutexAccess_);
+    int ret = readTransaction(addr, bytes, obuf);
+    RISCV_mutex_unlock(&mutexAccess_);
+    return ret;
+}
+
+int DpiClient::write(uint64_t addr, int bytes, uint8_t *ibuf) {
+    RISCV_mutex_lock(&mutexAccess_);
+    int ret = writeTransaction(addr, bytes, ibuf);
+    RISCV_mutex_unlock(&mutexAccess_);
+    return ret;
+}
+
+int DpiClient::readTransaction(uint64_t addr, int bytes, uint8_t *obuf) {
     uint8_t *pout = obuf;
     int bytes_total = bytes;
     Reg64Type t;
@@ -502,10 +525,12 @@ int DpiClient::read(uint64_t addr, int bytes, uint8_t *obuf) {
     return bytes;
 }
 
-int DpiClient::write(uint64_t addr, int bytes, uint8_t *ibuf) {
+int DpiClient::writeTransaction(uint64_t addr, int bytes, uint8_t *ibuf) {
     uint8_t *pin = ibuf;
     int bytes_total = bytes;
 
+    postMemDirty(addr, bytes);
+
     // Read unaligned first qword
     if ((addr & 0x7) != 0 || bytes < 8) {
         int toffset;
@@ -80,6 +80,8 @@ class DpiClient : public IService,
 
     void msgRead(uint64_t addr, int bytes);
     void msgWrite(uint64_t addr, int bytes, uint8_t *buf);
+    int readTransaction(uint64_t addr, int bytes, uint8_t *obuf);
+    int writeTransaction(uint64_t addr, int bytes, uint8_t *ibuf);
 
  private:
     static const int BURST_LEN_MAX = 4*8;    // hardcoded in libdpiwrapper
@@ -100,6 +102,7 @@ class DpiClient : public IService,
     socket_def hsock_;
 
     mutex_def mutex_tx_;
+    mutex_def mutexAccess_;     // TAP is shared by the debugger threads
     event_def event_cmd_;
     char rcvbuf[4096];
     char cmdbuf_[4096];
@@ -14,42 +14,117 @@
  *  limitations under the License.
  */
 
+#include <generic-isa.h>
 #include "gdbcmd.h"
+#include "tcpclient.h"
+#include "coreservices/imemop.h"
+#include "coreservices/icpuarm.h"
+#include "debug/dsumap.h"
 
 namespace debugger {
-/*
-RspPacket::RspPacket(const char* const c_str) : RspPacket() {
-    append('$');
-    append(c_str);
-    append('#');
-    RISCV_sprintf(&data[size], sizeof(data) - size, "%02x",
-                checksum(c_str, strlen(c_str)));
-    size += 2; // for checksum
-    data[size] = '\0';
+
+/** Register shown as unavailable ('xx..') */
+static const uint16_t DPORT_NONE = 0xFFFF;
+/** Register set reported by 'g' packet */
+static const int RISCV_GDB_REGS = 33;   // x0..x31, pc
+static const int ARM_GDB_REGS = 26;     // r0..r15, f0..f7, fps, cpsr
+/** Halt polling: yield first, then wait with timeout */
+static const int HALT_SPIN_MAX = 1000;
+static const int HALT_POLL_MS = 10;
+
+static uint16_t dport_ireg(int idx) {
+    return static_cast<uint16_t>(DSUREG(ureg.v.iregs[idx]) >> 3);
 }
 
-void RspPacket::removeCRC(){
-    data[size - 3] = '\0';
-    size -= 3;
+static uint16_t dport_freg(int idx) {
+    return static_cast<uint16_t>(DSUREG(ureg.v.fregs[idx]) >> 3);
 }
 
-void RspPacket::append(const char* c_str){
-    size_t length = strlen(c_str);
-    memcpy(&data[size], c_str, length);
-    size += length;
+/** Memory block size read via TAP while computing qCRC */
+static const int CRC_CHUNK_SIZE = 1 << 12;
+
+/** The same polynomial and bit order as libiberty xcrc32() used by GDB */
+static uint32_t gdb_crc32(const uint8_t *buf, int sz, uint32_t crc) {
+    static uint32_t table[256] = {0};
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i << 24;
+            for (int n = 0; n < 8; n++) {
+                c = (c & 0x80000000) ? (c << 1) ^ 0x04c11db7 : (c << 1);
+            }
+            table[i] = c;
+        }
+    }
+    for (int i = 0; i < sz; i++) {
+        crc = (crc << 8) ^ table[((crc >> 24) ^ buf[i]) & 0xff];
+    }
+    return crc;
 }
 
-uint8_t RspPacket::checksum(const char *data, const size_t sz) {
-    uint8_t sum = 0;
-    for (size_t i = 0; i < sz; i++) {
-        sum += static_cast<unsigned char>(data[i]);
+static int hex2nibble(char s) {
+    if (s >= '0' && s <= '9') {
+        return s - '0';
+    } else if (s >= 'a' && s <= 'f') {
+        return s - 'a' + 10;
+    } else if (s >= 'A' && s <= 'F') {
+        return s - 'A' + 10;
     }
-    return sum;
+    return -1;
 }
-*/
 
 GdbCommands::GdbCommands(IService *parent) : TcpCommandsGen(parent) {
     estate_ = State_AckMode;
+    packet_len_ = 0;
+
+    AttributeType lstServ;
+    RISCV_get_services_with_iface(IFACE_DSU_GENERIC, &lstServ);
+    idsu_ = 0;
+    if (lstServ.size() != 0) {
+        IService *iserv = static_cast<IService *>(lstServ[0u].to_iface());
+        idsu_ = static_cast<IDsuGeneric *>(
+                            iserv->getInterface(IFACE_DSU_GENERIC));
+        if (idsu_->getCpuTotal() == 0) {
+            idsu_ = 0;
+        }
+    }
+    isArm_ = RISCV_get_service_iface(cpu_.to_string(), IFACE_CPU_ARM) != 0;
+
+    hartg_ = 0;
+    hartc_ = -1;
+    hartstop_ = 0;
+    nonstop_ = false;
+    running_ = 0;
+    interrupted_ = 0;
+    stopQueue_.make_list(0);
+    brList_.make_list(0);
+    RISCV_mutex_init(&mutexStop_);
+}
+
+GdbCommands::~GdbCommands() {
+    RISCV_mutex_destroy(&mutexStop_);
+}
+
+/** Non-stop mode: stop of the resumed hart is reported asynchronously */
+void GdbCommands::hapTriggered(EHapType type, uint64_t param,
+                               const char *descr) {
+    TcpCommandsGen::hapTriggered(type, param, descr);
+    if (type != HAP_Halt || !nonstop_ || param >= 64) {
+        return;
+    }
+    int hart = static_cast<int>(param);
+    RISCV_mutex_lock(&mutexStop_);
+    if ((running_ & (1ull << hart)) && isHartHalted(hart)) {
+        running_ &= ~(1ull << hart);
+        AttributeType item;
+        item.make_int64(hart);
+        stopQueue_.add_to_list(&item);
+        if (stopQueue_.size() == 1) {
+            char tstr[64] = "Stop:";
+            formatStopReply(hart, &tstr[5], sizeof(tstr) - 5);
+            sendNotification(tstr);
+        }
+    }
+    RISCV_mutex_unlock(&mutexStop_);
 }
 
 int GdbCommands::processCommand(const char *cmdbuf, int bufsz) {
@@ -72,9 +147,16 @@ int GdbCommands::processCommand(const char *cmdbuf, int bufsz) {
         return bufsz;
     }
 
+    if (bufsz - 4 >= static_cast<int>(sizeof(packet_data_))) {
+        RISCV_error("RSP packet %d bytes exceeds buffer", bufsz);
+        sendPacket("E01");
+        return bufsz;
+    }
+
     // Remove '$' start symbol and CRC at the end
-    memcpy(&packet_data_, &cmdbuf[1], bufsz - 4);
-    packet_data_[bufsz - 4] = '\0';
+    packet_len_ = bufsz - 4;
+    memcpy(&packet_data_, &cmdbuf[1], packet_len_);
+    packet_data_[packet_len_] = '\0';
 
     handlePacket(packet_data_);
     return bufsz;
@@ -168,13 +250,13 @@ void GdbCommands::handleQuery() {
         sendPacket("1");
     } else if (strcmp("qC", packet_data_) == 0) {
         /* Return the current thread ID.
-         * Reply QCpid - Where pid is a HEX encoded 16 bit process id.
-         * Set thread id 1, because we don't have other threads. */
-        sendPacket("QC1");
-    } else if (strncmp("qCRC", packet_data_, strlen("qCRC")) == 0) {
-        /* Return CRC of memory area.
-         * Return Error 01 */
-        sendPacket("E01");
+         * Reply QC<tid> - thread id is the hart index plus one. */
+        char tstr[32];
+        RISCV_sprintf(tstr, sizeof(tstr), "QC%x", hartstop_ + 1);
+        sendPacket(tstr);
+    } else if (strncmp("qCRC:", packet_data_, strlen("qCRC:")) == 0) {
+        /* Return CRC of memory area, used by 'compare-sections' */
+        handleCrc();
     } else if (strcmp("qfThreadInfo", packet_data_) == 0) {
         /* Obtain a list of active thread ids from the target (OS)
          * this query works iteratively:
@@ -189,7 +271,15 @@ void GdbCommands::handleQuery() {
          * reply m<id>,<id>,... a comma-separated list of thread ids
          * reply l 	            denotes end of list.
          */
-        sendPacket("m1");
+        char tstr[16];
+        packet_data_[0] = 'm';
+        packet_len_ = 1;
+        for (int i = 0; i < hartTotal(); i++) {
+            RISCV_sprintf(tstr, sizeof(tstr), i ? ",%x" : "%x", i + 1);
+            memcpy(&packet_data_[packet_len_], tstr, strlen(tstr));
+            packet_len_ += static_cast<int>(strlen(tstr));
+        }
+        sendPacket(packet_data_, packet_len_);
     } else if (strcmp("qsThreadInfo", packet_data_) == 0) {
         /* Return info about more active threads.
          * We have no more, so return the end of list marker, 'l' */
@@ -213,46 +303,92 @@ void GdbCommands::handleQuery() {
     } else if (strncmp("qSupported", 
                         packet_data_, strlen("qSupported")) == 0) {
         /* Report a list of the features we support.
-         * 1000h == 4096
-         * 500h  == 1280 */
-        sendPacket("PacketSize=500;QStartNoAckMode+;vContSupported+");
-        //QNonStop+
+         * PacketSize is a hex value of RSP_PACKET_SIZE */
+        char tstr[128];
+        RISCV_sprintf(tstr, sizeof(tstr),
+                      "PacketSize=%x;QStartNoAckMode+;QNonStop+;"
+                      "qXfer:memory-map:read+;vContSupported+",
+                      RSP_PACKET_SIZE);
+        sendPacket(tstr);
     } else if (strncmp("qSymbol:", packet_data_, strlen("qSymbol:")) == 0) {
         /* Offer to look up symbols. Ignore for now */
         sendPacket("OK");
     } else if (strncmp("qThreadExtraInfo,",
                        packet_data_, strlen("qThreadExtraInfo,")) == 0) {
-        /* Report that we are runnable */
-        char tstr[128] = "\0";
-        RISCV_sprintf (tstr, sizeof(tstr), "%02x%02x%02x%02x%02x%02x%02x%02x",
-             'R', 'u', 'n', 'n', 'a', 'b', 'l', 'e');
+        /* Report hart index and its state as a hex encoded string */
+        int hart = parseThreadId(&packet_data_[strlen("qThreadExtraInfo,")]);
+        if (hart < 0) {
+            sendPacket("E01");
+            return;
+        }
+        char info[64];
+        char tstr[128];
+        RISCV_sprintf(info, sizeof(info), "hart%d %s", hart,
+                      isHartHalted(hart) ? "halted" : "running");
+        for (int i = 0; info[i]; i++) {
+            RISCV_sprintf(&tstr[2*i], 3, "%02x", static_cast<uint8_t>(info[i]));
+        }
         sendPacket(tstr);
     } else if (strncmp("qTStatus", packet_data_, strlen("qTStatus")) == 0) {
         /* Don't support tracing, return empty packet. */
         sendPacket("");
+    } else if (strncmp("qXfer:memory-map:read::", packet_data_,
+                       strlen("qXfer:memory-map:read::")) == 0) {
+        handleMemoryMap();
     } else if (strncmp("qXfer:", packet_data_, strlen("qXfer:")) == 0) {
-        /* No 'qXfer' requests supported, return empty packet. */
+        /* Other 'qXfer' objects aren't supported, return empty packet. */
         sendPacket("");
     } else {
-        RISCV_error("Unrecognized RSP query: %s \n", packet_data_);
+        RISCV_error("Unrecognized RSP query: %s", packet_data_);
         sendPacket("");
     }
 }
 
 void GdbCommands::handleStopReasonQuery() {
-    sendPacket("S05");
+    if (!nonstop_) {
+        sendStopReply(hartstop_);
+        return;
+    }
+    // Non-stop: all stopped threads are reported via vStopped sequence
+    char tstr[64];
+    RISCV_mutex_lock(&mutexStop_);
+    stopQueue_.make_list(0);
+    for (int i = 0; i < hartTotal(); i++) {
+        if (isHartHalted(i) && !(running_ & (1ull << i))) {
+            AttributeType item;
+            item.make_int64(i);
+            stopQueue_.add_to_list(&item);
+        }
+    }
+    if (stopQueue_.size() == 0) {
+        sendPacket("OK");
+    } else {
+        formatStopReply(stopQueue_[0u].to_int(), tstr, sizeof(tstr));
+        sendPacket(tstr);
+    }
+    RISCV_mutex_unlock(&mutexStop_);
 }
 
-void GdbCommands::handleContinue() {
-    AttributeType res;
-    if (!iexec_) {
-        sendPacket("E01");
-        return;
+void GdbCommands::handleStopped() {
+    char tstr[64];
+    RISCV_mutex_lock(&mutexStop_);
+    if (stopQueue_.size()) {
+        stopQueue_.remove_from_list(0);
     }
-    RISCV_event_clear(&eventHalt_);
-    iexec_->exec("run", &res, false);
-    RISCV_event_wait(&eventHalt_);
-    sendPacket("S05");
+    if (stopQueue_.size() == 0) {
+        sendPacket("OK");
+    } else {
+        formatStopReply(stopQueue_[0u].to_int(), tstr, sizeof(tstr));
+        sendPacket(tstr);
+    }
+    RISCV_mutex_unlock(&mutexStop_);
+}
+
+void GdbCommands::handleContinue() {
+    uint64_t mask = hartc_ < 0 ? ~0ull >> (64 - hartTotal())
+                               : 1ull << hartc_;
+    resumeHarts(mask, 0);
+    allStop(waitHalt(mask));
 }
 
 void GdbCommands::handleDetach() {
@@ -260,62 +396,95 @@ void GdbCommands::handleDetach() {
     sendPacket("OK");
 }
 
-void GdbCommands::appendRegValue(char *s, uint32_t value) {
-    char byte_hex[3];
+void GdbCommands::handleGetRegisters() {
+    char resp[1024];
+    DebugPortTransactionType trans[RISCV_GDB_REGS];
+    int total = isArm_ ? ARM_GDB_REGS : RISCV_GDB_REGS;
+    int bytes;
+    int cnt = 0;
+    uint16_t addr;
 
-    RISCV_sprintf(byte_hex, 3, "%02X", value & 0xFF);
-    strncat(s, byte_hex, 2);
-    RISCV_sprintf(byte_hex, 3, "%02X", (value >> 8) & 0xFF);
-    strncat(s, byte_hex, 2);
-    RISCV_sprintf(byte_hex, 3, "%02X", (value >> 16) & 0xFF);
-    strncat(s, byte_hex, 2);
-    RISCV_sprintf(byte_hex, 3, "%02X", (value >> 24) & 0xFF);
-    strncat(s, byte_hex, 2);
-}
+    // Whole register set is read in one debug port transaction
+    for (int i = 0; i < total; i++) {
+        bytes = regLocation(i, &addr);
+        if (bytes == 0 || addr == DPORT_NONE) {
+            continue;
+        }
+        trans[cnt].write = 0;
+        trans[cnt].addr = addr;
+        trans[cnt].bytes = 8;
+        trans[cnt].rdata = 0;
+        cnt++;
+    }
+    transportDport(hartg_, trans, cnt);
 
-void GdbCommands::handleGetRegisters() {
-    char resp[512] = "\0";
-    AttributeType res;
-
-    if (iexec_) {
-        iexec_->exec("regs", &res, false);
-    }
-    appendRegValue(resp, res["r0"].to_uint32());
-    appendRegValue(resp, res["r1"].to_uint32());
-    appendRegValue(resp, res["r2"].to_uint32());
-    appendRegValue(resp, res["r3"].to_uint32());
-    appendRegValue(resp, res["r4"].to_uint32());
-    appendRegValue(resp, res["r5"].to_uint32());
-    appendRegValue(resp, res["r6"].to_uint32());
-    appendRegValue(resp, res["r7"].to_uint32());
-    appendRegValue(resp, res["r8"].to_uint32());
-    appendRegValue(resp, res["r9"].to_uint32());
-    appendRegValue(resp, res["r10"].to_uint32());
-    appendRegValue(resp, res["r11"].to_uint32());
-    appendRegValue(resp, res["fp"].to_uint32());
-    appendRegValue(resp, res["sp"].to_uint32());
-    appendRegValue(resp, res["lr"].to_uint32());
-    appendRegValue(resp, res["pc"].to_uint32());
-    strncat(resp, "xxxxxxxxxxxxxxxxxxxxxxxxx", 96 / 8 * 2);  // f0
-    strncat(resp, "xxxxxxxxxxxxxxxxxxxxxxxxx", 96 / 8 * 2);
-    strncat(resp, "xxxxxxxxxxxxxxxxxxxxxxxxx", 96 / 8 * 2);
-    strncat(resp, "xxxxxxxxxxxxxxxxxxxxxxxxx", 96 / 8 * 2);
-    strncat(resp, "xxxxxxxxxxxxxxxxxxxxxxxxx", 96 / 8 * 2);
-    strncat(resp, "xxxxxxxxxxxxxxxxxxxxxxxxx", 96 / 8 * 2);
-    strncat(resp, "xxxxxxxxxxxxxxxxxxxxxxxxx", 96 / 8 * 2);
-    strncat(resp, "xxxxxxxxxxxxxxxxxxxxxxxxx", 96 / 8 * 2);  // f7
-    strncat(resp, "xxxxxxxxxxxxxxxxxxxxxxxxx", 32 / 8 * 2);  // fps
-    appendRegValue(resp, res["cpsr"].to_uint32());
-    sendPacket(resp);
+    int n = 0;
+    cnt = 0;
+    for (int i = 0; i < total; i++) {
+        bytes = regLocation(i, &addr);
+        if (bytes == 0) {
+            continue;
+        }
+        if (addr == DPORT_NONE) {
+            memset(&resp[cnt], 'x', 2 * bytes);
+            cnt += 2 * bytes;
+        } else {
+            cnt += formatRegister(trans[n++].rdata, bytes, &resp[cnt]);
+        }
+    }
+    sendPacket(resp, cnt);
 }
 
 void GdbCommands::handleSetRegisters() {
-    sendPacket("");
+    /* Syntax is: G<XX...> registers in the same order as in 'g' reply */
+    const char *p = &packet_data_[1];
+    const char *pend = &packet_data_[packet_len_];
+    DebugPortTransactionType trans[RISCV_GDB_REGS];
+    int total = isArm_ ? ARM_GDB_REGS : RISCV_GDB_REGS;
+    int cnt = 0;
+    uint16_t addr;
+    uint64_t val;
+    int bytes;
+    for (int i = 0; i < total; i++) {
+        bytes = regLocation(i, &addr);
+        if (p + 2 * bytes > pend) {
+            break;
+        }
+        val = 0;
+        for (int n = 0; n < bytes; n++) {
+            int hi = hex2nibble(p[2*n]);
+            int lo = hex2nibble(p[2*n + 1]);
+            val |= static_cast<uint64_t>((hi << 4) | lo) << (8 * n);
+            if (hi < 0 || lo < 0) {
+                addr = DPORT_NONE;
+            }
+        }
+        if (addr != DPORT_NONE) {
+            trans[cnt].write = 1;
+            trans[cnt].addr = addr;
+            trans[cnt].bytes = 8;
+            trans[cnt].wdata = val;
+            cnt++;
+        }
+        p += 2 * bytes;
+    }
+    transportDport(hartg_, trans, cnt);
+    sendPacket("OK");
 }
 
 void GdbCommands::handleSetThread() {
-    /* Set the thread number of subsequent operations. For now ignore
-       silently and just reply "OK" */
+    /* Syntax is: H<op><thread-id>
+     * 'g' selects thread for registers access, 'c' for step and continue */
+    int hart = parseThreadId(&packet_data_[2]);
+    if (hart == -2) {
+        sendPacket("E01");
+        return;
+    }
+    if (packet_data_[1] == 'g') {
+        hartg_ = hart < 0 ? hartstop_ : hart;
+    } else if (packet_data_[1] == 'c') {
+        hartc_ = hart;
+    }
     sendPacket("OK");
 }
 
@@ -330,40 +499,70 @@ void GdbCommands::handleGetMemory() {
      * Lowest address first, encoded as pairs of hex digits.
      * The length given is the number of bytes to be read.
      */
+    static const char HEX[] = "0123456789abcdef";
     unsigned long address;
     int len;
-    if (RISCV_sscanf(packet_data_, "m%lx,%x:", &address, &len) != 2) {
+    if (RISCV_sscanf(packet_data_, "m%lx,%x:", &address, &len) != 2
+        || len < 0 || len > RSP_PACKET_SIZE / 2) {
         RISCV_info("Failed to recognize RSP read memory command: %s",
                     packet_data_);
         sendPacket("E01");
         return;
     }
 
-    AttributeType res;
-    char tstr[256];
-    RISCV_sprintf(tstr, sizeof(tstr), "read 0x%lx %d", address, len);
-
-    if (iexec_) {
-        iexec_->exec(tstr, &res, false);
+    // Hex string is build in place from the end of the raw data
+    uint8_t *bts = reinterpret_cast<uint8_t *>(packet_data_);
+    if (!itap_ || itap_->read(address, len, bts) == TAP_ERROR) {
+        sendPacket("E01");
+        return;
     }
-
-    uint8_t *bts = res.data();
-    tstr[0] = 0;
-    for (size_t offset = 0; offset < res.size(); offset++) {
-        char byte_hex[3];
-        RISCV_sprintf(byte_hex, sizeof(byte_hex), "%02x", bts[offset]);
-        strncat(tstr, byte_hex, 2);
+    for (int i = len - 1; i >= 0; i--) {
+        uint8_t v = bts[i];
+        packet_data_[2*i] = HEX[v >> 4];
+        packet_data_[2*i + 1] = HEX[v & 0xf];
     }
-
-    sendPacket(tstr);
+    sendPacket(packet_data_, 2 * len);
 }
 
 void GdbCommands::handleWriteMemoryHex() {
-    sendPacket("");
+    /* Syntax is: M<addr>,<length>:<XX...> */
+    unsigned long address;
+    int len;
+    if (RISCV_sscanf(packet_data_, "M%lx,%x:", &address, &len) != 2) {
+        RISCV_info("Failed to recognize RSP write memory %s", packet_data_);
+        sendPacket("E01");
+        return;
+    }
+    char *data_ptr = static_cast<char *>(
+                    memchr(packet_data_, ':', packet_len_));
+    if (!data_ptr || 2 * len > packet_len_ - (data_ptr + 1 - packet_data_)) {
+        sendPacket("E01");
+        return;
+    }
+    data_ptr++;
+
+    // Decoded data overwrites the hex string, it is always shorter
+    uint8_t *bts = reinterpret_cast<uint8_t *>(packet_data_);
+    for (int i = 0; i < len; i++) {
+        int hi = hex2nibble(data_ptr[2*i]);
+        int lo = hex2nibble(data_ptr[2*i + 1]);
+        if (hi < 0 || lo < 0) {
+            sendPacket("E01");
+            return;
+        }
+        bts[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    if (len && (!itap_ || itap_->write(address, len, bts) == TAP_ERROR)) {
+        sendPacket("E01");
+        return;
+    }
+    sendPacket("OK");
 }
 
 void GdbCommands::handleReadRegister() {
     unsigned int regnum;
+    char resp[64];
+    int cnt;
 
     if (RISCV_sscanf(packet_data_, "p%x", &regnum) != 1) {
         RISCV_info("Failed to recognize RSP read register "
@@ -371,62 +570,46 @@ void GdbCommands::handleReadRegister() {
         sendPacket("E01");
         return;
     }
-
-    AttributeType res;
-    if (iexec_) {
-        iexec_->exec("regs", &res, false);
+    cnt = appendRegister(hartg_, static_cast<int>(regnum), resp);
+    if (cnt == 0) {
+        sendPacket("E01");
+        return;
     }
-
-    char resp[256] = "\0";
-    appendRegValue(resp, res.dict_value(regnum)->to_uint32());
-    sendPacket(resp);
+    sendPacket(resp, cnt);
 }
 
 void GdbCommands::handleWriteRegister() {
-    unsigned       regnum;            /* Register index */
-    char           byte0[3];  /* Data to set */
-    char           byte1[3];
-    char           byte2[3];
-    char           byte3[3];
-
-    if (RISCV_sscanf(packet_data_, "P%x=%2s%2s%2s%2s",
-               &regnum, byte0, byte1, byte2, byte3) != 5) {
+    /* Syntax is: P<n>=<XX...> little-endian value */
+    unsigned int regnum;
+    uint16_t addr;
+    uint64_t val = 0;
+    int bytes;
+
+    if (RISCV_sscanf(packet_data_, "P%x=", &regnum) != 1) {
         RISCV_info("Failed to recognize RSP write register "
                    "command: %s", packet_data_);
         sendPacket("E01");
         return;
     }
-
-    AttributeType res;
-    char tstr[256];
-
-    /** Hardcode for ARM only */
-    char regname[10] = "\0";
-    if (regnum < 12) {
-        RISCV_sprintf(regname, sizeof(regname), "r%d", regnum);
-    } else if (regnum == 12) {
-        RISCV_sprintf(regname, sizeof(regname), "fp");
-    } else if (regnum == 13) {
-        RISCV_sprintf(regname, sizeof(regname), "sp");
-    } else if (regnum == 14) {
-        RISCV_sprintf(regname, sizeof(regname), "lr");
-    } else if (regnum == 15) {
-        RISCV_sprintf(regname, sizeof(regname), "pc");
-    } else if (regnum == 26) {
-        RISCV_sprintf(regname, sizeof(regname), "cpsr");
-    } else {
-        RISCV_info("Failed to recognize register: %d", regnum);
+    const char *p = static_cast<char *>(memchr(packet_data_, '=',
+                                               packet_len_));
+    bytes = regLocation(static_cast<int>(regnum), &addr);
+    if (!p || bytes == 0 || addr == DPORT_NONE
+        || static_cast<int>(strlen(p + 1)) < 2 * bytes) {
         sendPacket("E01");
         return;
     }
-
-    RISCV_sprintf(tstr, sizeof(tstr), "reg %s 0x%s%s%s%s",
-                  regname, byte3, byte2, byte1, byte0);
-    RISCV_info("command: %s", tstr);
-
-    if (iexec_) {
-        iexec_->exec(tstr, &res, false);
+    p++;
+    for (int n = 0; n < bytes; n++) {
+        int hi = hex2nibble(p[2*n]);
+        int lo = hex2nibble(p[2*n + 1]);
+        if (hi < 0 || lo < 0) {
+            sendPacket("E01");
+            return;
+        }
+        val |= static_cast<uint64_t>((hi << 4) | lo) << (8 * n);
     }
+    writeDport(hartg_, addr, val);
     sendPacket("OK");
 }
 
@@ -434,78 +617,313 @@ void GdbCommands::handleGeneralSet() {
     if (strncmp("QStartNoAckMode",
         packet_data_, strlen("QStartNoAckMode")) == 0) {
         estate_ = State_WaitAckToSwitch;
+    } else if (strcmp("QNonStop:1", packet_data_) == 0) {
+        nonstop_ = true;
+    } else if (strcmp("QNonStop:0", packet_data_) == 0) {
+        nonstop_ = false;
     }
     sendPacket("OK");
 }
 
 void GdbCommands::handleStep() {
-    sendPacket("");
+    int hart = hartc_ >= 0 ? hartc_ : hartg_;
+    resumeHarts(0, 1ull << hart);
+    allStop(waitHalt(1ull << hart));
 }
 
 void GdbCommands::handleThreadAlive() {
+    if (parseThreadId(&packet_data_[1]) < 0) {
+        sendPacket("E01");
+        return;
+    }
     sendPacket("OK");
 }
 
 void GdbCommands::handleVCommand() {
     if (strcmp("vMustReplyEmpty", packet_data_) == 0) {
         sendPacket("");
-    } else if (strncmp(packet_data_, "vCont", 5) == 0) {
-        const char *packet_ptr = packet_data_;
-        packet_ptr += 5;
-        if (*packet_ptr == '?') {
-            sendPacket("vCont;c;C");
-            return;
+    } else if (strcmp("vStopped", packet_data_) == 0) {
+        handleStopped();
+    } else if (strcmp("vCont?", packet_data_) == 0) {
+        sendPacket("vCont;c;C;s;S;t;r");
+    } else if (strncmp(packet_data_, "vCont;", 6) == 0) {
+        /* Syntax is: vCont[;action[:thread-id]]...
+         * The leftmost action applies to the thread if several match. */
+        uint64_t runmask = 0;
+        uint64_t stepmask = 0;
+        uint64_t stopmask = 0;
+        uint64_t assigned = 0;
+        uint64_t mask;
+        unsigned long rstart = 0, rend = 0;
+        int rhart = -1;
+        int hart;
+        const char *p = &packet_data_[5];
+        while (p && *p == ';') {
+            p++;
+            const char *ptid = strchr(p, ':');
+            const char *pnext = strchr(p, ';');
+            if (ptid && (!pnext || ptid < pnext)) {
+                hart = parseThreadId(ptid + 1);
+                if (hart == -2) {
+                    sendPacket("E01");
+                    return;
+                }
+            } else {
+                hart = -1;
+            }
+            mask = hart < 0 ? ~0ull >> (64 - hartTotal()) : 1ull << hart;
+            mask &= ~assigned;
+            assigned |= mask;
+            switch (*p) {
+            case 'c':
+            case 'C':
+                runmask |= mask;
+                break;
+            case 's':
+            case 'S':
+                stepmask |= mask;
+                break;
+            case 't':
+                stopmask |= mask;
+                break;
+            case 'r':
+                if (RISCV_sscanf(p, "r%lx,%lx", &rstart, &rend) != 2
+                    || hart < 0) {
+                    sendPacket("E01");
+                    return;
+                }
+                if (nonstop_) {
+                    // Range is checked by GDB after each step
+                    stepmask |= mask;
+                } else if (mask) {
+                    rhart = hart;
+                }
+                break;
+            default:
+                sendPacket("E01");
+                return;
+            }
+            p = pnext;
         }
-        if (*packet_ptr == ';') {
-            packet_ptr++;
-        }
-        if (*packet_ptr == 'c') {
-            RISCV_info("Continue packet: %s", packet_data_);
-            handleContinue();
+
+        if (nonstop_) {
+            RISCV_mutex_lock(&mutexStop_);
+            interrupted_ |= stopmask;
+            running_ |= runmask | stepmask | stopmask;
+            RISCV_mutex_unlock(&mutexStop_);
+            resumeHarts(runmask, stepmask);
+            for (int i = 0; i < hartTotal(); i++) {
+                if ((stopmask >> i) & 0x1) {
+                    if (isHartHalted(i)) {
+                        hapTriggered(HAP_Halt, i, "Already stopped");
+                    } else {
+                        haltHarts(1ull << i);
+                    }
+                }
+            }
+            sendPacket("OK");
+            return;
         }
-        if (*packet_ptr == 's') {
-            AttributeType res;
-            RISCV_info("Step packet: %s", packet_data_);
-            iexec_->exec("c 1", &res, false);
-            sendPacket("S05");
+
+        resumeHarts(runmask, stepmask);
+        if (rhart >= 0) {
+            hart = rangeStep(rhart, rstart, rend, runmask | stepmask);
+            allStop(hart);
+        } else if (runmask | stepmask) {
+            allStop(waitHalt(runmask | stepmask));
+        } else {
+            sendStopReply(hartstop_);
         }
+    } else {
+        sendPacket("");
     }
 }
 
 void GdbCommands::handleWriteMemory() {
-    size_t         len;             /* Number of bytes to write */
-    unsigned long  address;         /* Where to write the memory */
-    const char     *data_ptr;       /* Pointer to the binary data */
-
-    if (RISCV_sscanf(packet_data_, "X%lx,%lx:", &address, &len) != 2) {
+    /* Syntax is: X<addr>,<length>:<binary data>
+     * Symbols '#', '$', '}' and '*' are escaped by '}' and xor with 0x20.
+     * Zero length packet is used by GDB to probe support of this command.
+     */
+    unsigned long address;
+    int len;
+    if (RISCV_sscanf(packet_data_, "X%lx,%x:", &address, &len) != 2) {
         RISCV_info("Failed to recognize RSP write memory %s",
                    packet_data_);
         sendPacket("E01");
         return;
     }
-
-    data_ptr = static_cast<char*>(memchr(packet_data_, ':', DATA_MAX));
+    char *data_ptr = static_cast<char *>(
+                    memchr(packet_data_, ':', packet_len_));
+    if (!data_ptr) {
+        sendPacket("E01");
+        return;
+    }
     data_ptr++;
-    char data_hex[2 * DATA_MAX + 1];
-    data_hex[0] = '\0';
 
-    for (size_t offset = 0; offset < len; offset++) {
-        char byte_hex[3];
-        RISCV_sprintf(byte_hex, sizeof(byte_hex), "%02x", data_ptr[offset]);
-        strncat(data_hex, byte_hex, 2);
+    // Unescaped data overwrites the packet, it is never longer
+    uint8_t *bts = reinterpret_cast<uint8_t *>(packet_data_);
+    const char *pend = &packet_data_[packet_len_];
+    int cnt = 0;
+    while (data_ptr < pend && cnt < len) {
+        if (*data_ptr == '}' && data_ptr + 1 < pend) {
+            data_ptr++;
+            bts[cnt++] = static_cast<uint8_t>(*data_ptr ^ 0x20);
+        } else {
+            bts[cnt++] = static_cast<uint8_t>(*data_ptr);
+        }
+        data_ptr++;
+    }
+    if (cnt != len) {
+        RISCV_info("RSP write memory: %d bytes of %d", cnt, len);
+        sendPacket("E01");
+        return;
+    }
+    if (len && (!itap_ || itap_->write(address, len, bts) == TAP_ERROR)) {
+        sendPacket("E01");
+        return;
+    }
+    sendPacket("OK");
+}
+
+void GdbCommands::handleCrc() {
+    /* Syntax is: qCRC:<addr>,<length>
+     * Reply 'C<crc32>' computed over target memory */
+    unsigned long address;
+    unsigned long len;
+    if (RISCV_sscanf(packet_data_, "qCRC:%lx,%lx", &address, &len) != 2) {
+        sendPacket("E01");
+        return;
+    }
+    uint8_t *bts = reinterpret_cast<uint8_t *>(packet_data_);
+    uint32_t crc = 0xffffffff;
+    int sz;
+    while (len) {
+        sz = len < CRC_CHUNK_SIZE ? static_cast<int>(len) : CRC_CHUNK_SIZE;
+        if (!itap_ || itap_->read(address, sz, bts) == TAP_ERROR) {
+            sendPacket("E01");
+            return;
+        }
+        crc = gdb_crc32(bts, sz, crc);
+        address += sz;
+        len -= sz;
+    }
+    char tstr[16];
+    RISCV_sprintf(tstr, sizeof(tstr), "C%08x", crc);
+    sendPacket(tstr);
+}
+
+void GdbCommands::handleMemoryMap() {
+    /* Syntax is: qXfer:memory-map:read::<offset>,<length>
+     * Reply 'm<data>' if more data follows or 'l<data>' for the last part */
+    unsigned long off, len;
+    if (RISCV_sscanf(packet_data_, "qXfer:memory-map:read::%lx,%lx",
+                     &off, &len) != 2) {
+        sendPacket("E00");
+        return;
+    }
+    if (off == 0 || memmap_.size() == 0) {
+        buildMemoryMap();
+    }
+    if (memmap_.size() == 0) {
+        sendPacket("E01");
+        return;
+    }
+    unsigned long total = static_cast<unsigned long>(memmap_.size());
+    if (off > total) {
+        sendPacket("E01");
+        return;
+    }
+    if (len > total - off) {
+        len = total - off;
     }
+    if (len > RSP_PACKET_SIZE - 1) {
+        len = RSP_PACKET_SIZE - 1;
+    }
+    packet_data_[0] = (off + len) < total ? 'm' : 'l';
+    memcpy(&packet_data_[1], &memmap_.getBuffer()[off], len);
+    sendPacket(packet_data_, static_cast<int>(len) + 1);
+}
 
-    AttributeType res;
-    // 32 should be enough for 'write 0x000000 9999 '
-    char tstr[DATA_MAX * 2 + 32];
-    RISCV_sprintf(tstr, sizeof(tstr), "write 0x%lx %lu 0x%s",
-                  address, len, data_hex);
+/**
+ * Document is built from the slave devices list of the CPU's system bus.
+ * Overlapped regions are skipped because GDB rejects such map entirely.
+ */
+void GdbCommands::buildMemoryMap() {
+    memmap_.clear();
+    IService *icpu = static_cast<IService *>(
+                        RISCV_get_service(cpu_.to_string()));
+    AttributeType *sysbus = 0;
+    if (icpu) {
+        sysbus = static_cast<AttributeType *>(icpu->getAttribute("SysBus"));
+    }
+    if (!sysbus || !sysbus->is_string()) {
+        return;
+    }
+    IService *ibus = static_cast<IService *>(
+                        RISCV_get_service(sysbus->to_string()));
+    AttributeType *maplist = 0;
+    if (ibus) {
+        maplist = static_cast<AttributeType *>(ibus->getAttribute("MapList"));
+    }
+    if (!maplist || !maplist->is_list()) {
+        return;
+    }
 
-    if (iexec_) {
-        iexec_->exec(tstr, &res, false);
+    // [[base, length, readonly], ...] sorted by base address
+    AttributeType regions;
+    regions.make_list(0);
+    for (unsigned i = 0; i < maplist->size(); i++) {
+        const AttributeType &dev = (*maplist)[i];
+        IMemoryOperation *imem = 0;
+        const char *devname = 0;
+        if (dev.is_string()) {
+            devname = dev.to_string();
+            imem = static_cast<IMemoryOperation *>(RISCV_get_service_iface(
+                    devname, IFACE_MEMORY_OPERATION));
+        } else if (dev.is_list() && dev.size() == 2) {
+            devname = dev[0u].to_string();
+            imem = static_cast<IMemoryOperation *>(
+                RISCV_get_service_port_iface(devname, dev[1].to_string(),
+                                             IFACE_MEMORY_OPERATION));
+        }
+        if (!imem || imem->getLength() == 0) {
+            continue;
+        }
+        IService *idev = static_cast<IService *>(RISCV_get_service(devname));
+        AttributeType *rdonly = 0;
+        if (idev) {
+            rdonly = static_cast<AttributeType *>(
+                        idev->getAttribute("ReadOnly"));
+        }
+        AttributeType item;
+        item.make_list(3);
+        item[0u].make_uint64(imem->getBaseAddress());
+        item[1].make_uint64(imem->getLength());
+        item[2].make_boolean(rdonly && rdonly->is_bool() && rdonly->to_bool());
+        regions.add_to_list(&item);
     }
+    regions.sort(0);
 
-    sendPacket("OK");
+    memmap_.write_string("<?xml version=\"1.0\"?>\n"
+        "<!DOCTYPE memory-map PUBLIC \"+//IDN gnu.org//DTD GDB Memory Map "
+        "V1.0//EN\" \"http://sourceware.org/gdb/gdb-memory-map.dtd\">\n"
+        "<memory-map>\n");
+    uint64_t next_free = 0;
+    for (unsigned i = 0; i < regions.size(); i++) {
+        uint64_t base = regions[i][0u].to_uint64();
+        if (i && base < next_free) {
+            continue;
+        }
+        next_free = base + regions[i][1].to_uint64();
+        memmap_.write_string("  <memory type=\"");
+        memmap_.write_string(regions[i][2].to_bool() ? "rom" : "ram");
+        memmap_.write_string("\" start=\"");
+        memmap_.write_uint64(base);
+        memmap_.write_string("\" length=\"");
+        memmap_.write_uint64(regions[i][1].to_uint64());
+        memmap_.write_string("\"/>\n");
+    }
+    memmap_.write_string("</memory-map>\n");
 }
 
 void GdbCommands::handleBreakpoint() {
@@ -544,8 +962,375 @@ void GdbCommands::handleBreakpoint() {
     }
 }
 
+int GdbCommands::hartTotal() {
+    if (!idsu_) {
+        return 1;
+    }
+    unsigned total = idsu_->getCpuTotal();
+    return total > 64 ? 64 : static_cast<int>(total);
+}
+
+/** Without DSU service the context hart is accessed via TAP */
+bool GdbCommands::isHartHalted(int hart) {
+    if (idsu_) {
+        return idsu_->isCpuHalted(hart);
+    }
+    Reg64Type t;
+    t.val = 0;
+    if (itap_) {
+        itap_->read(DSUREGBASE(ulocal.v.haltsum0), 8, t.buf);
+    }
+    return ((t.val >> hart) & 0x1) != 0;
+}
+
+uint64_t GdbCommands::readDport(int hart, uint16_t addr) {
+    if (idsu_) {
+        return idsu_->nb_debug_read(hart, addr);
+    }
+    Reg64Type t;
+    t.val = 0;
+    if (itap_) {
+        itap_->read(DSU_OFFSET + (static_cast<uint64_t>(addr) << 3), 8, t.buf);
+    }
+    return t.val;
+}
+
+void GdbCommands::writeDport(int hart, uint16_t addr, uint64_t val) {
+    if (idsu_) {
+        idsu_->nb_debug_write(hart, addr, val);
+        return;
+    }
+    Reg64Type t;
+    t.val = val;
+    if (itap_) {
+        itap_->write(DSU_OFFSET + (static_cast<uint64_t>(addr) << 3), 8, t.buf);
+    }
+}
+
+/**
+ * Many reads and writes in one request: single handshake with the CPU
+ * thread in simulation, vectored TAP access otherwise.
+ */
+void GdbCommands::transportDport(int hart, DebugPortTransactionType *trans,
+                                 int cnt) {
+    if (idsu_) {
+        idsu_->nb_debug_vector(hart, trans, cnt);
+        return;
+    }
+    uint64_t addr[RISCV_GDB_REGS];
+    uint64_t data[RISCV_GDB_REGS];
+    int n;
+    for (int i = 0; i < cnt; i += n) {
+        // Requests of the same direction are merged
+        n = 0;
+        while (i + n < cnt && n < RISCV_GDB_REGS
+            && trans[i + n].write == trans[i].write) {
+            addr[n] = DSU_OFFSET
+                    + (static_cast<uint64_t>(trans[i + n].addr) << 3);
+            data[n] = trans[i + n].wdata;
+            n++;
+        }
+        if (!itap_) {
+            memset(data, 0, sizeof(data));
+        } else if (trans[i].write) {
+            itap_->writeRegs(addr, n, data);
+        } else {
+            itap_->readRegs(addr, n, data);
+        }
+        for (int k = 0; k < n; k++) {
+            trans[i + k].rdata = data[k];
+        }
+    }
+}
+
+/**
+ * GDB register number to debug port address. Returns register size in
+ * bytes or 0 if there's no such register.
+ *      RISC-V: x0..x31, pc, f0..f31, then CSRs 65 + csr index
+ *      ARM:    r0..r14, pc, f0..f7 and fps (unavailable), cpsr
+ */
+int GdbCommands::regLocation(int regnum, uint16_t *addr) {
+    if (isArm_) {
+        if (regnum < 15) {
+            *addr = dport_ireg(regnum);
+        } else if (regnum == 15) {
+            *addr = CSR_dpc;
+        } else if (regnum < 24) {
+            *addr = DPORT_NONE;
+            return 12;
+        } else if (regnum == 24) {
+            *addr = DPORT_NONE;
+        } else if (regnum == 25) {
+            *addr = dport_ireg(16);
+        } else {
+            return 0;
+        }
+        return 4;
+    }
+    if (regnum < 32) {
+        *addr = dport_ireg(regnum);
+    } else if (regnum == 32) {
+        *addr = CSR_dpc;
+    } else if (regnum < 65) {
+        *addr = dport_freg(regnum - 33);
+    } else if (regnum < 65 + 4096) {
+        *addr = static_cast<uint16_t>(regnum - 65);
+    } else {
+        return 0;
+    }
+    return 8;
+}
+
+int GdbCommands::appendRegister(int hart, int regnum, char *s) {
+    uint16_t addr;
+    int bytes = regLocation(regnum, &addr);
+    if (bytes == 0) {
+        return 0;
+    }
+    if (addr == DPORT_NONE) {
+        memset(s, 'x', 2 * bytes);
+        return 2 * bytes;
+    }
+    return formatRegister(readDport(hart, addr), bytes, s);
+}
+
+/** Target byte order hex string */
+int GdbCommands::formatRegister(uint64_t val, int bytes, char *s) {
+    static const char HEX[] = "0123456789abcdef";
+    for (int i = 0; i < bytes; i++) {
+        s[2*i] = HEX[(val >> (8*i + 4)) & 0xf];
+        s[2*i + 1] = HEX[(val >> (8*i)) & 0xf];
+    }
+    return 2 * bytes;
+}
+
+/**
+ * Returns hart index, -1 for all/any threads or -2 on error.
+ */
+int GdbCommands::parseThreadId(const char *s) {
+    unsigned long tid;
+    if (s[0] == '-' && s[1] == '1') {
+        return -1;
+    }
+    if (RISCV_sscanf(s, "%lx", &tid) != 1) {
+        return -2;
+    }
+    if (tid == 0) {
+        return -1;
+    }
+    if (tid > static_cast<unsigned long>(hartTotal())) {
+        return -2;
+    }
+    return static_cast<int>(tid - 1);
+}
+
+bool GdbCommands::isBreakpoint(uint64_t addr) {
+    for (unsigned i = 0; i < brList_.size(); i++) {
+        const AttributeType &br = brList_[i];
+        if (!(br[BrkList_flags].to_uint64() & BreakFlag_HW)
+            && br[BrkList_address].to_uint64() == addr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GdbCommands::writeBreakpoints() {
+    Reg64Type data;
+    uint64_t addr;
+    for (unsigned i = 0; i < brList_.size(); i++) {
+        const AttributeType &br = brList_[i];
+        if (br[BrkList_flags].to_uint64() & BreakFlag_HW) {
+            continue;
+        }
+        addr = br[BrkList_address].to_uint64();
+        data.val = br[BrkList_opcode].to_uint32();
+        itap_->write(addr, br[BrkList_oplen].to_int(), data.buf);
+        // Memory is shared, I-cache is flushed in every hart
+        for (int n = 0; n < hartTotal(); n++) {
+            writeDport(n, CSR_flushi, addr);
+        }
+    }
+}
+
+void GdbCommands::removeBreakpoints() {
+    Reg64Type data;
+    for (unsigned i = 0; i < brList_.size(); i++) {
+        const AttributeType &br = brList_[i];
+        if (br[BrkList_flags].to_uint64() & BreakFlag_HW) {
+            continue;
+        }
+        data.val = br[BrkList_instr].to_uint32();
+        itap_->write(br[BrkList_address].to_uint64(),
+                     br[BrkList_oplen].to_int(), data.buf);
+    }
+}
+
+void GdbCommands::resumeHart(int hart, int steps) {
+    CrGenericRuncontrolType runctrl;
+    CrGenericDebugControlType dcsr;
+    if (steps) {
+        writeDport(hart, CSR_insperstep, steps);
+        dcsr.val = 0;
+        dcsr.bits.step = 1;
+        dcsr.bits.ebreakm = 1;
+        writeDport(hart, CSR_dcsr, dcsr.val);
+    }
+    runctrl.val = 0;
+    runctrl.bits.req_resume = 1;
+    writeDport(hart, CSR_runcontrol, runctrl.val);
+}
+
+/**
+ * The same sequence as 'run' command but applied to the set of harts.
+ * Hart standing on a software breakpoint makes a step before breakpoints
+ * are written into memory.
+ */
+void GdbCommands::resumeHarts(uint64_t runmask, uint64_t stepmask) {
+    uint64_t mask = runmask | stepmask;
+    if (!mask || !itap_) {
+        return;
+    }
+    brList_.make_list(0);
+    if (isrc_) {
+        isrc_->getBreakpointList(&brList_);
+    }
+    for (int i = 0; i < hartTotal(); i++) {
+        if (!((mask >> i) & 0x1) || !isHartHalted(i)) {
+            continue;
+        }
+        if (isBreakpoint(readDport(i, CSR_dpc))) {
+            resumeHart(i, 1);
+            waitHalt(1ull << i);
+            stepmask &= ~(1ull << i);
+        }
+    }
+    writeBreakpoints();
+
+    for (int i = 0; i < hartTotal(); i++) {
+        if ((runmask >> i) & 0x1) {
+            resumeHart(i, 0);
+        } else if ((stepmask >> i) & 0x1) {
+            resumeHart(i, 1);
+        }
+    }
+    RISCV_trigger_hap(HAP_Resume, mask, "GDB resume");
+}
+
+void GdbCommands::haltHarts(uint64_t mask) {
+    CrGenericRuncontrolType runctrl;
+    runctrl.val = 0;
+    runctrl.bits.req_halt = 1;
+    for (int i = 0; i < hartTotal(); i++) {
+        if (((mask >> i) & 0x1) && !isHartHalted(i)) {
+            writeDport(i, CSR_runcontrol, runctrl.val);
+        }
+    }
+}
+
+/** Returns index of the halted hart from the mask or -1 if mask is empty */
+int GdbCommands::waitHalt(uint64_t mask) {
+    if (mask == 0) {
+        return -1;
+    }
+    for (int cnt = 0; ; cnt++) {
+        for (int i = 0; i < hartTotal(); i++) {
+            if (((mask >> i) & 0x1) && isHartHalted(i)) {
+                return i;
+            }
+        }
+        if (cnt < HALT_SPIN_MAX) {
+            RISCV_sleep_ms(0);
+        } else {
+            RISCV_event_wait_ms(&eventHalt_, HALT_POLL_MS);
+            RISCV_event_clear(&eventHalt_);
+        }
+    }
+    return -1;
+}
+
+/**
+ * Range stepping: instructions are stepped inside of the simulator while
+ * the next pc stays in [start, end) without any round trip to GDB. Stops
+ * on a breakpoint or when any of the other resumed harts halts.
+ */
+int GdbCommands::rangeStep(int hart, uint64_t start, uint64_t end,
+                           uint64_t othermask) {
+    uint64_t npc;
+    int halted;
+    othermask &= ~(1ull << hart);
+    resumeHarts(0, 1ull << hart);
+    while (true) {
+        waitHalt(1ull << hart);
+        npc = readDport(hart, CSR_dpc);
+        if (npc < start || npc >= end || isBreakpoint(npc)) {
+            break;
+        }
+        for (halted = 0; halted < hartTotal(); halted++) {
+            if (((othermask >> halted) & 0x1) && isHartHalted(halted)) {
+                return halted;
+            }
+        }
+        resumeHart(hart, 1);
+    }
+    return hart;
+}
+
+/** All-stop mode: report the first halted hart and stop the rest */
+void GdbCommands::allStop(int hart) {
+    uint64_t mask = ~0ull >> (64 - hartTotal());
+    mask &= ~(1ull << hart);
+    haltHarts(mask);
+    for (int i = 0; i < hartTotal(); i++) {
+        if ((mask >> i) & 0x1) {
+            waitHalt(1ull << i);
+        }
+    }
+    if (itap_) {
+        removeBreakpoints();
+    }
+    sendStopReply(hart);
+}
+
+void GdbCommands::formatStopReply(int hart, char *s, int sz) {
+    int sig = 5;    // SIGTRAP
+    if (interrupted_ & (1ull << hart)) {
+        interrupted_ &= ~(1ull << hart);
+        sig = 0;
+    }
+    RISCV_sprintf(s, sz, "T%02xthread:%x;", sig, hart + 1);
+}
+
+void GdbCommands::sendStopReply(int hart) {
+    char tstr[64];
+    hartstop_ = hart;
+    hartg_ = hart;
+    formatStopReply(hart, tstr, sizeof(tstr));
+    sendPacket(tstr);
+}
+
+/** Asynchronous notification '%<data>#<checksum>' */
+void GdbCommands::sendNotification(const char *data) {
+    TcpClient *client = static_cast<TcpClient *>(parent_);
+    if (client->isClosed()) {
+        return;
+    }
+    char tstr[128];
+    RISCV_sprintf(tstr, sizeof(tstr), "%%%s#%02x",
+                  data, checksum(data, static_cast<int>(strlen(data))));
+    client->writeData(tstr, static_cast<int>(strlen(tstr)));
+}
+
 void GdbCommands::sendPacket(const char *data) {
-    int tsz = strlen(data);
+    sendPacket(data, static_cast<int>(strlen(data)));
+}
+
+void GdbCommands::sendPacket(const char *data, int tsz) {
+    if (tsz + 8 > resptotal_) {
+        delete [] respbuf_;
+        resptotal_ = tsz + 8;
+        respbuf_ = new char[resptotal_];
+    }
     respcnt_ = 0;
     if (estate_ != State_NoAckMode) {
         respbuf_[respcnt_++] = '+';
@@ -18,10 +18,14 @@
 #define __DEBUGGER_SERVICES_REMOTE_GDBCMD_H__
 
 #include "tcpcmd_gen.h"
+#include "coreservices/idsugen.h"
+#include <autobuffer.h>
 
 namespace debugger {
 
 static const int DATA_MAX = 4096;
+/** Negotiated via qSupported, doesn't include '$', '#' and checksum */
+static const int RSP_PACKET_SIZE = 0x8000;
 
 /*struct RspPacket {
     RspPacket() : size(0), is_good(false) {}
@@ -40,9 +44,21 @@ static const int DATA_MAX = 4096;
 };*/
 
 
+/**
+ * @brief GDB Remote Serial Protocol.
+ * @details Every hart of the DSU is reported as a thread with id equal to
+ *          hart index plus one. Registers are accessed via debug port of
+ *          the selected hart without switching the DSU context. All-stop
+ *          and non-stop modes are supported.
+ */
 class GdbCommands : public TcpCommandsGen {
  public:
     explicit GdbCommands(IService *parent);
+    virtual ~GdbCommands();
+
+    /** IHap */
+    virtual void hapTriggered(EHapType type, uint64_t param,
+                              const char *descr);
 
  protected:
     virtual int processCommand(const char *cmdbuf, int bufsz);
@@ -53,7 +69,7 @@ class GdbCommands : public TcpCommandsGen {
         return s == '$';
     }
     virtual bool isEndMarker(const char *s, int sz) {
-        return s[sz - 3] == '#';
+        return sz >= 3 && s[sz - 3] == '#';
     }
 
  private:
@@ -61,6 +77,7 @@ class GdbCommands : public TcpCommandsGen {
     void handlePacket(char *data);
     uint8_t checksum(const char *data, const int sz);
     void sendPacket(const char *data);
+    void sendPacket(const char *data, int sz);
 
     // RSP packet handlers
     void handleStopReasonQuery();
@@ -81,14 +98,57 @@ class GdbCommands : public TcpCommandsGen {
     void handleVCommand();
     void handleWriteMemory();
     void handleBreakpoint();
-
-    void appendRegValue(char *s, uint32_t value);
+    void handleCrc();
+    void handleMemoryMap();
+    void handleStopped();
+
+    void buildMemoryMap();
+
+    // Harts access methods
+    int hartTotal();
+    bool isHartHalted(int hart);
+    uint64_t readDport(int hart, uint16_t addr);
+    void writeDport(int hart, uint16_t addr, uint64_t val);
+    void transportDport(int hart, DebugPortTransactionType *trans, int cnt);
+    int regLocation(int regnum, uint16_t *addr);
+    int appendRegister(int hart, int regnum, char *s);
+    int formatRegister(uint64_t val, int bytes, char *s);
+    int parseThreadId(const char *s);
+
+    // Execution control
+    void resumeHart(int hart, int steps);
+    void resumeHarts(uint64_t runmask, uint64_t stepmask);
+    void haltHarts(uint64_t mask);
+    int waitHalt(uint64_t mask);
+    void writeBreakpoints();
+    void removeBreakpoints();
+    bool isBreakpoint(uint64_t addr);
+    int rangeStep(int hart, uint64_t start, uint64_t end,
+                  uint64_t othermask);
+    void allStop(int hart);
+    void formatStopReply(int hart, char *s, int sz);
+    void sendStopReply(int hart);
+    void sendNotification(const char *data);
 
  private:
     //RspPacket previous_packet;
     //bool is_ack_mode;
     //bool last_success_;
     char packet_data_[1 << 16];
+    int packet_len_;            // packet_data_ may contain binary data
+    AutoBuffer memmap_;         // qXfer:memory-map XML document
+
+    IDsuGeneric *idsu_;         // not available on real hardware
+    bool isArm_;                // otherwise RISC-V register layout
+    int hartg_;                 // Hg: registers access thread
+    int hartc_;                 // Hc: step and continue, -1 means all
+    int hartstop_;              // thread of the last stop reply
+    bool nonstop_;
+    uint64_t running_;          // non-stop: harts resumed by GDB
+    uint64_t interrupted_;      // non-stop: harts stopped via vCont;t
+    AttributeType stopQueue_;   // non-stop: not acknowledged stop replies
+    mutex_def mutexStop_;
+    AttributeType brList_;
     enum EState {
         State_AckMode,
         State_WaitAckToSwitch,
@@ -15,94 +15,163 @@
  */
 
 #include "jsoncmd.h"
+#include "tcpclient.h"
 
 namespace debugger {
 
 JsonCommands::JsonCommands(IService *parent) : TcpCommandsGen(parent) {
+    events_ = false;
 }
 
 int JsonCommands::processCommand(const char *cmdbuf, int bufsz) {
     AttributeType cmd;
-    cmd.from_config(rxbuf_);
+    cmd.from_config(cmdbuf);
     if (!cmd.is_list() || cmd.size() < 3) {
         respcnt_ = RISCV_sprintf(respbuf_, resptotal_, "%s",
                                  "wrong request format");
         return 0;
     }
 
-    AttributeType &requestType = cmd[1];
-    AttributeType &requestAction = cmd[2];
     AttributeType resp;
-    resp.make_string("OK");
     uint32_t idx = cmd[0u].to_uint32();
 
+    if (cmd[1].is_equal("Batch")) {
+        /** List of [type, action] pairs, responses in the same order */
+        AttributeType &batch = cmd[2];
+        if (!batch.is_list()) {
+            resp.make_list(2);
+            resp[0u].make_string("ERROR");
+            resp[1].make_string("Wrong batch format");
+        } else {
+            resp.make_list(batch.size());
+            for (unsigned i = 0; i < batch.size(); i++) {
+                AttributeType &item = batch[i];
+                if (!item.is_list() || item.size() < 2) {
+                    resp[i].make_list(2);
+                    resp[i][0u].make_string("ERROR");
+                    resp[i][1].make_string("Wrong command format");
+                    continue;
+                }
+                processRequest(item[0u], item[1], &resp[i]);
+            }
+        }
+    } else {
+        processRequest(cmd[1], cmd[2], &resp);
+    }
+
+    char tstr[32];
+    int tsz = RISCV_sprintf(tstr, sizeof(tstr), "[%d,", idx);
+    txbuf_.clear();
+    txbuf_.write_bin(tstr, tsz);
+    resp.to_config(&txbuf_);
+    txbuf_.write_string(']');
+
+    // Response is sent with the terminating zero
+    if (txbuf_.size() + 1 > resptotal_) {
+        delete [] respbuf_;
+        resptotal_ = txbuf_.size() + 1;
+        respbuf_ = new char[resptotal_];
+    }
+    memcpy(respbuf_, txbuf_.getBuffer(), txbuf_.size() + 1);
+    respcnt_ = txbuf_.size() + 1;
+    return rxcnt_;
+}
+
+void JsonCommands::hapTriggered(EHapType type, uint64_t param,
+                                const char *descr) {
+    TcpCommandsGen::hapTriggered(type, param, descr);
+    if (!events_) {
+        return;
+    }
+    const char *name;
+    switch (type) {
+    case HAP_Halt:          name = "Halt"; break;
+    case HAP_Resume:        name = "Resume"; break;
+    case HAP_Breakpoint:    name = "Breakpoint"; break;
+    case HAP_RegChanged:    name = "RegChanged"; break;
+    case HAP_MemDirty:      name = "MemDirty"; break;
+    default:
+        return;
+    }
+    TcpClient *client = static_cast<TcpClient *>(parent_);
+    if (client->isClosed()) {
+        return;
+    }
+    char tstr[128];
+    int sz = RISCV_sprintf(tstr, sizeof(tstr),
+                           "['Event','%s',0x%" RV_PRI64 "x]", name, param);
+    // Sent with the terminating zero as any other message
+    client->writeData(tstr, sz + 1);
+}
+
+void JsonCommands::processRequest(AttributeType &requestType,
+                                  AttributeType &requestAction,
+                                  AttributeType *resp) {
+    resp->make_string("OK");
     if (requestType.is_equal("Configuration")) {
-        resp.clone(&platformConfig_);
+        resp->clone(&platformConfig_);
     } else if (requestType.is_equal("Command")) {
         /** Redirect command to console directly */
-        iexec_->exec(requestAction.to_string(), &resp, false);
+        if (requestAction.is_list()) {
+            // Already split on arguments: [name, arg1, ...]
+            iexec_->exec(&requestAction, resp);
+        } else {
+            iexec_->exec(requestAction.to_string(), resp, false);
+        }
         if (igui_) {
             igui_->externalCommand(&requestAction);
         }
     } else if (requestType.is_equal("Breakpoint")) {
         /** Breakpoints action */
         if (requestAction[0u].is_equal("Add")) {
-            br_add(requestAction[1], &resp);
+            br_add(requestAction[1], resp);
         } else if (requestAction[0u].is_equal("Remove")) {
-            br_rm(requestAction[1], &resp);
+            br_rm(requestAction[1], resp);
         } else {
-            resp.make_string("Wrong breakpoint command");
+            resp->make_string("Wrong breakpoint command");
         }
     } else if (requestType.is_equal("Control")) {
         /** Run Control action */
         if (requestAction[0u].is_equal("GoUntil")) {
-            go_until(requestAction[1], &resp);
+            go_until(requestAction[1], resp);
         } else if (requestAction[0u].is_equal("GoMsec")) {
-            go_msec(requestAction[1], &resp);
+            go_msec(requestAction[1], resp);
         } else if (requestAction[0u].is_equal("Step")) {
-            step(requestAction[1].to_int(), &resp);
+            step(requestAction[1].to_int(), resp);
         } else {
-            resp.make_string("Wrong control command");
+            resp->make_string("Wrong control command");
         }
     } else if (requestType.is_equal("Status")) {
         /** Pump status */
         if (requestAction.is_equal("IsON")) {
-            resp.make_boolean(icpufunc_->isOn());
+            resp->make_boolean(icpufunc_->isOn());
         } else if (requestAction.is_equal("IsHalt")) {
-            resp.make_boolean(icpugen_->isHalt());
+            resp->make_boolean(icpugen_->isHalt());
         } else if (requestAction.is_equal("Steps")) {
-            resp.make_uint64(iclk_->getStepCounter());
+            resp->make_uint64(iclk_->getStepCounter());
         } else if (requestAction.is_equal("TimeSec")) {
             double t1 = iclk_->getStepCounter() / iclk_->getFreqHz();
-            resp.make_floating(t1);
+            resp->make_floating(t1);
         } else {
-            resp.make_string("Wrong status command");
+            resp->make_string("Wrong status command");
         }
+    } else if (requestType.is_equal("Events")) {
+        /** Subscribe/unsubscribe on target events */
+        events_ = requestAction.to_bool();
     } else if (requestType.is_equal("Symbol")) {
         /** Symbols table conversion */
         if (requestAction[0u].is_equal("ToAddr")) {
-            symb2addr(requestAction[1].to_string(), &resp);
+            symb2addr(requestAction[1].to_string(), resp);
         } else if (requestAction[0u].is_equal("FromAddr")) {
             // todo:
         } else {
-            resp.make_string("Wrong symbol command");
+            resp->make_string("Wrong symbol command");
         }
     } else {
-        resp.make_list(2);
-        resp[0u].make_string("ERROR");
-        resp[1].make_string("Wrong command format");
+        resp->make_list(2);
+        (*resp)[0u].make_string("ERROR");
+        (*resp)[1].make_string("Wrong command format");
     }
-    resp.to_config();
-
-    if (static_cast<int>(resp.size()) > (resptotal_ - 64)) {
-        delete [] respbuf_;
-        resptotal_ = resp.size() + 64;
-        respbuf_ = new char[resptotal_];
-    }
-
-    respcnt_ = RISCV_sprintf(respbuf_, resptotal_, "[%d,%s]",
-                             idx, resp.to_string()) + 1;
-    return rxcnt_;
 }
 
 }  // namespace debugger
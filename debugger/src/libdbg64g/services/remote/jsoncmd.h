@@ -17,20 +17,45 @@
 #ifndef __DEBUGGER_SERVICES_REMOTE_JSONCMD_H__
 #define __DEBUGGER_SERVICES_REMOTE_JSONCMD_H__
 
+#include <autobuffer.h>
 #include "tcpcmd_gen.h"
 
 namespace debugger {
 
+/**
+ * @brief JSON-RPC requests handler.
+ * @details Request is a zero terminated list [idx, RequestType, Action],
+ *          response is [idx, Result]. Requests sent without waiting for the
+ *          previous response are executed in order and each response is sent
+ *          as soon as it's ready, so a client matches them by idx.
+ *          [idx, 'Batch', [[RequestType, Action], ...]] executes the whole
+ *          list in one round trip and responds [idx, [Result, ...]].
+ *          [idx, 'Events', true] subscribes the client on target events
+ *          pushed without request as ['Event', Name, Param].
+ */
 class JsonCommands : public TcpCommandsGen {
  public:
     explicit JsonCommands(IService *parent);
 
+    /** IHap */
+    virtual void hapTriggered(EHapType type, uint64_t param,
+                              const char *descr);
+
  protected:
     virtual int processCommand(const char *cmdbuf, int bufsz);
     virtual bool isStartMarker(char s) { return true; }
     virtual bool isEndMarker(const char *s, int sz) {
         return s[sz - 1] == '\0';
     }
+
+ private:
+    void processRequest(AttributeType &requestType,
+                        AttributeType &requestAction,
+                        AttributeType *resp);
+
+ private:
+    AutoBuffer txbuf_;      // reused between requests
+    bool events_;           // client subscribed on events
 };
 
 }  // namespace debugger
@@ -15,22 +15,45 @@
  */
 
 #include "tcpclient.h"
+#include "tcpserver.h"
 #include "jsoncmd.h"
 #include "gdbcmd.h"
+#include "bincmd.h"
 
 namespace debugger {
 
+/** Reading is paused when buffered data exceeds these limits */
+static const int RX_PENDING_MAX = 1 << 20;
+static const int TX_PENDING_MAX = 1 << 22;
+/** Console output is dropped, command responses are always buffered */
+static const int TX_CONSOLE_MAX = 1 << 24;
+
+/**
+ * IThread isn't registered: the thread is stopped and joined by TcpServer
+ * that owns the connection, not by the simulation exit sequence.
+ */
 TcpClient::TcpClient(const char *name) : IService(name) {
-    registerInterface(static_cast<IThread *>(this));
     registerAttribute("Enable", &isEnable_);
     registerAttribute("PlatformConfig", &platformConfig_);
     registerAttribute("Type", &type_);
     registerAttribute("ListenDefaultOutput", &listenDefaultOutput_);
+    char tstr[128];
+    RISCV_sprintf(tstr, sizeof(tstr), "%s_rx", name);
+    RISCV_event_create(&eventRx_, tstr);
+    RISCV_mutex_init(&mutexRx_);
     RISCV_mutex_init(&mutexTx_);
+    hsock_ = -1;
+    server_ = 0;
+    txoff_ = 0;
+    txdropped_ = 0;
+    rxpaused_ = false;
+    finished_ = false;
     tcpcmd_ = 0;
 }
 
 TcpClient::~TcpClient() {
+    RISCV_event_close(&eventRx_);
+    RISCV_mutex_destroy(&mutexRx_);
     RISCV_mutex_destroy(&mutexTx_);
     if (tcpcmd_) {
         delete tcpcmd_;
@@ -42,12 +65,17 @@ void TcpClient::postinitService() {
         tcpcmd_ = new JsonCommands(static_cast<IService *>(this));
     } else if (type_.is_equal("gdb")) {
         tcpcmd_ = new GdbCommands(static_cast<IService *>(this));
+    } else if (type_.is_equal("bin")) {
+        tcpcmd_ = new BinCommands(static_cast<IService *>(this));
     } else {
         RISCV_error("Unsupported command type %s.", type_.to_string());
         return;
     }
 
     tcpcmd_->setPlatformConfig(&platformConfig_);
+    if (listenDefaultOutput_.to_bool()) {
+        RISCV_add_default_output(static_cast<IRawListener *>(this));
+    }
     if (isEnable_.to_bool()) {
         if (!run()) {
             RISCV_error("Can't create thread.", NULL);
@@ -57,80 +85,151 @@ void TcpClient::postinitService() {
 }
 
 int TcpClient::updateData(const char *buf, int buflen) {
-    int tsz = RISCV_sprintf(&asyncbuf_[0].ibyte, sizeof(asyncbuf_),
-                    "['%s',", "Console");
-
-    memcpy(&asyncbuf_[tsz], buf, buflen);
-    tsz += buflen;
-    asyncbuf_[tsz++].ubyte = ']';
-    asyncbuf_[tsz++].ubyte = '\0';
-
-    sendData(&asyncbuf_[0].ubyte, tsz);
+    RISCV_mutex_lock(&mutexTx_);
+    if (txbuf_.size() - txoff_ + buflen > TX_CONSOLE_MAX) {
+        txdropped_++;
+        RISCV_mutex_unlock(&mutexTx_);
+        return buflen;
+    }
+    tcpcmd_->formatConsole(buf, buflen, &txbuf_);
+    RISCV_mutex_unlock(&mutexTx_);
+    server_->wakeup();
     return buflen;
 }
 
 void TcpClient::busyLoop() {
-    int rxbytes;
-    if (listenDefaultOutput_.to_bool()) {
-        RISCV_add_default_output(static_cast<IRawListener *>(this));
-    }
-
-    txcnt_ = 0;
     while (isEnabled()) {
-        rxbytes = recv(hsock_, rcvbuf, sizeof(rcvbuf), 0);
-        if (rxbytes <= 0) {
-            // Timeout:
+        if (RISCV_event_wait_ms(&eventRx_, 500)) {
             continue;
-        } 
-
-        rcvbuf[rxbytes] = '\0';
-        RISCV_debug("i=>[%d]: %s", rxbytes, rcvbuf);
-        tcpcmd_->updateData(rcvbuf, rxbytes);
-        int tsz = tcpcmd_->response_size();
-        if (tsz != 0) {
-            sendData(tcpcmd_->response_buf(), tsz);
         }
-        tcpcmd_->done();
-    }
-
-    if (listenDefaultOutput_.to_bool()) {
-        RISCV_remove_default_output(static_cast<IRawListener *>(this));
+        RISCV_event_clear(&eventRx_);
+
+        RISCV_mutex_lock(&mutexRx_);
+        rxwork_.clear();
+        rxwork_.write_bin(rxbuf_.getBuffer(), rxbuf_.size());
+        rxbuf_.clear();
+        RISCV_mutex_unlock(&mutexRx_);
+
+        const char *pbuf = rxwork_.getBuffer();
+        int total = rxwork_.size();
+        while (total > 0 && isEnabled()) {
+            int processed = tcpcmd_->updateData(pbuf, total);
+            int tsz = tcpcmd_->response_size();
+            if (tsz != 0) {
+                writeData(reinterpret_cast<char *>(tcpcmd_->response_buf()),
+                          tsz);
+            }
+            tcpcmd_->done();
+            if (processed == 0) {
+                break;
+            }
+            pbuf += processed;
+            total -= processed;
+        }
+        // Reading could be paused by the server
+        server_->wakeup();
     }
-    closeSocket();
+    finished_ = true;
 }
 
-int TcpClient::sendData(uint8_t *buf, int sz) {
+void TcpClient::writeData(const char *buf, int sz) {
     RISCV_mutex_lock(&mutexTx_);
-    memcpy(txbuf_, buf, sz);
-    txbuf_[sz] = '\0';
-    txcnt_ = sz;
+    txbuf_.write_bin(buf, sz);
     RISCV_mutex_unlock(&mutexTx_);
+    server_->wakeup();
+}
 
-    //RISCV_debug("o<=[%d]: %s", txcnt_, txbuf_);
-
-    int total = txcnt_;
-    char *ptx = txbuf_;
-    int txbytes;
+bool TcpClient::readSocket() {
+    char tbuf[1 << 16];
+    int rxbytes;
+    bool received = false;
+    bool ret = true;
+    while (true) {
+        rxpaused_ = !isReadReady();
+        if (rxpaused_) {
+            break;
+        }
+        rxbytes = recv(hsock_, tbuf, sizeof(tbuf), 0);
+        if (rxbytes == 0) {
+            ret = false;        // closed by remote side
+            break;
+        } else if (rxbytes < 0) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+            ret = WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+            ret = errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+            break;
+        }
+        RISCV_mutex_lock(&mutexRx_);
+        rxbuf_.write_bin(tbuf, rxbytes);
+        RISCV_mutex_unlock(&mutexRx_);
+        received = true;
+    }
+    if (received) {
+        RISCV_event_set(&eventRx_);
+    }
+    return ret;
+}
 
-    while (total > 0) {
-        txbytes = send(hsock_, ptx, total, 0);
+bool TcpClient::writeSocket() {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    int flags = 0;
+#else
+    int flags = MSG_NOSIGNAL;
+#endif
+    bool ret = true;
+    RISCV_mutex_lock(&mutexTx_);
+    while (txoff_ < txbuf_.size()) {
+        int txbytes = send(hsock_, &txbuf_.getBuffer()[txoff_],
+                           txbuf_.size() - txoff_, flags);
         if (txbytes <= 0) {
-            RISCV_error("Send error: txcnt=%d", txcnt_);
-            loopEnable_.state = false;
-            return -1;
+#if defined(_WIN32) || defined(__CYGWIN__)
+            ret = WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+            ret = errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+            if (!ret) {
+                RISCV_error("Send error: txcnt=%d", txbuf_.size() - txoff_);
+            }
+            break;
         }
-        total -= txbytes;
-        ptx += txbytes;
+        txoff_ += txbytes;
     }
+    if (txoff_ == txbuf_.size()) {
+        txbuf_.clear();
+        txoff_ = 0;
+    }
+    RISCV_mutex_unlock(&mutexTx_);
+    return ret;
+}
+
+bool TcpClient::isReadReady() {
+    RISCV_mutex_lock(&mutexRx_);
+    bool ret = rxbuf_.size() < RX_PENDING_MAX;
+    RISCV_mutex_unlock(&mutexRx_);
     RISCV_mutex_lock(&mutexTx_);
-    txcnt_ = 0;
+    ret = ret && (txbuf_.size() - txoff_) < TX_PENDING_MAX;
     RISCV_mutex_unlock(&mutexTx_);
-    return 0;
+    return ret;
 }
 
-void TcpClient::closeSocket() {
-    if (hsock_ < 0) {
-        return;
+bool TcpClient::isWriteReady() {
+    RISCV_mutex_lock(&mutexTx_);
+    bool ret = txoff_ < txbuf_.size();
+    RISCV_mutex_unlock(&mutexTx_);
+    return ret;
+}
+
+void TcpClient::closeConnection() {
+    if (listenDefaultOutput_.to_bool()) {
+        RISCV_remove_default_output(static_cast<IRawListener *>(this));
+    }
+    // Thread may wait target event, so it isn't joined here
+    RISCV_event_clear(&loopEnable_);
+    RISCV_event_set(&eventRx_);
+    if (txdropped_) {
+        RISCV_info("%d console messages were dropped", txdropped_);
     }
 
 #if defined(_WIN32) || defined(__CYGWIN__)
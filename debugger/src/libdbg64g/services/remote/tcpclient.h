@@ -19,12 +19,27 @@
 
 #include <iclass.h>
 #include <iservice.h>
+#include <autobuffer.h>
 #include "tcpcmd_gen.h"
 #include "coreservices/ithread.h"
 #include "coreservices/irawlistener.h"
 
 namespace debugger {
 
+class TcpServer;
+
+/** Connection argument passed by TcpServer via setExtArgument() */
+struct TcpConnectionType {
+    socket_def hsock;
+    TcpServer *server;
+};
+
+/**
+ * @brief Single connection of the TcpServer.
+ * @details Socket is read and written only by the server I/O thread using
+ *          the buffers of this class. Own thread executes commands because
+ *          some of them wait target events (halt, power on/off).
+ */
 class TcpClient : public IService,
                   public IThread,
                   public IRawListener {
@@ -35,20 +50,35 @@ class TcpClient : public IService,
     /** IService interface */
     virtual void postinitService();
     virtual void setExtArgument(void *args) {
-        hsock_ = *reinterpret_cast<socket_def *>(args);
+        TcpConnectionType *p = reinterpret_cast<TcpConnectionType *>(args);
+        hsock_ = p->hsock;
+        server_ = p->server;
     }
 
     /** IRawListener interface */
     virtual int updateData(const char *buf, int buflen);
 
+    /** Server I/O thread methods */
+    socket_def getSocket() { return hsock_; }
+    bool isClosed() { return hsock_ == -1; }
+    /** Read all available data, returns false when connection closed */
+    bool readSocket();
+    /** Send buffered data, returns false on error */
+    bool writeSocket();
+    /** Backpressure: stop reading while previous data isn't processed */
+    bool isReadReady();
+    bool isReadPaused() { return rxpaused_; }
+    bool isWriteReady();
+    void closeConnection();
+    /** Thread of the closed connection can be joined without waiting */
+    bool isFinished() { return finished_; }
+    /** Append data to the send queue (responses, notifications) */
+    void writeData(const char *buf, int sz);
+
  protected:
     /** IThread interface */
     virtual void busyLoop();
 
- protected:
-    int sendData(uint8_t *buf, int sz);
-    void closeSocket();
-
  private:
     AttributeType isEnable_;
     AttributeType timeout_;
@@ -57,14 +87,17 @@ class TcpClient : public IService,
     AttributeType listenDefaultOutput_;
 
     socket_def hsock_;
+    TcpServer *server_;
+    event_def eventRx_;
+    mutex_def mutexRx_;
     mutex_def mutexTx_;
-    char rcvbuf[4096];
-    char txbuf_[1<<20];
-    int txcnt_;
-    union reg8_type {
-        char ibyte;
-        uint8_t ubyte;
-    } asyncbuf_[1 << 20];
+    AutoBuffer rxbuf_;          // received by server, not processed
+    AutoBuffer rxwork_;         // processing in client thread
+    AutoBuffer txbuf_;          // waiting for send
+    int txoff_;                 // already sent part of txbuf_
+    int txdropped_;             // console messages dropped on overflow
+    bool rxpaused_;             // socket wasn't read until EAGAIN
+    bool finished_;
 
     TcpCommandsGen *tcpcmd_;
 };
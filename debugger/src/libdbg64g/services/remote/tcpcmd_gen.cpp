@@ -18,6 +18,9 @@
 
 namespace debugger {
 
+/** Single request limit, the rest of the oversized request is discarded */
+static const int RX_FRAME_MAX = 1 << 22;
+
 TcpCommandsGen::TcpCommandsGen(IService *parent) : IHap(HAP_All) {
     parent_ = parent;
     rxcnt_ = 0;
@@ -35,6 +38,18 @@ TcpCommandsGen::TcpCommandsGen(IService *parent) : IHap(HAP_All) {
     iexec_ = static_cast<ICmdExecutor *>(
         RISCV_get_service_iface(executor_.to_string(), IFACE_CMD_EXECUTOR));
 
+    itap_ = 0;
+    IService *iservexec = static_cast<IService *>(
+                        RISCV_get_service(executor_.to_string()));
+    if (iservexec) {
+        AttributeType *tap =
+            static_cast<AttributeType *>(iservexec->getAttribute("Tap"));
+        if (tap && tap->is_string()) {
+            itap_ = static_cast<ITap *>(
+                RISCV_get_service_iface(tap->to_string(), IFACE_TAP));
+        }
+    }
+
     igui_ = static_cast<IGui *>(
         RISCV_get_service_iface(gui_.to_string(), IFACE_GUI_PLUGIN));
 
@@ -57,6 +72,7 @@ TcpCommandsGen::TcpCommandsGen(IService *parent) : IHap(HAP_All) {
     char tstr[128];
     RISCV_sprintf(tstr, sizeof(tstr), "%s_halt", parent_->getObjName());
     RISCV_event_create(&eventHalt_, tstr);
+    haltMask_ = ~0ull;
     RISCV_sprintf(tstr, sizeof(tstr), "%s_delay_ms", parent_->getObjName());
     RISCV_event_create(&eventDelayMs_, tstr);
     RISCV_sprintf(tstr, sizeof(tstr), "%s_pwr", parent_->getObjName());
@@ -66,6 +82,7 @@ TcpCommandsGen::TcpCommandsGen(IService *parent) : IHap(HAP_All) {
 }
 
 TcpCommandsGen::~TcpCommandsGen() {
+    RISCV_unregister_hap(static_cast<IHap *>(this));
     RISCV_event_close(&eventHalt_);
     RISCV_event_close(&eventDelayMs_);
     RISCV_event_close(&eventPowerChanged_);
@@ -82,48 +99,75 @@ void TcpCommandsGen::hapTriggered(EHapType type,
                                   uint64_t param,
                                   const char *descr) {
     if (type == HAP_Halt) {
-        RISCV_event_set(&eventHalt_);
+        // Param is the index of the halted hart
+        if (param >= 64 || ((haltMask_ >> param) & 0x1)) {
+            RISCV_event_set(&eventHalt_);
+        }
     } else if (type == HAP_CpuTurnON || type == HAP_CpuTurnOFF) {
         RISCV_event_set(&eventPowerChanged_);
     }
 }
 
+void TcpCommandsGen::formatConsole(const char *buf, int sz,
+                                   AutoBuffer *out) {
+    out->write_string("['Console',");
+    out->write_bin(buf, sz);
+    out->write_string(']');
+    out->write_string('\0');
+}
+
 void TcpCommandsGen::stepCallback(uint64_t t) {
     RISCV_event_set(&eventDelayMs_);
 }
 
 int TcpCommandsGen::updateData(const char *buf, int buflen) {
-    int ret = 0;
     for (int i = 0; i < buflen; i++) {
         switch (estate_) {
         case State_Idle:
             if (isStartMarker(buf[i])) {
-                rxbuf_[rxcnt_++] = buf[i];
+                rxbuf_.clear();
+                rxbuf_.write_string(buf[i]);
+                rxcnt_ = rxbuf_.size();
                 estate_ = State_Started;
             }
             break;
         case State_Started:
-            if (rxcnt_ < static_cast<int>(sizeof(rxbuf_))) {
-                rxbuf_[rxcnt_++] = buf[i];
-                rxbuf_[rxcnt_] = '\0';
-            } else {
-                RISCV_error("rxbuf_ overflow %d", rxcnt_);
-            }
-            if (isEndMarker(rxbuf_, rxcnt_)) {
+            rxbuf_.write_string(buf[i]);
+            rxcnt_ = rxbuf_.size();
+            if (isEndMarker(rxbuf_.getBuffer(), rxcnt_)) {
                 estate_ = State_Ready;
+            } else if (rxcnt_ >= RX_FRAME_MAX) {
+                RISCV_error("Request dropped: exceeds %d bytes", RX_FRAME_MAX);
+                estate_ = State_Skip;
+            }
+            break;
+        case State_Skip:
+            // Only the tail is kept to detect the end marker
+            if (rxcnt_ >= 64) {
+                char tail[4];
+                memcpy(tail, &rxbuf_.getBuffer()[rxcnt_ - 4], 4);
+                rxbuf_.clear();
+                rxbuf_.write_bin(tail, 4);
+            }
+            rxbuf_.write_string(buf[i]);
+            rxcnt_ = rxbuf_.size();
+            if (isEndMarker(rxbuf_.getBuffer(), rxcnt_)) {
+                rxcnt_ = 0;
+                estate_ = State_Idle;
             }
             break;
         default:;
         }
 
         if (estate_ == State_Ready) {
-            processCommand(rxbuf_, rxcnt_);
+            processCommand(rxbuf_.getBuffer(), rxcnt_);
             rxcnt_ = 0;
             estate_ = State_Idle;
-            ret = i + 1;  // take into account the last symbol
+            // Response should be sent before the next command
+            return i + 1;
         }
     }
-    return ret;
+    return 0;
 }
 
 void TcpCommandsGen::br_add(const AttributeType &symb, AttributeType *res) {
@@ -142,9 +186,7 @@ void TcpCommandsGen::br_add(const AttributeType &symb, AttributeType *res) {
         res->make_string("br_add: Wrong format");
         return;
     }
-    char tstr[256];
-    RISCV_sprintf(tstr, sizeof(tstr), "br add 0x%x", addr);
-    iexec_->exec(tstr, res, false);
+    breakpointCmd("add", addr, res);
 }
 
 void TcpCommandsGen::br_rm(const AttributeType &symb, AttributeType *res) {
@@ -163,23 +205,46 @@ void TcpCommandsGen::br_rm(const AttributeType &symb, AttributeType *res) {
         res->make_string("br_rm: Wrong format");
         return;
     }
-    char tstr[256];
-    RISCV_sprintf(tstr, sizeof(tstr), "br rm 0x%x", addr);
-    iexec_->exec(tstr, res, false);
+    breakpointCmd("rm", addr, res);
 }
 
-void TcpCommandsGen::step(int cnt, AttributeType *res) {
-    char tstr[128];
-    RISCV_sprintf(tstr, sizeof(tstr), "c %d", cnt);
+void TcpCommandsGen::breakpointCmd(const char *action, uint64_t addr,
+                                   AttributeType *res) {
+    AttributeType args;
+    args.make_list(3);
+    args[0u].make_string("br");
+    args[1].make_string(action);
+    args[2].make_uint64(addr);
+    iexec_->exec(&args, res);
+}
 
+void TcpCommandsGen::runCmd(uint64_t steps, AttributeType *res) {
+    AttributeType args;
+    args.make_list(steps ? 2 : 1);
+    args[0u].make_string("c");
+    if (steps) {
+        args[1].make_uint64(steps);
+    }
+    iexec_->exec(&args, res);
+}
+
+void TcpCommandsGen::runAndWait(uint64_t steps, AttributeType *res) {
+    AttributeType hart;
+    iexec_->exec("cpucontext", &hart, true);
+    haltMask_ = 1ull << (hart.to_uint64() & 0x3f);
+    RISCV_event_clear(&eventHalt_);
+    runCmd(steps, res);
+    RISCV_event_wait(&eventHalt_);
+    haltMask_ = ~0ull;
+}
+
+void TcpCommandsGen::step(int cnt, AttributeType *res) {
     int log_level_old = cpuLogLevel_->to_int();
     if (cnt < 10) {
         cpuLogLevel_->make_int64(4);
     }
 
-    RISCV_event_clear(&eventHalt_);
-    iexec_->exec(tstr, res, false);
-    RISCV_event_wait(&eventHalt_);
+    runAndWait(static_cast<uint64_t>(cnt), res);
     cpuLogLevel_->make_int64(log_level_old);
 }
 
@@ -200,24 +265,18 @@ void TcpCommandsGen::go_until(const AttributeType &symb, AttributeType *res) {
         return;
     }
     // Add breakpoint
-    char tstr[256];
-    RISCV_sprintf(tstr, sizeof(tstr), "br add 0x%x", addr);
-    iexec_->exec(tstr, res, false);
+    breakpointCmd("add", addr, res);
 
     // Set CPU LogLevel=1 to hide all debugging messages
     int log_level_old = cpuLogLevel_->to_int();
     cpuLogLevel_->make_int64(1);
 
     // Run simulation
-    RISCV_event_clear(&eventHalt_);
-    RISCV_sprintf(tstr, sizeof(tstr), "c", 0);
-    iexec_->exec(tstr, res, false);
-    RISCV_event_wait(&eventHalt_);
+    runAndWait(0, res);
     cpuLogLevel_->make_int64(log_level_old);
 
     // Remove breakpoint:
-    RISCV_sprintf(tstr, sizeof(tstr), "br rm 0x%x", addr);
-    iexec_->exec(tstr, res, false);
+    breakpointCmd("rm", addr, res);
 }
 
 void TcpCommandsGen::symb2addr(const char *symbol, AttributeType *res) {
@@ -269,7 +328,7 @@ void TcpCommandsGen::power_off(const char *btn_name, AttributeType *res) {
     RISCV_event_clear(&eventPowerChanged_);
     RISCV_sprintf(tstr, sizeof(tstr), "%s press", btn_name);
     iexec_->exec(tstr, &t1, false);
-    iexec_->exec("c", &t1, false);
+    runCmd(0, &t1);
     RISCV_event_wait(&eventPowerChanged_);
     RISCV_sprintf(tstr, sizeof(tstr), "%s release", btn_name);
     iexec_->exec(tstr, &t1, false);
@@ -277,17 +336,12 @@ void TcpCommandsGen::power_off(const char *btn_name, AttributeType *res) {
 }
 
 void TcpCommandsGen::go_msec(const AttributeType &msec, AttributeType *res) {
-    char tstr[256];
     double delta = 0.001 * iclk_->getFreqHz() * msec.to_float();
     if (delta == 0) {
         delta = 1;
     }
-    RISCV_sprintf(tstr, sizeof(tstr),
-        "c %" RV_PRI64 "d", static_cast<uint64_t>(delta));
 
-    RISCV_event_clear(&eventHalt_);
-    iexec_->exec(tstr, res, false);
-    RISCV_event_wait(&eventHalt_);
+    runAndWait(static_cast<uint64_t>(delta), res);
 }
 
 }  // namespace debugger
@@ -18,6 +18,7 @@
 #define __DEBUGGER_TCPCMD_GEN_H__
 
 #include <api_core.h>
+#include <autobuffer.h>
 #include <iclass.h>
 #include <iservice.h>
 #include <ihap.h>
@@ -26,6 +27,7 @@
 #include "coreservices/icpugen.h"
 #include "coreservices/icpufunctional.h"
 #include "coreservices/icmdexec.h"
+#include "coreservices/itap.h"
 #include "coreservices/isrccode.h"
 #include "coreservices/ikeyboard.h"
 #include "coreservices/iclock.h"
@@ -46,7 +48,10 @@ class TcpCommandsGen : public IRawListener,
     explicit TcpCommandsGen(IService *parent);
     virtual ~TcpCommandsGen();
 
-    /** IRawListener interface */
+    /**
+     * IRawListener interface. Stops on the first complete command and
+     * returns number of processed bytes, 0 if all bytes were buffered.
+     */
     virtual int updateData(const char *buf, int buflen);
 
     /** IHap */
@@ -61,6 +66,8 @@ class TcpCommandsGen : public IRawListener,
     uint8_t *response_buf() { return reinterpret_cast<uint8_t *>(respbuf_); }
     int response_size() { return respcnt_; }
     void done() { respcnt_ = 0; }
+    /** Console output notification, ['Console',text] by default */
+    virtual void formatConsole(const char *buf, int sz, AutoBuffer *out);
 
  protected:
     virtual int processCommand(const char *cmdbuf, int bufsz) = 0;
@@ -79,9 +86,14 @@ class TcpCommandsGen : public IRawListener,
     void symb2addr(const char *symbol, AttributeType *res);
     void power_on(const char *btn_name, AttributeType *res);
     void power_off(const char *btn_name, AttributeType *res);
+    /** Typed executor calls without text formatting and parsing */
+    void breakpointCmd(const char *action, uint64_t addr, AttributeType *res);
+    void runCmd(uint64_t steps, AttributeType *res);
+    /** Resume the selected hart and wait until this hart halts */
+    void runAndWait(uint64_t steps, AttributeType *res);
 
  protected:
-    char rxbuf_[4096];
+    AutoBuffer rxbuf_;      // batch requests may be large
     int rxcnt_;
     AttributeType platformConfig_;
     AttributeType cpu_;
@@ -95,6 +107,7 @@ class TcpCommandsGen : public IRawListener,
 
     IService *parent_;
     ICmdExecutor *iexec_;
+    ITap *itap_;                // the same as used by the command executor
     ISourceCode *isrc_;
     ICpuGeneric *icpugen_;
     ICpuFunctional *icpufunc_;
@@ -103,12 +116,14 @@ class TcpCommandsGen : public IRawListener,
     AttributeType *cpuLogLevel_;
 
     event_def eventHalt_;
+    uint64_t haltMask_;         // harts whose HAP_Halt sets eventHalt_
     event_def eventDelayMs_;
     event_def eventPowerChanged_;
 
     enum EState {
         State_Idle,
         State_Started,
+        State_Skip,
         State_Ready
     } estate_;
 };
@@ -28,20 +28,53 @@ TcpServer::TcpServer(const char *name) : IService(name) {
     registerAttribute("PlatformConfig", &platformConfig_);
     registerAttribute("Type", &type_);
     registerAttribute("ListenDefaultOutput", &listenDefaultOutput_);
+    hsock_ = -1;
+    hwake_ = -1;
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+    hepoll_ = -1;
+#endif
+    clients_.make_list(0);
+    closed_.make_list(0);
+    clientIdx_ = 0;
+}
+
+TcpServer::~TcpServer() {
+    deleteAllClients();
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+    if (hepoll_ >= 0) {
+        close(hepoll_);
+    }
+#endif
 }
 
 void TcpServer::postinitService() {
     createServerSocket();
 
-    if (listen(hsock_, 1) < 0)  {
+    if (listen(hsock_, SOMAXCONN) < 0)  {
         RISCV_error("listen() failed", 0);
         return;
     }
 
-    /** By default socket was created with Blocking mode */
-    if (!blockmode_.to_bool()) {
-        setBlockingMode(false);
+    /** I/O thread never blocks on socket, BlockingMode is ignored */
+    setBlockingMode(false);
+
+    if (createWakeupSocket() < 0) {
+        return;
+    }
+
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+    hepoll_ = epoll_create(1);
+    if (hepoll_ < 0) {
+        RISCV_error("epoll_create() failed", 0);
+        return;
     }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &hsock_;
+    epoll_ctl(hepoll_, EPOLL_CTL_ADD, hsock_, &ev);
+    ev.data.ptr = &hwake_;
+    epoll_ctl(hepoll_, EPOLL_CTL_ADD, hwake_, &ev);
+#endif
 
     if (isEnable_.to_bool()) {
         if (!run()) {
@@ -52,63 +85,234 @@ void TcpServer::postinitService() {
 }
 
 void TcpServer::busyLoop() {
-    socket_def client_sock;
-    int err;
+    int timeout_ms = timeout_.to_int();
+    if (timeout_ms <= 0) {
+        timeout_ms = 400;
+    }
+
+    while (isEnabled()) {
+        waitEvents(timeout_ms);
+        processClients();
+    }
+
+    deleteAllClients();
+    closeServerSocket();
+}
+
+void TcpServer::wakeup() {
+    char t1 = 0;
+    sendto(hwake_, &t1, 1, 0,
+           reinterpret_cast<struct sockaddr *>(&wakeaddr_),
+           sizeof(wakeaddr_));
+}
 
+#if defined(_WIN32) || defined(__CYGWIN__)
+void TcpServer::waitEvents(int timeout_ms) {
     fd_set readSet;
+    fd_set writeSet;
     timeval timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 400000;   // 400 ms
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = 1000 * (timeout_ms % 1000);
+    TcpClient *client;
+    char tbuf[64];
 
-    int idx = 0;
-    char tname[64];
+    FD_ZERO(&readSet);
+    FD_ZERO(&writeSet);
+    FD_SET(hsock_, &readSet);
+    FD_SET(hwake_, &readSet);
+    for (unsigned i = 0; i < clients_.size(); i++) {
+        client = static_cast<TcpClient *>(
+                    static_cast<IService *>(clients_[i].to_iface()));
+        if (client->isReadReady()) {
+            FD_SET(client->getSocket(), &readSet);
+        }
+        if (client->isWriteReady()) {
+            FD_SET(client->getSocket(), &writeSet);
+        }
+    }
+    // Windows ignores the first argument
+    if (select(0, &readSet, &writeSet, NULL, &timeout) <= 0) {
+        return;
+    }
 
+    if (FD_ISSET(hwake_, &readSet)) {
+        while (recv(hwake_, tbuf, sizeof(tbuf), 0) > 0) {}
+    }
+    if (FD_ISSET(hsock_, &readSet)) {
+        acceptClients();
+    }
+    for (unsigned i = 0; i < clients_.size(); i++) {
+        client = static_cast<TcpClient *>(
+                    static_cast<IService *>(clients_[i].to_iface()));
+        if (FD_ISSET(client->getSocket(), &readSet)
+            && !client->readSocket()) {
+            closeClient(client);
+            i--;
+        }
+    }
+}
+#else
+void TcpServer::waitEvents(int timeout_ms) {
+    struct epoll_event events[64];
+    TcpClient *client;
+    char tbuf[64];
+
+    int total = epoll_wait(hepoll_, events, 64, timeout_ms);
+    for (int i = 0; i < total; i++) {
+        if (events[i].data.ptr == &hsock_) {
+            acceptClients();
+        } else if (events[i].data.ptr == &hwake_) {
+            while (recv(hwake_, tbuf, sizeof(tbuf), 0) > 0) {}
+        } else {
+            client = static_cast<TcpClient *>(events[i].data.ptr);
+            if (client->isClosed()) {
+                continue;
+            }
+            // Edge triggered: paused reading is resumed in processClients()
+            if ((events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP
+                                    | EPOLLERR)) && !client->readSocket()) {
+                closeClient(client);
+            }
+        }
+    }
+}
+#endif
+
+void TcpServer::acceptClients() {
+    socket_def client_sock;
+    char tname[64];
     IClass *icls;
     IService *isrv;
-    while (isEnabled()) {
-        FD_ZERO(&readSet);
-        FD_SET(hsock_, &readSet);
-        err = select(hsock_ + 1, &readSet, NULL, NULL, &timeout);
-        if (err > 0) {
-            client_sock = accept(hsock_, 0, 0);
-            setRcvTimeout(client_sock, timeout_.to_int());
-            RISCV_sprintf(tname, sizeof(tname), "client%d", idx++);
-
-            icls = static_cast<IClass *>(RISCV_get_class("TcpClientClass"));
-            isrv = icls->createService(".", tname);
-            AttributeType lst, item;
-            lst.make_list(0);
-            item.make_list(2);
-            item[0u].make_string("LogLevel");
-            item[1].make_int64(logLevel_.to_int());
-            lst.add_to_list(&item);
-            item[0u].make_string("Enable");
-            item[1].make_boolean(true);
-            lst.add_to_list(&item);
-            item[0u].make_string("PlatformConfig");
-            item[1].clone(&platformConfig_);
-            lst.add_to_list(&item);
-            item[0u].make_string("Type");
-            item[1].clone(&type_);
-            lst.add_to_list(&item);
-            item[0u].make_string("ListenDefaultOutput");
-            item[1].clone(&listenDefaultOutput_);
-            lst.add_to_list(&item);
-
-            isrv->initService(&lst);
-            IThread *ithrd =
-                static_cast<IThread *>(isrv->getInterface(IFACE_THREAD));
-            ithrd->setExtArgument(&client_sock);
-            isrv->postinitService();
-            RISCV_info("TCP %s %p started", isrv->getObjName(), client_sock);
-        } else if (err == 0) {
-            // timeout
-        } else {
-            RISCV_info("TCP server thread accept() failed", 0);
-            loopEnable_.state = false;
+
+    while (true) {
+        client_sock = accept(hsock_, 0, 0);
+#if defined(_WIN32) || defined(__CYGWIN__)
+        if (client_sock == INVALID_SOCKET) {
+            return;
         }
+#else
+        if (client_sock < 0) {
+            return;
+        }
+#endif
+        setBlockingMode(client_sock, false);
+        int enable = 1;
+        setsockopt(client_sock, IPPROTO_TCP, TCP_NODELAY,
+                   reinterpret_cast<const char *>(&enable), sizeof(int));
+        RISCV_sprintf(tname, sizeof(tname), "%s_client%d",
+                      getObjName(), clientIdx_++);
+
+        icls = static_cast<IClass *>(RISCV_get_class("TcpClientClass"));
+        isrv = icls->createService(".", tname);
+        AttributeType lst, item;
+        lst.make_list(0);
+        item.make_list(2);
+        item[0u].make_string("LogLevel");
+        item[1].make_int64(logLevel_.to_int());
+        lst.add_to_list(&item);
+        item[0u].make_string("Enable");
+        item[1].make_boolean(true);
+        lst.add_to_list(&item);
+        item[0u].make_string("PlatformConfig");
+        item[1].clone(&platformConfig_);
+        lst.add_to_list(&item);
+        item[0u].make_string("Type");
+        item[1].clone(&type_);
+        lst.add_to_list(&item);
+        item[0u].make_string("ListenDefaultOutput");
+        item[1].clone(&listenDefaultOutput_);
+        lst.add_to_list(&item);
+
+        isrv->initService(&lst);
+        TcpConnectionType conn;
+        conn.hsock = client_sock;
+        conn.server = this;
+        TcpClient *client = static_cast<TcpClient *>(isrv);
+        client->setExtArgument(&conn);
+        isrv->postinitService();
+
+        item.make_iface(isrv);
+        clients_.add_to_list(&item);
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = client;
+        epoll_ctl(hepoll_, EPOLL_CTL_ADD, client_sock, &ev);
+#endif
+        RISCV_info("TCP %s %p started", isrv->getObjName(), client_sock);
+    }
+}
+
+/**
+ * Flush output buffers filled by other threads and resume reading of the
+ * connections paused by backpressure.
+ */
+void TcpServer::processClients() {
+    TcpClient *client;
+    for (unsigned i = 0; i < closed_.size(); i++) {
+        client = static_cast<TcpClient *>(
+                    static_cast<IService *>(closed_[i].to_iface()));
+        if (client->isFinished()) {
+            client->stop();
+            closed_.remove_from_list(i);
+            i--;
+            deleteClient(client);
+        }
+    }
+    for (unsigned i = 0; i < clients_.size(); i++) {
+        client = static_cast<TcpClient *>(
+                    static_cast<IService *>(clients_[i].to_iface()));
+        if (client->isWriteReady() && !client->writeSocket()) {
+            closeClient(client);
+            i--;
+            continue;
+        }
+        if (client->isReadPaused() && client->isReadReady()
+            && !client->readSocket()) {
+            closeClient(client);
+            i--;
+        }
+    }
+}
+
+void TcpServer::closeClient(TcpClient *client) {
+    for (unsigned i = 0; i < clients_.size(); i++) {
+        if (clients_[i].to_iface() == static_cast<IService *>(client)) {
+            closed_.add_to_list(&clients_[i]);
+            clients_.remove_from_list(i);
+            break;
+        }
+    }
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+    epoll_ctl(hepoll_, EPOLL_CTL_DEL, client->getSocket(), NULL);
+#endif
+    RISCV_info("TCP %s closed", client->getObjName());
+    // Thread may wait a target event, the service is deleted when finished
+    client->closeConnection();
+}
+
+void TcpServer::deleteClient(TcpClient *client) {
+    IClass *icls = static_cast<IClass *>(RISCV_get_class("TcpClientClass"));
+    icls->deleteService(client->getObjName());
+}
+
+/**
+ * Server stop: opened connections are closed, then threads of all closed
+ * connections are joined, including ones still executing a command.
+ */
+void TcpServer::deleteAllClients() {
+    TcpClient *client;
+    while (clients_.size()) {
+        closeClient(static_cast<TcpClient *>(
+                    static_cast<IService *>(clients_[0u].to_iface())));
+    }
+    while (closed_.size()) {
+        client = static_cast<TcpClient *>(
+                    static_cast<IService *>(closed_[0u].to_iface()));
+        closed_.remove_from_list(0u);
+        client->stop();
+        deleteClient(client);
     }
-    closeServerSocket();
 }
 
 int TcpServer::createServerSocket() {
@@ -190,50 +394,55 @@ int TcpServer::createServerSocket() {
     return 0;
 }
 
-void TcpServer::setRcvTimeout(socket_def skt, int timeout_ms) {
-    if (!timeout_ms) {
-        return;
+int TcpServer::createWakeupSocket() {
+    hwake_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (hwake_ < 0) {
+        RISCV_error("%s", "Error: socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)");
+        return -1;
     }
-    struct timeval tv;
-#if defined(_WIN32) || defined(__CYGWIN__)
-    /** On windows timeout of the setsockopt() function is the DWORD
-        * size variable in msec, so we use only the first field in timeval
-        * struct and directly assgign argument.
-        */
-    tv.tv_sec = timeout_ms;
-    tv.tv_usec = 0;
-#else
-    tv.tv_usec = (timeout_ms % 1000) * 1000;
-    tv.tv_sec = timeout_ms / 1000;
-#endif
-    setsockopt(skt, SOL_SOCKET, SO_RCVTIMEO,
-                    reinterpret_cast<char *>(&tv), sizeof(struct timeval));
+    memset(&wakeaddr_, 0, sizeof(wakeaddr_));
+    wakeaddr_.sin_family = AF_INET;
+    wakeaddr_.sin_addr.s_addr = inet_addr("127.0.0.1");
+    wakeaddr_.sin_port = 0;
+    if (bind(hwake_, reinterpret_cast<struct sockaddr *>(&wakeaddr_),
+             sizeof(wakeaddr_)) != 0) {
+        RISCV_error("%s", "Error: bind() wakeup socket");
+        return -1;
+    }
+    addr_size_t addr_sz = sizeof(wakeaddr_);
+    getsockname(hwake_, reinterpret_cast<struct sockaddr *>(&wakeaddr_),
+                &addr_sz);
+    setBlockingMode(hwake_, false);
+    return 0;
 }
 
 bool TcpServer::setBlockingMode(bool mode) {
+    if (setBlockingMode(hsock_, mode)) {
+        blockmode_.make_boolean(mode);
+        return true;
+    }
+    return false;
+}
+
+bool TcpServer::setBlockingMode(socket_def skt, bool mode) {
     int ret;
 #if defined(_WIN32) || defined(__CYGWIN__)
     // 0 = disable non-blocking mode
     // 1 = enable non-blocking mode
     u_long arg = mode ? 0 : 1;
-    ret = ioctlsocket(hsock_, FIONBIO, &arg);
+    ret = ioctlsocket(skt, FIONBIO, &arg);
     if (ret == SOCKET_ERROR) {
         RISCV_error("Set non-blocking socket failed", 0);
     }
 #else
-    int flags = fcntl(hsock_, F_GETFL, 0);
+    int flags = fcntl(skt, F_GETFL, 0);
     if (flags < 0) {
         return false;
     }
     flags = mode ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
-    ret = fcntl(hsock_, F_SETFL, flags);
+    ret = fcntl(skt, F_SETFL, flags);
 #endif
-    if (ret == 0) {
-        // success
-        blockmode_.make_boolean(mode);
-        return true;
-    }
-    return false;
+    return ret == 0;
 }
 
 void TcpServer::closeServerSocket() {
@@ -243,11 +452,14 @@ void TcpServer::closeServerSocket() {
 
 #if defined(_WIN32) || defined(__CYGWIN__)
     closesocket(hsock_);
+    closesocket(hwake_);
 #else
     shutdown(hsock_, SHUT_RDWR);
     close(hsock_);
+    close(hwake_);
 #endif
     hsock_ = -1;
+    hwake_ = -1;
 }
 
 
@@ -21,17 +21,30 @@
 #include <iservice.h>
 #include "coreservices/ithread.h"
 #include "tcpclient.h"
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+#include <sys/epoll.h>
+#endif
 
 namespace debugger {
 
+/**
+ * @brief TCP server with all connections served by a single I/O thread.
+ * @details Sockets are non-blocking and multiplexed with epoll (select on
+ *          Windows). Connection threads and console output put data into
+ *          the connection buffers and call wakeup() to flush them.
+ */
 class TcpServer : public IService,
                   public IThread {
  public:
     explicit TcpServer(const char *name);
+    virtual ~TcpServer();
 
     /** IService interface */
     virtual void postinitService();
 
+    /** Wake up I/O thread to send buffered data from any thread */
+    void wakeup();
+
  protected:
     /** IThread interface */
     virtual void busyLoop();
@@ -39,8 +52,15 @@ class TcpServer : public IService,
  protected:
     int createServerSocket();
     void closeServerSocket();
-    void setRcvTimeout(socket_def skt, int timeout_ms);
+    int createWakeupSocket();
     bool setBlockingMode(bool mode);
+    bool setBlockingMode(socket_def skt, bool mode);
+    void waitEvents(int timeout_ms);
+    void acceptClients();
+    void processClients();
+    void closeClient(TcpClient *client);
+    void deleteClient(TcpClient *client);
+    void deleteAllClients();
 
  private:
     AttributeType isEnable_;
@@ -54,7 +74,14 @@ class TcpServer : public IService,
 
     struct sockaddr_in sockaddr_ipv4_;
     socket_def hsock_;
-    char rcvbuf[4096];
+    socket_def hwake_;
+    struct sockaddr_in wakeaddr_;
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+    int hepoll_;
+#endif
+    AttributeType clients_;     // opened connections
+    AttributeType closed_;      // closed, waiting the thread end
+    int clientIdx_;
 };
 
 DECLARE_CLASS(TcpServer)